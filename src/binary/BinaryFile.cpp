@@ -27,6 +27,7 @@ bool BinaryFile::load(const std::string& filepath) {
     m_filepath = filepath;
     m_loaded = true;
     m_hasChanges = false;
+    notifyWrite(0, WholeFile);
     return true;
 }
 
@@ -57,10 +58,51 @@ bool BinaryFile::save() {
 }
 
 void BinaryFile::clear() {
+    bool hadData = !m_data.empty();
     m_data.clear();
     m_filepath.clear();
     m_loaded = false;
     m_hasChanges = false;
+    if (hadData) {
+        notifyWrite(0, WholeFile);
+    }
+}
+
+size_t BinaryFile::addWriteObserver(WriteObserver observer) {
+    size_t id = m_nextObserverId++;
+    m_writeObservers[id] = std::move(observer);
+    return id;
+}
+
+void BinaryFile::removeWriteObserver(size_t id) {
+    m_writeObservers.erase(id);
+}
+
+void BinaryFile::beginDeferredWrites() {
+    m_deferWrites = true;
+}
+
+void BinaryFile::endDeferredWrites() {
+    std::vector<std::pair<size_t, size_t>> writes;
+    {
+        std::lock_guard<std::mutex> lock(m_deferredMutex);
+        m_deferWrites = false;
+        writes.swap(m_deferredWrites);
+    }
+    for (const auto& [offset, length] : writes) {
+        notifyWrite(offset, length);
+    }
+}
+
+void BinaryFile::notifyWrite(size_t offset, size_t length) {
+    if (m_deferWrites) {
+        std::lock_guard<std::mutex> lock(m_deferredMutex);
+        m_deferredWrites.emplace_back(offset, length);
+        return;
+    }
+    for (const auto& [id, observer] : m_writeObservers) {
+        observer(offset, length);
+    }
 }
 
 uint8_t BinaryFile::readByte(size_t offset) const {
@@ -139,6 +181,7 @@ bool BinaryFile::writeByte(size_t offset, uint8_t value) {
     }
     m_data[offset] = value;
     m_hasChanges = true;
+    notifyWrite(offset, 1);
     return true;
 }
 
@@ -160,6 +203,7 @@ bool BinaryFile::writeInt16(size_t offset, int16_t value, Endianness endian) {
         EndiannessConverter::writeBigEndian<int16_t>(m_data.data() + offset, value);
     }
     m_hasChanges = true;
+    notifyWrite(offset, sizeof(int16_t));
     return true;
 }
 
@@ -173,6 +217,7 @@ bool BinaryFile::writeUInt16(size_t offset, uint16_t value, Endianness endian) {
         EndiannessConverter::writeBigEndian<uint16_t>(m_data.data() + offset, value);
     }
     m_hasChanges = true;
+    notifyWrite(offset, sizeof(uint16_t));
     return true;
 }
 
@@ -186,6 +231,7 @@ bool BinaryFile::writeInt32(size_t offset, int32_t value, Endianness endian) {
         EndiannessConverter::writeBigEndian<int32_t>(m_data.data() + offset, value);
     }
     m_hasChanges = true;
+    notifyWrite(offset, sizeof(int32_t));
     return true;
 }
 
@@ -199,6 +245,7 @@ bool BinaryFile::writeUInt32(size_t offset, uint32_t value, Endianness endian) {
         EndiannessConverter::writeBigEndian<uint32_t>(m_data.data() + offset, value);
     }
     m_hasChanges = true;
+    notifyWrite(offset, sizeof(uint32_t));
     return true;
 }
 
@@ -212,6 +259,7 @@ bool BinaryFile::writeFloat(size_t offset, float value, Endianness endian) {
         EndiannessConverter::writeBigEndian<float>(m_data.data() + offset, value);
     }
     m_hasChanges = true;
+    notifyWrite(offset, sizeof(float));
     return true;
 }
 
@@ -249,6 +297,9 @@ bool BinaryFile::writeBytes(size_t offset, const std::vector<uint8_t>& bytes) {
     }
     
     if (!isValidOffset(offset) || (offset + bytes.size() > m_data.size())) {
+        if (m_deferWrites) {
+            return false; // Other threads may be writing into m_data
+        }
         // Resize if needed
         if (offset + bytes.size() > m_data.size()) {
             m_data.resize(offset + bytes.size());
@@ -257,6 +308,7 @@ bool BinaryFile::writeBytes(size_t offset, const std::vector<uint8_t>& bytes) {
     
     std::memcpy(m_data.data() + offset, bytes.data(), bytes.size());
     m_hasChanges = true;
+    notifyWrite(offset, bytes.size());
     return true;
 }
 
@@ -6,11 +6,21 @@
 #include <vector>
 #include <cstdint>
 #include <string>
+#include <functional>
+#include <map>
+#include <atomic>
+#include <mutex>
+#include <utility>
 
 namespace WinMMM10 {
 
 class BinaryFile {
 public:
+    // Called with the byte range touched by every write. Loading or clearing
+    // the image reports (0, WholeFile).
+    using WriteObserver = std::function<void(size_t offset, size_t length)>;
+    static constexpr size_t WholeFile = static_cast<size_t>(-1);
+    
     BinaryFile();
     ~BinaryFile() = default;
     
@@ -57,12 +67,30 @@ public:
     bool hasChanges() const { return m_hasChanges; }
     void markChanged() { m_hasChanges = true; }
     void markSaved() { m_hasChanges = false; }
+    
+    // Observers are not notified for writes made through data()/at() pointers
+    size_t addWriteObserver(WriteObserver observer);
+    void removeWriteObserver(size_t id);
+    
+    // While deferred, writes only record their ranges and observers run once
+    // per range in endDeferredWrites() on the calling thread. Writes to
+    // disjoint ranges inside the image may then come from several threads;
+    // writes that would grow the image are refused.
+    void beginDeferredWrites();
+    void endDeferredWrites();
 
 private:
+    void notifyWrite(size_t offset, size_t length);
+    
     std::vector<uint8_t> m_data;
     std::string m_filepath;
     bool m_loaded{false};
-    bool m_hasChanges{false};
+    std::atomic<bool> m_hasChanges{false};
+    std::map<size_t, WriteObserver> m_writeObservers;
+    size_t m_nextObserverId{1};
+    bool m_deferWrites{false};
+    std::mutex m_deferredMutex;
+    std::vector<std::pair<size_t, size_t>> m_deferredWrites;
 };
 
 } // namespace WinMMM10
@@ -9,39 +9,72 @@ void EditHistory::pushEdit(size_t offset, uint8_t oldValue, uint8_t newValue) {
         return;
     }
     
-    m_undoStack.push({offset, oldValue, newValue});
+    if (inTransaction()) {
+        m_transaction.push_back({offset, oldValue, newValue});
+        return;
+    }
+    m_undoStack.push({{offset, oldValue, newValue}});
     clearRedo();
 }
 
-Edit EditHistory::undo() {
+void EditHistory::pushRange(size_t offset, const uint8_t* oldBytes, const uint8_t* newBytes, size_t length) {
+    beginTransaction();
+    for (size_t i = 0; i < length; ++i) {
+        if (oldBytes[i] != newBytes[i]) {
+            m_transaction.push_back({offset + i, oldBytes[i], newBytes[i]});
+        }
+    }
+    endTransaction();
+}
+
+void EditHistory::beginTransaction() {
+    ++m_transactionDepth;
+}
+
+void EditHistory::endTransaction() {
+    if (m_transactionDepth == 0 || --m_transactionDepth > 0) {
+        return;
+    }
+    
+    // Empty transactions leave no undo step
+    if (!m_transaction.empty()) {
+        m_undoStack.push(std::move(m_transaction));
+        clearRedo();
+    }
+    m_transaction = Step();
+}
+
+std::vector<Edit> EditHistory::undo() {
     if (m_undoStack.empty()) {
-        return {0, 0, 0};
+        return {};
     }
     
-    Edit edit = m_undoStack.top();
+    Step step = std::move(m_undoStack.top());
     m_undoStack.pop();
-    m_redoStack.push({edit.offset, edit.newValue, edit.oldValue});
-    return edit;
+    std::vector<Edit> edits(step.rbegin(), step.rend());
+    m_redoStack.push(std::move(step));
+    return edits;
 }
 
-Edit EditHistory::redo() {
+std::vector<Edit> EditHistory::redo() {
     if (m_redoStack.empty()) {
-        return {0, 0, 0};
+        return {};
     }
     
-    Edit edit = m_redoStack.top();
+    Step step = std::move(m_redoStack.top());
     m_redoStack.pop();
-    m_undoStack.push({edit.offset, edit.newValue, edit.oldValue});
-    return edit;
+    std::vector<Edit> edits = step;
+    m_undoStack.push(std::move(step));
+    return edits;
 }
 
 void EditHistory::clear() {
     while (!m_undoStack.empty()) {
         m_undoStack.pop();
     }
-    while (!m_redoStack.empty()) {
-        m_redoStack.pop();
-    }
+    clearRedo();
+    m_transaction.clear();
+    m_transactionDepth = 0;
 }
 
 void EditHistory::clearRedo() {
@@ -51,4 +84,3 @@ void EditHistory::clearRedo() {
 }
 
 } // namespace WinMMM10
-
@@ -13,17 +13,30 @@ struct Edit {
     uint8_t newValue;
 };
 
+// Byte-level undo history. Edits pushed between beginTransaction() and
+// endTransaction() form one undo step; outside a transaction every edit is
+// its own step.
 class EditHistory {
 public:
     EditHistory();
     ~EditHistory() = default;
     
     void pushEdit(size_t offset, uint8_t oldValue, uint8_t newValue);
+    // Records the bytes that differ between oldBytes and newBytes
+    void pushRange(size_t offset, const uint8_t* oldBytes, const uint8_t* newBytes, size_t length);
+    
+    // Transactions nest; the outermost endTransaction() closes the step
+    void beginTransaction();
+    void endTransaction();
+    bool inTransaction() const { return m_transactionDepth > 0; }
+    
     bool canUndo() const { return !m_undoStack.empty(); }
     bool canRedo() const { return !m_redoStack.empty(); }
     
-    Edit undo();
-    Edit redo();
+    // Edits of one step in the order they must be applied: undo() returns
+    // them newest first with oldValue to restore, redo() oldest first
+    std::vector<Edit> undo();
+    std::vector<Edit> redo();
     
     void clear();
     void clearRedo();
@@ -32,9 +45,12 @@ public:
     size_t redoCount() const { return m_redoStack.size(); }
 
 private:
-    std::stack<Edit> m_undoStack;
-    std::stack<Edit> m_redoStack;
+    using Step = std::vector<Edit>;
+    
+    std::stack<Step> m_undoStack;
+    std::stack<Step> m_redoStack;
+    Step m_transaction;
+    size_t m_transactionDepth{0};
 };
 
 } // namespace WinMMM10
-
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <algorithm>
+#include <bit>
 #include <cstring>
 
 namespace WinMMM10 {
@@ -11,6 +12,10 @@ enum class Endianness {
     Big
 };
 
+// Byte order of the build target, for compile-time specialization
+inline constexpr Endianness NativeEndianness =
+    (std::endian::native == std::endian::big) ? Endianness::Big : Endianness::Little;
+
 class EndiannessConverter {
 public:
     static Endianness systemEndianness();
@@ -0,0 +1,608 @@
+#include "HashService.h"
+#include "Endianness.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace WinMMM10 {
+
+namespace {
+
+// ---- XXH3 (64-bit), scalar version of the reference algorithm ----
+
+constexpr uint64_t Prime32_1 = 0x9E3779B1U;
+constexpr uint64_t Prime32_2 = 0x85EBCA77U;
+constexpr uint64_t Prime32_3 = 0xC2B2AE3DU;
+constexpr uint64_t Prime64_1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t Prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t Prime64_3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t Prime64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t Prime64_5 = 0x27D4EB2F165667C5ULL;
+constexpr uint64_t PrimeMx1 = 0x165667919E3779F9ULL;
+constexpr uint64_t PrimeMx2 = 0x9FB21C651E98DF25ULL;
+
+constexpr size_t SecretSize = 192;
+constexpr size_t StripeLength = 64;
+constexpr size_t SecretConsumeRate = 8;
+constexpr size_t StripesPerBlock = (SecretSize - StripeLength) / SecretConsumeRate;
+constexpr size_t BlockLength = StripeLength * StripesPerBlock;
+
+constexpr uint8_t DefaultSecret[SecretSize] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    if constexpr (NativeEndianness == Endianness::Big) {
+        value = EndiannessConverter::swapBytes(value);
+    }
+    return value;
+}
+
+uint64_t read64(const uint8_t* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    if constexpr (NativeEndianness == Endianness::Big) {
+        value = EndiannessConverter::swapBytes(value);
+    }
+    return value;
+}
+
+void write64(uint8_t* p, uint64_t value) {
+    if constexpr (NativeEndianness == Endianness::Big) {
+        value = EndiannessConverter::swapBytes(value);
+    }
+    std::memcpy(p, &value, sizeof(value));
+}
+
+uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+uint32_t swap32(uint32_t x) {
+    return ((x << 24) & 0xFF000000U) | ((x << 8) & 0x00FF0000U) | ((x >> 8) & 0x0000FF00U) | ((x >> 24) & 0xFFU);
+}
+
+uint64_t swap64(uint64_t x) {
+    return (static_cast<uint64_t>(swap32(static_cast<uint32_t>(x))) << 32) | swap32(static_cast<uint32_t>(x >> 32));
+}
+
+// Low and high halves of the 128-bit product, xored
+uint64_t mul128Fold64(uint64_t lhs, uint64_t rhs) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t product = static_cast<__uint128_t>(lhs) * rhs;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+    uint64_t loLo = (lhs & 0xFFFFFFFFULL) * (rhs & 0xFFFFFFFFULL);
+    uint64_t hiLo = (lhs >> 32) * (rhs & 0xFFFFFFFFULL);
+    uint64_t loHi = (lhs & 0xFFFFFFFFULL) * (rhs >> 32);
+    uint64_t hiHi = (lhs >> 32) * (rhs >> 32);
+    uint64_t cross = (loLo >> 32) + (hiLo & 0xFFFFFFFFULL) + loHi;
+    uint64_t upper = (hiLo >> 32) + (cross >> 32) + hiHi;
+    uint64_t lower = (cross << 32) | (loLo & 0xFFFFFFFFULL);
+    return lower ^ upper;
+#endif
+}
+
+uint64_t xxh64Avalanche(uint64_t h) {
+    h ^= h >> 33;
+    h *= Prime64_2;
+    h ^= h >> 29;
+    h *= Prime64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t xxh3Avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= PrimeMx1;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t rrmxmx(uint64_t h, uint64_t length) {
+    h ^= rotl64(h, 49) ^ rotl64(h, 24);
+    h *= PrimeMx2;
+    h ^= (h >> 35) + length;
+    h *= PrimeMx2;
+    h ^= h >> 28;
+    return h;
+}
+
+uint64_t mix16(const uint8_t* input, const uint8_t* secret, uint64_t seed) {
+    return mul128Fold64(read64(input) ^ (read64(secret) + seed), read64(input + 8) ^ (read64(secret + 8) - seed));
+}
+
+uint64_t hashUpTo16(const uint8_t* input, size_t length, const uint8_t* secret, uint64_t seed) {
+    if (length > 8) {
+        uint64_t flipLow = (read64(secret + 24) ^ read64(secret + 32)) + seed;
+        uint64_t flipHigh = (read64(secret + 40) ^ read64(secret + 48)) - seed;
+        uint64_t low = read64(input) ^ flipLow;
+        uint64_t high = read64(input + length - 8) ^ flipHigh;
+        uint64_t acc = length + swap64(low) + high + mul128Fold64(low, high);
+        return xxh3Avalanche(acc);
+    }
+    if (length >= 4) {
+        seed ^= static_cast<uint64_t>(swap32(static_cast<uint32_t>(seed))) << 32;
+        uint64_t first = read32(input);
+        uint64_t last = read32(input + length - 4);
+        uint64_t flip = (read64(secret + 8) ^ read64(secret + 16)) - seed;
+        return rrmxmx((last + (first << 32)) ^ flip, length);
+    }
+    if (length > 0) {
+        uint32_t combined = (static_cast<uint32_t>(input[0]) << 16) |
+                            (static_cast<uint32_t>(input[length >> 1]) << 24) |
+                            static_cast<uint32_t>(input[length - 1]) | (static_cast<uint32_t>(length) << 8);
+        uint64_t flip = (read32(secret) ^ read32(secret + 4)) + seed;
+        return xxh64Avalanche(combined ^ flip);
+    }
+    return xxh64Avalanche(seed ^ read64(secret + 56) ^ read64(secret + 64));
+}
+
+uint64_t hashUpTo128(const uint8_t* input, size_t length, const uint8_t* secret, uint64_t seed) {
+    uint64_t acc = length * Prime64_1;
+    if (length > 32) {
+        if (length > 64) {
+            if (length > 96) {
+                acc += mix16(input + 48, secret + 96, seed);
+                acc += mix16(input + length - 64, secret + 112, seed);
+            }
+            acc += mix16(input + 32, secret + 64, seed);
+            acc += mix16(input + length - 48, secret + 80, seed);
+        }
+        acc += mix16(input + 16, secret + 32, seed);
+        acc += mix16(input + length - 32, secret + 48, seed);
+    }
+    acc += mix16(input, secret, seed);
+    acc += mix16(input + length - 16, secret + 16, seed);
+    return xxh3Avalanche(acc);
+}
+
+uint64_t hashUpTo240(const uint8_t* input, size_t length, const uint8_t* secret, uint64_t seed) {
+    uint64_t acc = length * Prime64_1;
+    size_t rounds = length / 16;
+    for (size_t i = 0; i < 8; ++i) {
+        acc += mix16(input + 16 * i, secret + 16 * i, seed);
+    }
+    acc = xxh3Avalanche(acc);
+    for (size_t i = 8; i < rounds; ++i) {
+        acc += mix16(input + 16 * i, secret + 16 * (i - 8) + 3, seed);
+    }
+    acc += mix16(input + length - 16, secret + 136 - 17, seed);
+    return xxh3Avalanche(acc);
+}
+
+void accumulateStripe(uint64_t* acc, const uint8_t* input, const uint8_t* secret) {
+    for (size_t i = 0; i < 8; ++i) {
+        uint64_t value = read64(input + 8 * i);
+        uint64_t key = value ^ read64(secret + 8 * i);
+        acc[i ^ 1] += value;
+        acc[i] += (key & 0xFFFFFFFFULL) * (key >> 32);
+    }
+}
+
+void scramble(uint64_t* acc, const uint8_t* secret) {
+    for (size_t i = 0; i < 8; ++i) {
+        uint64_t value = acc[i];
+        value ^= value >> 47;
+        value ^= read64(secret + 8 * i);
+        acc[i] = value * Prime32_1;
+    }
+}
+
+uint64_t hashLong(const uint8_t* input, size_t length, const uint8_t* secret) {
+    uint64_t acc[8] = {Prime32_3, Prime64_1, Prime64_2, Prime64_3, Prime64_4, Prime32_2, Prime64_5, Prime32_1};
+    
+    size_t blocks = (length - 1) / BlockLength;
+    for (size_t b = 0; b < blocks; ++b) {
+        const uint8_t* block = input + b * BlockLength;
+        for (size_t s = 0; s < StripesPerBlock; ++s) {
+            accumulateStripe(acc, block + s * StripeLength, secret + s * SecretConsumeRate);
+        }
+        scramble(acc, secret + SecretSize - StripeLength);
+    }
+    
+    // Partial last block, then the last 64 bytes as a final stripe
+    size_t stripes = ((length - 1) - blocks * BlockLength) / StripeLength;
+    const uint8_t* tail = input + blocks * BlockLength;
+    for (size_t s = 0; s < stripes; ++s) {
+        accumulateStripe(acc, tail + s * StripeLength, secret + s * SecretConsumeRate);
+    }
+    accumulateStripe(acc, input + length - StripeLength, secret + SecretSize - StripeLength - 7);
+    
+    uint64_t result = length * Prime64_1;
+    for (size_t i = 0; i < 4; ++i) {
+        result += mul128Fold64(acc[2 * i] ^ read64(secret + 11 + 16 * i), acc[2 * i + 1] ^ read64(secret + 19 + 16 * i));
+    }
+    return xxh3Avalanche(result);
+}
+
+// ---- SHA-256 ----
+
+constexpr uint32_t Sha256Rounds[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+uint32_t rotr32(uint32_t x, int r) {
+    return (x >> r) | (x << (32 - r));
+}
+
+uint32_t readBig32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+// ---- Tree hashing ----
+
+size_t resolveWorkers(size_t workerCount, size_t jobs) {
+    if (workerCount == 0) {
+        unsigned int cores = std::thread::hardware_concurrency();
+        workerCount = cores > 0 ? cores : 1;
+    }
+    return std::max<size_t>(1, std::min(workerCount, jobs));
+}
+
+// Runs job(i) for every i in [0, count), the calling thread included
+template<typename Job>
+void runParallel(size_t count, size_t workerCount, Job&& job) {
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < count; i = next++) {
+            job(i);
+        }
+    };
+    
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < resolveWorkers(workerCount, count); ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+HashDigest flatDigest(const uint8_t* data, size_t size, HashAlgorithm algorithm) {
+    HashDigest digest;
+    digest.algorithm = algorithm;
+    if (algorithm == HashAlgorithm::SHA256) {
+        digest.bytes = HashService::sha256(data, size);
+    } else {
+        uint64_t value = HashService::xxh3(data, size);
+        for (size_t i = 0; i < 8; ++i) {
+            digest.bytes[i] = static_cast<uint8_t>(value >> (56 - 8 * i));
+        }
+    }
+    return digest;
+}
+
+// Root of a tree over chunk digests of an input of the given length
+HashDigest rootDigest(const std::vector<HashDigest>& chunks, size_t length, HashAlgorithm algorithm) {
+    std::vector<uint8_t> joined;
+    joined.reserve(chunks.size() * 32 + 8);
+    for (const HashDigest& chunk : chunks) {
+        joined.insert(joined.end(), chunk.bytes.begin(), chunk.bytes.begin() + chunk.size());
+    }
+    uint8_t lengthBytes[8];
+    write64(lengthBytes, length);
+    joined.insert(joined.end(), lengthBytes, lengthBytes + 8);
+    return flatDigest(joined.data(), joined.size(), algorithm);
+}
+
+size_t algorithmSlot(HashAlgorithm algorithm) {
+    return algorithm == HashAlgorithm::SHA256 ? 1 : 0;
+}
+
+} // namespace
+
+std::string HashDigest::toHex() const {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(size() * 2);
+    for (size_t i = 0; i < size(); ++i) {
+        hex += digits[bytes[i] >> 4];
+        hex += digits[bytes[i] & 0x0F];
+    }
+    return hex;
+}
+
+void Sha256::reset() {
+    static const uint32_t initial[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    std::memcpy(m_state, initial, sizeof(m_state));
+    m_buffered = 0;
+    m_length = 0;
+}
+
+void Sha256::compress(const uint8_t* block) {
+    uint32_t w[64];
+    for (size_t i = 0; i < 16; ++i) {
+        w[i] = readBig32(block + 4 * i);
+    }
+    for (size_t i = 16; i < 64; ++i) {
+        uint32_t s0 = rotr32(w[i - 15], 7) ^ rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr32(w[i - 2], 17) ^ rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    
+    uint32_t a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3];
+    uint32_t e = m_state[4], f = m_state[5], g = m_state[6], h = m_state[7];
+    for (size_t i = 0; i < 64; ++i) {
+        uint32_t s1 = rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25);
+        uint32_t choice = (e & f) ^ (~e & g);
+        uint32_t t1 = h + s1 + choice + Sha256Rounds[i] + w[i];
+        uint32_t s0 = rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22);
+        uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = s0 + majority;
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    m_state[0] += a;
+    m_state[1] += b;
+    m_state[2] += c;
+    m_state[3] += d;
+    m_state[4] += e;
+    m_state[5] += f;
+    m_state[6] += g;
+    m_state[7] += h;
+}
+
+void Sha256::update(const uint8_t* data, size_t size) {
+    m_length += size;
+    if (m_buffered > 0) {
+        size_t take = std::min(size, sizeof(m_buffer) - m_buffered);
+        std::memcpy(m_buffer + m_buffered, data, take);
+        m_buffered += take;
+        data += take;
+        size -= take;
+        if (m_buffered < sizeof(m_buffer)) {
+            return;
+        }
+        compress(m_buffer);
+        m_buffered = 0;
+    }
+    
+    // Whole blocks straight from the input
+    for (; size >= sizeof(m_buffer); data += sizeof(m_buffer), size -= sizeof(m_buffer)) {
+        compress(data);
+    }
+    std::memcpy(m_buffer, data, size);
+    m_buffered = size;
+}
+
+std::array<uint8_t, 32> Sha256::finish() {
+    uint64_t bits = m_length * 8;
+    uint8_t padding[72] = {0x80};
+    size_t padLength = (m_buffered < 56 ? 56 : 120) - m_buffered;
+    for (size_t i = 0; i < 8; ++i) {
+        padding[padLength + i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+    }
+    update(padding, padLength + 8);
+    
+    std::array<uint8_t, 32> digest;
+    for (size_t i = 0; i < 8; ++i) {
+        digest[4 * i] = static_cast<uint8_t>(m_state[i] >> 24);
+        digest[4 * i + 1] = static_cast<uint8_t>(m_state[i] >> 16);
+        digest[4 * i + 2] = static_cast<uint8_t>(m_state[i] >> 8);
+        digest[4 * i + 3] = static_cast<uint8_t>(m_state[i]);
+    }
+    reset();
+    return digest;
+}
+
+uint64_t HashService::xxh3(const uint8_t* data, size_t size, uint64_t seed) {
+    if (size <= 16) {
+        return hashUpTo16(data, size, DefaultSecret, seed);
+    }
+    if (size <= 128) {
+        return hashUpTo128(data, size, DefaultSecret, seed);
+    }
+    if (size <= 240) {
+        return hashUpTo240(data, size, DefaultSecret, seed);
+    }
+    if (seed == 0) {
+        return hashLong(data, size, DefaultSecret);
+    }
+    
+    // Long inputs fold a non-zero seed into a derived secret
+    uint8_t secret[SecretSize];
+    for (size_t i = 0; i < SecretSize; i += 16) {
+        write64(secret + i, read64(DefaultSecret + i) + seed);
+        write64(secret + i + 8, read64(DefaultSecret + i + 8) - seed);
+    }
+    return hashLong(data, size, secret);
+}
+
+std::array<uint8_t, 32> HashService::sha256(const uint8_t* data, size_t size) {
+    Sha256 hasher;
+    hasher.update(data, size);
+    return hasher.finish();
+}
+
+HashDigest HashService::hashBuffer(const uint8_t* data, size_t size, HashAlgorithm algorithm, size_t workerCount) {
+    if (size <= ChunkSize) {
+        return flatDigest(data, size, algorithm);
+    }
+    
+    std::vector<HashDigest> chunks((size + ChunkSize - 1) / ChunkSize);
+    runParallel(chunks.size(), workerCount, [&](size_t i) {
+        size_t offset = i * ChunkSize;
+        chunks[i] = flatDigest(data + offset, std::min(ChunkSize, size - offset), algorithm);
+    });
+    return rootDigest(chunks, size, algorithm);
+}
+
+HashService::HashService(BinaryFile& file, size_t workerCount)
+    : m_file(file)
+    , m_workerCount(workerCount)
+{
+    m_observerId = m_file.addWriteObserver([this](size_t offset, size_t length) {
+        invalidate(offset, length);
+    });
+}
+
+HashService::~HashService() {
+    m_file.removeWriteObserver(m_observerId);
+}
+
+void HashService::invalidate(size_t offset, size_t length) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (length != 0) {
+        m_fileSha256Valid = false;
+    }
+    if (length == BinaryFile::WholeFile) {
+        for (ChunkCache& cache : m_chunks) {
+            cache.digests.clear();
+            cache.valid.clear();
+        }
+        m_cachedSize = 0;
+        m_ranges.clear();
+        return;
+    }
+    if (length == 0) {
+        return;
+    }
+    
+    size_t end = offset + length;
+    size_t firstChunk = offset / ChunkSize;
+    for (ChunkCache& cache : m_chunks) {
+        size_t lastChunk = std::min((end - 1) / ChunkSize + 1, cache.valid.size());
+        for (size_t i = firstChunk; i < lastChunk; ++i) {
+            cache.valid[i] = 0;
+        }
+    }
+    for (auto it = m_ranges.begin(); it != m_ranges.end();) {
+        size_t rangeOffset = std::get<0>(it->first);
+        size_t rangeLength = std::get<1>(it->first);
+        if (offset < rangeOffset + rangeLength && rangeOffset < end) {
+            it = m_ranges.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+HashDigest HashService::hash(HashAlgorithm algorithm) {
+    HashDigest empty;
+    empty.algorithm = algorithm;
+    if (!m_file.isLoaded()) {
+        return empty;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t size = m_file.size();
+    if (size <= ChunkSize) {
+        return flatDigest(m_file.data(), size, algorithm);
+    }
+    
+    // A size change moves the end of the old and the new last chunk
+    size_t chunkCount = (size + ChunkSize - 1) / ChunkSize;
+    if (size != m_cachedSize) {
+        for (ChunkCache& cache : m_chunks) {
+            if (!cache.valid.empty()) {
+                cache.valid.back() = 0;
+            }
+            cache.digests.resize(chunkCount);
+            cache.valid.resize(chunkCount, 0);
+            cache.valid.back() = 0;
+        }
+        m_cachedSize = size;
+    }
+    
+    ChunkCache& cache = m_chunks[algorithmSlot(algorithm)];
+    std::vector<size_t> stale;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        if (!cache.valid[i]) {
+            stale.push_back(i);
+        }
+    }
+    const uint8_t* data = m_file.data();
+    runParallel(stale.size(), m_workerCount, [&](size_t job) {
+        size_t offset = stale[job] * ChunkSize;
+        cache.digests[stale[job]] = flatDigest(data + offset, std::min(ChunkSize, size - offset), algorithm);
+    });
+    for (size_t i : stale) {
+        cache.valid[i] = 1;
+    }
+    return rootDigest(cache.digests, size, algorithm);
+}
+
+HashDigest HashService::hashRange(size_t offset, size_t length, HashAlgorithm algorithm) {
+    HashDigest empty;
+    empty.algorithm = algorithm;
+    if (!m_file.isLoaded() || offset > m_file.size() || length > m_file.size() - offset) {
+        return empty;
+    }
+    if (offset == 0 && length == m_file.size()) {
+        return hash(algorithm);
+    }
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto key = std::make_tuple(offset, length, algorithm);
+    auto it = m_ranges.find(key);
+    if (it != m_ranges.end()) {
+        return it->second;
+    }
+    
+    // Ranges are cheap to recompute; keep only the recent ones
+    if (m_ranges.size() >= 256) {
+        m_ranges.clear();
+    }
+    HashDigest digest = hashBuffer(m_file.data() + offset, length, algorithm, m_workerCount);
+    m_ranges.emplace(key, digest);
+    return digest;
+}
+
+HashDigest HashService::fileSha256() {
+    HashDigest digest;
+    digest.algorithm = HashAlgorithm::SHA256;
+    if (!m_file.isLoaded()) {
+        return digest;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_fileSha256Valid) {
+        m_fileSha256.algorithm = HashAlgorithm::SHA256;
+        m_fileSha256.bytes = sha256(m_file.data(), m_file.size());
+        m_fileSha256Valid = true;
+    }
+    return m_fileSha256;
+}
+
+size_t HashService::cachedChunks(HashAlgorithm algorithm) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const ChunkCache& cache = m_chunks[algorithmSlot(algorithm)];
+    return static_cast<size_t>(std::count(cache.valid.begin(), cache.valid.end(), 1));
+}
+
+void HashService::clearCache() {
+    invalidate(0, BinaryFile::WholeFile);
+}
+
+} // namespace WinMMM10
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "BinaryFile.h"
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace WinMMM10 {
+
+enum class HashAlgorithm {
+    XXH3,  // 64-bit XXH3, fast, for cache keys
+    SHA256 // Tree digest over large inputs; see HashService::fileSha256()
+};
+
+struct HashDigest {
+    HashAlgorithm algorithm{HashAlgorithm::XXH3};
+    std::array<uint8_t, 32> bytes{}; // XXH3 fills the first 8, big-endian
+    
+    size_t size() const { return algorithm == HashAlgorithm::XXH3 ? 8 : 32; }
+    std::string toHex() const;
+    bool operator==(const HashDigest& other) const = default;
+};
+
+// Streaming SHA-256 (FIPS 180-4)
+class Sha256 {
+public:
+    Sha256() { reset(); }
+    
+    void reset();
+    void update(const uint8_t* data, size_t size);
+    std::array<uint8_t, 32> finish();
+
+private:
+    void compress(const uint8_t* block);
+    
+    uint32_t m_state[8];
+    uint8_t m_buffer[64];
+    size_t m_buffered{0};
+    uint64_t m_length{0};
+};
+
+// Hashes of loaded binaries and of ranges inside them.
+//
+// Inputs up to ChunkSize bytes hash to the plain XXH3 / SHA-256 of their
+// bytes. Larger inputs are tree hashed: every ChunkSize chunk is hashed on its
+// own, in parallel, and the digest is the hash of the chunk digests followed
+// by the input length (little-endian 64-bit). Tree digests therefore do not
+// match sha256sum output; compare them only with other HashService digests,
+// e.g. as cache keys. Integrity checks and stored file hashes use
+// fileSha256(), the plain SHA-256 of the whole image.
+//
+// A service attaches to one BinaryFile and keeps the chunk digests of the
+// whole image and the digests of recently hashed ranges. Its write observer
+// drops whatever a write touches, so hashing again after an edit only
+// rehashes the changed chunks. The service must not outlive the file.
+class HashService {
+public:
+    static constexpr size_t ChunkSize = size_t(1) << 20;
+    
+    explicit HashService(BinaryFile& file, size_t workerCount = 0);
+    ~HashService();
+    HashService(const HashService&) = delete;
+    HashService& operator=(const HashService&) = delete;
+    
+    // Empty digest (all zero bytes) if no binary is loaded or the range lies
+    // outside it
+    HashDigest hash(HashAlgorithm algorithm);
+    HashDigest hashRange(size_t offset, size_t length, HashAlgorithm algorithm);
+    // Streamed over the whole image in one pass, as sha256sum prints it; kept
+    // until the next write
+    HashDigest fileSha256();
+    
+    // Number of chunks currently cached for the whole-image digest
+    size_t cachedChunks(HashAlgorithm algorithm) const;
+    void clearCache();
+    
+    // One-shot hashes of a buffer
+    static uint64_t xxh3(const uint8_t* data, size_t size, uint64_t seed = 0);
+    static std::array<uint8_t, 32> sha256(const uint8_t* data, size_t size);
+    static HashDigest hashBuffer(const uint8_t* data, size_t size, HashAlgorithm algorithm,
+                                 size_t workerCount = 0);
+    
+    // FNV-1a over the raw bytes of a trivially copyable value, for small keys
+    // built field by field; start from Fnv1aBasis
+    static constexpr uint64_t Fnv1aBasis = 0xCBF29CE484222325ULL;
+    template<typename T>
+    static void fnv1a(uint64_t& hash, const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            hash ^= bytes[i];
+            hash *= 0x100000001B3ULL;
+        }
+    }
+
+private:
+    struct ChunkCache {
+        std::vector<HashDigest> digests;
+        std::vector<uint8_t> valid;
+    };
+    
+    void invalidate(size_t offset, size_t length);
+    
+    BinaryFile& m_file;
+    size_t m_observerId{0};
+    size_t m_workerCount;
+    mutable std::mutex m_mutex;
+    ChunkCache m_chunks[2];
+    size_t m_cachedSize{0};
+    HashDigest m_fileSha256;
+    bool m_fileSha256Valid{false};
+    std::map<std::tuple<size_t, size_t, HashAlgorithm>, HashDigest> m_ranges;
+};
+
+} // namespace WinMMM10
@@ -9,13 +9,13 @@ MemoryMapper::~MemoryMapper() {
     close();
 }
 
-bool MemoryMapper::open(const std::string& filepath) {
+bool MemoryMapper::open(const std::string& filepath, bool readOnly, AccessHint hint) {
     close();
     
 #ifdef _WIN32
     m_fileHandle = CreateFileA(
         filepath.c_str(),
-        GENERIC_READ | GENERIC_WRITE,
+        readOnly ? GENERIC_READ : GENERIC_READ | GENERIC_WRITE,
         FILE_SHARE_READ,
         nullptr,
         OPEN_EXISTING,
@@ -45,7 +45,7 @@ bool MemoryMapper::open(const std::string& filepath) {
     m_mapHandle = CreateFileMapping(
         m_fileHandle,
         nullptr,
-        PAGE_READWRITE,
+        readOnly ? PAGE_READONLY : PAGE_READWRITE,
         0,
         0,
         nullptr
@@ -59,7 +59,7 @@ bool MemoryMapper::open(const std::string& filepath) {
     
     m_mappedData = MapViewOfFile(
         m_mapHandle,
-        FILE_MAP_ALL_ACCESS,
+        readOnly ? FILE_MAP_READ : FILE_MAP_ALL_ACCESS,
         0,
         0,
         m_size
@@ -73,11 +73,21 @@ bool MemoryMapper::open(const std::string& filepath) {
         return false;
     }
     
+    // A read-only view stays valid without the handles; drop them so many
+    // mapped files do not use up the handle limit
+    if (readOnly) {
+        CloseHandle(m_mapHandle);
+        CloseHandle(m_fileHandle);
+        m_mapHandle = nullptr;
+        m_fileHandle = INVALID_HANDLE_VALUE;
+    }
+    
     m_data = static_cast<uint8_t*>(m_mappedData);
     m_mapped = true;
+    m_readOnly = readOnly;
     return true;
 #else
-    m_fileDescriptor = ::open(filepath.c_str(), O_RDWR);
+    m_fileDescriptor = ::open(filepath.c_str(), readOnly ? O_RDONLY : O_RDWR);
     if (m_fileDescriptor < 0) {
         return false;
     }
@@ -96,15 +106,26 @@ bool MemoryMapper::open(const std::string& filepath) {
         return false;
     }
     
-    m_mappedData = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fileDescriptor, 0);
+    m_mappedData = readOnly ? mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fileDescriptor, 0)
+                            : mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fileDescriptor, 0);
     if (m_mappedData == MAP_FAILED) {
         ::close(m_fileDescriptor);
         m_fileDescriptor = -1;
         return false;
     }
+    if (hint != AccessHint::Normal) {
+        madvise(m_mappedData, m_size, hint == AccessHint::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+    }
+    if (readOnly) {
+        // The mapping outlives the descriptor; many mapped files must not use
+        // up the descriptor limit
+        ::close(m_fileDescriptor);
+        m_fileDescriptor = -1;
+    }
     
     m_data = static_cast<uint8_t*>(m_mappedData);
     m_mapped = true;
+    m_readOnly = readOnly;
     return true;
 #endif
 }
@@ -141,6 +162,7 @@ void MemoryMapper::close() {
     m_data = nullptr;
     m_size = 0;
     m_mapped = false;
+    m_readOnly = false;
 }
 
 const uint8_t* MemoryMapper::at(size_t offset) const {
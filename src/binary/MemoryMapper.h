@@ -20,10 +20,20 @@ public:
     MemoryMapper();
     ~MemoryMapper();
     
-    bool open(const std::string& filepath);
+    // How the caller will walk the mapping, passed on to the kernel
+    enum class AccessHint {
+        Normal,     // Default readahead
+        Sequential, // Read once from start to end, e.g. by a parser
+        Random      // Scattered lookups; readahead would be wasted
+    };
+    
+    // A read-only mapping is private; writing through data() then faults, so
+    // only readers such as importers use it. The hint is ignored on Windows.
+    bool open(const std::string& filepath, bool readOnly = false, AccessHint hint = AccessHint::Normal);
     void close();
     
     bool isOpen() const { return m_mapped; }
+    bool isReadOnly() const { return m_readOnly; }
     size_t size() const { return m_size; }
     
     const uint8_t* data() const { return m_data; }
@@ -42,6 +52,7 @@ private:
     uint8_t* m_data{nullptr};
     size_t m_size{0};
     bool m_mapped{false};
+    bool m_readOnly{false};
     
 #ifdef _WIN32
     HANDLE m_fileHandle{INVALID_HANDLE_VALUE};
@@ -7,6 +7,8 @@
 #include <QFile>
 #include <QCoreApplication>
 #include <QDebug>
+#include <QDirIterator>
+#include <QThreadPool>
 #include <algorithm>
 #include <fstream>
 #include <sstream>
@@ -19,12 +21,25 @@ ApplicationCache& ApplicationCache::instance() {
     return instance;
 }
 
-void ApplicationCache::initializeDirectories() {
-    // Early return if already initialized
-    if (!m_cacheDir.empty()) {
-        return;
-    }
-    
+void ApplicationCache::initializeDirectories() const {
+    // Thumbnail and eviction workers may be the first to ask for a directory
+    std::call_once(m_directoriesOnce, [this]() {
+        ApplicationCache* self = const_cast<ApplicationCache*>(this);
+        try {
+            self->createDirectories();
+        }
+        catch (const std::exception& e) {
+            // Log error but continue - cache is optional
+            qWarning() << "Failed to initialize cache directories:" << e.what();
+            QFileInfo exeInfo(QCoreApplication::applicationFilePath());
+            self->m_cacheDir = (exeInfo.absolutePath() + "/cache").toStdString();
+            self->m_tempDir = (exeInfo.absolutePath() + "/cache/temp").toStdString();
+            self->m_thumbnailDir = (exeInfo.absolutePath() + "/cache/thumbnails").toStdString();
+        }
+    });
+}
+
+void ApplicationCache::createDirectories() {
     QString cacheBase;
     
     try {
@@ -150,52 +165,103 @@ void ApplicationCache::clearRecentFiles() {
 }
 
 std::string ApplicationCache::getCacheDirectory() const {
-    if (m_cacheDir.empty()) {
-        // Use mutable version to initialize
-        ApplicationCache* mutableThis = const_cast<ApplicationCache*>(this);
-        mutableThis->initializeDirectories();
-    }
+    initializeDirectories();
     return m_cacheDir;
 }
 
 std::string ApplicationCache::getTempDirectory() const {
-    if (m_tempDir.empty()) {
-        ApplicationCache* mutableThis = const_cast<ApplicationCache*>(this);
-        mutableThis->initializeDirectories();
-    }
+    initializeDirectories();
     return m_tempDir;
 }
 
 std::string ApplicationCache::getThumbnailDirectory() const {
-    if (m_thumbnailDir.empty()) {
-        ApplicationCache* mutableThis = const_cast<ApplicationCache*>(this);
-        mutableThis->initializeDirectories();
-    }
+    initializeDirectories();
     return m_thumbnailDir;
 }
 
-uint64_t ApplicationCache::calculateDirectorySize(const std::string& path) const {
-    uint64_t totalSize = 0;
-    QDir dir(QString::fromStdString(path));
-    if (!dir.exists()) return 0;
-    
-    QFileInfoList entries = dir.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
-    for (const QFileInfo& info : entries) {
-        if (info.isFile()) {
-            totalSize += info.size();
-        } else if (info.isDir()) {
-            totalSize += calculateDirectorySize(info.absoluteFilePath().toStdString());
-        }
+std::string ApplicationCache::getCategoryDirectory(CacheCategory category) const {
+    switch (category) {
+        case CacheCategory::Thumbnails: return getThumbnailDirectory();
+        case CacheCategory::Temp: return getTempDirectory();
+        case CacheCategory::Projects: return getCacheDirectory() + "/projects";
+        default: return {};
     }
-    return totalSize;
 }
 
 uint64_t ApplicationCache::getCacheSize() const {
-    return calculateDirectorySize(getCacheDirectory());
+    std::lock_guard<std::mutex> lock(m_ledgerMutex);
+    uint64_t total = 0;
+    for (uint64_t size : m_ledger) {
+        total += size;
+    }
+    return total;
 }
 
 uint64_t ApplicationCache::getTempSize() const {
-    return calculateDirectorySize(getTempDirectory());
+    return getCategorySize(CacheCategory::Temp);
+}
+
+uint64_t ApplicationCache::getCategorySize(CacheCategory category) const {
+    std::lock_guard<std::mutex> lock(m_ledgerMutex);
+    return m_ledger[static_cast<size_t>(category)];
+}
+
+void ApplicationCache::recordWrite(CacheCategory category, int64_t deltaBytes) {
+    std::lock_guard<std::mutex> lock(m_ledgerMutex);
+    uint64_t& size = m_ledger[static_cast<size_t>(category)];
+    if (deltaBytes < 0 && static_cast<uint64_t>(-deltaBytes) > size) {
+        size = 0; // Ledger drifted; the next reconcile corrects it
+    } else {
+        size += deltaBytes;
+    }
+}
+
+void ApplicationCache::resetCategory(CacheCategory category) {
+    std::lock_guard<std::mutex> lock(m_ledgerMutex);
+    m_ledger[static_cast<size_t>(category)] = 0;
+}
+
+bool ApplicationCache::reconcileSizes(std::function<void()> onFinished) {
+    if (m_reconciling.exchange(true)) {
+        return false; // A scan is already running
+    }
+    
+    // Resolve directories once, before the scan starts
+    QString cacheDir = QString::fromStdString(getCacheDirectory());
+    QString tempDir = QString::fromStdString(getTempDirectory());
+    QString thumbnailDir = QString::fromStdString(getThumbnailDirectory());
+    QString projectDir = QString::fromStdString(getCategoryDirectory(CacheCategory::Projects));
+    
+    QThreadPool::globalInstance()->start([this, cacheDir, tempDir, thumbnailDir, projectDir, onFinished]() {
+        std::array<uint64_t, CategoryCount> scanned{};
+        
+        QDirIterator it(cacheDir, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            it.next();
+            QString path = it.filePath();
+            CacheCategory category = CacheCategory::Other;
+            if (path.startsWith(thumbnailDir + "/")) {
+                category = CacheCategory::Thumbnails;
+            } else if (path.startsWith(tempDir + "/")) {
+                category = CacheCategory::Temp;
+            } else if (path.startsWith(projectDir + "/")) {
+                category = CacheCategory::Projects;
+            }
+            scanned[static_cast<size_t>(category)] += it.fileInfo().size();
+        }
+        
+        // Writes that raced with the scan are folded in by the next reconcile
+        {
+            std::lock_guard<std::mutex> lock(m_ledgerMutex);
+            m_ledger = scanned;
+        }
+        m_reconciling = false;
+        
+        if (onFinished) {
+            onFinished();
+        }
+    });
+    return true;
 }
 
 void ApplicationCache::removeDirectoryContents(const std::string& path) const {
@@ -217,12 +283,18 @@ void ApplicationCache::removeDirectoryContents(const std::string& path) const {
 
 void ApplicationCache::clearCache() {
     removeDirectoryContents(getCacheDirectory());
+    {
+        std::lock_guard<std::mutex> lock(m_ledgerMutex);
+        m_ledger.fill(0);
+    }
     // Recreate directories
-    initializeDirectories();
+    QDir().mkpath(QString::fromStdString(m_tempDir));
+    QDir().mkpath(QString::fromStdString(m_thumbnailDir));
 }
 
 void ApplicationCache::clearTempFiles() {
     removeDirectoryContents(getTempDirectory());
+    resetCategory(CacheCategory::Temp);
     // Recreate temp directory
     QDir tempDir(QString::fromStdString(m_tempDir));
     if (!tempDir.exists()) {
@@ -232,30 +304,37 @@ void ApplicationCache::clearTempFiles() {
 
 void ApplicationCache::saveThumbnail(const std::string& key, const std::vector<uint8_t>& data) {
     std::string filename = getThumbnailDirectory() + "/" + key + ".thumb";
+    QFileInfo previous(QString::fromStdString(filename));
+    int64_t previousSize = previous.exists() ? previous.size() : 0;
+    
     std::ofstream file(filename, std::ios::binary);
     if (file.is_open()) {
         file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        recordWrite(CacheCategory::Thumbnails, static_cast<int64_t>(data.size()) - previousSize);
     }
 }
 
 std::vector<uint8_t> ApplicationCache::loadThumbnail(const std::string& key) const {
     std::string filename = getThumbnailDirectory() + "/" + key + ".thumb";
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
+    QFile file(QString::fromStdString(filename));
+    if (!file.open(QIODevice::ReadOnly)) {
         return {};
     }
     
-    file.seekg(0, std::ios::end);
-    size_t size = file.tellg();
-    file.seekg(0, std::ios::beg);
+    QByteArray bytes = file.readAll();
+    file.close();
     
-    std::vector<uint8_t> data(size);
-    file.read(reinterpret_cast<char*>(data.data()), size);
-    return data;
+    // Record the access for LRU eviction; many filesystems are mounted noatime.
+    // Windows only sets file times through a handle with write access.
+    if (file.open(QIODevice::ReadWrite)) {
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileAccessTime);
+    }
+    return std::vector<uint8_t>(bytes.begin(), bytes.end());
 }
 
 void ApplicationCache::clearThumbnails() {
     removeDirectoryContents(getThumbnailDirectory());
+    resetCategory(CacheCategory::Thumbnails);
     QDir thumbDir(QString::fromStdString(m_thumbnailDir));
     if (!thumbDir.exists()) {
         thumbDir.mkpath(".");
@@ -263,21 +342,7 @@ void ApplicationCache::clearThumbnails() {
 }
 
 void ApplicationCache::load() {
-    try {
-        initializeDirectories();
-    }
-    catch (const std::exception& e) {
-        // Log error but continue - cache is optional
-        qWarning() << "Failed to initialize cache directories:" << e.what();
-        // Use fallback paths
-        if (m_cacheDir.empty()) {
-            QString exePath = QCoreApplication::applicationFilePath();
-            QFileInfo exeInfo(exePath);
-            m_cacheDir = (exeInfo.absolutePath() + "/cache").toStdString();
-            m_tempDir = (exeInfo.absolutePath() + "/cache/temp").toStdString();
-            m_thumbnailDir = (exeInfo.absolutePath() + "/cache/thumbnails").toStdString();
-        }
-    }
+    initializeDirectories();
     
     try {
         QSettings settings(QSettings::IniFormat, QSettings::UserScope, "WinMMM10", "Editor");
@@ -307,6 +372,19 @@ void ApplicationCache::load() {
             m_recentBinaries.push_back(rf);
         }
         settings.endArray();
+        
+        // Load size ledger; rebuild it in the background if it was never written
+        bool hasLedger = settings.contains("cacheLedger/thumbnails");
+        {
+            std::lock_guard<std::mutex> lock(m_ledgerMutex);
+            m_ledger[static_cast<size_t>(CacheCategory::Thumbnails)] = settings.value("cacheLedger/thumbnails").toULongLong();
+            m_ledger[static_cast<size_t>(CacheCategory::Temp)] = settings.value("cacheLedger/temp").toULongLong();
+            m_ledger[static_cast<size_t>(CacheCategory::Projects)] = settings.value("cacheLedger/projects").toULongLong();
+            m_ledger[static_cast<size_t>(CacheCategory::Other)] = settings.value("cacheLedger/other").toULongLong();
+        }
+        if (!hasLedger) {
+            reconcileSizes();
+        }
     }
     catch (const std::exception& e) {
         qWarning() << "Failed to load cache settings:" << e.what();
@@ -336,6 +414,13 @@ void ApplicationCache::save() {
         settings.setValue("lastAccessed", m_recentBinaries[i].lastAccessed);
     }
     settings.endArray();
+    
+    // Save size ledger
+    std::lock_guard<std::mutex> lock(m_ledgerMutex);
+    settings.setValue("cacheLedger/thumbnails", static_cast<qulonglong>(m_ledger[static_cast<size_t>(CacheCategory::Thumbnails)]));
+    settings.setValue("cacheLedger/temp", static_cast<qulonglong>(m_ledger[static_cast<size_t>(CacheCategory::Temp)]));
+    settings.setValue("cacheLedger/projects", static_cast<qulonglong>(m_ledger[static_cast<size_t>(CacheCategory::Projects)]));
+    settings.setValue("cacheLedger/other", static_cast<qulonglong>(m_ledger[static_cast<size_t>(CacheCategory::Other)]));
 }
 
 } // namespace WinMMM10
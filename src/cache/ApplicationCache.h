@@ -4,6 +4,10 @@
 #include <vector>
 #include <cstdint>
 #include <filesystem>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <mutex>
 
 namespace WinMMM10 {
 
@@ -13,6 +17,13 @@ struct RecentFile {
     int64_t lastAccessed{0};
 };
 
+enum class CacheCategory {
+    Thumbnails,
+    Temp,
+    Projects,
+    Other
+};
+
 class ApplicationCache {
 public:
     static ApplicationCache& instance();
@@ -28,13 +39,24 @@ public:
     std::string getCacheDirectory() const;
     std::string getTempDirectory() const;
     std::string getThumbnailDirectory() const;
+    std::string getCategoryDirectory(CacheCategory category) const; // Empty for Other
     
-    // Cache size management
+    // Cache size management (served from the size ledger, no directory walk)
     uint64_t getCacheSize() const;
     uint64_t getTempSize() const;
+    uint64_t getCategorySize(CacheCategory category) const;
     void clearCache();
     void clearTempFiles();
     
+    // Size ledger: writers report byte deltas for files they create or delete
+    void recordWrite(CacheCategory category, int64_t deltaBytes);
+    
+    // Re-scans the cache directories on a worker thread and replaces the ledger.
+    // onFinished is invoked on that worker thread. Returns false (and never calls
+    // onFinished) if a scan is already running.
+    bool reconcileSizes(std::function<void()> onFinished = nullptr);
+    bool isReconciling() const { return m_reconciling.load(); }
+    
     // Thumbnail cache
     void saveThumbnail(const std::string& key, const std::vector<uint8_t>& data);
     std::vector<uint8_t> loadThumbnail(const std::string& key) const;
@@ -50,15 +72,22 @@ private:
     ApplicationCache(const ApplicationCache&) = delete;
     ApplicationCache& operator=(const ApplicationCache&) = delete;
     
-    void initializeDirectories();
-    uint64_t calculateDirectorySize(const std::string& path) const;
+    void initializeDirectories() const; // Once, from whichever thread asks first
+    void createDirectories();
     void removeDirectoryContents(const std::string& path) const;
+    void resetCategory(CacheCategory category);
     
     std::vector<RecentFile> m_recentProjects;
     std::vector<RecentFile> m_recentBinaries;
     std::string m_cacheDir;
     std::string m_tempDir;
     std::string m_thumbnailDir;
+    mutable std::once_flag m_directoriesOnce;
+    
+    static constexpr size_t CategoryCount = 4;
+    mutable std::mutex m_ledgerMutex;
+    std::array<uint64_t, CategoryCount> m_ledger{};
+    std::atomic<bool> m_reconciling{false};
 };
 
 } // namespace WinMMM10
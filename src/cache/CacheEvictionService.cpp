@@ -0,0 +1,241 @@
+#include "CacheEvictionService.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSettings>
+#include <algorithm>
+#include <vector>
+
+namespace WinMMM10 {
+
+namespace {
+
+const char* categoryKey(CacheCategory category) {
+    switch (category) {
+        case CacheCategory::Thumbnails: return "thumbnails";
+        case CacheCategory::Temp: return "temp";
+        case CacheCategory::Projects: return "projects";
+        default: return "other";
+    }
+}
+
+// Last access time if the filesystem records it, otherwise last modification
+QDateTime lastUsed(const QFileInfo& info) {
+    QDateTime read = info.lastRead();
+    QDateTime modified = info.lastModified();
+    if (!read.isValid() || read < modified) {
+        return modified;
+    }
+    return read;
+}
+
+} // namespace
+
+CacheEvictionService::CacheEvictionService() {
+    const int64_t day = 24 * 60 * 60;
+    m_policies[static_cast<size_t>(CacheCategory::Thumbnails)] = {256ULL * 1024 * 1024, 30 * day};
+    m_policies[static_cast<size_t>(CacheCategory::Temp)] = {1024ULL * 1024 * 1024, 7 * day};
+    m_policies[static_cast<size_t>(CacheCategory::Projects)] = {512ULL * 1024 * 1024, 90 * day};
+}
+
+CacheEvictionService::~CacheEvictionService() {
+    stop();
+}
+
+void CacheEvictionService::setPolicy(CacheCategory category, const EvictionPolicy& policy) {
+    size_t index = static_cast<size_t>(category);
+    if (index >= CategoryCount) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_policies[index] = policy;
+}
+
+EvictionPolicy CacheEvictionService::policy(CacheCategory category) const {
+    size_t index = static_cast<size_t>(category);
+    if (index >= CategoryCount) {
+        return EvictionPolicy();
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_policies[index];
+}
+
+void CacheEvictionService::start(std::chrono::seconds interval, PassCallback onFirstPass) {
+    stop();
+    
+    // Resolve directories once, before the thread starts
+    auto& cache = ApplicationCache::instance();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < CategoryCount; ++i) {
+            m_directories[i] = cache.getCategoryDirectory(static_cast<CacheCategory>(i));
+        }
+        m_stopRequested = false;
+        if (onFirstPass) {
+            m_passCallbacks.push_back(std::move(onFirstPass));
+        }
+    }
+    
+    m_thread = std::thread(&CacheEvictionService::threadMain, this, interval);
+}
+
+void CacheEvictionService::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopRequested = true;
+    }
+    m_wakeup.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+bool CacheEvictionService::isRunning() const {
+    return m_thread.joinable();
+}
+
+bool CacheEvictionService::requestPass(PassCallback onFinished) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_thread.joinable() || m_stopRequested) {
+            return false;
+        }
+        m_passRequested = true;
+        if (onFinished) {
+            m_passCallbacks.push_back(std::move(onFinished));
+        }
+    }
+    m_wakeup.notify_all();
+    return true;
+}
+
+void CacheEvictionService::threadMain(std::chrono::seconds interval) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopRequested) {
+        std::vector<PassCallback> callbacks;
+        callbacks.swap(m_passCallbacks);
+        m_passRequested = false;
+        lock.unlock();
+        Result result = runOnce();
+        for (const PassCallback& callback : callbacks) {
+            callback(result);
+        }
+        lock.lock();
+        m_wakeup.wait_for(lock, interval, [this]() { return m_stopRequested || m_passRequested; });
+    }
+    m_passCallbacks.clear();
+}
+
+CacheEvictionService::Result CacheEvictionService::runOnce() {
+    std::lock_guard<std::mutex> passLock(m_passMutex);
+    
+    std::array<EvictionPolicy, CategoryCount> policies;
+    std::array<std::string, CategoryCount> directories;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        policies = m_policies;
+        directories = m_directories;
+    }
+    
+    Result total;
+    for (size_t i = 0; i < CategoryCount; ++i) {
+        if (directories[i].empty()) {
+            directories[i] = ApplicationCache::instance().getCategoryDirectory(static_cast<CacheCategory>(i));
+        }
+        Result result = evictCategory(static_cast<CacheCategory>(i), directories[i], policies[i]);
+        total.filesRemoved += result.filesRemoved;
+        total.bytesFreed += result.bytesFreed;
+    }
+    return total;
+}
+
+CacheEvictionService::Result CacheEvictionService::evictCategory(CacheCategory category,
+                                                                  const std::string& directory,
+                                                                  const EvictionPolicy& policy) const {
+    Result result;
+    if (policy.maxBytes == 0 && policy.maxAgeSeconds == 0) {
+        return result;
+    }
+    
+    QDir dir(QString::fromStdString(directory));
+    if (!dir.exists()) {
+        return result;
+    }
+    
+    struct CacheFile {
+        QString path;
+        uint64_t size;
+        QDateTime used;
+    };
+    
+    // Files in subdirectories count against the category too
+    std::vector<CacheFile> files;
+    uint64_t totalSize = 0;
+    QDirIterator it(dir.absolutePath(), QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        QFileInfo info = it.fileInfo();
+        files.push_back({info.absoluteFilePath(), static_cast<uint64_t>(info.size()), lastUsed(info)});
+        totalSize += info.size();
+    }
+    
+    // Least recently used first
+    std::sort(files.begin(), files.end(), [](const CacheFile& a, const CacheFile& b) {
+        return a.used < b.used;
+    });
+    
+    QDateTime cutoff;
+    if (policy.maxAgeSeconds > 0) {
+        cutoff = QDateTime::currentDateTime().addSecs(-policy.maxAgeSeconds);
+    }
+    
+    for (const CacheFile& file : files) {
+        bool expired = cutoff.isValid() && file.used < cutoff;
+        bool overBudget = policy.maxBytes > 0 && totalSize > policy.maxBytes;
+        if (!expired && !overBudget) {
+            break; // Remaining files are newer and the category fits
+        }
+        
+        if (QFile::remove(file.path)) {
+            totalSize -= file.size;
+            result.filesRemoved++;
+            result.bytesFreed += file.size;
+        }
+    }
+    
+    if (result.bytesFreed > 0) {
+        ApplicationCache::instance().recordWrite(category, -static_cast<int64_t>(result.bytesFreed));
+    }
+    return result;
+}
+
+void CacheEvictionService::load() {
+    QSettings settings(QSettings::IniFormat, QSettings::UserScope, "WinMMM10", "Editor");
+    settings.beginGroup("cacheEviction");
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < CategoryCount; ++i) {
+        QString key = categoryKey(static_cast<CacheCategory>(i));
+        EvictionPolicy& policy = m_policies[i];
+        policy.maxBytes = settings.value(key + "/maxBytes", static_cast<qulonglong>(policy.maxBytes)).toULongLong();
+        policy.maxAgeSeconds = settings.value(key + "/maxAgeSeconds", static_cast<qlonglong>(policy.maxAgeSeconds)).toLongLong();
+    }
+    settings.endGroup();
+}
+
+void CacheEvictionService::save() const {
+    QSettings settings(QSettings::IniFormat, QSettings::UserScope, "WinMMM10", "Editor");
+    settings.beginGroup("cacheEviction");
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < CategoryCount; ++i) {
+        QString key = categoryKey(static_cast<CacheCategory>(i));
+        settings.setValue(key + "/maxBytes", static_cast<qulonglong>(m_policies[i].maxBytes));
+        settings.setValue(key + "/maxAgeSeconds", static_cast<qlonglong>(m_policies[i].maxAgeSeconds));
+    }
+    settings.endGroup();
+}
+
+} // namespace WinMMM10
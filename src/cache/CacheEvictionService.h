@@ -0,0 +1,78 @@
+#pragma once
+
+#include "ApplicationCache.h"
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace WinMMM10 {
+
+// Limits applied to one cache category. Zero disables the respective limit.
+struct EvictionPolicy {
+    uint64_t maxBytes{0};
+    int64_t maxAgeSeconds{0};
+};
+
+// Periodically trims the on-disk cache categories (thumbnails, temp, project
+// caches) in a background thread. Files past their TTL are removed first, then
+// the least recently accessed files until the category fits its size cap.
+class CacheEvictionService {
+public:
+    CacheEvictionService();
+    ~CacheEvictionService();
+    CacheEvictionService(const CacheEvictionService&) = delete;
+    CacheEvictionService& operator=(const CacheEvictionService&) = delete;
+    
+    void setPolicy(CacheCategory category, const EvictionPolicy& policy);
+    EvictionPolicy policy(CacheCategory category) const;
+    
+    struct Result {
+        size_t filesRemoved{0};
+        uint64_t bytesFreed{0};
+    };
+    using PassCallback = std::function<void(const Result&)>;
+    
+    // The thread runs a pass right away; onFirstPass is invoked after it
+    void start(std::chrono::seconds interval = DefaultInterval, PassCallback onFirstPass = nullptr);
+    void stop();
+    bool isRunning() const;
+    
+    // Runs one eviction pass on the calling thread
+    Result runOnce();
+    
+    // Wakes the service thread for a pass now; onFinished is invoked on that
+    // thread. Returns false (and never calls onFinished) if it is not running.
+    bool requestPass(PassCallback onFinished = nullptr);
+    
+    // Load/Save policies
+    void load();
+    void save() const;
+    
+    static constexpr std::chrono::seconds DefaultInterval{600};
+
+private:
+    Result evictCategory(CacheCategory category, const std::string& directory,
+                         const EvictionPolicy& policy) const;
+    void threadMain(std::chrono::seconds interval);
+    
+    static constexpr size_t CategoryCount = 3; // Thumbnails, Temp, Projects
+    
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::array<EvictionPolicy, CategoryCount> m_policies;
+    std::array<std::string, CategoryCount> m_directories;
+    std::thread m_thread;
+    bool m_stopRequested{false};
+    bool m_passRequested{false};
+    std::vector<PassCallback> m_passCallbacks; // Waiting for the next pass
+    
+    std::mutex m_passMutex; // Serializes runOnce between the worker and callers
+};
+
+} // namespace WinMMM10
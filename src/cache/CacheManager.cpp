@@ -18,8 +18,7 @@ void CacheManager::setCurrentProject(const std::string& projectPath) {
 
 uint64_t CacheManager::getTotalCacheSize() const {
     uint64_t total = 0;
-    total += applicationCache().getCacheSize();
-    total += applicationCache().getTempSize();
+    total += applicationCache().getCacheSize(); // Ledger total already includes temp files
     if (m_currentProjectCache) {
         total += m_currentProjectCache->getCacheSize();
     }
@@ -33,6 +32,7 @@ void CacheManager::clearAllCaches() {
 }
 
 void CacheManager::clearApplicationCache() {
+    m_mapDataCache.clear();
     applicationCache().clearCache();
     applicationCache().clearRecentFiles();
     applicationCache().clearThumbnails();
@@ -50,14 +50,24 @@ void CacheManager::clearTempFiles() {
 
 CacheManager::CacheStats CacheManager::getCacheStats() const {
     CacheStats stats;
-    stats.applicationCacheSize = applicationCache().getCacheSize();
-    stats.tempFilesSize = applicationCache().getTempSize();
+    // Summed per category; subtracting temp from the total could wrap when
+    // temp files are written between the two reads
+    const ApplicationCache& cache = applicationCache();
+    stats.tempFilesSize = cache.getTempSize();
+    stats.applicationCacheSize = cache.getCategorySize(CacheCategory::Thumbnails) +
+                                 cache.getCategorySize(CacheCategory::Projects) +
+                                 cache.getCategorySize(CacheCategory::Other);
     if (m_currentProjectCache) {
         stats.projectCacheSize = m_currentProjectCache->getCacheSize();
     }
     stats.totalSize = stats.applicationCacheSize + stats.projectCacheSize + stats.tempFilesSize;
     stats.recentProjectsCount = applicationCache().getRecentProjects().size();
     stats.recentBinariesCount = applicationCache().getRecentBinaries().size();
+    
+    MapDataCache::Stats mapStats = m_mapDataCache.stats();
+    stats.decodedMapsSize = mapStats.usedBytes;
+    stats.decodedMapsBudget = mapStats.byteBudget;
+    stats.decodedMapsCount = mapStats.entryCount;
     return stats;
 }
 
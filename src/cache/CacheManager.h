@@ -2,6 +2,8 @@
 
 #include "ApplicationCache.h"
 #include "ProjectCache.h"
+#include "MapDataCache.h"
+#include "CacheEvictionService.h"
 #include <string>
 #include <memory>
 #include <cstdint>
@@ -21,6 +23,14 @@ public:
     ProjectCache* currentProjectCache() { return m_currentProjectCache.get(); }
     const ProjectCache* currentProjectCache() const { return m_currentProjectCache.get(); }
     
+    // Decoded map cache (in-memory only)
+    MapDataCache& mapDataCache() { return m_mapDataCache; }
+    const MapDataCache& mapDataCache() const { return m_mapDataCache; }
+    
+    // Background size/age eviction of on-disk caches
+    CacheEvictionService& evictionService() { return m_evictionService; }
+    const CacheEvictionService& evictionService() const { return m_evictionService; }
+    
     // Combined cache operations
     uint64_t getTotalCacheSize() const;
     void clearAllCaches();
@@ -36,6 +46,9 @@ public:
         uint64_t totalSize{0};
         size_t recentProjectsCount{0};
         size_t recentBinariesCount{0};
+        uint64_t decodedMapsSize{0};
+        uint64_t decodedMapsBudget{0};
+        size_t decodedMapsCount{0};
     };
     
     CacheStats getCacheStats() const;
@@ -47,6 +60,8 @@ private:
     CacheManager& operator=(const CacheManager&) = delete;
     
     std::unique_ptr<ProjectCache> m_currentProjectCache;
+    MapDataCache m_mapDataCache;
+    CacheEvictionService m_evictionService;
 };
 
 } // namespace WinMMM10
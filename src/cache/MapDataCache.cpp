@@ -0,0 +1,216 @@
+#include "MapDataCache.h"
+#include "../binary/HashService.h"
+#include <functional>
+#include <string>
+
+namespace WinMMM10 {
+
+namespace {
+
+void hashAxis(uint64_t& hash, const MapAxis& axis) {
+    HashService::fnv1a(hash, axis.address());
+    HashService::fnv1a(hash, axis.count());
+    HashService::fnv1a(hash, axis.dataType());
+    HashService::fnv1a(hash, static_cast<int>(axis.endianness()));
+    HashService::fnv1a(hash, axis.factor());
+    HashService::fnv1a(hash, axis.offset());
+}
+
+} // namespace
+
+uint64_t MapDataCache::definitionKey(const MapDefinition& definition) {
+    uint64_t hash = HashService::Fnv1aBasis;
+    HashService::fnv1a(hash, std::hash<std::string>{}(definition.name()));
+    HashService::fnv1a(hash, definition.address());
+    HashService::fnv1a(hash, static_cast<int>(definition.type()));
+    HashService::fnv1a(hash, definition.rows());
+    HashService::fnv1a(hash, definition.columns());
+    HashService::fnv1a(hash, definition.dataType());
+    HashService::fnv1a(hash, static_cast<int>(definition.endianness()));
+    HashService::fnv1a(hash, definition.factor());
+    HashService::fnv1a(hash, definition.offset());
+    hashAxis(hash, definition.xAxis());
+    hashAxis(hash, definition.yAxis());
+    return hash;
+}
+
+void MapDataCache::attach(BinaryFile* file) {
+    if (file == m_binaryFile) {
+        return;
+    }
+    detach();
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_binaryFile = file;
+    if (m_binaryFile) {
+        m_observerId = m_binaryFile->addWriteObserver([this](size_t offset, size_t length) {
+            invalidateRange(offset, length);
+        });
+    }
+}
+
+void MapDataCache::detach() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_binaryFile && m_observerId != 0) {
+        m_binaryFile->removeWriteObserver(m_observerId);
+    }
+    m_binaryFile = nullptr;
+    m_observerId = 0;
+    m_entries.clear();
+    m_index.clear();
+    m_usedBytes = 0;
+}
+
+const MapDataCache::Entry* MapDataCache::lookup(uint64_t key) {
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+        ++m_misses;
+        return nullptr;
+    }
+    
+    ++m_hits;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return &m_entries.front();
+}
+
+void MapDataCache::insert(Entry entry) {
+    auto existing = m_index.find(entry.key);
+    if (existing != m_index.end()) {
+        eraseEntry(existing->second);
+    }
+    
+    m_usedBytes += entry.bytes;
+    m_entries.push_front(std::move(entry));
+    m_index[m_entries.front().key] = m_entries.begin();
+    evictToBudget();
+}
+
+void MapDataCache::evictToBudget() {
+    // Never evict the entry that was just inserted, even if it alone exceeds the budget
+    while (m_usedBytes > m_byteBudget && m_entries.size() > 1) {
+        eraseEntry(std::prev(m_entries.end()));
+        ++m_evictions;
+    }
+}
+
+void MapDataCache::eraseEntry(EntryList::iterator it) {
+    m_usedBytes -= it->bytes;
+    m_index.erase(it->key);
+    m_entries.erase(it);
+}
+
+std::shared_ptr<const Map2D> MapDataCache::get2D(const MapDefinition& definition) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_binaryFile || !m_binaryFile->isLoaded()) {
+        return nullptr;
+    }
+    
+    uint64_t key = definitionKey(definition);
+    if (const Entry* entry = lookup(key); entry && entry->map2D) {
+        return entry->map2D;
+    }
+    
+    size_t address = definition.address();
+    size_t dataSize = definition.totalSize();
+    if (address + dataSize > m_binaryFile->size()) {
+        return nullptr;
+    }
+    
+    auto map = std::make_shared<Map2D>(definition);
+    map->loadFromBinary(m_binaryFile->at(address), dataSize);
+    
+    Entry entry;
+    entry.key = key;
+    entry.begin = address;
+    entry.end = address + dataSize;
+    entry.bytes = map->memoryUsage();
+    entry.map2D = map;
+    insert(std::move(entry));
+    return map;
+}
+
+std::shared_ptr<const Map3D> MapDataCache::get3D(const MapDefinition& definition) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_binaryFile || !m_binaryFile->isLoaded()) {
+        return nullptr;
+    }
+    
+    uint64_t key = definitionKey(definition);
+    if (const Entry* entry = lookup(key); entry && entry->map3D) {
+        return entry->map3D;
+    }
+    
+    size_t address = definition.address();
+    size_t dataSize = definition.totalSize();
+    if (address + dataSize > m_binaryFile->size()) {
+        return nullptr;
+    }
+    
+    auto map = std::make_shared<Map3D>(definition);
+    map->loadFromBinary(m_binaryFile->at(address), dataSize);
+    
+    Entry entry;
+    entry.key = key;
+    entry.begin = address;
+    entry.end = address + dataSize;
+    entry.bytes = map->memoryUsage();
+    entry.map3D = map;
+    insert(std::move(entry));
+    return map;
+}
+
+void MapDataCache::setByteBudget(uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_byteBudget = bytes;
+    while (m_usedBytes > m_byteBudget && !m_entries.empty()) {
+        eraseEntry(std::prev(m_entries.end()));
+        ++m_evictions;
+    }
+}
+
+uint64_t MapDataCache::byteBudget() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_byteBudget;
+}
+
+void MapDataCache::invalidateRange(size_t offset, size_t length) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (length == BinaryFile::WholeFile) {
+        m_entries.clear();
+        m_index.clear();
+        m_usedBytes = 0;
+        return;
+    }
+    
+    size_t end = offset + length;
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it->begin < end && offset < it->end) {
+            auto next = std::next(it);
+            eraseEntry(it);
+            it = next;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void MapDataCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_index.clear();
+    m_usedBytes = 0;
+}
+
+MapDataCache::Stats MapDataCache::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    stats.entryCount = m_entries.size();
+    stats.usedBytes = m_usedBytes;
+    stats.byteBudget = m_byteBudget;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.evictions = m_evictions;
+    return stats;
+}
+
+} // namespace WinMMM10
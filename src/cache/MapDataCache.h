@@ -0,0 +1,84 @@
+#pragma once
+
+#include "../maps/Map2D.h"
+#include "../maps/Map3D.h"
+#include "../binary/BinaryFile.h"
+#include <cstdint>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace WinMMM10 {
+
+// In-memory LRU cache of decoded Map2D/Map3D objects for the attached binary.
+// Entries are evicted once the byte budget is exceeded and dropped as soon as
+// a BinaryFile write touches their address range.
+class MapDataCache {
+public:
+    MapDataCache() = default;
+    ~MapDataCache() = default;
+    MapDataCache(const MapDataCache&) = delete;
+    MapDataCache& operator=(const MapDataCache&) = delete;
+
+    // Must be detached before the BinaryFile is destroyed
+    void attach(BinaryFile* file);
+    void detach();
+    BinaryFile* binaryFile() const { return m_binaryFile; }
+
+    // Returns nullptr if no binary is loaded or the map is out of range
+    std::shared_ptr<const Map2D> get2D(const MapDefinition& definition);
+    std::shared_ptr<const Map3D> get3D(const MapDefinition& definition);
+
+    void setByteBudget(uint64_t bytes);
+    uint64_t byteBudget() const;
+
+    void invalidateRange(size_t offset, size_t length);
+    void clear();
+
+    struct Stats {
+        size_t entryCount{0};
+        uint64_t usedBytes{0};
+        uint64_t byteBudget{0};
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t evictions{0};
+    };
+
+    Stats stats() const;
+
+    static constexpr uint64_t DefaultByteBudget = 64ULL * 1024 * 1024;
+
+private:
+    struct Entry {
+        uint64_t key{0};
+        size_t begin{0};
+        size_t end{0};
+        size_t bytes{0};
+        std::shared_ptr<const Map2D> map2D;
+        std::shared_ptr<const Map3D> map3D;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    static uint64_t definitionKey(const MapDefinition& definition);
+    const Entry* lookup(uint64_t key);
+    void insert(Entry entry);
+    void evictToBudget();
+    void eraseEntry(EntryList::iterator it);
+
+    mutable std::mutex m_mutex;
+    BinaryFile* m_binaryFile{nullptr};
+    size_t m_observerId{0};
+
+    EntryList m_entries; // Front = most recently used
+    std::unordered_map<uint64_t, EntryList::iterator> m_index;
+    uint64_t m_byteBudget{DefaultByteBudget};
+    uint64_t m_usedBytes{0};
+    uint64_t m_hits{0};
+    uint64_t m_misses{0};
+    uint64_t m_evictions{0};
+};
+
+} // namespace WinMMM10
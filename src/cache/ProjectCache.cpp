@@ -1,4 +1,5 @@
 #include "ProjectCache.h"
+#include "ApplicationCache.h"
 #include <QFileInfo>
 #include <QDir>
 #include <QStandardPaths>
@@ -167,6 +168,9 @@ void ProjectCache::load() {
 
 void ProjectCache::save() {
     std::string cacheFile = getCacheFilePath();
+    QFileInfo previous(QString::fromStdString(cacheFile));
+    int64_t previousSize = previous.exists() ? previous.size() : 0;
+    
     QSettings settings(QString::fromStdString(cacheFile), QSettings::IniFormat);
     settings.clear();
     
@@ -207,6 +211,12 @@ void ProjectCache::save() {
         settings.endGroup();
     }
     settings.endGroup();
+    
+    // Flush now so the size ledger sees the final file size
+    settings.sync();
+    QFileInfo written(QString::fromStdString(cacheFile));
+    int64_t writtenSize = written.exists() ? written.size() : 0;
+    ApplicationCache::instance().recordWrite(CacheCategory::Projects, writtenSize - previousSize);
 }
 
 } // namespace WinMMM10
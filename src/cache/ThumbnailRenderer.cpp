@@ -0,0 +1,125 @@
+#include "ThumbnailRenderer.h"
+#include "ApplicationCache.h"
+#include <algorithm>
+
+namespace WinMMM10 {
+
+ThumbnailRenderer::ThumbnailRenderer(size_t workerCount) {
+    if (workerCount == 0) {
+        // Leave one core for the UI thread
+        unsigned int cores = std::thread::hardware_concurrency();
+        workerCount = cores > 1 ? cores - 1 : 1;
+    }
+    
+    m_workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back(&ThumbnailRenderer::workerMain, this);
+    }
+}
+
+ThumbnailRenderer::~ThumbnailRenderer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopRequested = true;
+        m_jobs.clear();
+    }
+    m_wakeup.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThumbnailRenderer::request(const std::vector<MapDefinition>& maps, const BinaryFile& file, Callback callback) {
+    // Snapshot on the calling thread so workers never touch the live BinaryFile
+    std::deque<Job> jobs;
+    for (size_t i = 0; i < maps.size(); ++i) {
+        const MapDefinition& definition = maps[i];
+        size_t address = definition.address();
+        size_t dataSize = definition.totalSize();
+        if (dataSize == 0 || address + dataSize > file.size()) {
+            continue;
+        }
+        
+        Job job;
+        job.index = i;
+        job.definition = definition;
+        job.bytes.assign(file.at(address), file.at(address) + dataSize);
+        jobs.push_back(std::move(job));
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_generation;
+        for (auto& job : jobs) {
+            job.generation = m_generation;
+        }
+        m_jobs = std::move(jobs);
+        m_callback = std::move(callback);
+    }
+    m_wakeup.notify_all();
+}
+
+void ThumbnailRenderer::cancel() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_generation;
+    m_jobs.clear();
+    m_callback = nullptr;
+}
+
+void ThumbnailRenderer::workerMain() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wakeup.wait(lock, [this]() { return m_stopRequested || !m_jobs.empty(); });
+        if (m_stopRequested) {
+            return;
+        }
+        
+        Job job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        Callback callback = m_callback;
+        lock.unlock();
+        
+        renderJob(job, [this, &callback, generation = job.generation](size_t index, const MapThumbnail& thumbnail) {
+            // Drop results of a request that was replaced while rendering
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                if (generation != m_generation) {
+                    return;
+                }
+            }
+            if (callback) {
+                callback(index, thumbnail);
+            }
+        });
+        
+        lock.lock();
+    }
+}
+
+void ThumbnailRenderer::renderJob(const Job& job, const Callback& callback) const {
+    auto& cache = ApplicationCache::instance();
+    std::string key = MapThumbnail::contentKey(job.definition, job.bytes.data(), job.bytes.size());
+    
+    MapThumbnail thumbnail;
+    if (MapThumbnail::deserialize(cache.loadThumbnail(key), thumbnail)) {
+        callback(job.index, thumbnail);
+        return;
+    }
+    
+    if (job.definition.type() == MapType::Map3D) {
+        Map3D map(job.definition);
+        map.loadFromBinary(job.bytes.data(), job.bytes.size());
+        thumbnail = MapThumbnail::render(map, ThumbnailSize);
+    } else {
+        Map2D map(job.definition);
+        map.loadFromBinary(job.bytes.data(), job.bytes.size());
+        thumbnail = MapThumbnail::render(map, ThumbnailSize);
+    }
+    
+    if (thumbnail.isValid()) {
+        cache.saveThumbnail(key, thumbnail.serialize());
+        callback(job.index, thumbnail);
+    }
+}
+
+} // namespace WinMMM10
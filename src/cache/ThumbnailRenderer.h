@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../maps/MapThumbnail.h"
+#include "../binary/BinaryFile.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace WinMMM10 {
+
+// Renders map thumbnails on a pool of worker threads. Results are looked up in
+// and stored to the ApplicationCache thumbnail store, keyed by map content.
+class ThumbnailRenderer {
+public:
+    // Called on a worker thread; index refers to the position in the request
+    using Callback = std::function<void(size_t index, const MapThumbnail& thumbnail)>;
+    
+    explicit ThumbnailRenderer(size_t workerCount = 0); // 0 = hardware concurrency - 1
+    ~ThumbnailRenderer();
+    ThumbnailRenderer(const ThumbnailRenderer&) = delete;
+    ThumbnailRenderer& operator=(const ThumbnailRenderer&) = delete;
+    
+    // Copies the bytes of every map out of file, then renders asynchronously.
+    // Replaces any pending request; its remaining callbacks are not invoked.
+    void request(const std::vector<MapDefinition>& maps, const BinaryFile& file, Callback callback);
+    void cancel();
+    
+    static constexpr uint16_t ThumbnailSize = 32;
+
+private:
+    struct Job {
+        size_t index{0};
+        MapDefinition definition;
+        std::vector<uint8_t> bytes;
+        uint64_t generation{0};
+    };
+    
+    void workerMain();
+    void renderJob(const Job& job, const Callback& callback) const;
+    
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::deque<Job> m_jobs;
+    Callback m_callback;
+    uint64_t m_generation{0};
+    bool m_stopRequested{false};
+    std::vector<std::thread> m_workers;
+};
+
+} // namespace WinMMM10
@@ -5,15 +5,20 @@ namespace WinMMM10 {
 
 void AnnotationManager::addAnnotation(const Annotation& annotation) {
     m_annotations[annotation.address] = annotation;
+    m_indexValid = false;
 }
 
 void AnnotationManager::removeAnnotation(size_t address) {
-    m_annotations.erase(address);
+    if (m_annotations.erase(address) > 0) {
+        m_indexValid = false;
+    }
 }
 
 Annotation* AnnotationManager::findAnnotation(size_t address) {
     auto it = m_annotations.find(address);
     if (it != m_annotations.end()) {
+        // The caller may change the length
+        m_indexValid = false;
         return &it->second;
     }
     return nullptr;
@@ -38,20 +43,46 @@ std::vector<Annotation> AnnotationManager::getAllAnnotations() const {
 
 std::vector<Annotation> AnnotationManager::getAnnotationsInRange(size_t startAddress, size_t endAddress) const {
     std::vector<Annotation> result;
-    for (const auto& [addr, annotation] : m_annotations) {
-        if (addr >= startAddress && addr <= endAddress) {
-            result.push_back(annotation);
-        }
+    if (endAddress < startAddress) {
+        return result;
     }
+    size_t end = endAddress == static_cast<size_t>(-1) ? endAddress : endAddress + 1;
+    visitRange(startAddress, end, [&result](const Annotation& annotation) {
+        result.push_back(annotation);
+    });
+    std::sort(result.begin(), result.end(),
+              [](const Annotation& a, const Annotation& b) { return a.address < b.address; });
+    return result;
+}
+
+std::vector<const Annotation*> AnnotationManager::getAnnotationsAt(size_t address) const {
+    std::vector<const Annotation*> result;
+    visitRange(address, address + 1, [&result](const Annotation& annotation) {
+        result.push_back(&annotation);
+    });
     return result;
 }
 
+void AnnotationManager::ensureIndex() const {
+    if (m_indexValid) {
+        return;
+    }
+    // Map nodes stay put until erased, and erasing invalidates the index
+    m_index.clear();
+    for (const auto& [addr, annotation] : m_annotations) {
+        m_index.insert(addr, annotation.end(), &annotation);
+    }
+    m_index.build();
+    m_indexValid = true;
+}
+
 bool AnnotationManager::hasAnnotation(size_t address) const {
     return m_annotations.find(address) != m_annotations.end();
 }
 
 void AnnotationManager::clear() {
     m_annotations.clear();
+    m_indexValid = false;
 }
 
 } // namespace WinMMM10
@@ -3,7 +3,9 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <limits>
 #include <map>
+#include "IntervalIndex.h"
 
 namespace WinMMM10 {
 
@@ -11,11 +13,19 @@ struct Annotation {
     size_t address;
     std::string note;
     std::string color; // Hex color code
+    size_t length{1};  // Bytes covered from address on
     int64_t timestamp{0};
     
     Annotation() = default;
-    Annotation(size_t addr, const std::string& n, const std::string& col = "#FFFF00")
-        : address(addr), note(n), color(col) {}
+    Annotation(size_t addr, const std::string& n, const std::string& col = "#FFFF00", size_t len = 1)
+        : address(addr), note(n), color(col), length(len) {}
+    
+    // Saturates at the top of the address space
+    size_t end() const {
+        size_t span = length > 0 ? length : 1;
+        return span > std::numeric_limits<size_t>::max() - address ? std::numeric_limits<size_t>::max()
+                                                                  : address + span;
+    }
 };
 
 class AnnotationManager {
@@ -29,14 +39,31 @@ public:
     const Annotation* findAnnotation(size_t address) const;
     
     std::vector<Annotation> getAllAnnotations() const;
+    // Annotations overlapping [startAddress, endAddress], in address order
     std::vector<Annotation> getAnnotationsInRange(size_t startAddress, size_t endAddress) const;
+    // Annotations covering address
+    std::vector<const Annotation*> getAnnotationsAt(size_t address) const;
+    
+    // Calls visitor(const Annotation&) for every annotation overlapping
+    // [startAddress, endAddress), without copying; O(log n + hits)
+    template<typename Visitor>
+    void visitRange(size_t startAddress, size_t endAddress, Visitor&& visitor) const {
+        ensureIndex();
+        m_index.query(startAddress, endAddress, [&](const auto& entry) { visitor(*entry.value); });
+    }
     
     bool hasAnnotation(size_t address) const;
     void clear();
     size_t count() const { return m_annotations.size(); }
 
 private:
+    // The index is rebuilt on the first query after a change, so bulk
+    // imports pay for one build. Not safe for concurrent queries.
+    void ensureIndex() const;
+    
     std::map<size_t, Annotation> m_annotations; // Keyed by address
+    mutable IntervalIndex<const Annotation*> m_index;
+    mutable bool m_indexValid{false};
 };
 
 } // namespace WinMMM10
@@ -0,0 +1,463 @@
+#include "EditJournal.h"
+#include "ProjectSerializer.h"
+#include "../binary/HashService.h"
+#include "../binary/MemoryMapper.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace WinMMM10 {
+
+namespace {
+
+// Record: [u32 type][u32 length][u64 XXH3 of payload, seeded with type and
+// length][payload], little-endian
+enum RecordType : uint32_t {
+    BaseRecord = 1,    // u64 size, u64 hash, binary path
+    EditRecord = 2,    // u64 offset, bytes
+    ProjectRecord = 3  // u32 path length, project path, project JSON
+};
+
+constexpr size_t FileHeaderSize = 16; // Magic, u32 version, u32 reserved
+constexpr size_t RecordHeaderSize = 16;
+
+void putU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+void putU64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+uint32_t getU32(const uint8_t* data) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; --i) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+uint64_t getU64(const uint8_t* data) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+uint64_t recordSeed(uint32_t type, uint32_t length) {
+    return (static_cast<uint64_t>(type) << 32) | length;
+}
+
+// The payload is appended between beginRecord() and endRecord()
+size_t beginRecord(std::string& out, RecordType type) {
+    size_t start = out.size();
+    putU32(out, type);
+    out.append(RecordHeaderSize - 4, '\0');
+    return start;
+}
+
+void endRecord(std::string& out, size_t start) {
+    uint32_t type = getU32(reinterpret_cast<const uint8_t*>(out.data() + start));
+    uint32_t length = static_cast<uint32_t>(out.size() - start - RecordHeaderSize);
+    const uint8_t* payload = reinterpret_cast<const uint8_t*>(out.data() + start + RecordHeaderSize);
+    std::string header;
+    putU32(header, length);
+    putU64(header, HashService::xxh3(payload, length, recordSeed(type, length)));
+    out.replace(start + 4, header.size(), header);
+}
+
+std::string fileHeader() {
+    std::string header(EditJournal::Magic, sizeof(EditJournal::Magic));
+    putU32(header, EditJournal::Version);
+    putU32(header, 0);
+    return header;
+}
+
+bool syncToDisk(std::FILE* stream) {
+    if (std::fflush(stream) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(stream)) == 0;
+#else
+    return fsync(fileno(stream)) == 0;
+#endif
+}
+
+// Replaces the file only once the new contents are on disk
+bool writeWhole(const std::string& path, const std::string& bytes, std::string& error) {
+    QSaveFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(bytes.data(), static_cast<qint64>(bytes.size())) != static_cast<qint64>(bytes.size()) ||
+        !file.commit()) {
+        error = "Cannot write " + path + ": " + file.errorString().toStdString();
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+EditJournal::~EditJournal() {
+    stop(false);
+}
+
+bool EditJournal::start(BinaryFile& file, const std::string& journalPath, std::string& error) {
+    stop(false);
+    if (!file.isLoaded()) {
+        error = "No binary is loaded";
+        return false;
+    }
+    
+    m_journalPath = journalPath;
+    m_baseSize = file.size();
+    m_baseHash = HashService::xxh3(file.data(), file.size());
+    m_file = &file;
+    std::string bytes = fileHeader() + encodeBase();
+    QDir().mkpath(QFileInfo(QString::fromStdString(journalPath)).absolutePath());
+    if (!writeWhole(journalPath, bytes, error)) {
+        m_file = nullptr;
+        return false;
+    }
+    m_journalBytes = bytes.size();
+    m_compactedBytes = bytes.size();
+    
+    m_stream = std::fopen(journalPath.c_str(), "ab");
+    if (!m_stream) {
+        error = "Cannot append to " + journalPath;
+        m_file = nullptr;
+        QFile::remove(QString::fromStdString(journalPath));
+        return false;
+    }
+    
+    m_observerId = file.addWriteObserver([this](size_t offset, size_t length) {
+        // Loading or clearing replaces the image; the owner starts over then
+        if (length != BinaryFile::WholeFile) {
+            markRange(m_pending, offset, length);
+        }
+    });
+    m_stopRequested = false;
+    m_error.clear();
+    m_worker = std::thread(&EditJournal::workerMain, this);
+    return true;
+}
+
+void EditJournal::stop(bool discard) {
+    if (!m_file) {
+        return;
+    }
+    m_file->removeWriteObserver(m_observerId);
+    m_file = nullptr;
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (discard) {
+            m_batches.clear();
+        }
+        m_stopRequested = true;
+    }
+    m_wakeup.notify_all();
+    m_worker.join();
+    if (m_stream) {
+        std::fclose(m_stream);
+        m_stream = nullptr;
+    }
+    if (discard) {
+        QFile::remove(QString::fromStdString(m_journalPath));
+    }
+    
+    m_pending.clear();
+    m_dirty.clear();
+    m_projectRecord.clear();
+    m_projectPending = false;
+}
+
+void EditJournal::recordProject(const Project& project) {
+    if (!m_file) {
+        return;
+    }
+    m_projectRecord.clear();
+    size_t start = beginRecord(m_projectRecord, ProjectRecord);
+    putU32(m_projectRecord, static_cast<uint32_t>(project.filepath().size()));
+    m_projectRecord += project.filepath();
+    m_projectRecord += ProjectSerializer::toJson(project);
+    endRecord(m_projectRecord, start);
+    m_projectPending = true;
+}
+
+void EditJournal::flush() {
+    if (!m_file || (m_pending.empty() && !m_projectPending)) {
+        return;
+    }
+    
+    Batch batch;
+    appendEdits(batch.bytes, m_pending);
+    for (const auto& [begin, end] : m_pending) {
+        markRange(m_dirty, begin, end - begin);
+    }
+    m_pending.clear();
+    if (m_projectPending) {
+        batch.bytes += m_projectRecord;
+        m_projectPending = false;
+    }
+    
+    // Ranges edited over and over grow the journal without bound otherwise
+    if (m_journalBytes + batch.bytes.size() > std::max(MinCompactBytes, 2 * m_compactedBytes)) {
+        batch.bytes = fileHeader() + encodeBase();
+        appendEdits(batch.bytes, m_dirty);
+        batch.bytes += m_projectRecord;
+        batch.rewrite = true;
+        m_compactedBytes = batch.bytes.size();
+        m_journalBytes = batch.bytes.size();
+    } else {
+        m_journalBytes += batch.bytes.size();
+    }
+    enqueue(std::move(batch));
+}
+
+void EditJournal::waitForWrites() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() { return m_batches.empty() && !m_writing; });
+}
+
+std::string EditJournal::lastError() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_error;
+}
+
+void EditJournal::markRange(std::map<size_t, size_t>& ranges, size_t offset, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    size_t begin = offset;
+    size_t end = offset + length;
+    
+    // Merge with every range that overlaps or touches [begin, end)
+    auto it = ranges.upper_bound(begin);
+    if (it != ranges.begin() && std::prev(it)->second >= begin) {
+        --it;
+    }
+    while (it != ranges.end() && it->first <= end) {
+        begin = std::min(begin, it->first);
+        end = std::max(end, it->second);
+        it = ranges.erase(it);
+    }
+    ranges.emplace(begin, end);
+}
+
+void EditJournal::appendEdits(std::string& out, const std::map<size_t, size_t>& ranges) const {
+    const uint8_t* data = m_file->data();
+    size_t size = m_file->size();
+    for (auto [begin, end] : ranges) {
+        end = std::min(end, size);
+        for (size_t offset = begin; offset < end; offset += MaxEditBytes) {
+            size_t length = std::min(end - offset, MaxEditBytes);
+            size_t start = beginRecord(out, EditRecord);
+            putU64(out, offset);
+            out.append(reinterpret_cast<const char*>(data + offset), length);
+            endRecord(out, start);
+        }
+    }
+}
+
+std::string EditJournal::encodeBase() const {
+    std::string out;
+    size_t start = beginRecord(out, BaseRecord);
+    putU64(out, m_baseSize);
+    putU64(out, m_baseHash);
+    out += m_file->filepath();
+    endRecord(out, start);
+    return out;
+}
+
+void EditJournal::enqueue(Batch batch) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_batches.push_back(std::move(batch));
+    }
+    m_wakeup.notify_one();
+}
+
+void EditJournal::workerMain() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wakeup.wait(lock, [this]() { return m_stopRequested || !m_batches.empty(); });
+        if (m_batches.empty()) {
+            return; // Stop requested and everything written
+        }
+    
+        // Everything queued is written with a single sync
+        std::deque<Batch> batches;
+        batches.swap(m_batches);
+        m_writing = true;
+        lock.unlock();
+    
+        std::string error;
+        bool ok = writeBatches(batches, error);
+    
+        lock.lock();
+        m_writing = false;
+        if (!ok) {
+            m_error = error;
+        }
+        m_idle.notify_all();
+    }
+}
+
+bool EditJournal::writeBatches(std::deque<Batch>& batches, std::string& error) {
+    // Only what follows the last rewrite matters
+    auto rewrite = std::find_if(batches.rbegin(), batches.rend(), [](const Batch& batch) { return batch.rewrite; });
+    if (rewrite != batches.rend()) {
+        batches.erase(batches.begin(), std::prev(rewrite.base()));
+        if (m_stream) {
+            std::fclose(m_stream);
+            m_stream = nullptr;
+        }
+        bool written = writeWhole(m_journalPath, batches.front().bytes, error);
+        m_stream = std::fopen(m_journalPath.c_str(), "ab");
+        if (!written) {
+            return false;
+        }
+        batches.pop_front();
+    }
+    
+    if (!m_stream) {
+        error = "Cannot append to " + m_journalPath;
+        return false;
+    }
+    for (const Batch& batch : batches) {
+        if (std::fwrite(batch.bytes.data(), 1, batch.bytes.size(), m_stream) != batch.bytes.size()) {
+            error = "Cannot append to " + m_journalPath;
+            return false;
+        }
+    }
+    if (!syncToDisk(m_stream)) {
+        error = "Cannot sync " + m_journalPath;
+        return false;
+    }
+    return true;
+}
+
+std::string EditJournal::journalPathFor(const std::string& binaryPath) {
+    uint64_t hash = HashService::xxh3(reinterpret_cast<const uint8_t*>(binaryPath.data()), binaryPath.size());
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.wmmj", static_cast<unsigned long long>(hash));
+    return (QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/recovery/").toStdString() + name;
+}
+
+bool EditJournal::read(const std::string& journalPath, Contents& contents, std::string& error) {
+    MemoryMapper mapper;
+    if (!mapper.open(journalPath, true, MemoryMapper::AccessHint::Sequential)) {
+        error = "Cannot open " + journalPath;
+        return false;
+    }
+    const uint8_t* data = mapper.data();
+    size_t size = mapper.size();
+    if (size < FileHeaderSize || std::memcmp(data, Magic, sizeof(Magic)) != 0) {
+        error = journalPath + " is not an edit journal";
+        return false;
+    }
+    uint32_t version = getU32(data + sizeof(Magic));
+    if (version != Version) {
+        error = journalPath + ": unsupported journal version " + std::to_string(version);
+        return false;
+    }
+    
+    contents = Contents();
+    bool haveBase = false;
+    size_t position = FileHeaderSize;
+    while (position < size) {
+        // A crash may have cut the last write short; keep what came before
+        if (size - position < RecordHeaderSize) {
+            contents.torn = true;
+            break;
+        }
+        uint32_t type = getU32(data + position);
+        uint32_t length = getU32(data + position + 4);
+        uint64_t checksum = getU64(data + position + 8);
+        const uint8_t* payload = data + position + RecordHeaderSize;
+        if (length > size - position - RecordHeaderSize ||
+            HashService::xxh3(payload, length, recordSeed(type, length)) != checksum) {
+            contents.torn = true;
+            break;
+        }
+        position += RecordHeaderSize + length;
+    
+        const char* text = reinterpret_cast<const char*>(payload);
+        if (!haveBase && type != BaseRecord) {
+            error = journalPath + ": edits before the base record";
+            return false;
+        }
+        switch (type) {
+        case BaseRecord:
+            if (haveBase || length < 16) {
+                error = journalPath + ": invalid base record";
+                return false;
+            }
+            contents.baseSize = getU64(payload);
+            contents.baseHash = getU64(payload + 8);
+            contents.binaryPath.assign(text + 16, length - 16);
+            haveBase = true;
+            break;
+        case EditRecord:
+            if (length < 8) {
+                error = journalPath + ": invalid edit record";
+                return false;
+            }
+            contents.edits.push_back({getU64(payload), std::vector<uint8_t>(payload + 8, payload + length)});
+            break;
+        case ProjectRecord: {
+            uint32_t pathLength = length >= 4 ? getU32(payload) : 0;
+            if (length < 4 || pathLength > length - 4) {
+                error = journalPath + ": invalid project record";
+                return false;
+            }
+            contents.projectPath.assign(text + 4, pathLength);
+            contents.projectJson.assign(text + 4 + pathLength, length - 4 - pathLength);
+            break;
+        }
+        default:
+            break; // Written by a newer version; its edits still apply
+        }
+    }
+    
+    if (!haveBase) {
+        error = journalPath + ": no base record";
+        return false;
+    }
+    return true;
+}
+
+bool EditJournal::replay(const Contents& contents, BinaryFile& file, std::string& error) {
+    if (!file.isLoaded() || file.size() != contents.baseSize ||
+        HashService::xxh3(file.data(), file.size()) != contents.baseHash) {
+        error = "The binary is not the one the journal was written for";
+        return false;
+    }
+    for (const Edit& edit : contents.edits) {
+        if (edit.offset > SIZE_MAX - edit.bytes.size() || !file.writeBytes(edit.offset, edit.bytes)) {
+            error = "Cannot apply the edit at offset " + std::to_string(edit.offset);
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace WinMMM10
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Project.h"
+#include "../binary/BinaryFile.h"
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace WinMMM10 {
+
+// Write-ahead journal of the unsaved edits to a binary and its project, for
+// autosave and crash recovery.
+//
+// start() writes a base record naming the binary and the hash of its image,
+// then observes the file. Writes only mark their ranges; flush() coalesces
+// them, copies their current bytes together with the last recorded project,
+// and a worker thread appends the records and syncs the journal, so the
+// image itself is never rewritten. Every record carries a checksum, and
+// read() stops at the first torn or damaged one. Once the journal has grown
+// to twice its last compacted size it is rewritten with one record per
+// dirty range.
+//
+// Writes through data()/at() pointers are not observed. start(), flush() and
+// the observed writes belong to the thread that owns the file.
+class EditJournal {
+public:
+    struct Edit {
+        uint64_t offset{0};
+        std::vector<uint8_t> bytes;
+    };
+    
+    struct Contents {
+        std::string binaryPath;
+        uint64_t baseSize{0};
+        uint64_t baseHash{0};     // XXH3 of the image the edits apply to
+        std::vector<Edit> edits;  // In write order
+        std::string projectPath;
+        std::string projectJson;  // Latest recorded project, empty if none
+        bool torn{false};         // Records after a damaged one were dropped
+    };
+    
+    EditJournal() = default;
+    ~EditJournal(); // Stops and keeps the journal
+    EditJournal(const EditJournal&) = delete;
+    EditJournal& operator=(const EditJournal&) = delete;
+    
+    // Replaces any journal being written. The image of file must match the
+    // binary on disk, i.e. it was just loaded or saved.
+    bool start(BinaryFile& file, const std::string& journalPath, std::string& error);
+    // Writes what is queued; with discard the journal file is removed
+    void stop(bool discard);
+    bool isActive() const { return m_file != nullptr; }
+    const std::string& journalPath() const { return m_journalPath; }
+    
+    // Written with the next flush, replacing the project recorded before
+    void recordProject(const Project& project);
+    void flush();
+    void waitForWrites();
+    std::string lastError() const; // Of the worker thread, empty if none
+    
+    // <AppData>/recovery/<hash of binaryPath>.wmmj
+    static std::string journalPathFor(const std::string& binaryPath);
+    static bool read(const std::string& journalPath, Contents& contents, std::string& error);
+    // Applies the edits to file, which must hold the base image
+    static bool replay(const Contents& contents, BinaryFile& file, std::string& error);
+    
+    static constexpr char Magic[8] = {'W', 'M', 'M', '1', '0', 'J', 'N', 'L'};
+    static constexpr uint32_t Version = 1;
+    static constexpr size_t MaxEditBytes = 1 << 20;          // Longer ranges are split
+    static constexpr uint64_t MinCompactBytes = 4ull << 20;  // Not compacted below this
+
+private:
+    struct Batch {
+        std::string bytes;
+        bool rewrite{false}; // Replace the journal instead of appending
+    };
+    
+    void markRange(std::map<size_t, size_t>& ranges, size_t offset, size_t length);
+    void appendEdits(std::string& out, const std::map<size_t, size_t>& ranges) const;
+    std::string encodeBase() const;
+    void enqueue(Batch batch);
+    void workerMain();
+    bool writeBatches(std::deque<Batch>& batches, std::string& error);
+    
+    BinaryFile* m_file{nullptr};
+    size_t m_observerId{0};
+    std::string m_journalPath;
+    uint64_t m_baseSize{0};
+    uint64_t m_baseHash{0};
+    std::map<size_t, size_t> m_pending;   // begin -> end, not yet flushed
+    std::map<size_t, size_t> m_dirty;     // begin -> end, since start()
+    std::string m_projectRecord;          // Last recorded project
+    bool m_projectPending{false};
+    uint64_t m_journalBytes{0};
+    uint64_t m_compactedBytes{0};
+    
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::condition_variable m_idle;
+    std::deque<Batch> m_batches;
+    bool m_writing{false};
+    bool m_stopRequested{false};
+    std::string m_error;
+    std::FILE* m_stream{nullptr};         // The worker's while it runs
+    std::thread m_worker;
+};
+
+} // namespace WinMMM10
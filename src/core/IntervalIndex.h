@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace WinMMM10 {
+
+// Static index of half-open address ranges [begin, end) with attached values,
+// answering "which ranges overlap [begin, end)?" in O(log n + hits).
+//
+// Ranges are kept sorted by begin in one array that doubles as an implicit
+// balanced binary tree (node i sits at the level given by its trailing one
+// bits), each node caching the largest end in its subtree. Queries prune
+// subtrees whose largest end lies at or before the query. Call build() after
+// inserting and before querying; inserting again invalidates the index.
+template<typename T>
+class IntervalIndex {
+public:
+    struct Entry {
+        size_t begin;
+        size_t end;
+        T value;
+    };
+    
+    void insert(size_t begin, size_t end, T value) {
+        m_entries.push_back({begin, end, std::move(value)});
+        m_maxEnd.clear();
+        m_built = false;
+    }
+    
+    void clear() {
+        m_entries.clear();
+        m_maxEnd.clear();
+        m_built = false;
+    }
+    
+    size_t size() const { return m_entries.size(); }
+    bool empty() const { return m_entries.empty(); }
+    bool isBuilt() const { return m_built; }
+    
+    // Entries in begin order, valid after build()
+    const std::vector<Entry>& entries() const { return m_entries; }
+    
+    void build() {
+        std::stable_sort(m_entries.begin(), m_entries.end(),
+                         [](const Entry& a, const Entry& b) { return a.begin < b.begin; });
+        size_t n = m_entries.size();
+        m_maxEnd.resize(n);
+        m_rootLevel = 0;
+        m_built = true;
+        if (n == 0) {
+            return;
+        }
+    
+        // Leaves (even indices) cover only themselves
+        size_t lastIndex = 0;
+        size_t lastMax = 0;
+        for (size_t i = 0; i < n; i += 2) {
+            lastIndex = i;
+            m_maxEnd[i] = m_entries[i].end;
+            lastMax = m_maxEnd[i];
+        }
+    
+        // Inner nodes level by level; a missing right child takes the running
+        // maximum of the incomplete right edge of the tree
+        size_t level = 1;
+        for (; (size_t(1) << level) <= n; ++level) {
+            size_t half = size_t(1) << (level - 1);
+            size_t first = (half << 1) - 1;
+            size_t step = half << 2;
+            for (size_t i = first; i < n; i += step) {
+                size_t left = m_maxEnd[i - half];
+                size_t right = i + half < n ? m_maxEnd[i + half] : lastMax;
+                m_maxEnd[i] = std::max({m_entries[i].end, left, right});
+            }
+            lastIndex = ((lastIndex >> level) & 1) ? lastIndex - half : lastIndex + half;
+            if (lastIndex < n && m_maxEnd[lastIndex] > lastMax) {
+                lastMax = m_maxEnd[lastIndex];
+            }
+        }
+        m_rootLevel = level - 1;
+    }
+    
+    // Calls visitor(const Entry&) for every entry overlapping [begin, end)
+    template<typename Visitor>
+    void query(size_t begin, size_t end, Visitor&& visitor) const {
+        size_t n = m_entries.size();
+        if (!m_built || n == 0 || begin >= end) {
+            return;
+        }
+    
+        struct Frame {
+            size_t level;
+            size_t node;
+            bool leftDone;
+        };
+        Frame stack[64];
+        size_t top = 0;
+        stack[top++] = {m_rootLevel, (size_t(1) << m_rootLevel) - 1, false};
+    
+        while (top > 0) {
+            Frame frame = stack[--top];
+            if (frame.level <= 3) {
+                // Small subtree: scan its entries directly
+                size_t first = frame.node >> frame.level << frame.level;
+                size_t last = std::min(first + (size_t(1) << (frame.level + 1)) - 1, n);
+                for (size_t i = first; i < last && m_entries[i].begin < end; ++i) {
+                    if (begin < m_entries[i].end) {
+                        visitor(m_entries[i]);
+                    }
+                }
+            } else if (!frame.leftDone) {
+                size_t left = frame.node - (size_t(1) << (frame.level - 1));
+                stack[top++] = {frame.level, frame.node, true};
+                if (left >= n || m_maxEnd[left] > begin) {
+                    stack[top++] = {frame.level - 1, left, false};
+                }
+            } else if (frame.node < n && m_entries[frame.node].begin < end) {
+                if (begin < m_entries[frame.node].end) {
+                    visitor(m_entries[frame.node]);
+                }
+                stack[top++] = {frame.level - 1, frame.node + (size_t(1) << (frame.level - 1)), false};
+            }
+        }
+    }
+    
+    bool overlaps(size_t begin, size_t end) const {
+        bool found = false;
+        query(begin, end, [&found](const Entry&) { found = true; });
+        return found;
+    }
+    
+    // Entries containing address, i.e. overlapping [address, address + 1)
+    std::vector<const Entry*> at(size_t address) const {
+        std::vector<const Entry*> hits;
+        query(address, address + 1, [&hits](const Entry& entry) { hits.push_back(&entry); });
+        return hits;
+    }
+
+private:
+    std::vector<Entry> m_entries;
+    std::vector<size_t> m_maxEnd;
+    size_t m_rootLevel{0};
+    bool m_built{false};
+};
+
+} // namespace WinMMM10
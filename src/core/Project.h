@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../maps/MapDefinition.h"
+#include "AnnotationManager.h"
+#include "BookmarkManager.h"
 #include <string>
 #include <vector>
 #include <memory>
@@ -36,6 +38,12 @@ public:
     
     std::vector<MapDefinition>& maps() { return m_maps; }
     const std::vector<MapDefinition>& maps() const { return m_maps; }
+    
+    // Saved with the project; the managers hold the live copies while it is open
+    std::vector<Annotation>& annotations() { return m_annotations; }
+    const std::vector<Annotation>& annotations() const { return m_annotations; }
+    std::vector<Bookmark>& bookmarks() { return m_bookmarks; }
+    const std::vector<Bookmark>& bookmarks() const { return m_bookmarks; }
 
 private:
     std::string m_name;
@@ -44,6 +52,8 @@ private:
     std::string m_ecuName;
     std::string m_description;
     std::vector<MapDefinition> m_maps;
+    std::vector<Annotation> m_annotations;
+    std::vector<Bookmark> m_bookmarks;
 };
 
 } // namespace WinMMM10
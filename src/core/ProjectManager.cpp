@@ -1,89 +1,33 @@
 #include "ProjectManager.h"
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
-#include <QJsonValue>
-#include <QFile>
-#include <QIODevice>
-#include <QDir>
-#include <fstream>
+#include "ProjectSerializer.h"
+#include <QThreadPool>
 
 namespace WinMMM10 {
 
 ProjectManager::ProjectManager() = default;
 
+ProjectManager::~ProjectManager() {
+    waitForBackgroundSaves();
+}
+
 bool ProjectManager::createProject(const std::string& filepath, const std::string& name) {
     auto project = std::make_unique<Project>();
     project->setName(name);
     project->setFilepath(filepath);
     
     m_currentProject = std::move(project);
-    m_hasUnsavedChanges = true;
+    markChanged();
     return true;
 }
 
 bool ProjectManager::loadProject(const std::string& filepath) {
-    QFile file(QString::fromStdString(filepath));
-    if (!file.open(QIODevice::ReadOnly)) {
-        return false;
-    }
-    
-    QByteArray data = file.readAll();
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (doc.isNull() || !doc.isObject()) {
-        return false;
-    }
-    
-    QJsonObject root = doc.object();
     auto project = std::make_unique<Project>();
-    
-    project->setName(root["name"].toString().toStdString());
-    project->setFilepath(filepath);
-    project->setBinaryFilepath(root["binaryFilepath"].toString().toStdString());
-    project->setEcuName(root["ecuName"].toString().toStdString());
-    project->setDescription(root["description"].toString().toStdString());
-    
-    QJsonArray mapsArray = root["maps"].toArray();
-    for (const QJsonValue& mapValue : mapsArray) {
-        QJsonObject mapObj = mapValue.toObject();
-        MapDefinition map;
-        map.setName(mapObj["name"].toString().toStdString());
-        map.setAddress(static_cast<size_t>(mapObj["address"].toInt()));
-        map.setType(mapObj["type"].toString() == "3D" ? MapType::Map3D : MapType::Map2D);
-        map.setRows(static_cast<size_t>(mapObj["rows"].toInt()));
-        map.setColumns(static_cast<size_t>(mapObj["columns"].toInt()));
-        map.setDataType(static_cast<uint16_t>(mapObj["dataType"].toInt()));
-        map.setFactor(mapObj["factor"].toDouble());
-        map.setOffset(mapObj["offset"].toDouble());
-        map.setUnit(mapObj["unit"].toString().toStdString());
-        
-        QJsonObject xAxisObj = mapObj["xAxis"].toObject();
-        MapAxis& xAxis = map.xAxis();
-        xAxis.setAddress(static_cast<size_t>(xAxisObj["address"].toInt()));
-        xAxis.setCount(static_cast<size_t>(xAxisObj["count"].toInt()));
-        xAxis.setDataType(static_cast<uint16_t>(xAxisObj["dataType"].toInt()));
-        xAxis.setFactor(xAxisObj["factor"].toDouble());
-        xAxis.setOffset(xAxisObj["offset"].toDouble());
-        xAxis.setName(xAxisObj["name"].toString().toStdString());
-        xAxis.setUnit(xAxisObj["unit"].toString().toStdString());
-        
-        if (map.type() == MapType::Map3D) {
-            QJsonObject yAxisObj = mapObj["yAxis"].toObject();
-            MapAxis& yAxis = map.yAxis();
-            yAxis.setAddress(static_cast<size_t>(yAxisObj["address"].toInt()));
-            yAxis.setCount(static_cast<size_t>(yAxisObj["count"].toInt()));
-            yAxis.setDataType(static_cast<uint16_t>(yAxisObj["dataType"].toInt()));
-            yAxis.setFactor(yAxisObj["factor"].toDouble());
-            yAxis.setOffset(yAxisObj["offset"].toDouble());
-            yAxis.setName(yAxisObj["name"].toString().toStdString());
-            yAxis.setUnit(yAxisObj["unit"].toString().toStdString());
-        }
-        
-        project->addMap(map);
+    if (!ProjectSerializer::load(filepath, *project, m_lastError)) {
+        return false;
     }
     
     m_currentProject = std::move(project);
-    m_hasUnsavedChanges = false;
+    markSaved();
     return true;
 }
 
@@ -99,68 +43,71 @@ bool ProjectManager::saveProjectAs(const std::string& filepath) {
         return false;
     }
     
-    QJsonObject root;
-    root["name"] = QString::fromStdString(m_currentProject->name());
-    root["binaryFilepath"] = QString::fromStdString(m_currentProject->binaryFilepath());
-    root["ecuName"] = QString::fromStdString(m_currentProject->ecuName());
-    root["description"] = QString::fromStdString(m_currentProject->description());
-    
-    QJsonArray mapsArray;
-    for (const MapDefinition& map : m_currentProject->maps()) {
-        QJsonObject mapObj;
-        mapObj["name"] = QString::fromStdString(map.name());
-        mapObj["address"] = static_cast<qint64>(map.address());
-        mapObj["type"] = (map.type() == MapType::Map3D) ? "3D" : "2D";
-        mapObj["rows"] = static_cast<int>(map.rows());
-        mapObj["columns"] = static_cast<int>(map.columns());
-        mapObj["dataType"] = static_cast<int>(map.dataType());
-        mapObj["factor"] = map.factor();
-        mapObj["offset"] = map.offset();
-        mapObj["unit"] = QString::fromStdString(map.unit());
-        
-        QJsonObject xAxisObj;
-        const MapAxis& xAxis = map.xAxis();
-        xAxisObj["address"] = static_cast<qint64>(xAxis.address());
-        xAxisObj["count"] = static_cast<int>(xAxis.count());
-        xAxisObj["dataType"] = static_cast<int>(xAxis.dataType());
-        xAxisObj["factor"] = xAxis.factor();
-        xAxisObj["offset"] = xAxis.offset();
-        xAxisObj["name"] = QString::fromStdString(xAxis.name());
-        xAxisObj["unit"] = QString::fromStdString(xAxis.unit());
-        mapObj["xAxis"] = xAxisObj;
-        
-        if (map.type() == MapType::Map3D) {
-            QJsonObject yAxisObj;
-            const MapAxis& yAxis = map.yAxis();
-            yAxisObj["address"] = static_cast<qint64>(yAxis.address());
-            yAxisObj["count"] = static_cast<int>(yAxis.count());
-            yAxisObj["dataType"] = static_cast<int>(yAxis.dataType());
-            yAxisObj["factor"] = yAxis.factor();
-            yAxisObj["offset"] = yAxis.offset();
-            yAxisObj["name"] = QString::fromStdString(yAxis.name());
-            yAxisObj["unit"] = QString::fromStdString(yAxis.unit());
-            mapObj["yAxis"] = yAxisObj;
-        }
-        
-        mapsArray.append(mapObj);
+    // Waits for a background save in progress, which this one supersedes
+    std::lock_guard<std::mutex> lock(m_saveMutex);
+    if (!ProjectSerializer::save(*m_currentProject, filepath, m_lastError)) {
+        return false;
     }
-    root["maps"] = mapsArray;
-    
-    QJsonDocument doc(root);
-    QFile file(QString::fromStdString(filepath));
-    if (!file.open(QIODevice::WriteOnly)) {
+    m_writtenTickets[filepath] = ++m_nextTicket;
+    m_currentProject->setFilepath(filepath);
+    markSaved();
+    return true;
+}
+
+bool ProjectManager::saveProjectInBackground(SaveCallback onFinished) {
+    if (!m_currentProject || m_currentProject->filepath().empty()) {
         return false;
     }
     
-    file.write(doc.toJson());
-    m_currentProject->setFilepath(filepath);
-    m_hasUnsavedChanges = false;
+    // The copy is the only state the worker reads
+    auto snapshot = std::make_shared<const Project>(*m_currentProject);
+    uint64_t revision = m_revision;
+    uint64_t ticket = ++m_nextTicket;
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        ++m_pendingSaves;
+    }
+    
+    QThreadPool::globalInstance()->start([this, snapshot, revision, ticket, onFinished]() {
+        bool ok = true;
+        std::string error;
+        {
+            std::lock_guard<std::mutex> lock(m_saveMutex);
+            uint64_t& written = m_writtenTickets[snapshot->filepath()];
+            // Skipped if a save started later already wrote this file
+            if (ticket > written) {
+                ok = ProjectSerializer::save(*snapshot, snapshot->filepath(), error);
+                if (ok) {
+                    written = ticket;
+                    setSavedRevision(revision);
+                }
+            }
+        }
+        if (onFinished) {
+            onFinished(ok, error);
+        }
+        
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        --m_pendingSaves;
+        m_pendingDone.notify_all();
+    });
     return true;
 }
 
+void ProjectManager::waitForBackgroundSaves() {
+    std::unique_lock<std::mutex> lock(m_pendingMutex);
+    m_pendingDone.wait(lock, [this]() { return m_pendingSaves == 0; });
+}
+
+void ProjectManager::setSavedRevision(uint64_t revision) {
+    uint64_t saved = m_savedRevision.load();
+    while (saved < revision && !m_savedRevision.compare_exchange_weak(saved, revision)) {
+    }
+}
+
 void ProjectManager::closeProject() {
     m_currentProject.reset();
-    m_hasUnsavedChanges = false;
+    markSaved();
 }
 
 } // namespace WinMMM10
@@ -1,34 +1,64 @@
 #pragma once
 
 #include "Project.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 namespace WinMMM10 {
 
 class ProjectManager {
 public:
     ProjectManager();
-    ~ProjectManager() = default;
+    ~ProjectManager(); // Waits for background saves
     
     bool createProject(const std::string& filepath, const std::string& name);
     bool loadProject(const std::string& filepath);
     bool saveProject();
     bool saveProjectAs(const std::string& filepath);
     
+    // Saves a copy of the current project to its file on a worker thread, so
+    // later edits are not part of it and stay unsaved. onFinished runs on
+    // the worker thread. When saves to one file overlap, the one started last
+    // is what the file ends up holding. Returns false if there is no project.
+    using SaveCallback = std::function<void(bool ok, const std::string& error)>;
+    bool saveProjectInBackground(SaveCallback onFinished);
+    void waitForBackgroundSaves();
+    
+    const std::string& lastError() const { return m_lastError; }
+    
     bool hasCurrentProject() const { return m_currentProject != nullptr; }
     Project* currentProject() { return m_currentProject.get(); }
     const Project* currentProject() const { return m_currentProject.get(); }
     
     void closeProject();
     
-    bool hasUnsavedChanges() const { return m_hasUnsavedChanges; }
-    void markChanged() { m_hasUnsavedChanges = true; }
-    void markSaved() { m_hasUnsavedChanges = false; }
+    // Changes are counted so a background save of an older state does not
+    // mark newer changes as saved
+    bool hasUnsavedChanges() const { return m_revision != m_savedRevision.load(); }
+    void markChanged() { ++m_revision; }
+    uint64_t revision() const { return m_revision; }
+    void markSaved() { m_savedRevision = m_revision; }
 
 private:
+    void setSavedRevision(uint64_t revision);
+    
     std::unique_ptr<Project> m_currentProject;
-    bool m_hasUnsavedChanges{false};
+    std::string m_lastError;
+    uint64_t m_revision{0};                 // UI thread only
+    std::atomic<uint64_t> m_savedRevision{0};
+    
+    std::mutex m_saveMutex;                 // Held while a background save writes
+    std::mutex m_pendingMutex;
+    std::condition_variable m_pendingDone;
+    size_t m_pendingSaves{0};
+    uint64_t m_nextTicket{0};               // Start order of background saves
+    std::unordered_map<std::string, uint64_t> m_writtenTickets; // By file, under m_saveMutex
 };
 
 } // namespace WinMMM10
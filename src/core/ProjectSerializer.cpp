@@ -0,0 +1,869 @@
+#include "ProjectSerializer.h"
+#include "../binary/MemoryMapper.h"
+#include <QSaveFile>
+#include <QString>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace WinMMM10 {
+
+namespace {
+
+constexpr size_t ChunkSize = 64 * 1024;
+constexpr int MaxDepth = 64;
+
+// Appends compact JSON to a buffer and hands it to the file in chunks; with
+// no file everything stays in the buffer
+class JsonWriter {
+public:
+    explicit JsonWriter(QSaveFile* file = nullptr) : m_file(file) { m_buffer.reserve(ChunkSize + 4096); }
+    
+    void beginObject() { separate(); m_buffer += '{'; m_needComma = false; }
+    void endObject() { m_buffer += '}'; m_needComma = true; }
+    void beginArray() { separate(); m_buffer += '['; m_needComma = false; }
+    void endArray() { m_buffer += ']'; m_needComma = true; }
+    // Starts the next value on a new line
+    void newline() { m_newline = true; }
+    void endDocument() { m_buffer += '\n'; }
+    
+    void key(std::string_view name) {
+        separate();
+        appendString(name);
+        m_buffer += ':';
+        m_needComma = false;
+    }
+    
+    void value(std::string_view text) { separate(); appendString(text); m_needComma = true; }
+    void value(const char* text) { value(std::string_view(text)); }
+    void value(const std::string& text) { value(std::string_view(text)); }
+    
+    // JSON has no infinity or NaN; they are written as null, as QJsonDocument does
+    void value(double number) {
+        separate();
+        if (!std::isfinite(number)) {
+            m_buffer += "null";
+        } else {
+            char digits[32];
+            auto result = std::to_chars(digits, digits + sizeof(digits), number);
+            m_buffer.append(digits, result.ptr);
+        }
+        m_needComma = true;
+    }
+    
+    void value(uint64_t number) { appendInteger(number); }
+    void value(int64_t number) { appendInteger(number); }
+    
+    // Writes out the buffer once it holds a chunk
+    void maybeFlush() {
+        if (m_file && m_buffer.size() >= ChunkSize) {
+            flush();
+        }
+    }
+    
+    bool flush() {
+        if (m_file && !m_buffer.empty()) {
+            if (m_file->write(m_buffer.data(), static_cast<qint64>(m_buffer.size())) !=
+                static_cast<qint64>(m_buffer.size())) {
+                m_failed = true;
+            }
+            m_buffer.clear();
+        }
+        return !m_failed;
+    }
+    
+    std::string& buffer() { return m_buffer; }
+
+private:
+    void separate() {
+        if (m_needComma) {
+            m_buffer += ',';
+        }
+        if (m_newline) {
+            m_buffer += '\n';
+            m_newline = false;
+        }
+    }
+    
+    template<typename T>
+    void appendInteger(T number) {
+        separate();
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), number);
+        m_buffer.append(digits, result.ptr);
+        m_needComma = true;
+    }
+    
+    // UTF-8 passes through; quotes, backslashes and control characters are escaped
+    void appendString(std::string_view text) {
+        static const char hex[] = "0123456789abcdef";
+        m_buffer += '"';
+        size_t plain = 0;
+        for (size_t i = 0; i < text.size(); ++i) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') {
+                continue;
+            }
+            m_buffer.append(text.data() + plain, i - plain);
+            plain = i + 1;
+            switch (c) {
+            case '"': m_buffer += "\\\""; break;
+            case '\\': m_buffer += "\\\\"; break;
+            case '\n': m_buffer += "\\n"; break;
+            case '\r': m_buffer += "\\r"; break;
+            case '\t': m_buffer += "\\t"; break;
+            default:
+                m_buffer += "\\u00";
+                m_buffer += hex[c >> 4];
+                m_buffer += hex[c & 0xF];
+                break;
+            }
+        }
+        m_buffer.append(text.data() + plain, text.size() - plain);
+        m_buffer += '"';
+    }
+    
+    QSaveFile* m_file;
+    std::string m_buffer;
+    bool m_needComma{false};
+    bool m_newline{false};
+    bool m_failed{false};
+};
+
+// Pull parser over the whole text. readObject and readArray call back once
+// per member or element, and the callback must consume exactly one value.
+// The first error stops the parse and is kept with its line number.
+class JsonReader {
+public:
+    explicit JsonReader(std::string_view text) : m_text(text) {
+        if (m_text.substr(0, 3) == "\xEF\xBB\xBF") {
+            m_pos = 3; // UTF-8 byte order mark
+        }
+    }
+    
+    const std::string& error() const { return m_error; }
+    
+    bool fail(const char* message) {
+        if (m_error.empty()) {
+            size_t line = 1 + static_cast<size_t>(std::count(m_text.begin(), m_text.begin() + m_pos, '\n'));
+            m_error = "Line " + std::to_string(line) + ": " + message;
+        }
+        return false;
+    }
+    
+    bool atEnd() {
+        skipWhitespace();
+        return m_pos == m_text.size();
+    }
+    
+    template<typename Member>
+    bool readObject(Member&& member) {
+        if (!consume('{')) {
+            return fail("expected an object");
+        }
+        if (++m_depth > MaxDepth) {
+            return fail("nested too deeply");
+        }
+        if (!consume('}')) {
+            do {
+                std::string_view key;
+                if (!readKey(key) || !consume(':')) {
+                    return fail("expected a member name");
+                }
+                if (!member(key)) {
+                    return false;
+                }
+            } while (consume(','));
+            if (!consume('}')) {
+                return fail("expected ',' or '}'");
+            }
+        }
+        --m_depth;
+        return true;
+    }
+    
+    template<typename Element>
+    bool readArray(Element&& element) {
+        if (!consume('[')) {
+            return fail("expected an array");
+        }
+        if (++m_depth > MaxDepth) {
+            return fail("nested too deeply");
+        }
+        if (!consume(']')) {
+            do {
+                if (!element()) {
+                    return false;
+                }
+            } while (consume(','));
+            if (!consume(']')) {
+                return fail("expected ',' or ']'");
+            }
+        }
+        --m_depth;
+        return true;
+    }
+    
+    // null leaves value unchanged in all readers
+    bool readString(std::string& value) {
+        if (consumeNull()) {
+            return true;
+        }
+        std::string_view text;
+        if (!readStringView(text, value)) {
+            return false;
+        }
+        if (text.data() != value.data()) {
+            value.assign(text);
+        }
+        return true;
+    }
+    
+    bool readDouble(double& value) {
+        if (consumeNull()) {
+            return true;
+        }
+        std::string_view token = numberToken();
+        auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+        if (token.empty() || result.ec != std::errc() || result.ptr != token.data() + token.size()) {
+            return fail("expected a number");
+        }
+        return true;
+    }
+    
+    // Integers written as doubles ("4096.0", "1e3") are accepted
+    bool readUnsigned(uint64_t& value) {
+        if (consumeNull()) {
+            return true;
+        }
+        std::string_view token = numberToken();
+        auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+        if (!token.empty() && result.ec == std::errc() && result.ptr == token.data() + token.size()) {
+            return true;
+        }
+        double number = 0.0;
+        result = std::from_chars(token.data(), token.data() + token.size(), number);
+        if (token.empty() || result.ec != std::errc() || result.ptr != token.data() + token.size() ||
+            !(number >= 0.0 && number < 18446744073709551616.0)) {
+            return fail("expected an unsigned integer");
+        }
+        value = static_cast<uint64_t>(number);
+        return true;
+    }
+    
+    bool readInteger(int64_t& value) {
+        if (consumeNull()) {
+            return true;
+        }
+        std::string_view token = numberToken();
+        auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+        if (!token.empty() && result.ec == std::errc() && result.ptr == token.data() + token.size()) {
+            return true;
+        }
+        double number = 0.0;
+        result = std::from_chars(token.data(), token.data() + token.size(), number);
+        if (token.empty() || result.ec != std::errc() || result.ptr != token.data() + token.size() ||
+            !(number >= -9223372036854775808.0 && number < 9223372036854775808.0)) {
+            return fail("expected an integer");
+        }
+        value = static_cast<int64_t>(number);
+        return true;
+    }
+    
+    template<typename T>
+    bool readSize(T& value) {
+        uint64_t number = value;
+        if (!readUnsigned(number)) {
+            return false;
+        }
+        value = static_cast<T>(number);
+        return true;
+    }
+    
+    bool skipValue() {
+        skipWhitespace();
+        if (m_pos == m_text.size()) {
+            return fail("unexpected end of file");
+        }
+        switch (m_text[m_pos]) {
+        case '{':
+            return readObject([this](std::string_view) { return skipValue(); });
+        case '[':
+            return readArray([this]() { return skipValue(); });
+        case '"': {
+            std::string_view text;
+            return readStringView(text, m_scratch);
+        }
+        case 't':
+            return consumeWord("true") || fail("unexpected character");
+        case 'f':
+            return consumeWord("false") || fail("unexpected character");
+        case 'n':
+            return consumeWord("null") || fail("unexpected character");
+        default: {
+            double number = 0.0;
+            return readDouble(number);
+        }
+        }
+    }
+
+private:
+    void skipWhitespace() {
+        while (m_pos < m_text.size()) {
+            char c = m_text[m_pos];
+            if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+                break;
+            }
+            ++m_pos;
+        }
+    }
+    
+    bool consume(char c) {
+        skipWhitespace();
+        if (m_pos < m_text.size() && m_text[m_pos] == c) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+    
+    bool consumeWord(std::string_view word) {
+        if (m_text.substr(m_pos, word.size()) == word) {
+            m_pos += word.size();
+            return true;
+        }
+        return false;
+    }
+    
+    bool consumeNull() {
+        skipWhitespace();
+        return consumeWord("null");
+    }
+    
+    std::string_view numberToken() {
+        skipWhitespace();
+        size_t start = m_pos;
+        while (m_pos < m_text.size()) {
+            char c = m_text[m_pos];
+            if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) {
+                break;
+            }
+            ++m_pos;
+        }
+        return m_text.substr(start, m_pos - start);
+    }
+    
+    bool readKey(std::string_view& key) {
+        return readStringView(key, m_keyBuffer);
+    }
+    
+    // Views the text directly unless there are escapes, which are decoded
+    // into buffer
+    bool readStringView(std::string_view& text, std::string& buffer) {
+        if (!consume('"')) {
+            return fail("expected a string");
+        }
+        size_t start = m_pos;
+        while (m_pos < m_text.size() && m_text[m_pos] != '"' && m_text[m_pos] != '\\') {
+            ++m_pos;
+        }
+        if (m_pos == m_text.size()) {
+            return fail("unterminated string");
+        }
+        if (m_text[m_pos] == '"') {
+            text = m_text.substr(start, m_pos - start);
+            ++m_pos;
+            return true;
+        }
+    
+        buffer.assign(m_text.data() + start, m_pos - start);
+        while (m_pos < m_text.size()) {
+            char c = m_text[m_pos++];
+            if (c == '"') {
+                text = buffer;
+                return true;
+            }
+            if (c != '\\') {
+                buffer += c;
+                continue;
+            }
+            if (m_pos == m_text.size()) {
+                break;
+            }
+            char escape = m_text[m_pos++];
+            switch (escape) {
+            case '"': buffer += '"'; break;
+            case '\\': buffer += '\\'; break;
+            case '/': buffer += '/'; break;
+            case 'b': buffer += '\b'; break;
+            case 'f': buffer += '\f'; break;
+            case 'n': buffer += '\n'; break;
+            case 'r': buffer += '\r'; break;
+            case 't': buffer += '\t'; break;
+            case 'u': {
+                uint32_t code = 0;
+                if (!readHex4(code)) {
+                    return fail("bad \\u escape");
+                }
+                if (code >= 0xD800 && code < 0xDC00 && m_text.substr(m_pos, 2) == "\\u") {
+                    size_t mark = m_pos;
+                    m_pos += 2;
+                    uint32_t low = 0;
+                    if (readHex4(low) && low >= 0xDC00 && low < 0xE000) {
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    } else {
+                        m_pos = mark;
+                    }
+                }
+                if (code >= 0xD800 && code < 0xE000) {
+                    code = 0xFFFD; // Unpaired surrogate
+                }
+                appendUtf8(buffer, code);
+                break;
+            }
+            default:
+                return fail("bad escape");
+            }
+        }
+        return fail("unterminated string");
+    }
+    
+    bool readHex4(uint32_t& code) {
+        if (m_text.size() - m_pos < 4) {
+            return false;
+        }
+        auto result = std::from_chars(m_text.data() + m_pos, m_text.data() + m_pos + 4, code, 16);
+        if (result.ec != std::errc() || result.ptr != m_text.data() + m_pos + 4) {
+            return false;
+        }
+        m_pos += 4;
+        return true;
+    }
+    
+    static void appendUtf8(std::string& out, uint32_t code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+    
+    std::string_view m_text;
+    size_t m_pos{0};
+    int m_depth{0};
+    std::string m_keyBuffer;
+    std::string m_scratch;
+    std::string m_error;
+};
+
+void writeAxis(JsonWriter& writer, const MapAxis& axis) {
+    writer.beginObject();
+    writer.key("address");
+    writer.value(static_cast<uint64_t>(axis.address()));
+    writer.key("count");
+    writer.value(static_cast<uint64_t>(axis.count()));
+    writer.key("dataType");
+    writer.value(static_cast<uint64_t>(axis.dataType()));
+    writer.key("endianness");
+    writer.value(axis.endianness() == Endianness::Big ? "big" : "little");
+    writer.key("factor");
+    writer.value(axis.factor());
+    writer.key("offset");
+    writer.value(axis.offset());
+    writer.key("name");
+    writer.value(axis.name());
+    writer.key("unit");
+    writer.value(axis.unit());
+    writer.endObject();
+}
+
+void writeMap(JsonWriter& writer, const MapDefinition& map) {
+    writer.beginObject();
+    writer.key("name");
+    writer.value(map.name());
+    writer.key("address");
+    writer.value(static_cast<uint64_t>(map.address()));
+    writer.key("type");
+    writer.value(map.type() == MapType::Map3D ? "3D" : "2D");
+    writer.key("rows");
+    writer.value(static_cast<uint64_t>(map.rows()));
+    writer.key("columns");
+    writer.value(static_cast<uint64_t>(map.columns()));
+    writer.key("dataType");
+    writer.value(static_cast<uint64_t>(map.dataType()));
+    writer.key("endianness");
+    writer.value(map.endianness() == Endianness::Big ? "big" : "little");
+    writer.key("factor");
+    writer.value(map.factor());
+    writer.key("offset");
+    writer.value(map.offset());
+    writer.key("unit");
+    writer.value(map.unit());
+    writer.key("hardMin");
+    writer.value(map.hardMin());
+    writer.key("hardMax");
+    writer.value(map.hardMax());
+    writer.key("warningMin");
+    writer.value(map.warningMin());
+    writer.key("warningMax");
+    writer.value(map.warningMax());
+    writer.key("xAxis");
+    writeAxis(writer, map.xAxis());
+    writer.key("yAxis");
+    writeAxis(writer, map.yAxis());
+    writer.endObject();
+}
+
+void writeProject(JsonWriter& writer, const Project& project) {
+    writer.beginObject();
+    writer.key("name");
+    writer.value(project.name());
+    writer.key("binaryFilepath");
+    writer.value(project.binaryFilepath());
+    writer.key("ecuName");
+    writer.value(project.ecuName());
+    writer.key("description");
+    writer.value(project.description());
+    
+    // One item per line keeps project files diffable
+    writer.key("maps");
+    writer.beginArray();
+    for (const MapDefinition& map : project.maps()) {
+        writer.newline();
+        writeMap(writer, map);
+        writer.maybeFlush();
+    }
+    writer.endArray();
+    
+    writer.key("annotations");
+    writer.beginArray();
+    for (const Annotation& annotation : project.annotations()) {
+        writer.newline();
+        writer.beginObject();
+        writer.key("address");
+        writer.value(static_cast<uint64_t>(annotation.address));
+        writer.key("length");
+        writer.value(static_cast<uint64_t>(annotation.length));
+        writer.key("note");
+        writer.value(annotation.note);
+        writer.key("color");
+        writer.value(annotation.color);
+        writer.key("timestamp");
+        writer.value(annotation.timestamp);
+        writer.endObject();
+        writer.maybeFlush();
+    }
+    writer.endArray();
+    
+    writer.key("bookmarks");
+    writer.beginArray();
+    for (const Bookmark& bookmark : project.bookmarks()) {
+        writer.newline();
+        writer.beginObject();
+        writer.key("name");
+        writer.value(bookmark.name);
+        writer.key("address");
+        writer.value(static_cast<uint64_t>(bookmark.address));
+        writer.key("category");
+        writer.value(bookmark.category);
+        writer.key("description");
+        writer.value(bookmark.description);
+        writer.key("timestamp");
+        writer.value(bookmark.timestamp);
+        writer.endObject();
+        writer.maybeFlush();
+    }
+    writer.endArray();
+    writer.endObject();
+    writer.endDocument();
+}
+
+bool readEndianness(JsonReader& reader, std::string& scratch, Endianness& endianness) {
+    scratch.clear();
+    if (!reader.readString(scratch)) {
+        return false;
+    }
+    endianness = scratch == "big" ? Endianness::Big : Endianness::Little;
+    return true;
+}
+
+bool readAxis(JsonReader& reader, std::string& scratch, MapAxis& axis) {
+    return reader.readObject([&](std::string_view key) {
+        if (key == "address" || key == "count" || key == "dataType") {
+            uint64_t number = 0;
+            if (!reader.readUnsigned(number)) {
+                return false;
+            }
+            if (key == "address") {
+                axis.setAddress(static_cast<size_t>(number));
+            } else if (key == "count") {
+                axis.setCount(static_cast<size_t>(number));
+            } else {
+                axis.setDataType(static_cast<uint16_t>(number));
+            }
+            return true;
+        }
+        if (key == "endianness") {
+            Endianness endianness = axis.endianness();
+            bool ok = readEndianness(reader, scratch, endianness);
+            axis.setEndianness(endianness);
+            return ok;
+        }
+        if (key == "factor" || key == "offset") {
+            double number = key == "factor" ? axis.factor() : axis.offset();
+            if (!reader.readDouble(number)) {
+                return false;
+            }
+            if (key == "factor") {
+                axis.setFactor(number);
+            } else {
+                axis.setOffset(number);
+            }
+            return true;
+        }
+        if (key == "name" || key == "unit") {
+            scratch.clear();
+            if (!reader.readString(scratch)) {
+                return false;
+            }
+            if (key == "name") {
+                axis.setName(std::move(scratch));
+            } else {
+                axis.setUnit(std::move(scratch));
+            }
+            return true;
+        }
+        return reader.skipValue();
+    });
+}
+
+struct MapDouble {
+    std::string_view key;
+    double (MapDefinition::*get)() const;
+    void (MapDefinition::*set)(double);
+};
+
+constexpr MapDouble MapDoubles[] = {
+    {"factor", &MapDefinition::factor, &MapDefinition::setFactor},
+    {"offset", &MapDefinition::offset, &MapDefinition::setOffset},
+    {"hardMin", &MapDefinition::hardMin, &MapDefinition::setHardMin},
+    {"hardMax", &MapDefinition::hardMax, &MapDefinition::setHardMax},
+    {"warningMin", &MapDefinition::warningMin, &MapDefinition::setWarningMin},
+    {"warningMax", &MapDefinition::warningMax, &MapDefinition::setWarningMax},
+};
+
+// Keys missing from older files keep the MapDefinition defaults
+bool readMap(JsonReader& reader, std::string& scratch, MapDefinition& map) {
+    return reader.readObject([&](std::string_view key) {
+        if (key == "name" || key == "unit") {
+            scratch.clear();
+            if (!reader.readString(scratch)) {
+                return false;
+            }
+            if (key == "name") {
+                map.setName(std::move(scratch));
+            } else {
+                map.setUnit(std::move(scratch));
+            }
+            return true;
+        }
+        if (key == "address" || key == "rows" || key == "columns" || key == "dataType") {
+            uint64_t number = 0;
+            if (!reader.readUnsigned(number)) {
+                return false;
+            }
+            if (key == "address") {
+                map.setAddress(static_cast<size_t>(number));
+            } else if (key == "rows") {
+                map.setRows(static_cast<size_t>(number));
+            } else if (key == "columns") {
+                map.setColumns(static_cast<size_t>(number));
+            } else {
+                map.setDataType(static_cast<uint16_t>(number));
+            }
+            return true;
+        }
+        if (key == "type") {
+            scratch.clear();
+            if (!reader.readString(scratch)) {
+                return false;
+            }
+            map.setType(scratch == "3D" ? MapType::Map3D : MapType::Map2D);
+            return true;
+        }
+        if (key == "endianness") {
+            Endianness endianness = map.endianness();
+            bool ok = readEndianness(reader, scratch, endianness);
+            map.setEndianness(endianness);
+            return ok;
+        }
+        for (const auto& field : MapDoubles) {
+            if (key == field.key) {
+                double number = (map.*field.get)();
+                if (!reader.readDouble(number)) {
+                    return false;
+                }
+                (map.*field.set)(number);
+                return true;
+            }
+        }
+        if (key == "xAxis") {
+            return readAxis(reader, scratch, map.xAxis());
+        }
+        if (key == "yAxis") {
+            return readAxis(reader, scratch, map.yAxis());
+        }
+        return reader.skipValue();
+    });
+}
+
+bool readAnnotation(JsonReader& reader, Annotation& annotation) {
+    return reader.readObject([&](std::string_view key) {
+        if (key == "address") {
+            return reader.readSize(annotation.address);
+        }
+        if (key == "length") {
+            return reader.readSize(annotation.length);
+        }
+        if (key == "note") {
+            return reader.readString(annotation.note);
+        }
+        if (key == "color") {
+            return reader.readString(annotation.color);
+        }
+        if (key == "timestamp") {
+            return reader.readInteger(annotation.timestamp);
+        }
+        return reader.skipValue();
+    });
+}
+
+bool readBookmark(JsonReader& reader, Bookmark& bookmark) {
+    return reader.readObject([&](std::string_view key) {
+        if (key == "name") {
+            return reader.readString(bookmark.name);
+        }
+        if (key == "address") {
+            return reader.readSize(bookmark.address);
+        }
+        if (key == "category") {
+            return reader.readString(bookmark.category);
+        }
+        if (key == "description") {
+            return reader.readString(bookmark.description);
+        }
+        if (key == "timestamp") {
+            return reader.readInteger(bookmark.timestamp);
+        }
+        return reader.skipValue();
+    });
+}
+
+} // namespace
+
+bool ProjectSerializer::save(const Project& project, const std::string& filepath, std::string& error) {
+    QSaveFile file(QString::fromStdString(filepath));
+    if (!file.open(QIODevice::WriteOnly)) {
+        error = "Cannot write " + filepath + ": " + file.errorString().toStdString();
+        return false;
+    }
+    
+    JsonWriter writer(&file);
+    writeProject(writer, project);
+    // Without commit() the previous file is left as it was
+    if (!writer.flush() || !file.commit()) {
+        error = "Cannot write " + filepath + ": " + file.errorString().toStdString();
+        return false;
+    }
+    return true;
+}
+
+bool ProjectSerializer::load(const std::string& filepath, Project& project, std::string& error) {
+    MemoryMapper mapper;
+    if (!mapper.open(filepath, true, MemoryMapper::AccessHint::Sequential)) {
+        error = "Cannot open " + filepath;
+        return false;
+    }
+    std::string_view text(reinterpret_cast<const char*>(mapper.data()), mapper.size());
+    if (!fromJson(text, project, error)) {
+        error = filepath + ": " + error;
+        return false;
+    }
+    project.setFilepath(filepath);
+    return true;
+}
+
+std::string ProjectSerializer::toJson(const Project& project) {
+    JsonWriter writer;
+    writeProject(writer, project);
+    return std::move(writer.buffer());
+}
+
+bool ProjectSerializer::fromJson(std::string_view json, Project& project, std::string& error) {
+    JsonReader reader(json);
+    std::string scratch;
+    project.maps().clear();
+    project.annotations().clear();
+    project.bookmarks().clear();
+    
+    bool ok = reader.readObject([&](std::string_view key) {
+        if (key == "name" || key == "binaryFilepath" || key == "ecuName" || key == "description") {
+            scratch.clear();
+            if (!reader.readString(scratch)) {
+                return false;
+            }
+            if (key == "name") {
+                project.setName(scratch);
+            } else if (key == "binaryFilepath") {
+                project.setBinaryFilepath(scratch);
+            } else if (key == "ecuName") {
+                project.setEcuName(scratch);
+            } else {
+                project.setDescription(scratch);
+            }
+            return true;
+        }
+        // Built in place rather than copied in through addMap
+        if (key == "maps") {
+            return reader.readArray([&]() {
+                return readMap(reader, scratch, project.maps().emplace_back());
+            });
+        }
+        if (key == "annotations") {
+            return reader.readArray([&]() {
+                Annotation& annotation = project.annotations().emplace_back();
+                annotation.address = 0;
+                return readAnnotation(reader, annotation);
+            });
+        }
+        if (key == "bookmarks") {
+            return reader.readArray([&]() {
+                Bookmark& bookmark = project.bookmarks().emplace_back();
+                bookmark.address = 0;
+                return readBookmark(reader, bookmark);
+            });
+        }
+        return reader.skipValue();
+    });
+    if (ok && !reader.atEnd()) {
+        ok = reader.fail("unexpected text after the project");
+    }
+    if (!ok) {
+        error = reader.error();
+    }
+    return ok;
+}
+
+} // namespace WinMMM10
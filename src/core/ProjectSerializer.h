@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Project.h"
+#include <string>
+#include <string_view>
+
+namespace WinMMM10 {
+
+// Reads and writes project files without building a JSON document.
+//
+// The format is the JSON the project files always used, now with the map
+// limits, annotations and bookmarks, so older files still load. save()
+// writes each map as it is formatted, in 64 KiB chunks, through QSaveFile:
+// the previous file is replaced only once the new one is complete. load()
+// memory-maps the file and parses it in one pass straight into the
+// project's maps; keys it does not know are skipped.
+//
+// Both are free of shared state and may run on a worker thread.
+class ProjectSerializer {
+public:
+    static bool save(const Project& project, const std::string& filepath, std::string& error);
+    static bool load(const std::string& filepath, Project& project, std::string& error);
+    
+    // The same format in memory
+    static std::string toJson(const Project& project);
+    static bool fromJson(std::string_view json, Project& project, std::string& error);
+};
+
+} // namespace WinMMM10
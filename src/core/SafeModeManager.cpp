@@ -4,6 +4,7 @@
 #include <iomanip>
 #include <functional>
 #include <iostream>
+#include <limits>
 
 namespace WinMMM10 {
 
@@ -50,6 +51,104 @@ SafeModeManager::ValidationResult SafeModeManager::validateValue(
     return ValidationResult::Allowed;
 }
 
+namespace {
+
+// Counts over one block; every comparison feeds a counter so the loops
+// compile to straight-line code
+struct LimitCounts {
+    size_t outsideHard{0};
+    size_t notANumber{0};
+    size_t outsideWarning{0};
+    double lowest{std::numeric_limits<double>::infinity()};
+    double highest{-std::numeric_limits<double>::infinity()};
+};
+
+std::string formatLimitReason(const SafeModeManager::LimitReport& report, const SafeModeManager::ValueLimits& limits) {
+    std::ostringstream oss;
+    if (report.result == SafeModeManager::ValidationResult::Blocked) {
+        oss << report.outsideHard << " of " << report.checked << " values outside hard limits [" << limits.hardMin
+            << ", " << limits.hardMax << "]";
+    } else if (report.clamped > 0) {
+        oss << report.clamped << " of " << report.checked << " values clamped to hard limits [" << limits.hardMin
+            << ", " << limits.hardMax << "]";
+    } else {
+        oss << report.outsideWarning << " of " << report.checked << " values outside warning range ["
+            << limits.warningMin << ", " << limits.warningMax << "]";
+    }
+    if (report.lowest <= report.highest) {
+        oss << " (lowest " << report.lowest << ", highest " << report.highest << ")";
+    }
+    return oss.str();
+}
+
+SafeModeManager::LimitReport finishReport(const LimitCounts& counts, size_t checked, bool clamping,
+                                          const SafeModeManager::ValueLimits& limits) {
+    SafeModeManager::LimitReport report;
+    report.checked = checked;
+    report.outsideHard = counts.outsideHard;
+    report.outsideWarning = counts.outsideWarning;
+    report.clamped = clamping ? counts.outsideHard - counts.notANumber : 0;
+    report.lowest = counts.lowest;
+    report.highest = counts.highest;
+    
+    if (counts.notANumber > 0 || (!clamping && counts.outsideHard > 0)) {
+        report.result = SafeModeManager::ValidationResult::Blocked;
+    } else if (report.clamped > 0 || counts.outsideWarning > 0) {
+        report.result = SafeModeManager::ValidationResult::Warning;
+    }
+    if (report.result != SafeModeManager::ValidationResult::Allowed) {
+        report.reason = formatLimitReason(report, limits);
+    }
+    return report;
+}
+
+} // namespace
+
+SafeModeManager::LimitReport SafeModeManager::checkLimits(
+    std::span<const double> values,
+    const ValueLimits& limits) const {
+    
+    LimitReport report;
+    report.checked = values.size();
+    if (!m_enabled) {
+        return report;
+    }
+    
+    LimitCounts counts;
+    for (double value : values) {
+        counts.outsideHard += !((value >= limits.hardMin) & (value <= limits.hardMax));
+        counts.notANumber += value != value;
+        counts.outsideWarning += (value < limits.warningMin) | (value > limits.warningMax);
+        counts.lowest = value < counts.lowest ? value : counts.lowest;
+        counts.highest = value > counts.highest ? value : counts.highest;
+    }
+    return finishReport(counts, values.size(), false, limits);
+}
+
+SafeModeManager::LimitReport SafeModeManager::clampToLimits(
+    std::span<double> values,
+    const ValueLimits& limits) const {
+    
+    LimitReport report;
+    report.checked = values.size();
+    if (!m_enabled) {
+        return report;
+    }
+    
+    // NaN fails both comparisons and passes through unchanged
+    LimitCounts counts;
+    for (double& value : values) {
+        counts.outsideHard += !((value >= limits.hardMin) & (value <= limits.hardMax));
+        counts.notANumber += value != value;
+        counts.lowest = value < counts.lowest ? value : counts.lowest;
+        counts.highest = value > counts.highest ? value : counts.highest;
+        value = value < limits.hardMin ? limits.hardMin : value;
+        value = value > limits.hardMax ? limits.hardMax : value;
+        counts.outsideWarning += (value < limits.warningMin) | (value > limits.warningMax);
+    }
+    return finishReport(counts, values.size(), true, limits);
+}
+
 bool SafeModeManager::validateChecksum(
     const uint8_t* data, 
     size_t size, 
@@ -2,6 +2,8 @@
 
 #include <string>
 #include <cstdint>
+#include <cstddef>
+#include <span>
 
 namespace WinMMM10 {
 
@@ -29,6 +31,33 @@ public:
     
     ValidationResult validateValue(double value, const ValueLimits& limits, std::string& reason) const;
     
+    // How bulk writes treat values outside the hard limits
+    enum class LimitPolicy {
+        Block, // Reject the whole write
+        Clamp  // Pull values back to the nearest hard limit
+    };
+    
+    LimitPolicy limitPolicy() const { return m_limitPolicy; }
+    void setLimitPolicy(LimitPolicy policy) { m_limitPolicy = policy; }
+    
+    // Aggregated outcome of checking one block of values
+    struct LimitReport {
+        ValidationResult result{ValidationResult::Allowed};
+        size_t checked{0};
+        size_t outsideHard{0};    // NaN counts as outside
+        size_t outsideWarning{0}; // Counted after clamping
+        size_t clamped{0};
+        double lowest{0.0};       // Before clamping, NaN ignored
+        double highest{0.0};
+        std::string reason;       // Empty when Allowed
+    };
+    
+    // One pass over the whole block, without per-value branches. checkLimits
+    // blocks if any value is outside the hard limits; clampToLimits clamps
+    // those values in place and only blocks on NaN.
+    LimitReport checkLimits(std::span<const double> values, const ValueLimits& limits) const;
+    LimitReport clampToLimits(std::span<double> values, const ValueLimits& limits) const;
+    
     // Checksum validation
     bool validateChecksum(const uint8_t* data, size_t size, const std::string& algorithm = "CRC32") const;
     
@@ -47,6 +76,7 @@ private:
     SafeModeManager& operator=(const SafeModeManager&) = delete;
     
     bool m_enabled{true}; // Default: enabled
+    LimitPolicy m_limitPolicy{LimitPolicy::Block};
 };
 
 } // namespace WinMMM10
@@ -25,7 +25,9 @@ void Settings::load() {
         m_lastProjectPath = settings.value("lastProjectPath", "").toString().toStdString();
         m_lastBinaryPath = settings.value("lastBinaryPath", "").toString().toStdString();
         m_autoCleanupCache = settings.value("autoCleanupCache", false).toBool();
+        m_mapCacheBudgetMB = settings.value("mapCacheBudgetMB", 64).toInt();
         m_safeModeEnabled = settings.value("safeModeEnabled", true).toBool(); // Default: enabled
+        m_safeModeClampValues = settings.value("safeModeClampValues", false).toBool();
         m_windowGeometry = settings.value("windowGeometry", QByteArray()).toByteArray();
         m_windowState = settings.value("windowState", QByteArray()).toByteArray();
     }
@@ -52,7 +54,9 @@ void Settings::save() {
         settings.setValue("lastProjectPath", QString::fromStdString(m_lastProjectPath));
         settings.setValue("lastBinaryPath", QString::fromStdString(m_lastBinaryPath));
         settings.setValue("autoCleanupCache", m_autoCleanupCache);
+        settings.setValue("mapCacheBudgetMB", m_mapCacheBudgetMB);
         settings.setValue("safeModeEnabled", m_safeModeEnabled);
+        settings.setValue("safeModeClampValues", m_safeModeClampValues);
         settings.setValue("windowGeometry", m_windowGeometry);
         settings.setValue("windowState", m_windowState);
         settings.sync();
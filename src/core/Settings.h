@@ -18,9 +18,16 @@ public:
     bool autoCleanupCache() const { return m_autoCleanupCache; }
     void setAutoCleanupCache(bool enabled) { m_autoCleanupCache = enabled; }
     
+    int mapCacheBudgetMB() const { return m_mapCacheBudgetMB; }
+    void setMapCacheBudgetMB(int megabytes) { m_mapCacheBudgetMB = megabytes; }
+    
     bool safeModeEnabled() const { return m_safeModeEnabled; }
     void setSafeModeEnabled(bool enabled) { m_safeModeEnabled = enabled; }
     
+    // Clamp out-of-limit map values instead of blocking the write
+    bool safeModeClampValues() const { return m_safeModeClampValues; }
+    void setSafeModeClampValues(bool enabled) { m_safeModeClampValues = enabled; }
+    
     QByteArray windowGeometry() const { return m_windowGeometry; }
     void setWindowGeometry(const QByteArray& geometry) { m_windowGeometry = geometry; }
     
@@ -39,7 +46,9 @@ private:
     std::string m_lastProjectPath;
     std::string m_lastBinaryPath;
     bool m_autoCleanupCache{false};
+    int m_mapCacheBudgetMB{64};
     bool m_safeModeEnabled{true}; // Default: enabled
+    bool m_safeModeClampValues{false};
     QByteArray m_windowGeometry;
     QByteArray m_windowState;
 };
@@ -1,6 +1,11 @@
 #include "BatchOperations.h"
+#include "../core/IntervalIndex.h"
+#include "../maps/MapView.h"
 #include <algorithm>
+#include <atomic>
 #include <functional>
+#include <span>
+#include <thread>
 
 namespace WinMMM10 {
 
@@ -9,86 +14,6 @@ BatchOperations::BatchOperations(BinaryFile* file)
 {
 }
 
-double BatchOperations::readMapValue(const MapDefinition& map, size_t row, size_t col) const {
-    if (!m_binaryFile || !m_binaryFile->isLoaded()) {
-        return 0.0;
-    }
-    
-    size_t address = map.address();
-    size_t index = row * map.columns() + col;
-    
-    switch (map.dataType()) {
-        case 1: // uint8
-            address += index;
-            if (address < m_binaryFile->size()) {
-                uint8_t value = m_binaryFile->readUInt8(address);
-                return static_cast<double>(value) * map.factor() + map.offset();
-            }
-            break;
-        case 2: // uint16
-            address += index * 2;
-            if (address + 1 < m_binaryFile->size()) {
-                uint16_t value = m_binaryFile->readUInt16(address);
-                return static_cast<double>(value) * map.factor() + map.offset();
-            }
-            break;
-        case 3: // int16
-            address += index * 2;
-            if (address + 1 < m_binaryFile->size()) {
-                int16_t value = static_cast<int16_t>(m_binaryFile->readUInt16(address));
-                return static_cast<double>(value) * map.factor() + map.offset();
-            }
-            break;
-        case 4: // float
-            address += index * 4;
-            if (address + 3 < m_binaryFile->size()) {
-                return m_binaryFile->readFloat(address) * map.factor() + map.offset();
-            }
-            break;
-    }
-    
-    return 0.0;
-}
-
-void BatchOperations::writeMapValue(const MapDefinition& map, size_t row, size_t col, double value) {
-    if (!m_binaryFile || !m_binaryFile->isLoaded()) {
-        return;
-    }
-    
-    // Convert from physical value to raw value
-    double rawValue = (value - map.offset()) / map.factor();
-    
-    size_t address = map.address();
-    size_t index = row * map.columns() + col;
-    
-    switch (map.dataType()) {
-        case 1: // uint8
-            address += index;
-            if (address < m_binaryFile->size()) {
-                m_binaryFile->writeUInt8(address, static_cast<uint8_t>(std::round(rawValue)));
-            }
-            break;
-        case 2: // uint16
-            address += index * 2;
-            if (address + 1 < m_binaryFile->size()) {
-                m_binaryFile->writeUInt16(address, static_cast<uint16_t>(std::round(rawValue)));
-            }
-            break;
-        case 3: // int16
-            address += index * 2;
-            if (address + 1 < m_binaryFile->size()) {
-                m_binaryFile->writeInt16(address, static_cast<int16_t>(std::round(rawValue)));
-            }
-            break;
-        case 4: // float
-            address += index * 4;
-            if (address + 3 < m_binaryFile->size()) {
-                m_binaryFile->writeFloat(address, static_cast<float>(rawValue));
-            }
-            break;
-    }
-}
-
 bool BatchOperations::copyMapData(const MapDefinition& map, size_t startRow, size_t startCol,
                                   size_t endRow, size_t endCol, std::vector<double>& buffer) {
     buffer.clear();
@@ -104,14 +29,18 @@ bool BatchOperations::copyMapData(const MapDefinition& map, size_t startRow, siz
         return false;
     }
     
+    MapView view(map, m_binaryFile);
+    if (!view.isValid()) {
+        return false;
+    }
+    
+    // Decode only the selected cells, one row segment at a time
     size_t regionRows = endRow - startRow + 1;
     size_t regionCols = endCol - startCol + 1;
-    buffer.reserve(regionRows * regionCols);
+    buffer.resize(regionRows * regionCols);
     
-    for (size_t r = startRow; r <= endRow; ++r) {
-        for (size_t c = startCol; c <= endCol; ++c) {
-            buffer.push_back(readMapValue(map, r, c));
-        }
+    for (size_t r = 0; r < regionRows; ++r) {
+        view.read((startRow + r) * cols + startCol, std::span<double>(buffer.data() + r * regionCols, regionCols));
     }
     
     return true;
@@ -126,15 +55,41 @@ bool BatchOperations::pasteMapData(const MapDefinition& map, size_t startRow, si
         return false;
     }
     
+    MapView view(map, m_binaryFile);
+    if (!view.isValid()) {
+        return false;
+    }
+    if (buffer.empty()) {
+        return true;
+    }
+    
+    // Only the rows the buffer reaches are decoded and written back
+    size_t regionCols = cols - startCol;
+    size_t endRow = std::min(rows - 1, startRow + (buffer.size() - 1) / regionCols);
+    std::vector<double> values((endRow - startRow + 1) * cols);
+    if (!view.read(startRow * cols, values)) {
+        return false;
+    }
+    
     size_t bufferIndex = 0;
-    for (size_t r = startRow; r < rows && bufferIndex < buffer.size(); ++r) {
+    for (size_t r = 0; r <= endRow - startRow && bufferIndex < buffer.size(); ++r) {
         for (size_t c = startCol; c < cols && bufferIndex < buffer.size(); ++c) {
-            writeMapValue(map, r, c, buffer[bufferIndex]);
+            values[r * cols + c] = buffer[bufferIndex];
             bufferIndex++;
         }
     }
     
-    return true;
+    return view.write(startRow * cols, values);
+}
+
+bool BatchOperations::copyMapData(const MapDefinition& map, size_t startRow, size_t startCol,
+                                  size_t endRow, size_t endCol, MapClipboard& clipboard) {
+    return clipboard.copy(map, m_binaryFile, startRow, startCol, endRow, endCol);
+}
+
+bool BatchOperations::pasteMapData(const MapDefinition& map, size_t startRow, size_t startCol,
+                                  const MapClipboard& clipboard) {
+    return clipboard.paste(map, m_binaryFile, startRow, startCol);
 }
 
 bool BatchOperations::fillMap(const MapDefinition& map, double value, FillMode mode) {
@@ -150,40 +105,167 @@ bool BatchOperations::fillMapRegion(const MapDefinition& map, size_t startRow, s
         return false;
     }
     
+    if (startRow > endRow || startCol > endCol) {
+        return false;
+    }
+    
+    // Work on the block of rows covering the region
+    MapView view(map, m_binaryFile);
+    std::vector<double> values((endRow - startRow + 1) * cols);
+    if (!view.read(startRow * cols, values)) {
+        return false;
+    }
+    
     if (mode == Constant) {
-        for (size_t r = startRow; r <= endRow; ++r) {
-            for (size_t c = startCol; c <= endCol; ++c) {
-                writeMapValue(map, r, c, value);
-            }
+        for (size_t r = 0; r <= endRow - startRow; ++r) {
+            std::fill(values.begin() + r * cols + startCol, values.begin() + r * cols + endCol + 1, value);
         }
     } else if (mode == Linear) {
         // Simple linear interpolation from start to end
-        double startValue = readMapValue(map, startRow, startCol);
+        double startValue = values[startCol];
         double endValue = value;
         size_t totalCells = (endRow - startRow + 1) * (endCol - startCol + 1);
         size_t cellIndex = 0;
         
-        for (size_t r = startRow; r <= endRow; ++r) {
+        for (size_t r = 0; r <= endRow - startRow; ++r) {
             for (size_t c = startCol; c <= endCol; ++c) {
-                double t = static_cast<double>(cellIndex) / (totalCells - 1);
-                double interpolated = startValue + (endValue - startValue) * t;
-                writeMapValue(map, r, c, interpolated);
+                double t = totalCells > 1 ? static_cast<double>(cellIndex) / (totalCells - 1) : 1.0;
+                values[r * cols + c] = startValue + (endValue - startValue) * t;
                 cellIndex++;
             }
         }
     }
     
-    return true;
+    return view.write(startRow * cols, values);
 }
 
+namespace {
+
+// Byte range a map may touch, axes included; empty if it lies outside the image
+std::pair<size_t, size_t> mapRange(const MapDefinition& map, size_t fileSize) {
+    size_t size = map.totalSize();
+    if (size == 0 || map.address() > fileSize || size > fileSize - map.address()) {
+        return {0, 0};
+    }
+    return {map.address(), map.address() + size};
+}
+
+size_t findRoot(std::vector<size_t>& parent, size_t i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+} // namespace
+
 size_t BatchOperations::applyToAllMaps(const std::vector<MapDefinition>& maps,
-                                      std::function<void(const MapDefinition&, BinaryFile*)> operation) {
-    size_t count = 0;
-    for (const auto& map : maps) {
-        operation(map, m_binaryFile);
-        count++;
+                                      std::function<void(const MapDefinition&, BinaryFile*)> operation,
+                                      EditHistory* history, size_t workerCount,
+                                      std::vector<size_t>* skipped) {
+    if (skipped) {
+        skipped->clear();
+    }
+    if (maps.empty() || !m_binaryFile) {
+        return 0;
+    }
+    
+    // Index every in-range map and merge overlapping ones into conflict groups
+    size_t fileSize = m_binaryFile->size();
+    std::vector<std::pair<size_t, size_t>> ranges(maps.size());
+    std::vector<size_t> parent(maps.size());
+    std::vector<size_t> outsideImage;
+    IntervalIndex<size_t> index;
+    for (size_t i = 0; i < maps.size(); ++i) {
+        parent[i] = i;
+        ranges[i] = mapRange(maps[i], fileSize);
+        if (ranges[i].first == ranges[i].second) {
+            outsideImage.push_back(i);
+        } else {
+            index.insert(ranges[i].first, ranges[i].second, i);
+        }
+    }
+    index.build();
+    for (const auto& entry : index.entries()) {
+        index.query(entry.begin, entry.end, [&](const IntervalIndex<size_t>::Entry& other) {
+            size_t a = findRoot(parent, entry.value);
+            size_t b = findRoot(parent, other.value);
+            if (a != b) {
+                parent[std::max(a, b)] = std::min(a, b);
+            }
+        });
+    }
+    
+    // Groups keep list order, so overlapping maps run in the order given
+    std::vector<std::vector<size_t>> groups;
+    std::vector<size_t> groupOf(maps.size(), static_cast<size_t>(-1));
+    for (size_t i = 0; i < maps.size(); ++i) {
+        if (ranges[i].first == ranges[i].second) {
+            continue;
+        }
+        size_t root = findRoot(parent, i);
+        if (groupOf[root] == static_cast<size_t>(-1)) {
+            groupOf[root] = groups.size();
+            groups.emplace_back();
+        }
+        groups[groupOf[root]].push_back(i);
+    }
+    
+    // Overlapping ranges chain into one contiguous span per group, which is
+    // snapshotted before the group runs for the undo step
+    std::vector<std::pair<size_t, size_t>> groupRanges(groups.size());
+    for (size_t g = 0; g < groups.size(); ++g) {
+        groupRanges[g] = ranges[groups[g].front()];
+        for (size_t i : groups[g]) {
+            groupRanges[g].first = std::min(groupRanges[g].first, ranges[i].first);
+            groupRanges[g].second = std::max(groupRanges[g].second, ranges[i].second);
+        }
+    }
+    std::vector<std::vector<uint8_t>> before(history ? groups.size() : 0);
+    
+    if (workerCount == 0) {
+        unsigned int cores = std::thread::hardware_concurrency();
+        workerCount = cores > 0 ? cores : 1;
+    }
+    workerCount = std::min(workerCount, groups.size());
+    
+    m_binaryFile->beginDeferredWrites();
+    std::atomic<size_t> nextGroup{0};
+    auto worker = [&]() {
+        for (size_t g = nextGroup++; g < groups.size(); g = nextGroup++) {
+            if (history) {
+                before[g] = m_binaryFile->readBytes(groupRanges[g].first,
+                                                    groupRanges[g].second - groupRanges[g].first);
+            }
+            for (size_t i : groups[g]) {
+                operation(maps[i], m_binaryFile);
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < workerCount; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    m_binaryFile->endDeferredWrites();
+    
+    if (history) {
+        history->beginTransaction();
+        for (size_t g = 0; g < groups.size(); ++g) {
+            std::vector<uint8_t> after = m_binaryFile->readBytes(groupRanges[g].first, before[g].size());
+            history->pushRange(groupRanges[g].first, before[g].data(), after.data(), after.size());
+        }
+        history->endTransaction();
+    }
+    
+    if (skipped) {
+        *skipped = outsideImage;
     }
-    return count;
+    return maps.size() - outsideImage.size();
 }
 
 } // namespace WinMMM10
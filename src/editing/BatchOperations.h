@@ -2,6 +2,8 @@
 
 #include "../maps/MapDefinition.h"
 #include "../binary/BinaryFile.h"
+#include "../binary/EditHistory.h"
+#include "MapClipboard.h"
 #include <vector>
 #include <functional>
 #include <cstdint>
@@ -25,6 +27,11 @@ public:
                     size_t endRow, size_t endCol, std::vector<double>& buffer);
     bool pasteMapData(const MapDefinition& map, size_t startRow, size_t startCol,
                      const std::vector<double>& buffer);
+    // Structured block with shape, encoding and breakpoints; see MapClipboard
+    bool copyMapData(const MapDefinition& map, size_t startRow, size_t startCol,
+                    size_t endRow, size_t endCol, MapClipboard& clipboard);
+    bool pasteMapData(const MapDefinition& map, size_t startRow, size_t startCol,
+                     const MapClipboard& clipboard);
     
     // Fill operations
     bool fillMap(const MapDefinition& map, double value, FillMode mode = Constant);
@@ -32,13 +39,21 @@ public:
                       size_t endRow, size_t endCol, double value, FillMode mode = Constant);
     
     // Batch operations
+    //
+    // Runs operation once per map. Maps whose byte ranges don't overlap run
+    // concurrently on worker threads; maps that overlap are grouped and run in
+    // list order on one worker. operation must be safe to call concurrently
+    // and write only inside its own map's range. Observers of the file are
+    // notified after all workers finish. With a history, every changed byte is
+    // recorded as one undo step. Maps that do not lie inside the image are
+    // skipped, since their writes could be neither isolated nor undone; their
+    // positions in maps go to skipped. Returns the number of maps applied.
     size_t applyToAllMaps(const std::vector<MapDefinition>& maps,
-                         std::function<void(const MapDefinition&, BinaryFile*)> operation);
+                         std::function<void(const MapDefinition&, BinaryFile*)> operation,
+                         EditHistory* history = nullptr, size_t workerCount = 0,
+                         std::vector<size_t>* skipped = nullptr);
 
 private:
-    double readMapValue(const MapDefinition& map, size_t row, size_t col) const;
-    void writeMapValue(const MapDefinition& map, size_t row, size_t col, double value);
-    
     BinaryFile* m_binaryFile;
 };
 
@@ -1,4 +1,6 @@
 #include "InterpolationEngine.h"
+#include "../maps/MapView.h"
+#include "../maps/BreakpointSearch.h"
 #include <algorithm>
 #include <cmath>
 #include <vector>
@@ -10,85 +12,6 @@ InterpolationEngine::InterpolationEngine(BinaryFile* file)
 {
 }
 
-double InterpolationEngine::readMapValue(const MapDefinition& map, size_t row, size_t col) const {
-    if (!m_binaryFile || !m_binaryFile->isLoaded()) {
-        return 0.0;
-    }
-    
-    size_t address = map.address();
-    size_t index = row * map.columns() + col;
-    
-    switch (map.dataType()) {
-        case 1: // uint8
-            address += index;
-            if (address < m_binaryFile->size()) {
-                uint8_t value = m_binaryFile->readUInt8(address);
-                return static_cast<double>(value) * map.factor() + map.offset();
-            }
-            break;
-        case 2: // uint16
-            address += index * 2;
-            if (address + 1 < m_binaryFile->size()) {
-                uint16_t value = m_binaryFile->readUInt16(address);
-                return static_cast<double>(value) * map.factor() + map.offset();
-            }
-            break;
-        case 3: // int16
-            address += index * 2;
-            if (address + 1 < m_binaryFile->size()) {
-                int16_t value = static_cast<int16_t>(m_binaryFile->readUInt16(address));
-                return static_cast<double>(value) * map.factor() + map.offset();
-            }
-            break;
-        case 4: // float
-            address += index * 4;
-            if (address + 3 < m_binaryFile->size()) {
-                return m_binaryFile->readFloat(address) * map.factor() + map.offset();
-            }
-            break;
-    }
-    
-    return 0.0;
-}
-
-void InterpolationEngine::writeMapValue(const MapDefinition& map, size_t row, size_t col, double value) {
-    if (!m_binaryFile || !m_binaryFile->isLoaded()) {
-        return;
-    }
-    
-    double rawValue = (value - map.offset()) / map.factor();
-    
-    size_t address = map.address();
-    size_t index = row * map.columns() + col;
-    
-    switch (map.dataType()) {
-        case 1: // uint8
-            address += index;
-            if (address < m_binaryFile->size()) {
-                m_binaryFile->writeUInt8(address, static_cast<uint8_t>(std::round(rawValue)));
-            }
-            break;
-        case 2: // uint16
-            address += index * 2;
-            if (address + 1 < m_binaryFile->size()) {
-                m_binaryFile->writeUInt16(address, static_cast<uint16_t>(std::round(rawValue)));
-            }
-            break;
-        case 3: // int16
-            address += index * 2;
-            if (address + 1 < m_binaryFile->size()) {
-                m_binaryFile->writeInt16(address, static_cast<int16_t>(std::round(rawValue)));
-            }
-            break;
-        case 4: // float
-            address += index * 4;
-            if (address + 3 < m_binaryFile->size()) {
-                m_binaryFile->writeFloat(address, static_cast<float>(rawValue));
-            }
-            break;
-    }
-}
-
 double InterpolationEngine::linearInterpolate(double x0, double y0, double x1, double y1, double x) const {
     if (std::abs(x1 - x0) < 0.0001) {
         return y0;
@@ -113,75 +36,216 @@ bool InterpolationEngine::interpolateMap(const MapDefinition& map, Interpolation
 
 bool InterpolationEngine::interpolateRegion(const MapDefinition& map, size_t startRow, size_t startCol,
                                            size_t endRow, size_t endCol, InterpolationType type) {
-    if (type == InterpolationType::Linear) {
-        // Simple linear interpolation between corner points
-        double topLeft = readMapValue(map, startRow, startCol);
-        double topRight = readMapValue(map, startRow, endCol);
-        double bottomLeft = readMapValue(map, endRow, startCol);
-        double bottomRight = readMapValue(map, endRow, endCol);
-        
-        for (size_t r = startRow; r <= endRow; ++r) {
-            for (size_t c = startCol; c <= endCol; ++c) {
-                double rowT = static_cast<double>(r - startRow) / (endRow - startRow);
-                double colT = static_cast<double>(c - startCol) / (endCol - startCol);
-                
-                double top = linearInterpolate(0, topLeft, 1, topRight, colT);
-                double bottom = linearInterpolate(0, bottomLeft, 1, bottomRight, colT);
-                double value = linearInterpolate(0, top, 1, bottom, rowT);
-                
-                writeMapValue(map, r, c, value);
-            }
+    size_t cols = map.columns();
+    if (endRow >= map.rows() || endCol >= cols || startRow > endRow || startCol > endCol) {
+        return false;
+    }
+    
+    if (type != InterpolationType::Linear) {
+        return splineRegion(map, startRow, startCol, endRow, endCol,
+                            type == InterpolationType::Spline ? CubicSpline::Kind::Natural
+                                                              : CubicSpline::Kind::Monotone);
+    }
+    
+    // Only the block of rows covering the region is decoded and written back
+    MapView view(map, m_binaryFile);
+    std::vector<double> values((endRow - startRow + 1) * cols);
+    if (!view.read(startRow * cols, values)) {
+        return false;
+    }
+    
+    // Simple linear interpolation between corner points
+    size_t lastRow = endRow - startRow;
+    double topLeft = values[startCol];
+    double topRight = values[endCol];
+    double bottomLeft = values[lastRow * cols + startCol];
+    double bottomRight = values[lastRow * cols + endCol];
+    
+    for (size_t r = 0; r <= lastRow; ++r) {
+        for (size_t c = startCol; c <= endCol; ++c) {
+            double rowT = lastRow > 0 ? static_cast<double>(r) / lastRow : 0.0;
+            double colT = endCol > startCol ? static_cast<double>(c - startCol) / (endCol - startCol) : 0.0;
+            
+            double top = linearInterpolate(0, topLeft, 1, topRight, colT);
+            double bottom = linearInterpolate(0, bottomLeft, 1, bottomRight, colT);
+            values[r * cols + c] = linearInterpolate(0, top, 1, bottom, rowT);
+        }
+    }
+    
+    return view.write(startRow * cols, values);
+}
+
+namespace {
+
+// Breakpoints of one map dimension, or indices if the axis is missing or not ascending
+std::vector<double> knotPositions(const MapAxis& axis, const BinaryFile* file, size_t count) {
+    std::vector<double> values;
+    if (MapView::readAxis(axis, file, values) && values.size() == count &&
+        CubicSpline::isAscending(values)) {
+        return values;
+    }
+    values.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = static_cast<double>(i);
+    }
+    return values;
+}
+
+// Indices in [0, count) outside the open interval (first, last)
+std::vector<size_t> knownIndices(size_t count, size_t first, size_t last) {
+    std::vector<size_t> known;
+    for (size_t i = 0; i < count; ++i) {
+        if (i <= first || i >= last) {
+            known.push_back(i);
         }
     }
+    return known;
+}
+
+// Fits one spline per line through the known cells and evaluates it at the
+// interior positions. Positions are located once for all lines.
+void fillLines(const std::vector<double>& values, size_t lineCount, size_t firstLine,
+               size_t lineStride, size_t pointStride, const std::vector<double>& positions,
+               const std::vector<size_t>& known, size_t firstInterior, size_t interiorCount,
+               CubicSpline::Kind kind, std::vector<double>& out) {
+    std::vector<double> knotX(known.size());
+    for (size_t k = 0; k < known.size(); ++k) {
+        knotX[k] = positions[known[k]];
+    }
+    std::vector<uint32_t> index(interiorCount);
+    std::vector<double> weight(interiorCount);
+    locateBreakpoints(knotX, std::span<const double>(positions).subspan(firstInterior, interiorCount),
+                      index.data(), weight.data());
     
-    return true;
+    CubicSpline spline;
+    std::vector<double> knotY(known.size());
+    for (size_t line = 0; line < lineCount; ++line) {
+        size_t base = (firstLine + line) * lineStride;
+        for (size_t k = 0; k < known.size(); ++k) {
+            knotY[k] = values[base + known[k] * pointStride];
+        }
+        spline.fit(knotX, knotY, kind);
+        spline.evaluate(index.data(), weight.data(), interiorCount, out.data() + line * interiorCount);
+    }
 }
 
-bool InterpolationEngine::smoothMap(const MapDefinition& map, int kernelSize) {
-    if (kernelSize < 3 || kernelSize % 2 == 0) {
+} // namespace
+
+bool InterpolationEngine::hasInteriorKnots(const MapDefinition& map, size_t startRow, size_t startCol,
+                                           size_t endRow, size_t endCol) {
+    if (endRow >= map.rows() || endCol >= map.columns() || startRow > endRow || startCol > endCol) {
         return false;
     }
+    // Knots along a dimension are the region's border plus every line outside it
+    size_t knownCols = map.columns() - (endCol > startCol ? endCol - startCol - 1 : 0);
+    size_t knownRows = map.rows() - (endRow > startRow ? endRow - startRow - 1 : 0);
+    return (startCol < endCol && knownCols > 2) || (startRow < endRow && knownRows > 2);
+}
+
+bool InterpolationEngine::splineRegion(const MapDefinition& map, size_t startRow, size_t startCol,
+                                       size_t endRow, size_t endCol, CubicSpline::Kind kind) {
+    if (!hasInteriorKnots(map, startRow, startCol, endRow, endCol)) {
+        return false; // Every fit would be the straight line between the region's edges
+    }
     
-    size_t rows = map.rows();
-    size_t cols = map.columns();
-    std::vector<std::vector<double>> temp(rows, std::vector<double>(cols));
+    MapView view(map, m_binaryFile);
+    std::vector<double> values;
+    if (!view.read(values)) {
+        return false;
+    }
     
-    int halfKernel = kernelSize / 2;
+    size_t rows = view.rows();
+    size_t cols = view.columns();
     
-    // Read all values
-    for (size_t r = 0; r < rows; ++r) {
-        for (size_t c = 0; c < cols; ++c) {
-            temp[r][c] = readMapValue(map, r, c);
-        }
+    // A region one cell high or wide (e.g. on a curve) is fitted along the other dimension only
+    bool fitRows = startCol < endCol;
+    bool fitColumns = startRow < endRow;
+    size_t firstRow = fitColumns ? startRow + 1 : startRow;
+    size_t firstCol = fitRows ? startCol + 1 : startCol;
+    size_t interiorRows = fitColumns ? endRow - startRow - 1 : 1;
+    size_t interiorCols = fitRows ? endCol - startCol - 1 : 1;
+    if (interiorRows == 0 || interiorCols == 0) {
+        return true; // Border only, nothing to rebuild
     }
     
-    // Apply smoothing (simple box filter)
-    for (size_t r = 0; r < rows; ++r) {
-        for (size_t c = 0; c < cols; ++c) {
-            double sum = 0.0;
-            int count = 0;
-            
-            for (int dr = -halfKernel; dr <= halfKernel; ++dr) {
-                for (int dc = -halfKernel; dc <= halfKernel; ++dc) {
-                    int nr = static_cast<int>(r) + dr;
-                    int nc = static_cast<int>(c) + dc;
-                    
-                    if (nr >= 0 && nr < static_cast<int>(rows) &&
-                        nc >= 0 && nc < static_cast<int>(cols)) {
-                        sum += temp[nr][nc];
-                        count++;
-                    }
-                }
+    std::vector<double> xPositions = knotPositions(map.xAxis(), m_binaryFile, cols);
+    std::vector<double> yPositions = knotPositions(map.yAxis(), m_binaryFile, rows);
+    std::vector<size_t> knownCols = knownIndices(cols, startCol, endCol);
+    std::vector<size_t> knownRows = knownIndices(rows, startRow, endRow);
+    
+    // Along rows: one fit per interior row, row-major output
+    std::vector<double> alongRows;
+    if (fitRows) {
+        alongRows.resize(interiorRows * interiorCols);
+        fillLines(values, interiorRows, firstRow, cols, 1, xPositions, knownCols,
+                  firstCol, interiorCols, kind, alongRows);
+    }
+    
+    // Along columns: one fit per interior column, column-major output
+    std::vector<double> alongColumns;
+    if (fitColumns) {
+        alongColumns.resize(interiorRows * interiorCols);
+        fillLines(values, interiorCols, firstCol, 1, cols, yPositions, knownRows,
+                  firstRow, interiorRows, kind, alongColumns);
+    }
+    
+    if (!fitRows || !fitColumns) {
+        for (size_t r = 0; r < interiorRows; ++r) {
+            double* dst = values.data() + (firstRow + r) * cols + firstCol;
+            for (size_t c = 0; c < interiorCols; ++c) {
+                dst[c] = fitRows ? alongRows[r * interiorCols + c] : alongColumns[c * interiorRows + r];
             }
-            
-            if (count > 0) {
-                writeMapValue(map, r, c, sum / count);
+        }
+    } else {
+        // Gordon surface: row fits plus column fits minus the tensor-product
+        // spline through the grid of known rows and columns, which passes
+        // through every known row and column rather than averaging the fits
+        std::vector<double> grid(knownRows.size() * knownCols.size());
+        std::vector<double> gridX(knownCols.size()), gridY(knownRows.size());
+        for (size_t k = 0; k < knownCols.size(); ++k) {
+            gridX[k] = xPositions[knownCols[k]];
+        }
+        for (size_t r = 0; r < knownRows.size(); ++r) {
+            gridY[r] = yPositions[knownRows[r]];
+            for (size_t k = 0; k < knownCols.size(); ++k) {
+                grid[r * knownCols.size() + k] = values[knownRows[r] * cols + knownCols[k]];
+            }
+        }
+        
+        std::vector<double> tensor(interiorRows * interiorCols);
+        if (!CubicSpline::resample(grid, gridX, gridY,
+                                   std::span<const double>(xPositions).subspan(firstCol, interiorCols),
+                                   std::span<const double>(yPositions).subspan(firstRow, interiorRows),
+                                   tensor, kind)) {
+            return false;
+        }
+        
+        for (size_t r = 0; r < interiorRows; ++r) {
+            double* dst = values.data() + (firstRow + r) * cols + firstCol;
+            for (size_t c = 0; c < interiorCols; ++c) {
+                dst[c] = alongRows[r * interiorCols + c] + alongColumns[c * interiorRows + r] -
+                         tensor[r * interiorCols + c];
             }
         }
     }
     
-    return true;
+    // Only the rows of the region are written back
+    size_t first = firstRow * cols;
+    return view.write(first, std::span<const double>(values).subspan(first, interiorRows * cols));
 }
 
-} // namespace WinMMM10
+bool InterpolationEngine::smoothMap(const MapDefinition& map, int kernelSize, MapFilters::Type filter) {
+    MapView view(map, m_binaryFile);
+    std::vector<double> source;
+    if (!view.read(source)) {
+        return false;
+    }
+    
+    std::vector<double> smoothed(source.size());
+    if (!MapFilters::apply(filter, source, view.rows(), view.columns(), kernelSize, smoothed)) {
+        return false;
+    }
+    return view.write(smoothed);
+}
 
+} // namespace WinMMM10
@@ -2,13 +2,16 @@
 
 #include "../maps/MapDefinition.h"
 #include "../binary/BinaryFile.h"
+#include "MapFilters.h"
+#include "../maps/CubicSpline.h"
+#include <vector>
 
 namespace WinMMM10 {
 
 enum class InterpolationType {
-    Linear,
-    Cubic,
-    Spline
+    Linear, // Bilinear blend of the region's corners
+    Cubic,  // Monotone (Fritsch-Carlson) cubic through the surrounding cells
+    Spline  // Natural cubic spline through the surrounding cells
 };
 
 class InterpolationEngine {
@@ -16,16 +19,30 @@ public:
     InterpolationEngine(BinaryFile* file);
     ~InterpolationEngine() = default;
     
+    // Whole map from its corners; only Linear applies, as the spline methods
+    // need knots outside the region
     bool interpolateMap(const MapDefinition& map, InterpolationType type = InterpolationType::Linear);
-    bool smoothMap(const MapDefinition& map, int kernelSize = 3);
+    // Decodes the map once, filters the contiguous buffer and writes it back in one pass
+    bool smoothMap(const MapDefinition& map, int kernelSize = 3,
+                   MapFilters::Type filter = MapFilters::Type::Box);
+    // Linear rewrites the whole region from its corners. Cubic and Spline keep
+    // the region's border and rebuild its interior from the cells outside it:
+    // a spline through each row over the x axis and each column over the y
+    // axis, blended into one surface. A single-row region (e.g. on a curve)
+    // uses rows only. They fail unless hasInteriorKnots().
     bool interpolateRegion(const MapDefinition& map, size_t startRow, size_t startCol,
                           size_t endRow, size_t endCol, InterpolationType type = InterpolationType::Linear);
+    
+    // True if the region leaves more than two knots along a dimension it is
+    // fitted in, so a spline differs from the straight line between its edges
+    static bool hasInteriorKnots(const MapDefinition& map, size_t startRow, size_t startCol,
+                                 size_t endRow, size_t endCol);
 
 private:
-    double readMapValue(const MapDefinition& map, size_t row, size_t col) const;
-    void writeMapValue(const MapDefinition& map, size_t row, size_t col, double value);
     double linearInterpolate(double x0, double y0, double x1, double y1, double x) const;
     double cubicInterpolate(double p0, double p1, double p2, double p3, double t) const;
+    bool splineRegion(const MapDefinition& map, size_t startRow, size_t startCol,
+                      size_t endRow, size_t endCol, CubicSpline::Kind kind);
     
     BinaryFile* m_binaryFile;
 };
@@ -0,0 +1,413 @@
+#include "MapClipboard.h"
+#include "../maps/MapView.h"
+#include "../maps/CubicSpline.h"
+#include "../maps/ScalingEngine.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <sstream>
+
+namespace WinMMM10 {
+
+namespace {
+
+constexpr double EmptyCell = std::numeric_limits<double>::quiet_NaN();
+
+// Corner cell of an axis header written by writeTsv()
+constexpr const char* AxisCorner = "y\\x";
+
+// Shortest text that reads back as the same double; NaN stays an empty cell
+void appendNumber(std::string& line, double value) {
+    if (std::isnan(value)) {
+        return;
+    }
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    line.append(buffer, result.ptr);
+}
+
+bool parseField(std::string field, double& value, std::string& error) {
+    size_t begin = field.find_first_not_of(" \"");
+    size_t end = field.find_last_not_of(" \"");
+    if (begin == std::string::npos) {
+        value = EmptyCell;
+        return true;
+    }
+    field = field.substr(begin, end - begin + 1);
+    if (field.front() == '+') {
+        field.erase(0, 1);
+    }
+    std::replace(field.begin(), field.end(), ',', '.');
+    
+    auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+    if (result.ec != std::errc() || result.ptr != field.data() + field.size()) {
+        error = "'" + field + "' is not a number";
+        return false;
+    }
+    return true;
+}
+
+bool parseLine(const std::string& line, std::vector<double>& fields, std::string& error) {
+    fields.clear();
+    size_t start = 0;
+    while (true) {
+        size_t tab = line.find('\t', start);
+        double value = 0.0;
+        if (!parseField(line.substr(start, tab - start), value, error)) {
+            return false;
+        }
+        fields.push_back(value);
+        if (tab == std::string::npos) {
+            return true;
+        }
+        start = tab + 1;
+    }
+}
+
+// An axis read from text is either complete or absent
+bool finishAxis(std::vector<double>& axis, const char* name, std::string& error) {
+    size_t empty = static_cast<size_t>(std::count_if(axis.begin(), axis.end(),
+                                                     [](double v) { return std::isnan(v); }));
+    if (empty == axis.size()) {
+        axis.clear();
+        return true;
+    }
+    if (empty > 0) {
+        error = std::string("Some ") + name + " axis breakpoints are missing";
+        return false;
+    }
+    return true;
+}
+
+// Positions of one dimension for pasteResampled: the block's breakpoints and
+// the run of target breakpoints inside them, or cell indices when both sides
+// have the same count but no usable axes
+struct PasteDimension {
+    std::vector<double> source;
+    std::vector<double> target;
+    size_t first{0};
+};
+
+bool resolveDimension(const std::vector<double>& blockAxis, size_t blockCount, const MapAxis& axis,
+                      const BinaryFile* file, size_t targetCount, PasteDimension& dimension) {
+    std::vector<double> targetAxis;
+    bool hasTargetAxis = MapView::readAxis(axis, file, targetAxis) && targetAxis.size() == targetCount &&
+                         CubicSpline::isAscending(targetAxis);
+    if (!blockAxis.empty() && hasTargetAxis && CubicSpline::isAscending(blockAxis)) {
+        auto lower = std::lower_bound(targetAxis.begin(), targetAxis.end(), blockAxis.front());
+        auto upper = std::upper_bound(targetAxis.begin(), targetAxis.end(), blockAxis.back());
+        dimension.source = blockAxis;
+        dimension.target.assign(lower, upper);
+        dimension.first = static_cast<size_t>(lower - targetAxis.begin());
+        return !dimension.target.empty();
+    }
+    
+    if (blockCount != targetCount) {
+        return false;
+    }
+    dimension.source.resize(blockCount);
+    for (size_t i = 0; i < blockCount; ++i) {
+        dimension.source[i] = static_cast<double>(i);
+    }
+    dimension.target = dimension.source;
+    dimension.first = 0;
+    return true;
+}
+
+} // namespace
+
+void MapClipboard::clear() {
+    m_rows = 0;
+    m_columns = 0;
+    m_dataType = 0;
+    m_endianness = Endianness::Little;
+    m_factor = 1.0;
+    m_offset = 0.0;
+    m_xAxis.clear();
+    m_yAxis.clear();
+    m_raw.clear();
+    m_physical.clear();
+}
+
+bool MapClipboard::copy(const MapDefinition& map, const BinaryFile* file) {
+    return copy(map, file, 0, 0, map.rows() > 0 ? map.rows() - 1 : 0, map.columns() > 0 ? map.columns() - 1 : 0);
+}
+
+bool MapClipboard::copy(const MapDefinition& map, const BinaryFile* file,
+                        size_t startRow, size_t startCol, size_t endRow, size_t endCol) {
+    clear();
+    MapView view(map, file);
+    if (!view.isValid() || endRow >= view.rows() || endCol >= view.columns() ||
+        startRow > endRow || startCol > endCol) {
+        return false;
+    }
+    
+    m_rows = endRow - startRow + 1;
+    m_columns = endCol - startCol + 1;
+    m_dataType = map.dataType();
+    m_endianness = map.endianness();
+    m_factor = map.factor();
+    m_offset = map.offset();
+    
+    // Stored bytes one row segment at a time, then one decode over the whole block
+    size_t rowBytes = m_columns * view.elementSize();
+    m_raw.resize(m_rows * rowBytes);
+    for (size_t r = 0; r < m_rows; ++r) {
+        if (!view.readRaw((startRow + r) * view.columns() + startCol,
+                          std::span<uint8_t>(m_raw.data() + r * rowBytes, rowBytes))) {
+            clear();
+            return false;
+        }
+    }
+    m_physical.resize(m_rows * m_columns);
+    ScalingEngine::decode(m_dataType, m_raw.data(), m_physical.size(), m_endianness, m_factor, m_offset,
+                          m_physical.data());
+    
+    std::vector<double> axis;
+    if (MapView::readAxis(map.xAxis(), file, axis) && axis.size() == view.columns()) {
+        m_xAxis.assign(axis.begin() + startCol, axis.begin() + endCol + 1);
+    }
+    if (MapView::readAxis(map.yAxis(), file, axis) && axis.size() == view.rows()) {
+        m_yAxis.assign(axis.begin() + startRow, axis.begin() + endRow + 1);
+    }
+    return true;
+}
+
+bool MapClipboard::hasSameEncoding(const MapDefinition& map) const {
+    return !m_raw.empty() && m_dataType == map.dataType() && m_endianness == map.endianness() &&
+           m_factor == map.factor() && m_offset == map.offset();
+}
+
+bool MapClipboard::paste(const MapDefinition& map, BinaryFile* file, size_t row, size_t col) const {
+    MapView view(map, file);
+    if (!view.isWritable() || row >= view.rows() || col >= view.columns()) {
+        return false;
+    }
+    if (isEmpty()) {
+        return true;
+    }
+    
+    // Only the rows the block reaches are read and written back, in one write
+    size_t cols = view.columns();
+    size_t pasteRows = std::min(m_rows, view.rows() - row);
+    size_t pasteCols = std::min(m_columns, cols - col);
+    size_t first = row * cols;
+    
+    if (hasSameEncoding(map)) {
+        size_t elementSize = view.elementSize();
+        std::vector<uint8_t> bytes(pasteRows * cols * elementSize);
+        if (!view.readRaw(first, bytes)) {
+            return false;
+        }
+        for (size_t r = 0; r < pasteRows; ++r) {
+            std::memcpy(bytes.data() + (r * cols + col) * elementSize,
+                        m_raw.data() + r * m_columns * elementSize, pasteCols * elementSize);
+        }
+        return view.writeRaw(first, bytes);
+    }
+    
+    std::vector<double> values(pasteRows * cols);
+    if (!view.read(first, values)) {
+        return false;
+    }
+    for (size_t r = 0; r < pasteRows; ++r) {
+        for (size_t c = 0; c < pasteCols; ++c) {
+            double value = m_physical[r * m_columns + c];
+            if (!std::isnan(value)) {
+                values[r * cols + col + c] = value;
+            }
+        }
+    }
+    return view.write(first, values);
+}
+
+bool MapClipboard::pasteResampled(const MapDefinition& map, BinaryFile* file, MapResampler::Method method) const {
+    MapView view(map, file);
+    if (!view.isWritable() || isEmpty()) {
+        return false;
+    }
+    
+    PasteDimension x, y;
+    if (!resolveDimension(m_xAxis, m_columns, map.xAxis(), file, view.columns(), x) ||
+        !resolveDimension(m_yAxis, m_rows, map.yAxis(), file, view.rows(), y)) {
+        return false;
+    }
+    
+    std::vector<double> resampled(y.target.size() * x.target.size());
+    if (!MapResampler::resample(m_physical, x.source, y.source, x.target, y.target, resampled, method)) {
+        return false;
+    }
+    
+    size_t cols = view.columns();
+    size_t first = y.first * cols;
+    std::vector<double> values(y.target.size() * cols);
+    if (!view.read(first, values)) {
+        return false;
+    }
+    for (size_t r = 0; r < y.target.size(); ++r) {
+        for (size_t c = 0; c < x.target.size(); ++c) {
+            double value = resampled[r * x.target.size() + c];
+            if (!std::isnan(value)) {
+                values[r * cols + x.first + c] = value;
+            }
+        }
+    }
+    return view.write(first, values);
+}
+
+void MapClipboard::writeTsv(std::ostream& out) const {
+    bool labelled = !m_xAxis.empty() || !m_yAxis.empty();
+    std::string line;
+    if (labelled) {
+        line = AxisCorner;
+        for (size_t c = 0; c < m_columns; ++c) {
+            line += '\t';
+            if (!m_xAxis.empty()) {
+                appendNumber(line, m_xAxis[c]);
+            }
+        }
+        line += '\n';
+        out.write(line.data(), static_cast<std::streamsize>(line.size()));
+    }
+    
+    for (size_t r = 0; r < m_rows; ++r) {
+        line.clear();
+        if (labelled) {
+            if (!m_yAxis.empty()) {
+                appendNumber(line, m_yAxis[r]);
+            }
+            line += '\t';
+        }
+        for (size_t c = 0; c < m_columns; ++c) {
+            if (c > 0) {
+                line += '\t';
+            }
+            appendNumber(line, m_physical[r * m_columns + c]);
+        }
+        line += '\n';
+        out.write(line.data(), static_cast<std::streamsize>(line.size()));
+    }
+}
+
+std::string MapClipboard::toTsv() const {
+    std::ostringstream out;
+    writeTsv(out);
+    return out.str();
+}
+
+bool MapClipboard::readTsv(std::istream& in, std::string& error) {
+    clear();
+    
+    // The first line is the x axis header if it carries the corner marker, or
+    // if it has no corner cell at all: one cell fewer than the row below it.
+    // Otherwise a leading empty cell is just an empty value. Until the second
+    // line decides, the first is held back; every other row goes straight in.
+    bool marked = false;
+    bool decided = false;
+    bool labelled = false;
+    std::vector<double> first;
+    size_t firstLineNumber = 0;
+    auto appendRow = [&](const std::vector<double>& fields, size_t lineNumber) {
+        size_t skip = labelled ? 1 : 0;
+        size_t cells = fields.size() - skip;
+        if (m_columns == 0) {
+            m_columns = cells;
+        } else if (cells != m_columns) {
+            error = "Line " + std::to_string(lineNumber) + " has " + std::to_string(cells) + " cells, expected " +
+                    std::to_string(m_columns);
+            return false;
+        }
+        m_physical.insert(m_physical.end(), fields.begin() + skip, fields.end());
+        m_yAxis.push_back(labelled ? fields.front() : EmptyCell);
+        ++m_rows;
+        return true;
+    };
+    
+    std::vector<double> fields;
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+        if (firstLineNumber == 0) {
+            size_t tab = line.find('\t');
+            std::string corner = line.substr(0, tab);
+            corner.erase(std::remove_if(corner.begin(), corner.end(), [](char ch) { return ch == ' ' || ch == '"'; }),
+                         corner.end());
+            if (corner == AxisCorner) {
+                marked = true;
+                line.erase(0, tab == std::string::npos ? line.size() : tab);
+            }
+        }
+        if (!parseLine(line, fields, error)) {
+            error = "Line " + std::to_string(lineNumber) + ": " + error;
+            clear();
+            return false;
+        }
+        
+        if (firstLineNumber == 0) {
+            firstLineNumber = lineNumber;
+            first.swap(fields);
+            if (marked) {
+                decided = true;
+                labelled = true;
+                m_xAxis.assign(first.begin() + 1, first.end());
+            }
+            continue;
+        }
+        if (!decided) {
+            decided = true;
+            labelled = fields.size() == first.size() + 1;
+            if (labelled) {
+                m_xAxis = std::move(first);
+            } else if (!appendRow(first, firstLineNumber)) {
+                clear();
+                return false;
+            }
+        }
+        if (!appendRow(fields, lineNumber)) {
+            clear();
+            return false;
+        }
+    }
+    // A single line is a row of values
+    if (firstLineNumber != 0 && !decided && !appendRow(first, firstLineNumber)) {
+        clear();
+        return false;
+    }
+    
+    if (m_rows == 0 || m_columns == 0) {
+        error = "No values to paste";
+        clear();
+        return false;
+    }
+    if (labelled && m_xAxis.size() != m_columns) {
+        error = "The axis header has " + std::to_string(m_xAxis.size()) + " breakpoints, expected " +
+                std::to_string(m_columns);
+        clear();
+        return false;
+    }
+    if (!labelled) {
+        m_yAxis.clear();
+    }
+    if (!finishAxis(m_xAxis, "x", error) || !finishAxis(m_yAxis, "y", error)) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+bool MapClipboard::fromTsv(const std::string& text, std::string& error) {
+    std::istringstream in(text);
+    return readTsv(in, error);
+}
+
+} // namespace WinMMM10
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "../maps/MapDefinition.h"
+#include "../maps/MapResampler.h"
+#include "../binary/BinaryFile.h"
+#include "../binary/Endianness.h"
+#include <cstdint>
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace WinMMM10 {
+
+// A rectangular block of map cells with its shape, encoding and breakpoints.
+//
+// Blocks copied from a map carry both the stored bytes and the physical
+// values, so pasting into a map with the same element type, byte order and
+// scaling moves the bytes unchanged. Blocks with axes can also be pasted by
+// breakpoint onto a map with a different grid. For spreadsheets the block
+// converts to and from tab-separated text, streamed one row at a time.
+class MapClipboard {
+public:
+    MapClipboard() = default;
+    
+    bool isEmpty() const { return m_physical.empty(); }
+    void clear();
+    
+    size_t rows() const { return m_rows; }
+    size_t columns() const { return m_columns; }
+    const std::vector<double>& physicalValues() const { return m_physical; }
+    const std::vector<double>& xAxis() const { return m_xAxis; }
+    const std::vector<double>& yAxis() const { return m_yAxis; }
+    // Stored bytes, row-major; empty for blocks read from text
+    const std::vector<uint8_t>& rawValues() const { return m_raw; }
+    
+    // Copies the inclusive cell range together with the matching breakpoints
+    bool copy(const MapDefinition& map, const BinaryFile* file,
+              size_t startRow, size_t startCol, size_t endRow, size_t endCol);
+    bool copy(const MapDefinition& map, const BinaryFile* file);
+    
+    // Pastes with the block's top-left cell at (row, col), clipped to the map.
+    // Cells that are NaN (empty in pasted text) keep their current value.
+    bool paste(const MapDefinition& map, BinaryFile* file, size_t row = 0, size_t col = 0) const;
+    
+    // Pastes by breakpoint: every target cell whose axis values fall inside
+    // the block's axis range gets the block interpolated at that point. A
+    // dimension without axes on either side must have the same cell count.
+    bool pasteResampled(const MapDefinition& map, BinaryFile* file,
+                        MapResampler::Method method = MapResampler::Method::Bilinear) const;
+    
+    // Tab-separated rows. With axes, the first line holds the x breakpoints
+    // after a "y\x" corner cell and each row starts with its y breakpoint;
+    // an axis that is missing is written as empty cells.
+    void writeTsv(std::ostream& out) const;
+    std::string toTsv() const;
+    // Accepts '.' or ',' decimals and CRLF line ends. Besides the corner cell,
+    // a first line with one cell fewer than every following row is taken as
+    // the x axis header; empty cells are otherwise values to leave unchanged.
+    bool readTsv(std::istream& in, std::string& error);
+    bool fromTsv(const std::string& text, std::string& error);
+
+private:
+    bool hasSameEncoding(const MapDefinition& map) const;
+    
+    size_t m_rows{0};
+    size_t m_columns{0};
+    uint16_t m_dataType{0}; // 0 when the block has no stored bytes
+    Endianness m_endianness{Endianness::Little};
+    double m_factor{1.0};
+    double m_offset{0.0};
+    std::vector<double> m_xAxis;
+    std::vector<double> m_yAxis;
+    std::vector<uint8_t> m_raw;
+    std::vector<double> m_physical;
+};
+
+} // namespace WinMMM10
@@ -38,8 +38,6 @@ public:
                      double tolerance = 0.0001);
 
 private:
-    double readMapValue(const MapDefinition& map, const BinaryFile* file,
-                       size_t row, size_t col) const;
     double calculateDifference(double val1, double val2) const;
 };
 
@@ -0,0 +1,590 @@
+#include "MapExpression.h"
+#include "../maps/MapView.h"
+#include "../maps/MapResampler.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+
+namespace WinMMM10 {
+
+// Recursive-descent compiler emitting postfix bytecode. Precedence from
+// loosest: comparison, + -, * /, unary minus, ^ (right-associative).
+class ExpressionParser {
+public:
+    using Op = MapExpression::Op;
+    
+    ExpressionParser(const std::string& source, MapExpression& expression)
+        : m_source(source), m_expression(expression) {}
+    
+    bool parse() {
+        advance();
+    
+        // Optional "target =" prefix
+        if (m_token.kind == Token::Name || m_token.kind == Token::Quoted) {
+            size_t restart = m_token.position;
+            std::string name = m_token.text;
+            advance();
+            if (isSymbol("=")) {
+                m_expression.m_target = name;
+                advance();
+            } else {
+                m_position = restart;
+                advance();
+            }
+        }
+    
+        if (!parseComparison()) {
+            return false;
+        }
+        if (m_token.kind != Token::End) {
+            return fail("Unexpected '" + m_token.text + "'");
+        }
+        return true;
+    }
+
+private:
+    struct Token {
+        enum Kind { End, Number, Name, Quoted, Symbol, Invalid } kind{End};
+        std::string text;
+        double number{0.0};
+        size_t position{0};
+    };
+    
+    struct Function {
+        const char* name;
+        Op op;
+        int arity;
+    };
+    
+    static constexpr Function Functions[] = {
+        {"abs", Op::Abs, 1}, {"sqrt", Op::Sqrt, 1}, {"exp", Op::Exp, 1}, {"log", Op::Log, 1},
+        {"floor", Op::Floor, 1}, {"ceil", Op::Ceil, 1}, {"round", Op::Round, 1},
+        {"min", Op::Min, 2}, {"max", Op::Max, 2}, {"pow", Op::Power, 2},
+        {"clamp", Op::Clamp, 3}, {"if", Op::Select, 3}
+    };
+    
+    void advance() {
+        while (m_position < m_source.size() && std::isspace(static_cast<unsigned char>(m_source[m_position]))) {
+            ++m_position;
+        }
+    
+        m_token = Token();
+        m_token.position = m_position;
+        if (m_position >= m_source.size()) {
+            m_token.kind = Token::End;
+            m_token.text = "end of formula";
+            return;
+        }
+    
+        char c = m_source[m_position];
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            // digits [. digits] [e [+-] digits], independent of the C locale
+            size_t length = scanNumber(m_position);
+            const char* begin = m_source.data() + m_position;
+            auto result = std::from_chars(begin, begin + length, m_token.number);
+            bool valid = length > 0 && result.ec == std::errc() && result.ptr == begin + length;
+            m_token.kind = valid ? Token::Number : Token::Invalid;
+            length = std::max<size_t>(length, 1);
+            m_token.text = m_source.substr(m_position, length);
+            m_position += length;
+        } else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            size_t start = m_position;
+            while (m_position < m_source.size() &&
+                   (std::isalnum(static_cast<unsigned char>(m_source[m_position])) || m_source[m_position] == '_')) {
+                ++m_position;
+            }
+            m_token.kind = Token::Name;
+            m_token.text = m_source.substr(start, m_position - start);
+        } else if (c == '"') {
+            size_t close = m_source.find('"', m_position + 1);
+            if (close == std::string::npos) {
+                m_token.kind = Token::Invalid;
+                m_token.text = "\"";
+                m_position = m_source.size();
+                return;
+            }
+            m_token.kind = Token::Quoted;
+            m_token.text = m_source.substr(m_position + 1, close - m_position - 1);
+            m_position = close + 1;
+        } else {
+            static const char* twoChar[] = {"<=", ">=", "==", "!="};
+            m_token.kind = Token::Symbol;
+            m_token.text = std::string(1, c);
+            for (const char* symbol : twoChar) {
+                if (m_source.compare(m_position, 2, symbol) == 0) {
+                    m_token.text = symbol;
+                    break;
+                }
+            }
+            if (m_token.text.size() == 1 && std::string("+-*/^(),=<>").find(c) == std::string::npos) {
+                m_token.kind = Token::Invalid;
+            }
+            m_position += m_token.text.size();
+        }
+    }
+    
+    // Length of the number starting at start; 0 if there is no digit
+    size_t scanNumber(size_t start) const {
+        auto isDigit = [this](size_t i) {
+            return i < m_source.size() && std::isdigit(static_cast<unsigned char>(m_source[i]));
+        };
+        size_t i = start;
+        size_t digits = 0;
+        for (; isDigit(i); ++i, ++digits) {}
+        if (i < m_source.size() && m_source[i] == '.') {
+            for (++i; isDigit(i); ++i, ++digits) {}
+        }
+        if (digits == 0) {
+            return 0;
+        }
+        if (i < m_source.size() && (m_source[i] == 'e' || m_source[i] == 'E')) {
+            size_t exponent = i + 1;
+            if (exponent < m_source.size() && (m_source[exponent] == '+' || m_source[exponent] == '-')) {
+                ++exponent;
+            }
+            if (isDigit(exponent)) {
+                for (i = exponent; isDigit(i); ++i) {}
+            }
+        }
+        return i - start;
+    }
+    
+    bool isSymbol(const char* symbol) const {
+        return m_token.kind == Token::Symbol && m_token.text == symbol;
+    }
+    
+    bool fail(const std::string& message) {
+        m_expression.m_error = message + " at position " + std::to_string(m_token.position + 1);
+        return false;
+    }
+    
+    // stackEffect is the net change in stack slots
+    void emit(Op op, int stackEffect, uint32_t operand = 0) {
+        m_expression.m_code.push_back({op, operand});
+        m_depth += stackEffect;
+        m_expression.m_stackDepth = std::max(m_expression.m_stackDepth, static_cast<size_t>(m_depth));
+    }
+    
+    bool parseComparison() {
+        if (!parseAdditive()) {
+            return false;
+        }
+    
+        static const std::pair<const char*, Op> comparisons[] = {
+            {"<", Op::Less}, {"<=", Op::LessEqual}, {">", Op::Greater},
+            {">=", Op::GreaterEqual}, {"==", Op::Equal}, {"!=", Op::NotEqual}
+        };
+        for (;;) {
+            const Op* op = nullptr;
+            for (const auto& comparison : comparisons) {
+                if (isSymbol(comparison.first)) {
+                    op = &comparison.second;
+                }
+            }
+            if (!op) {
+                return true;
+            }
+            Op matched = *op;
+            advance();
+            if (!parseAdditive()) {
+                return false;
+            }
+            emit(matched, -1);
+        }
+    }
+    
+    bool parseAdditive() {
+        if (!parseMultiplicative()) {
+            return false;
+        }
+        while (isSymbol("+") || isSymbol("-")) {
+            Op op = isSymbol("+") ? Op::Add : Op::Subtract;
+            advance();
+            if (!parseMultiplicative()) {
+                return false;
+            }
+            emit(op, -1);
+        }
+        return true;
+    }
+    
+    bool parseMultiplicative() {
+        if (!parseUnary()) {
+            return false;
+        }
+        while (isSymbol("*") || isSymbol("/")) {
+            Op op = isSymbol("*") ? Op::Multiply : Op::Divide;
+            advance();
+            if (!parseUnary()) {
+                return false;
+            }
+            emit(op, -1);
+        }
+        return true;
+    }
+    
+    bool parseUnary() {
+        if (isSymbol("-")) {
+            advance();
+            if (!parseUnary()) {
+                return false;
+            }
+            emit(Op::Negate, 0);
+            return true;
+        }
+        if (isSymbol("+")) {
+            advance();
+            return parseUnary();
+        }
+        return parsePower();
+    }
+    
+    bool parsePower() {
+        if (!parsePrimary()) {
+            return false;
+        }
+        if (isSymbol("^")) {
+            advance();
+            if (!parseUnary()) {
+                return false;
+            }
+            emit(Op::Power, -1);
+        }
+        return true;
+    }
+    
+    bool parsePrimary() {
+        if (m_token.kind == Token::Number) {
+            m_expression.m_constants.push_back(m_token.number);
+            emit(Op::Constant, 1, static_cast<uint32_t>(m_expression.m_constants.size() - 1));
+            advance();
+            return true;
+        }
+    
+        if (isSymbol("(")) {
+            advance();
+            if (!parseComparison()) {
+                return false;
+            }
+            if (!isSymbol(")")) {
+                return fail("Expected ')'");
+            }
+            advance();
+            return true;
+        }
+    
+        if (m_token.kind == Token::Quoted) {
+            emitReference(m_token.text);
+            advance();
+            return true;
+        }
+    
+        if (m_token.kind != Token::Name) {
+            return fail(m_token.kind == Token::End ? "Unexpected end of formula" : "Unexpected '" + m_token.text + "'");
+        }
+    
+        std::string name = m_token.text;
+        advance();
+    
+        if (isSymbol("(")) {
+            return parseCall(name);
+        }
+    
+        if (name == "x") {
+            m_expression.m_usesX = true;
+            emit(Op::AxisX, 1);
+        } else if (name == "y") {
+            m_expression.m_usesY = true;
+            emit(Op::AxisY, 1);
+        } else if (name == "row") {
+            emit(Op::Row, 1);
+        } else if (name == "col") {
+            emit(Op::Column, 1);
+        } else {
+            emitReference(name);
+        }
+        return true;
+    }
+    
+    bool parseCall(const std::string& name) {
+        const Function* function = nullptr;
+        for (const Function& candidate : Functions) {
+            if (name == candidate.name) {
+                function = &candidate;
+            }
+        }
+        if (!function) {
+            return fail("Unknown function '" + name + "'");
+        }
+    
+        advance(); // '('
+        int arguments = 0;
+        if (!isSymbol(")")) {
+            for (;;) {
+                if (!parseComparison()) {
+                    return false;
+                }
+                ++arguments;
+                if (!isSymbol(",")) {
+                    break;
+                }
+                advance();
+            }
+        }
+        if (!isSymbol(")")) {
+            return fail("Expected ')'");
+        }
+        if (arguments != function->arity) {
+            return fail("'" + name + "' takes " + std::to_string(function->arity) + " argument(s)");
+        }
+        advance();
+    
+        emit(function->op, 1 - arguments);
+        return true;
+    }
+    
+    void emitReference(const std::string& name) {
+        auto& references = m_expression.m_references;
+        auto it = std::find(references.begin(), references.end(), name);
+        if (it == references.end()) {
+            references.push_back(name);
+            it = std::prev(references.end());
+        }
+        emit(Op::Input, 1, static_cast<uint32_t>(it - references.begin()));
+    }
+    
+    const std::string& m_source;
+    MapExpression& m_expression;
+    size_t m_position{0};
+    Token m_token;
+    int m_depth{0};
+};
+
+bool MapExpression::compile(const std::string& source) {
+    *this = MapExpression();
+    
+    ExpressionParser parser(source, *this);
+    if (!parser.parse()) {
+        std::string error = m_error;
+        *this = MapExpression();
+        m_error = error;
+        return false;
+    }
+    return true;
+}
+
+namespace {
+
+template<typename Func>
+void unary(double* a, size_t n, Func func) {
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = func(a[i]);
+    }
+}
+
+template<typename Func>
+void binary(double* a, const double* b, size_t n, Func func) {
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = func(a[i], b[i]);
+    }
+}
+
+const MapDefinition* findMap(const Project& project, const std::string& name) {
+    for (const MapDefinition& map : project.maps()) {
+        if (map.name() == name) {
+            return &map;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+bool MapExpression::evaluate(const Inputs& inputs, std::span<double> out) const {
+    size_t count = inputs.rows * inputs.columns;
+    if (!isCompiled() || out.size() < count || inputs.maps.size() < m_references.size()) {
+        return false;
+    }
+    for (const auto& map : inputs.maps) {
+        if (map.size() < count) {
+            return false;
+        }
+    }
+    if ((!inputs.xAxis.empty() && inputs.xAxis.size() < inputs.columns) ||
+        (!inputs.yAxis.empty() && inputs.yAxis.size() < inputs.rows)) {
+        return false;
+    }
+    
+    // One BlockSize slot per stack level; each instruction is a single loop over the block
+    std::vector<double> stack(m_stackDepth * BlockSize);
+    
+    for (size_t begin = 0; begin < count; begin += BlockSize) {
+        size_t n = std::min(BlockSize, count - begin);
+        size_t top = 0;
+        auto slot = [&](size_t index) { return stack.data() + index * BlockSize; };
+    
+        for (const Instruction& instruction : m_code) {
+            switch (instruction.op) {
+            case Op::Constant:
+                std::fill_n(slot(top++), n, m_constants[instruction.operand]);
+                break;
+            case Op::Input:
+                std::copy_n(inputs.maps[instruction.operand].data() + begin, n, slot(top++));
+                break;
+            case Op::AxisX:
+            case Op::Column: {
+                double* d = slot(top++);
+                bool useAxis = instruction.op == Op::AxisX && !inputs.xAxis.empty();
+                for (size_t i = 0; i < n; ++i) {
+                    size_t column = (begin + i) % inputs.columns;
+                    d[i] = useAxis ? inputs.xAxis[column] : static_cast<double>(column);
+                }
+                break;
+            }
+            case Op::AxisY:
+            case Op::Row: {
+                double* d = slot(top++);
+                bool useAxis = instruction.op == Op::AxisY && !inputs.yAxis.empty();
+                for (size_t i = 0; i < n; ++i) {
+                    size_t row = (begin + i) / inputs.columns;
+                    d[i] = useAxis ? inputs.yAxis[row] : static_cast<double>(row);
+                }
+                break;
+            }
+            case Op::Negate: unary(slot(top - 1), n, [](double a) { return -a; }); break;
+            case Op::Abs: unary(slot(top - 1), n, [](double a) { return std::abs(a); }); break;
+            case Op::Sqrt: unary(slot(top - 1), n, [](double a) { return std::sqrt(a); }); break;
+            case Op::Exp: unary(slot(top - 1), n, [](double a) { return std::exp(a); }); break;
+            case Op::Log: unary(slot(top - 1), n, [](double a) { return std::log(a); }); break;
+            case Op::Floor: unary(slot(top - 1), n, [](double a) { return std::floor(a); }); break;
+            case Op::Ceil: unary(slot(top - 1), n, [](double a) { return std::ceil(a); }); break;
+            case Op::Round: unary(slot(top - 1), n, [](double a) { return std::round(a); }); break;
+            case Op::Add: --top; binary(slot(top - 1), slot(top), n, [](double a, double b) { return a + b; }); break;
+            case Op::Subtract: --top; binary(slot(top - 1), slot(top), n, [](double a, double b) { return a - b; }); break;
+            case Op::Multiply: --top; binary(slot(top - 1), slot(top), n, [](double a, double b) { return a * b; }); break;
+            case Op::Divide: --top; binary(slot(top - 1), slot(top), n, [](double a, double b) { return a / b; }); break;
+            case Op::Power: --top; binary(slot(top - 1), slot(top), n, [](double a, double b) { return std::pow(a, b); }); break;
+            case Op::Min: --top; binary(slot(top - 1), slot(top), n, [](double a, double b) { return std::min(a, b); }); break;
+            case Op::Max: --top; binary(slot(top - 1), slot(top), n, [](double a, double b) { return std::max(a, b); }); break;
+            case Op::Less: --top; binary(slot(top - 1), slot(top), n, [](double a, double b) { return a < b ? 1.0 : 0.0; }); break;
+            case Op::LessEqual: --top; binary(slot(top - 1), slot(top), n, [](double a, double b) { return a <= b ? 1.0 : 0.0; }); break;
+            case Op::Greater: --top; binary(slot(top - 1), slot(top), n, [](double a, double b) { return a > b ? 1.0 : 0.0; }); break;
+            case Op::GreaterEqual: --top; binary(slot(top - 1), slot(top), n, [](double a, double b) { return a >= b ? 1.0 : 0.0; }); break;
+            case Op::Equal: --top; binary(slot(top - 1), slot(top), n, [](double a, double b) { return a == b ? 1.0 : 0.0; }); break;
+            case Op::NotEqual: --top; binary(slot(top - 1), slot(top), n, [](double a, double b) { return a != b ? 1.0 : 0.0; }); break;
+            case Op::Clamp: {
+                top -= 2;
+                double* v = slot(top - 1);
+                const double* lo = slot(top);
+                const double* hi = slot(top + 1);
+                for (size_t i = 0; i < n; ++i) {
+                    v[i] = std::min(std::max(v[i], lo[i]), hi[i]);
+                }
+                break;
+            }
+            case Op::Select: {
+                top -= 2;
+                double* c = slot(top - 1);
+                const double* a = slot(top);
+                const double* b = slot(top + 1);
+                for (size_t i = 0; i < n; ++i) {
+                    c[i] = c[i] != 0.0 ? a[i] : b[i];
+                }
+                break;
+            }
+            }
+        }
+    
+        std::copy_n(slot(0), n, out.data() + begin);
+    }
+    
+    return true;
+}
+
+bool MapExpression::apply(const Project& project, BinaryFile* file, const std::string& targetName,
+                          const Validator* validator) {
+    m_validation = ValidationFlags();
+    if (!isCompiled()) {
+        m_error = "Formula is not compiled";
+        return false;
+    }
+    
+    std::string name = targetName.empty() ? m_target : targetName;
+    const MapDefinition* target = findMap(project, name);
+    if (!target) {
+        m_error = name.empty() ? "Formula has no target map" : "Unknown map '" + name + "'";
+        return false;
+    }
+    
+    MapView targetView(*target, file);
+    std::vector<double> current;
+    if (!targetView.read(current)) {
+        m_error = "Map '" + name + "' lies outside the binary";
+        return false;
+    }
+    
+    // Decode every referenced map once, on the target grid
+    std::vector<std::vector<double>> values(m_references.size());
+    Inputs inputs;
+    inputs.rows = targetView.rows();
+    inputs.columns = targetView.columns();
+    for (size_t i = 0; i < m_references.size(); ++i) {
+        const MapDefinition* map = findMap(project, m_references[i]);
+        if (!map) {
+            m_error = "Unknown map '" + m_references[i] + "'";
+            return false;
+        }
+        // Maps on a different grid are interpolated onto the target's axes
+        if (!MapResampler::resample(*map, file, *target, file, values[i])) {
+            m_error = "Map '" + m_references[i] + "' lies outside the binary";
+            return false;
+        }
+        inputs.maps.push_back(values[i]);
+    }
+    
+    // Axes that are missing or do not match the grid fall back to indices
+    std::vector<double> xAxis, yAxis;
+    if (m_usesX && MapView::readAxis(target->xAxis(), file, xAxis) && xAxis.size() >= inputs.columns) {
+        inputs.xAxis = xAxis;
+    }
+    if (m_usesY && MapView::readAxis(target->yAxis(), file, yAxis) && yAxis.size() >= inputs.rows) {
+        inputs.yAxis = yAxis;
+    }
+    
+    std::vector<double> result(current.size());
+    if (!evaluate(inputs, result)) {
+        m_error = "Evaluation failed";
+        return false;
+    }
+    
+    for (size_t i = 0; i < result.size(); ++i) {
+        if (std::isnan(result[i])) {
+            result[i] = current[i];
+        }
+    }
+    
+    if (validator) {
+        m_validation = validator->validateBatch(current, result);
+        std::vector<size_t> flagged = m_validation.flaggedCells(1);
+        if (!flagged.empty()) {
+            // Only the first flagged cell is described
+            size_t cell = flagged[0];
+            auto warnings = validator->describe(target->address() + cell * targetView.elementSize(),
+                                                current[cell], result[cell], m_validation.at(cell));
+            m_error = std::to_string(m_validation.count()) + " cell(s) of '" + name + "' fail validation, e.g. (" +
+                      std::to_string(cell / inputs.columns + 1) + ", " + std::to_string(cell % inputs.columns + 1) +
+                      "): " + warnings[0].message;
+            return false;
+        }
+    }
+    
+    if (!targetView.write(result)) {
+        m_error = "Failed to write map '" + name + "'";
+        return false;
+    }
+    m_error.clear();
+    return true;
+}
+
+} // namespace WinMMM10
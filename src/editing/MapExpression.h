@@ -0,0 +1,86 @@
+#pragma once
+
+#include "../core/Project.h"
+#include "../binary/BinaryFile.h"
+#include "../validation/Validator.h"
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace WinMMM10 {
+
+// Compiled map formula, e.g. `out = a * 1.08 + clamp(b - 3, 0, 20)`.
+//
+// Identifiers (or "quoted names") refer to maps of the project; `x`, `y`,
+// `row` and `col` are the target cell's axis breakpoints and indices. Supported
+// operators are + - * / ^, comparisons (yielding 1 or 0) and the functions
+// abs, sqrt, exp, log, floor, ceil, round, min, max, pow, clamp and
+// if(cond, a, b). The formula compiles once to stack bytecode which is then
+// run over blocks of cells, one tight loop per instruction.
+class MapExpression {
+public:
+    MapExpression() = default;
+    
+    // False on a syntax error; see errorString()
+    bool compile(const std::string& source);
+    bool isCompiled() const { return !m_code.empty(); }
+    const std::string& errorString() const { return m_error; }
+    
+    // Map named on the left of '=', empty if the formula has no assignment
+    const std::string& target() const { return m_target; }
+    // Map names referenced by the formula, in input-slot order
+    const std::vector<std::string>& references() const { return m_references; }
+    
+    struct Inputs {
+        std::vector<std::span<const double>> maps; // One span per reference, row-major
+        std::span<const double> xAxis;             // Per column; empty means column index
+        std::span<const double> yAxis;             // Per row; empty means row index
+        size_t rows{0};
+        size_t columns{0};
+    };
+    
+    // Evaluates every cell into out (rows * columns values)
+    bool evaluate(const Inputs& inputs, std::span<double> out) const;
+    
+    // Resolves references against the project, resampling any on a different
+    // axis grid onto the target's, evaluates and writes the target map. Cells
+    // that evaluate to NaN (e.g. 0 / 0) keep their value. An empty targetName
+    // uses the formula's own target. With a validator, a result with any
+    // flagged cell is not written and validation() holds the flags.
+    bool apply(const Project& project, BinaryFile* file, const std::string& targetName = std::string(),
+               const Validator* validator = nullptr);
+    // Of the last apply() with a validator, one bit per target cell
+    const ValidationFlags& validation() const { return m_validation; }
+    
+    static constexpr size_t BlockSize = 256;
+
+private:
+    enum class Op : uint8_t {
+        Constant, Input, AxisX, AxisY, Row, Column,
+        Negate, Add, Subtract, Multiply, Divide, Power,
+        Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual,
+        Abs, Sqrt, Exp, Log, Floor, Ceil, Round,
+        Min, Max, Clamp, Select
+    };
+    
+    struct Instruction {
+        Op op;
+        uint32_t operand{0}; // Constant or input index
+    };
+    
+    friend class ExpressionParser;
+    
+    std::vector<Instruction> m_code;
+    std::vector<double> m_constants;
+    std::vector<std::string> m_references;
+    std::string m_target;
+    std::string m_error;
+    ValidationFlags m_validation;
+    size_t m_stackDepth{0};
+    bool m_usesX{false};
+    bool m_usesY{false};
+};
+
+} // namespace WinMMM10
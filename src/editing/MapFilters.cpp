@@ -0,0 +1,248 @@
+#include "MapFilters.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace WinMMM10 {
+
+namespace {
+
+bool validArguments(std::span<const double> values, size_t rows, size_t columns,
+                    int kernelSize, std::span<double> out) {
+    size_t count = rows * columns;
+    return count > 0 && kernelSize >= 3 && kernelSize % 2 == 1 &&
+           values.size() >= count && out.size() >= count;
+}
+
+// First and last index of the window around i, clipped to [0, n)
+inline size_t windowBegin(size_t i, size_t half) { return i > half ? i - half : 0; }
+inline size_t windowEnd(size_t i, size_t half, size_t n) { return std::min(i + half, n - 1); }
+
+std::vector<double> gaussianWeights(int kernelSize, double sigma) {
+    int half = kernelSize / 2;
+    std::vector<double> weights(kernelSize);
+    for (int k = -half; k <= half; ++k) {
+        weights[k + half] = std::exp(-(k * k) / (2.0 * sigma * sigma));
+    }
+    return weights;
+}
+
+} // namespace
+
+double MapFilters::defaultSigma(int kernelSize) {
+    return 0.3 * ((kernelSize - 1) * 0.5 - 1.0) + 0.8;
+}
+
+bool MapFilters::box(std::span<const double> values, size_t rows, size_t columns,
+                     int kernelSize, std::span<double> out) {
+    if (!validArguments(values, rows, columns, kernelSize, out)) {
+        return false;
+    }
+    
+    size_t half = static_cast<size_t>(kernelSize / 2);
+    std::vector<double> tmp(rows * columns);
+    
+    // Horizontal: one running sum per row
+    for (size_t r = 0; r < rows; ++r) {
+        const double* src = values.data() + r * columns;
+        double* dst = tmp.data() + r * columns;
+        double sum = 0.0;
+        for (size_t c = 0; c <= windowEnd(0, half, columns); ++c) {
+            sum += src[c];
+        }
+        for (size_t c = 0; c < columns; ++c) {
+            size_t count = windowEnd(c, half, columns) - windowBegin(c, half) + 1;
+            dst[c] = sum / static_cast<double>(count);
+            if (c + half + 1 < columns) {
+                sum += src[c + half + 1];
+            }
+            if (c >= half) {
+                sum -= src[c - half];
+            }
+        }
+    }
+    
+    // Vertical: running sums for all columns at once, so the inner loop is contiguous
+    std::vector<double> sums(columns, 0.0);
+    for (size_t r = 0; r <= windowEnd(0, half, rows); ++r) {
+        const double* src = tmp.data() + r * columns;
+        for (size_t c = 0; c < columns; ++c) {
+            sums[c] += src[c];
+        }
+    }
+    for (size_t r = 0; r < rows; ++r) {
+        double scale = 1.0 / static_cast<double>(windowEnd(r, half, rows) - windowBegin(r, half) + 1);
+        double* dst = out.data() + r * columns;
+        for (size_t c = 0; c < columns; ++c) {
+            dst[c] = sums[c] * scale;
+        }
+        if (r + half + 1 < rows) {
+            const double* incoming = tmp.data() + (r + half + 1) * columns;
+            for (size_t c = 0; c < columns; ++c) {
+                sums[c] += incoming[c];
+            }
+        }
+        if (r >= half) {
+            const double* outgoing = tmp.data() + (r - half) * columns;
+            for (size_t c = 0; c < columns; ++c) {
+                sums[c] -= outgoing[c];
+            }
+        }
+    }
+    return true;
+}
+
+bool MapFilters::gaussian(std::span<const double> values, size_t rows, size_t columns,
+                          int kernelSize, double sigma, std::span<double> out) {
+    if (!validArguments(values, rows, columns, kernelSize, out)) {
+        return false;
+    }
+    if (sigma <= 0.0) {
+        sigma = defaultSigma(kernelSize);
+    }
+    
+    size_t half = static_cast<size_t>(kernelSize / 2);
+    std::vector<double> weights = gaussianWeights(kernelSize, sigma);
+    const double* center = weights.data() + half;
+    std::vector<double> tmp(rows * columns);
+    
+    // Horizontal, weights renormalised over the taps inside the map
+    for (size_t r = 0; r < rows; ++r) {
+        const double* src = values.data() + r * columns;
+        double* dst = tmp.data() + r * columns;
+        for (size_t c = 0; c < columns; ++c) {
+            size_t begin = windowBegin(c, half);
+            size_t end = windowEnd(c, half, columns);
+            double sum = 0.0;
+            double norm = 0.0;
+            for (size_t j = begin; j <= end; ++j) {
+                double w = center[static_cast<std::ptrdiff_t>(j) - static_cast<std::ptrdiff_t>(c)];
+                sum += w * src[j];
+                norm += w;
+            }
+            dst[c] = sum / norm;
+        }
+    }
+    
+    // Vertical, accumulating whole rows so the inner loop is contiguous
+    for (size_t r = 0; r < rows; ++r) {
+        size_t begin = windowBegin(r, half);
+        size_t end = windowEnd(r, half, rows);
+        double* dst = out.data() + r * columns;
+        std::fill_n(dst, columns, 0.0);
+        double norm = 0.0;
+        for (size_t k = begin; k <= end; ++k) {
+            double w = center[static_cast<std::ptrdiff_t>(k) - static_cast<std::ptrdiff_t>(r)];
+            const double* src = tmp.data() + k * columns;
+            for (size_t c = 0; c < columns; ++c) {
+                dst[c] += w * src[c];
+            }
+            norm += w;
+        }
+        double scale = 1.0 / norm;
+        for (size_t c = 0; c < columns; ++c) {
+            dst[c] *= scale;
+        }
+    }
+    return true;
+}
+
+bool MapFilters::bilateral(std::span<const double> values, size_t rows, size_t columns,
+                           int kernelSize, double spatialSigma, double rangeSigma,
+                           std::span<double> out) {
+    if (!validArguments(values, rows, columns, kernelSize, out)) {
+        return false;
+    }
+    if (spatialSigma <= 0.0) {
+        spatialSigma = defaultSigma(kernelSize);
+    }
+    if (rangeSigma <= 0.0) {
+        auto [minIt, maxIt] = std::minmax_element(values.begin(), values.begin() + rows * columns);
+        rangeSigma = (*maxIt - *minIt) * 0.1;
+        if (rangeSigma <= 0.0) {
+            // Flat map, nothing to smooth
+            std::copy_n(values.begin(), rows * columns, out.begin());
+            return true;
+        }
+    }
+    
+    size_t half = static_cast<size_t>(kernelSize / 2);
+    std::vector<double> spatial = gaussianWeights(kernelSize, spatialSigma);
+    double rangeScale = -1.0 / (2.0 * rangeSigma * rangeSigma);
+    
+    for (size_t r = 0; r < rows; ++r) {
+        size_t rowBegin = windowBegin(r, half);
+        size_t rowEnd = windowEnd(r, half, rows);
+        for (size_t c = 0; c < columns; ++c) {
+            size_t colBegin = windowBegin(c, half);
+            size_t colEnd = windowEnd(c, half, columns);
+            double centerValue = values[r * columns + c];
+            double sum = 0.0;
+            double norm = 0.0;
+            for (size_t k = rowBegin; k <= rowEnd; ++k) {
+                double wy = spatial[k + half - r];
+                const double* src = values.data() + k * columns;
+                for (size_t j = colBegin; j <= colEnd; ++j) {
+                    double d = src[j] - centerValue;
+                    double w = wy * spatial[j + half - c] * std::exp(d * d * rangeScale);
+                    sum += w * src[j];
+                    norm += w;
+                }
+            }
+            out[r * columns + c] = sum / norm;
+        }
+    }
+    return true;
+}
+
+bool MapFilters::median(std::span<const double> values, size_t rows, size_t columns,
+                        int kernelSize, std::span<double> out) {
+    if (!validArguments(values, rows, columns, kernelSize, out)) {
+        return false;
+    }
+    
+    size_t half = static_cast<size_t>(kernelSize / 2);
+    std::vector<double> window;
+    window.reserve(static_cast<size_t>(kernelSize) * kernelSize);
+    
+    for (size_t r = 0; r < rows; ++r) {
+        size_t rowBegin = windowBegin(r, half);
+        size_t rowEnd = windowEnd(r, half, rows);
+        for (size_t c = 0; c < columns; ++c) {
+            size_t colBegin = windowBegin(c, half);
+            size_t colEnd = windowEnd(c, half, columns);
+            window.clear();
+            for (size_t k = rowBegin; k <= rowEnd; ++k) {
+                const double* src = values.data() + k * columns;
+                window.insert(window.end(), src + colBegin, src + colEnd + 1);
+            }
+            
+            // Clipped windows at the edges can be even-sized; average the two middle values
+            size_t mid = window.size() / 2;
+            std::nth_element(window.begin(), window.begin() + mid, window.end());
+            double result = window[mid];
+            if (window.size() % 2 == 0) {
+                result = 0.5 * (result + *std::max_element(window.begin(), window.begin() + mid));
+            }
+            out[r * columns + c] = result;
+        }
+    }
+    return true;
+}
+
+bool MapFilters::apply(Type type, std::span<const double> values, size_t rows, size_t columns,
+                       int kernelSize, std::span<double> out) {
+    switch (type) {
+        case Type::Box:
+            return box(values, rows, columns, kernelSize, out);
+        case Type::Gaussian:
+            return gaussian(values, rows, columns, kernelSize, 0.0, out);
+        case Type::Bilateral:
+            return bilateral(values, rows, columns, kernelSize, 0.0, 0.0, out);
+        case Type::Median:
+            return median(values, rows, columns, kernelSize, out);
+    }
+    return false;
+}
+
+} // namespace WinMMM10
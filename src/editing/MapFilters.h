@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+namespace WinMMM10 {
+
+// Smoothing filters on a decoded row-major map (rows x columns values).
+// Windows are square with an odd kernelSize and shrink at the map edges, so
+// border cells average over the neighbours they actually have. Every filter
+// reads from values and writes to out; both must hold rows * columns values
+// and must not overlap.
+class MapFilters {
+public:
+    enum class Type {
+        Box,
+        Gaussian,
+        Bilateral, // Edge-preserving: neighbours with very different values count less
+        Median     // Edge-preserving: removes single-cell spikes
+    };
+    
+    // Separable mean, O(1) per cell via running sums
+    static bool box(std::span<const double> values, size_t rows, size_t columns,
+                    int kernelSize, std::span<double> out);
+    
+    // Separable Gaussian, O(k) per cell. sigma <= 0 derives it from kernelSize.
+    static bool gaussian(std::span<const double> values, size_t rows, size_t columns,
+                         int kernelSize, double sigma, std::span<double> out);
+    
+    // Spatial Gaussian weighted by value similarity. rangeSigma is in physical
+    // units; <= 0 uses a tenth of the map's value range.
+    static bool bilateral(std::span<const double> values, size_t rows, size_t columns,
+                          int kernelSize, double spatialSigma, double rangeSigma,
+                          std::span<double> out);
+    
+    static bool median(std::span<const double> values, size_t rows, size_t columns,
+                       int kernelSize, std::span<double> out);
+    
+    // Dispatches to the filter above with default sigmas
+    static bool apply(Type type, std::span<const double> values, size_t rows, size_t columns,
+                      int kernelSize, std::span<double> out);
+    
+    static double defaultSigma(int kernelSize);
+};
+
+} // namespace WinMMM10
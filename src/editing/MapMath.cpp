@@ -1,4 +1,7 @@
 #include "MapMath.h"
+#include "MapExpression.h"
+#include "../maps/MapView.h"
+#include "../maps/MapResampler.h"
 #include <algorithm>
 #include <cmath>
 
@@ -9,163 +12,74 @@ MapMath::MapMath(BinaryFile* file)
 {
 }
 
-double MapMath::readMapValue(const MapDefinition& map, size_t row, size_t col) const {
-    if (!m_binaryFile || !m_binaryFile->isLoaded()) {
-        return 0.0;
-    }
-    
-    size_t address = map.address();
-    size_t index = row * map.columns() + col;
-    
-    switch (map.dataType()) {
-        case 1: // uint8
-            address += index;
-            if (address < m_binaryFile->size()) {
-                uint8_t value = m_binaryFile->readUInt8(address);
-                return static_cast<double>(value) * map.factor() + map.offset();
-            }
-            break;
-        case 2: // uint16
-            address += index * 2;
-            if (address + 1 < m_binaryFile->size()) {
-                uint16_t value = m_binaryFile->readUInt16(address);
-                return static_cast<double>(value) * map.factor() + map.offset();
-            }
-            break;
-        case 3: // int16
-            address += index * 2;
-            if (address + 1 < m_binaryFile->size()) {
-                int16_t value = static_cast<int16_t>(m_binaryFile->readUInt16(address));
-                return static_cast<double>(value) * map.factor() + map.offset();
-            }
-            break;
-        case 4: // float
-            address += index * 4;
-            if (address + 3 < m_binaryFile->size()) {
-                return m_binaryFile->readFloat(address) * map.factor() + map.offset();
-            }
-            break;
-    }
-    
-    return 0.0;
-}
-
-void MapMath::writeMapValue(const MapDefinition& map, size_t row, size_t col, double value) {
-    if (!m_binaryFile || !m_binaryFile->isLoaded()) {
-        return;
-    }
-    
-    double rawValue = (value - map.offset()) / map.factor();
-    
-    size_t address = map.address();
-    size_t index = row * map.columns() + col;
-    
-    switch (map.dataType()) {
-        case 1: // uint8
-            address += index;
-            if (address < m_binaryFile->size()) {
-                m_binaryFile->writeUInt8(address, static_cast<uint8_t>(std::round(rawValue)));
-            }
-            break;
-        case 2: // uint16
-            address += index * 2;
-            if (address + 1 < m_binaryFile->size()) {
-                m_binaryFile->writeUInt16(address, static_cast<uint16_t>(std::round(rawValue)));
-            }
-            break;
-        case 3: // int16
-            address += index * 2;
-            if (address + 1 < m_binaryFile->size()) {
-                m_binaryFile->writeInt16(address, static_cast<int16_t>(std::round(rawValue)));
-            }
-            break;
-        case 4: // float
-            address += index * 4;
-            if (address + 3 < m_binaryFile->size()) {
-                m_binaryFile->writeFloat(address, static_cast<float>(rawValue));
-            }
-            break;
-    }
+bool MapMath::readOnGrid(const MapDefinition& map, const MapDefinition& grid, std::vector<double>& values) const {
+    return MapResampler::resample(map, m_binaryFile, grid, m_binaryFile, values);
 }
 
 bool MapMath::addMaps(const MapDefinition& map1, const MapDefinition& map2, const MapDefinition& resultMap) {
-    if (map1.rows() != map2.rows() || map1.columns() != map2.columns() ||
-        map1.rows() != resultMap.rows() || map1.columns() != resultMap.columns()) {
+    std::vector<double> values1, values2;
+    if (!readOnGrid(map1, resultMap, values1) || !readOnGrid(map2, resultMap, values2)) {
         return false;
     }
     
-    for (size_t r = 0; r < map1.rows(); ++r) {
-        for (size_t c = 0; c < map1.columns(); ++c) {
-            double val1 = readMapValue(map1, r, c);
-            double val2 = readMapValue(map2, r, c);
-            writeMapValue(resultMap, r, c, val1 + val2);
-        }
+    for (size_t i = 0; i < values1.size(); ++i) {
+        values1[i] += values2[i];
     }
-    
-    return true;
+    return MapView(resultMap, m_binaryFile).write(values1);
 }
 
 bool MapMath::subtractMaps(const MapDefinition& map1, const MapDefinition& map2, const MapDefinition& resultMap) {
-    if (map1.rows() != map2.rows() || map1.columns() != map2.columns() ||
-        map1.rows() != resultMap.rows() || map1.columns() != resultMap.columns()) {
+    std::vector<double> values1, values2;
+    if (!readOnGrid(map1, resultMap, values1) || !readOnGrid(map2, resultMap, values2)) {
         return false;
     }
     
-    for (size_t r = 0; r < map1.rows(); ++r) {
-        for (size_t c = 0; c < map1.columns(); ++c) {
-            double val1 = readMapValue(map1, r, c);
-            double val2 = readMapValue(map2, r, c);
-            writeMapValue(resultMap, r, c, val1 - val2);
-        }
+    for (size_t i = 0; i < values1.size(); ++i) {
+        values1[i] -= values2[i];
     }
-    
-    return true;
+    return MapView(resultMap, m_binaryFile).write(values1);
 }
 
 bool MapMath::multiplyMaps(const MapDefinition& map1, const MapDefinition& map2, const MapDefinition& resultMap) {
-    if (map1.rows() != map2.rows() || map1.columns() != map2.columns() ||
-        map1.rows() != resultMap.rows() || map1.columns() != resultMap.columns()) {
+    std::vector<double> values1, values2;
+    if (!readOnGrid(map1, resultMap, values1) || !readOnGrid(map2, resultMap, values2)) {
         return false;
     }
     
-    for (size_t r = 0; r < map1.rows(); ++r) {
-        for (size_t c = 0; c < map1.columns(); ++c) {
-            double val1 = readMapValue(map1, r, c);
-            double val2 = readMapValue(map2, r, c);
-            writeMapValue(resultMap, r, c, val1 * val2);
-        }
+    for (size_t i = 0; i < values1.size(); ++i) {
+        values1[i] *= values2[i];
     }
-    
-    return true;
+    return MapView(resultMap, m_binaryFile).write(values1);
 }
 
 bool MapMath::divideMaps(const MapDefinition& map1, const MapDefinition& map2, const MapDefinition& resultMap) {
-    if (map1.rows() != map2.rows() || map1.columns() != map2.columns() ||
-        map1.rows() != resultMap.rows() || map1.columns() != resultMap.columns()) {
+    // Cells with a zero divisor keep their current result value
+    std::vector<double> values1, values2, result;
+    MapView resultView(resultMap, m_binaryFile);
+    if (!readOnGrid(map1, resultMap, values1) || !readOnGrid(map2, resultMap, values2) ||
+        !resultView.read(result)) {
         return false;
     }
     
-    for (size_t r = 0; r < map1.rows(); ++r) {
-        for (size_t c = 0; c < map1.columns(); ++c) {
-            double val1 = readMapValue(map1, r, c);
-            double val2 = readMapValue(map2, r, c);
-            if (std::abs(val2) > 0.0001) {
-                writeMapValue(resultMap, r, c, val1 / val2);
-            }
+    for (size_t i = 0; i < values1.size(); ++i) {
+        if (std::abs(values2[i]) > 0.0001) {
+            result[i] = values1[i] / values2[i];
         }
     }
-    
-    return true;
+    return resultView.write(result);
 }
 
 bool MapMath::addScalar(const MapDefinition& map, double scalar) {
-    for (size_t r = 0; r < map.rows(); ++r) {
-        for (size_t c = 0; c < map.columns(); ++c) {
-            double val = readMapValue(map, r, c);
-            writeMapValue(map, r, c, val + scalar);
-        }
+    MapView view(map, m_binaryFile);
+    std::vector<double> values;
+    if (!view.read(values)) {
+        return false;
     }
-    return true;
+    
+    for (double& value : values) {
+        value += scalar;
+    }
+    return view.write(values);
 }
 
 bool MapMath::subtractScalar(const MapDefinition& map, double scalar) {
@@ -173,13 +87,16 @@ bool MapMath::subtractScalar(const MapDefinition& map, double scalar) {
 }
 
 bool MapMath::multiplyScalar(const MapDefinition& map, double scalar) {
-    for (size_t r = 0; r < map.rows(); ++r) {
-        for (size_t c = 0; c < map.columns(); ++c) {
-            double val = readMapValue(map, r, c);
-            writeMapValue(map, r, c, val * scalar);
-        }
+    MapView view(map, m_binaryFile);
+    std::vector<double> values;
+    if (!view.read(values)) {
+        return false;
     }
-    return true;
+    
+    for (double& value : values) {
+        value *= scalar;
+    }
+    return view.write(values);
 }
 
 bool MapMath::divideScalar(const MapDefinition& map, double scalar) {
@@ -190,14 +107,28 @@ bool MapMath::divideScalar(const MapDefinition& map, double scalar) {
 }
 
 bool MapMath::applyFunction(const MapDefinition& map, std::function<double(double)> func) {
-    for (size_t r = 0; r < map.rows(); ++r) {
-        for (size_t c = 0; c < map.columns(); ++c) {
-            double val = readMapValue(map, r, c);
-            writeMapValue(map, r, c, func(val));
-        }
+    MapView view(map, m_binaryFile);
+    std::vector<double> values;
+    if (!view.read(values)) {
+        return false;
+    }
+    
+    for (double& value : values) {
+        value = func(value);
+    }
+    return view.write(values);
+}
+
+bool MapMath::applyFormula(const Project& project, const std::string& formula, std::string& error,
+                           const std::string& targetName, const Validator* validator) {
+    MapExpression expression;
+    bool applied = expression.compile(formula) && expression.apply(project, m_binaryFile, targetName, validator);
+    m_lastValidation = expression.validation();
+    if (!applied) {
+        error = expression.errorString();
+        return false;
     }
     return true;
 }
 
 } // namespace WinMMM10
-
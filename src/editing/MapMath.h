@@ -2,7 +2,11 @@
 
 #include "../maps/MapDefinition.h"
 #include "../binary/BinaryFile.h"
+#include "../core/Project.h"
+#include "../validation/Validator.h"
+#include <vector>
 #include <functional>
+#include <string>
 
 namespace WinMMM10 {
 
@@ -18,7 +22,8 @@ public:
         Divide
     };
     
-    // Map-to-map operations
+    // Map-to-map operations. Operands are interpolated onto the result map's
+    // axis grid, so maps with different breakpoints or sizes combine correctly.
     bool addMaps(const MapDefinition& map1, const MapDefinition& map2, const MapDefinition& resultMap);
     bool subtractMaps(const MapDefinition& map1, const MapDefinition& map2, const MapDefinition& resultMap);
     bool multiplyMaps(const MapDefinition& map1, const MapDefinition& map2, const MapDefinition& resultMap);
@@ -32,12 +37,20 @@ public:
     
     // Apply function to map
     bool applyFunction(const MapDefinition& map, std::function<double(double)> func);
+    
+    // Evaluate a formula over project maps, e.g. "out = a * 1.08 + clamp(b - 3, 0, 20)".
+    // See MapExpression for the syntax; error receives the reason on failure.
+    // With a validator nothing is written if any cell is flagged, and
+    // lastValidation() holds the flags.
+    bool applyFormula(const Project& project, const std::string& formula, std::string& error,
+                      const std::string& targetName = std::string(), const Validator* validator = nullptr);
+    const ValidationFlags& lastValidation() const { return m_lastValidation; }
 
 private:
-    double readMapValue(const MapDefinition& map, size_t row, size_t col) const;
-    void writeMapValue(const MapDefinition& map, size_t row, size_t col, double value);
+    bool readOnGrid(const MapDefinition& map, const MapDefinition& grid, std::vector<double>& values) const;
     
     BinaryFile* m_binaryFile;
+    ValidationFlags m_lastValidation;
 };
 
 } // namespace WinMMM10
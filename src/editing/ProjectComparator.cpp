@@ -0,0 +1,114 @@
+#include "ProjectComparator.h"
+#include "../maps/MapView.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+namespace WinMMM10 {
+
+MapComparisonSummary ProjectComparator::compareMap(const MapDefinition& map, const BinaryFile* original,
+                                                   const BinaryFile* modified, double tolerance) {
+    MapComparisonSummary summary;
+    summary.name = map.name();
+    
+    MapView originalView(map, original);
+    MapView modifiedView(map, modified);
+    if (!originalView.isValid() || !modifiedView.isValid()) {
+        return summary;
+    }
+    summary.compared = true;
+    summary.cellCount = originalView.size();
+    
+    // Identical bytes cannot differ after scaling
+    const uint8_t* originalBytes = original->at(map.address());
+    const uint8_t* modifiedBytes = modified->at(map.address());
+    if (std::memcmp(originalBytes, modifiedBytes, originalView.byteSize()) == 0) {
+        return summary;
+    }
+    
+    std::vector<double> before, after;
+    originalView.read(before);
+    modifiedView.read(after);
+    
+    summary.changedMask.assign((summary.cellCount + 63) / 64, 0);
+    double total = 0.0;
+    for (size_t i = 0; i < summary.cellCount; ++i) {
+        double delta = std::abs(after[i] - before[i]);
+        if (delta > tolerance) {
+            summary.changedMask[i / 64] |= uint64_t(1) << (i % 64);
+            ++summary.changedCells;
+            total += delta;
+            summary.maxDelta = std::max(summary.maxDelta, delta);
+        }
+    }
+    if (summary.changedCells > 0) {
+        summary.averageDelta = total / static_cast<double>(summary.changedCells);
+    } else {
+        summary.changedMask.clear(); // Byte changes below the tolerance
+    }
+    return summary;
+}
+
+ProjectComparator::Report ProjectComparator::compare(const Project& project, const BinaryFile* original,
+                                                     const BinaryFile* modified, double tolerance,
+                                                     size_t workerCount) {
+    Report report;
+    const auto& maps = project.maps();
+    report.maps.resize(maps.size());
+    if (maps.empty()) {
+        return report;
+    }
+    
+    if (workerCount == 0) {
+        unsigned int cores = std::thread::hardware_concurrency();
+        workerCount = cores > 0 ? cores : 1;
+    }
+    workerCount = std::min(workerCount, maps.size());
+    
+    // Both binaries are only read, so maps can be handed out freely
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < maps.size(); i = next++) {
+            report.maps[i] = compareMap(maps[i], original, modified, tolerance);
+            report.maps[i].mapIndex = i;
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < workerCount; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    for (const auto& summary : report.maps) {
+        report.comparedMaps += summary.compared ? 1 : 0;
+        report.changedMaps += summary.isChanged() ? 1 : 0;
+    }
+    return report;
+}
+
+void ProjectComparator::Report::sort(SortKey key, bool descending) {
+    auto value = [key](const MapComparisonSummary& summary) -> double {
+        switch (key) {
+            case SortKey::ChangedCells: return static_cast<double>(summary.changedCells);
+            case SortKey::PercentChanged: return summary.percentChanged();
+            case SortKey::MaxDelta: return summary.maxDelta;
+            case SortKey::AverageDelta: return summary.averageDelta;
+            default: return static_cast<double>(summary.mapIndex);
+        }
+    };
+    
+    // Ties keep project order
+    std::stable_sort(maps.begin(), maps.end(), [&](const MapComparisonSummary& a, const MapComparisonSummary& b) {
+        if (key == SortKey::Name) {
+            return descending ? b.name < a.name : a.name < b.name;
+        }
+        return descending ? value(b) < value(a) : value(a) < value(b);
+    });
+}
+
+} // namespace WinMMM10
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../core/Project.h"
+#include "../binary/BinaryFile.h"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace WinMMM10 {
+
+// Per-map outcome of a project comparison: summary statistics plus one bit
+// per cell, instead of a MapDifference record for every cell
+struct MapComparisonSummary {
+    size_t mapIndex{0};
+    std::string name;
+    bool compared{false}; // False if the map lies outside either binary
+    size_t cellCount{0};
+    size_t changedCells{0};
+    double maxDelta{0.0};     // Largest absolute difference
+    double averageDelta{0.0}; // Mean absolute difference over changed cells
+    std::vector<uint64_t> changedMask; // Row-major, bit set per changed cell
+    
+    bool isChanged() const { return changedCells > 0; }
+    bool isCellChanged(size_t cell) const {
+        return cell / 64 < changedMask.size() && (changedMask[cell / 64] >> (cell % 64)) & 1;
+    }
+    double percentChanged() const {
+        return cellCount > 0 ? 100.0 * static_cast<double>(changedCells) / static_cast<double>(cellCount) : 0.0;
+    }
+};
+
+// Compares every map of a project between two binaries that share its map
+// layout, e.g. a stock and a tuned image of the same ECU.
+class ProjectComparator {
+public:
+    enum class SortKey {
+        Index,
+        Name,
+        ChangedCells,
+        PercentChanged,
+        MaxDelta,
+        AverageDelta
+    };
+    
+    struct Report {
+        std::vector<MapComparisonSummary> maps;
+        size_t comparedMaps{0};
+        size_t changedMaps{0};
+        
+        void sort(SortKey key, bool descending = true);
+    };
+    
+    // Maps are compared in parallel. Maps whose stored bytes are identical in
+    // both binaries are skipped without decoding; the rest are decoded in bulk.
+    // workerCount 0 uses every core.
+    static Report compare(const Project& project, const BinaryFile* original, const BinaryFile* modified,
+                          double tolerance = 0.0001, size_t workerCount = 0);
+    
+    static MapComparisonSummary compareMap(const MapDefinition& map, const BinaryFile* original,
+                                           const BinaryFile* modified, double tolerance = 0.0001);
+};
+
+} // namespace WinMMM10
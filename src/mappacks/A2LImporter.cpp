@@ -0,0 +1,1212 @@
+#include "A2LImporter.h"
+#include "../binary/MemoryMapper.h"
+#include "../maps/MapDataType.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+namespace WinMMM10 {
+
+namespace {
+
+struct Token {
+    std::string_view text;
+    bool quoted{false};
+    
+    bool isDelimiter() const { return !quoted && (text == "/begin" || text == "/end"); }
+};
+
+bool startsWith(std::string_view text, std::string_view prefix) {
+    return text.substr(0, prefix.size()) == prefix;
+}
+
+bool parseUnsigned(std::string_view text, uint64_t& value) {
+    int base = 10;
+    if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        text.remove_prefix(2);
+        base = 16;
+    }
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value, base);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+bool parseNumber(std::string_view text, double& value) {
+    if (!text.empty() && text.front() == '+') {
+        text.remove_prefix(1);
+    }
+    bool negative = !text.empty() && text.front() == '-';
+    std::string_view magnitude = negative ? text.substr(1) : text;
+    if (magnitude.size() > 2 && magnitude[0] == '0' && (magnitude[1] == 'x' || magnitude[1] == 'X')) {
+        uint64_t integer = 0;
+        if (!parseUnsigned(magnitude, integer)) {
+            return false;
+        }
+        value = negative ? -static_cast<double>(integer) : static_cast<double>(integer);
+        return true;
+    }
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+enum AlignmentClass : uint8_t {
+    AlignByte,
+    AlignWord,
+    AlignLong,
+    AlignInt64,
+    AlignFloat16,
+    AlignFloat32,
+    AlignFloat64,
+    AlignmentClasses
+};
+
+// ASAP2 data type: MapDataType code (0 if the editor cannot show it), size
+// and alignment class. BYTE, WORD and LONG are the RESERVED sizes.
+struct ElementType {
+    uint16_t mapType{0};
+    uint8_t size{0};
+    uint8_t alignment{AlignByte};
+};
+
+constexpr uint16_t typeCode(MapDataType type) {
+    return static_cast<uint16_t>(type);
+}
+
+bool elementType(std::string_view name, ElementType& type) {
+    static constexpr struct {
+        std::string_view name;
+        ElementType type;
+    } Types[] = {
+        {"UBYTE", {typeCode(MapDataType::UInt8), 1, AlignByte}},
+        {"SBYTE", {typeCode(MapDataType::Int8), 1, AlignByte}},
+        {"UWORD", {typeCode(MapDataType::UInt16), 2, AlignWord}},
+        {"SWORD", {typeCode(MapDataType::Int16), 2, AlignWord}},
+        {"ULONG", {typeCode(MapDataType::UInt32), 4, AlignLong}},
+        {"SLONG", {typeCode(MapDataType::Int32), 4, AlignLong}},
+        {"A_UINT64", {0, 8, AlignInt64}},
+        {"A_INT64", {0, 8, AlignInt64}},
+        {"FLOAT16_IEEE", {0, 2, AlignFloat16}},
+        {"FLOAT32_IEEE", {typeCode(MapDataType::Float32), 4, AlignFloat32}},
+        {"FLOAT64_IEEE", {0, 8, AlignFloat64}},
+        {"BYTE", {0, 1, AlignByte}},
+        {"WORD", {0, 2, AlignWord}},
+        {"LONG", {0, 4, AlignLong}},
+    };
+    for (const auto& entry : Types) {
+        if (entry.name == name) {
+            type = entry.type;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Alignment class named by an ALIGNMENT_* keyword
+bool alignmentClass(std::string_view keyword, uint8_t& alignment) {
+    static constexpr std::string_view Names[AlignmentClasses] = {
+        "ALIGNMENT_BYTE", "ALIGNMENT_WORD", "ALIGNMENT_LONG", "ALIGNMENT_INT64",
+        "ALIGNMENT_FLOAT16_IEEE", "ALIGNMENT_FLOAT32_IEEE", "ALIGNMENT_FLOAT64_IEEE",
+    };
+    for (uint8_t i = 0; i < AlignmentClasses; ++i) {
+        if (Names[i] == keyword) {
+            alignment = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Axis index of a record layout keyword suffix (_X, _Y, _Z, _4, _5)
+uint8_t axisIndex(std::string_view keyword) {
+    switch (keyword.empty() ? 'X' : keyword.back()) {
+    case 'Y':
+        return 1;
+    case 'Z':
+        return 2;
+    case '4':
+        return 3;
+    case '5':
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+Endianness byteOrder(std::string_view order, Endianness fallback) {
+    if (startsWith(order, "MSB_FIRST") || order == "BIG_ENDIAN") {
+        return Endianness::Big;
+    }
+    if (startsWith(order, "MSB_LAST") || order == "LITTLE_ENDIAN") {
+        return Endianness::Little;
+    }
+    return fallback;
+}
+
+struct Conversion {
+    double factor{1.0};
+    double offset{0.0};
+    std::string_view unit;
+    bool linear{true};
+};
+
+struct LayoutItem {
+    enum Kind : uint8_t {
+        Values,
+        AxisPoints,
+        Other
+    };
+    
+    uint32_t position{0};
+    Kind kind{Other};
+    uint8_t axis{0};
+    bool columnDirection{false};
+    bool supported{true}; // Direct addressing, not ALTERNATE_*
+    ElementType type;
+    std::string_view typeName;
+    uint32_t count{1}; // Elements of an Other item
+};
+
+struct RecordLayout {
+    std::vector<LayoutItem> items; // Sorted by position once parsed
+    size_t fixedAxisPoints[2]{0, 0};
+    uint8_t alignment[AlignmentClasses]{}; // 0 = module alignment
+};
+
+struct AxisPointsRecord {
+    std::string_view inputQuantity;
+    std::string_view deposit;
+    std::string_view conversion;
+    std::string_view byteOrder;
+    std::string_view unit;
+    uint64_t address{0};
+    size_t maxPoints{0};
+};
+
+struct AxisDescription {
+    std::string_view attribute;
+    std::string_view inputQuantity;
+    std::string_view conversion;
+    std::string_view reference; // AXIS_PTS_REF
+    std::string_view byteOrder;
+    std::string_view unit;
+    size_t maxPoints{0};
+    size_t fixedPoints{0}; // FIX_AXIS_PAR*, 0 if not given
+};
+
+struct Characteristic {
+    std::string_view name;
+    std::string_view type;
+    std::string_view deposit;
+    std::string_view conversion;
+    std::string_view byteOrder;
+    std::string_view unit;
+    uint64_t address{0};
+    double lower{0.0};
+    double upper{0.0};
+    double extendedLower{0.0};
+    double extendedUpper{0.0};
+    bool extended{false};
+    size_t number{0};
+    size_t matrixDim[2]{0, 0};
+    AxisDescription axes[2];
+    uint8_t axisCount{0};
+};
+
+// Resolved axis of one characteristic. Inline breakpoints get their address
+// once the point counts of the whole record are known.
+struct ResolvedAxis {
+    MapAxis axis;
+    size_t count{0};
+    const LayoutItem* inlineItem{nullptr};
+};
+
+class Tokenizer {
+public:
+    explicit Tokenizer(std::string_view text)
+        : m_begin(text.data())
+        , m_pos(text.data())
+        , m_end(text.data() + text.size())
+    {
+        if (text.size() >= 3 && text.substr(0, 3) == "\xEF\xBB\xBF") {
+            m_pos += 3;
+        }
+    }
+    
+    // False at the end of the text or on a lexical error
+    bool next(Token& token) {
+        if (m_pushedBack) {
+            token = m_pending;
+            m_pushedBack = false;
+            return true;
+        }
+        return scan(token);
+    }
+    
+    void pushBack(const Token& token) {
+        m_pending = token;
+        m_pushedBack = true;
+    }
+    
+    const std::string& error() const { return m_error; }
+    
+    size_t line() const {
+        return static_cast<size_t>(std::count(m_begin, m_pos, '\n')) + 1;
+    }
+
+private:
+    static bool isSpace(char c) { return static_cast<unsigned char>(c) <= ' '; }
+    
+    bool scan(Token& token) {
+        while (true) {
+            while (m_pos < m_end && isSpace(*m_pos)) {
+                ++m_pos;
+            }
+            if (m_pos >= m_end) {
+                return false;
+            }
+            if (*m_pos != '/' || m_pos + 1 >= m_end || (m_pos[1] != '*' && m_pos[1] != '/')) {
+                break;
+            }
+            if (m_pos[1] == '/') {
+                const void* newline = std::memchr(m_pos, '\n', static_cast<size_t>(m_end - m_pos));
+                m_pos = newline ? static_cast<const char*>(newline) : m_end;
+                continue;
+            }
+            std::string_view rest(m_pos + 2, static_cast<size_t>(m_end - m_pos - 2));
+            size_t close = rest.find("*/");
+            if (close == std::string_view::npos) {
+                m_error = "Unterminated comment";
+                return false;
+            }
+            m_pos = rest.data() + close + 2;
+        }
+    
+        if (*m_pos == '"') {
+            // Quotes inside strings are escaped as \" or ""
+            const char* start = ++m_pos;
+            while (m_pos < m_end) {
+                if (*m_pos == '\\') {
+                    // A backslash ending the file escapes nothing
+                    m_pos += std::min<std::ptrdiff_t>(2, m_end - m_pos);
+                } else if (*m_pos != '"') {
+                    ++m_pos;
+                } else if (m_pos + 1 < m_end && m_pos[1] == '"') {
+                    m_pos += 2;
+                } else {
+                    break;
+                }
+            }
+            if (m_pos >= m_end) {
+                m_pos = start;
+                m_error = "Unterminated string";
+                return false;
+            }
+            token = {std::string_view(start, static_cast<size_t>(m_pos - start)), true};
+            ++m_pos;
+            return true;
+        }
+    
+        const char* start = m_pos;
+        while (m_pos < m_end && !isSpace(*m_pos) && *m_pos != '"' &&
+               !(*m_pos == '/' && m_pos + 1 < m_end && (m_pos[1] == '*' || m_pos[1] == '/') && m_pos != start)) {
+            ++m_pos;
+        }
+        token = {std::string_view(start, static_cast<size_t>(m_pos - start)), false};
+        return true;
+    }
+    
+    const char* m_begin;
+    const char* m_pos;
+    const char* m_end;
+    Token m_pending;
+    bool m_pushedBack{false};
+    std::string m_error;
+};
+
+class A2LParser {
+public:
+    A2LParser(std::string_view text, A2LImportStats& stats)
+        : m_tokens(text)
+        , m_stats(stats)
+    {
+    }
+    
+    bool parse(std::string& error);
+    void resolve(size_t baseAddress, std::vector<MapDefinition>& maps);
+    void fillInfo(MapPackInfo& info) const;
+
+private:
+    bool fail(const std::string& message);
+    void warn(std::string_view name, const std::string& message);
+    
+    bool next(Token& token);
+    bool argument(Token& token);
+    bool numberArgument(double& value);
+    bool countArgument(size_t& value);
+    bool fields(Token* out, size_t count, std::string_view block);
+    bool skipBlock(std::string_view block);
+    bool expectEnd(std::string_view block);
+    template<typename OnKeyword, typename OnBlock>
+    bool parseBody(std::string_view block, OnKeyword&& onKeyword, OnBlock&& onBlock);
+    
+    bool parseCharacteristic();
+    bool parseAxisDescription(AxisDescription& axis);
+    bool parseAxisPoints();
+    bool parseCompuMethod();
+    bool parseRecordLayout();
+    bool parseRecordLayoutItem(std::string_view keyword, RecordLayout& layout);
+    bool parseModCommon();
+    bool parseModPar();
+    
+    Conversion conversion(std::string_view name, std::string_view owner);
+    size_t itemOffset(const RecordLayout& layout, const LayoutItem* target, const size_t axisCounts[2],
+                      size_t valueCount) const;
+    bool resolveAxis(const Characteristic& characteristic, const AxisDescription& description,
+                     const RecordLayout& layout, uint8_t index, Endianness endianness, size_t baseAddress,
+                     ResolvedAxis& resolved, std::string& reason);
+    bool buildMap(const Characteristic& characteristic, size_t baseAddress, MapDefinition& map,
+                  std::string& reason);
+    
+    Tokenizer m_tokens;
+    A2LImportStats& m_stats;
+    std::string m_error;
+    
+    std::unordered_map<std::string_view, Conversion> m_conversions;
+    std::unordered_map<std::string_view, RecordLayout> m_layouts;
+    std::unordered_map<std::string_view, AxisPointsRecord> m_axisPoints;
+    std::vector<Characteristic> m_characteristics;
+    
+    std::string_view m_byteOrder;
+    uint8_t m_alignment[AlignmentClasses]{1, 2, 4, 8, 2, 4, 8};
+    std::string_view m_moduleName;
+    std::string_view m_moduleDescription;
+    std::string_view m_ecu;
+    std::string_view m_epk;
+};
+
+bool A2LParser::fail(const std::string& message) {
+    if (m_error.empty()) {
+        m_error = "Line " + std::to_string(m_tokens.line()) + ": " + message;
+    }
+    return false;
+}
+
+void A2LParser::warn(std::string_view name, const std::string& message) {
+    if (m_stats.warnings.size() < A2LImporter::MaxWarnings) {
+        m_stats.warnings.push_back(std::string(name) + ": " + message);
+    }
+}
+
+bool A2LParser::next(Token& token) {
+    if (m_tokens.next(token)) {
+        return true;
+    }
+    if (!m_tokens.error().empty()) {
+        fail(m_tokens.error());
+    }
+    return false;
+}
+
+// One argument of a keyword; running into /begin or /end means it is missing
+bool A2LParser::argument(Token& token) {
+    if (!next(token)) {
+        return fail("Unexpected end of file");
+    }
+    if (token.isDelimiter()) {
+        return fail("Missing argument before " + std::string(token.text));
+    }
+    return true;
+}
+
+bool A2LParser::numberArgument(double& value) {
+    Token token;
+    if (!argument(token)) {
+        return false;
+    }
+    if (!parseNumber(token.text, value)) {
+        return fail("'" + std::string(token.text) + "' is not a number");
+    }
+    return true;
+}
+
+bool A2LParser::countArgument(size_t& value) {
+    Token token;
+    uint64_t count = 0;
+    if (!argument(token)) {
+        return false;
+    }
+    if (!parseUnsigned(token.text, count)) {
+        return fail("'" + std::string(token.text) + "' is not a count");
+    }
+    value = static_cast<size_t>(count);
+    return true;
+}
+
+// The positional parameters that open a block
+bool A2LParser::fields(Token* out, size_t count, std::string_view block) {
+    for (size_t i = 0; i < count; ++i) {
+        if (!next(out[i])) {
+            return fail("Unexpected end of file in " + std::string(block));
+        }
+        if (out[i].isDelimiter()) {
+            return fail(std::string(block) + " has " + std::to_string(i) + " parameters, expected " +
+                        std::to_string(count));
+        }
+    }
+    return true;
+}
+
+// Skips a block whose /begin and name have been read
+bool A2LParser::skipBlock(std::string_view block) {
+    size_t depth = 1;
+    Token token;
+    while (next(token)) {
+        if (token.quoted) {
+            continue;
+        }
+        if (token.text == "/begin") {
+            ++depth;
+        } else if (token.text == "/end" && --depth == 0) {
+            return expectEnd(block);
+        }
+    }
+    return fail("Unexpected end of file in " + std::string(block));
+}
+
+// The name after /end
+bool A2LParser::expectEnd(std::string_view block) {
+    Token name;
+    if (!next(name)) {
+        return fail("Unexpected end of file in " + std::string(block));
+    }
+    if (name.text != block) {
+        return fail("/end " + std::string(name.text) + " closes /begin " + std::string(block));
+    }
+    return true;
+}
+
+// Walks a block body up to its /end, handing every unquoted token to
+// onKeyword (which consumes the keyword's arguments) and the name of every
+// nested block to onBlock (which consumes the block)
+template<typename OnKeyword, typename OnBlock>
+bool A2LParser::parseBody(std::string_view block, OnKeyword&& onKeyword, OnBlock&& onBlock) {
+    Token token;
+    while (next(token)) {
+        if (token.quoted) {
+            continue;
+        }
+        if (token.text == "/end") {
+            return expectEnd(block);
+        }
+        if (token.text == "/begin") {
+            Token name;
+            if (!argument(name) || !onBlock(name.text)) {
+                return false;
+            }
+            continue;
+        }
+        if (!onKeyword(token.text)) {
+            return false;
+        }
+    }
+    return fail("Unexpected end of file in " + std::string(block));
+}
+
+bool A2LParser::parse(std::string& error) {
+    // Only PROJECT and MODULE are entered; every other unknown block is skipped whole
+    std::vector<std::string_view> open;
+    Token token;
+    bool ok = true;
+    while (ok && next(token)) {
+        if (token.quoted) {
+            continue;
+        }
+        if (token.text == "/end") {
+            Token name;
+            ok = argument(name);
+            if (ok && (open.empty() || open.back() != name.text)) {
+                ok = fail("Unexpected /end " + std::string(name.text));
+            }
+            if (ok) {
+                open.pop_back();
+            }
+            continue;
+        }
+        if (token.text == "/include") {
+            Token file;
+            ok = argument(file);
+            if (ok) {
+                warn("/include", "included file " + std::string(file.text) + " was not read");
+            }
+            continue;
+        }
+        if (token.text != "/begin") {
+            continue;
+        }
+    
+        Token name;
+        if (!argument(name)) {
+            break;
+        }
+        std::string_view block = name.text;
+        if (block == "CHARACTERISTIC") {
+            ok = parseCharacteristic();
+        } else if (block == "AXIS_PTS") {
+            ok = parseAxisPoints();
+        } else if (block == "COMPU_METHOD") {
+            ok = parseCompuMethod();
+        } else if (block == "RECORD_LAYOUT") {
+            ok = parseRecordLayout();
+        } else if (block == "MOD_COMMON") {
+            ok = parseModCommon();
+        } else if (block == "MOD_PAR") {
+            ok = parseModPar();
+        } else if (block == "PROJECT" || block == "MODULE") {
+            Token header[2];
+            ok = fields(header, 2, block);
+            if (ok && block == "MODULE") {
+                m_moduleName = header[0].text;
+                m_moduleDescription = header[1].text;
+            }
+            open.push_back(block);
+        } else {
+            ok = skipBlock(block);
+        }
+    }
+    
+    if (ok && m_error.empty() && !open.empty()) {
+        fail("Unexpected end of file in " + std::string(open.back()));
+    }
+    if (!m_error.empty()) {
+        error = m_error;
+        return false;
+    }
+    return true;
+}
+
+bool A2LParser::parseCharacteristic() {
+    Token header[9];
+    if (!fields(header, 9, "CHARACTERISTIC")) {
+        return false;
+    }
+    Characteristic c;
+    c.name = header[0].text;
+    c.type = header[2].text;
+    c.deposit = header[4].text;
+    c.conversion = header[6].text;
+    uint64_t address = 0;
+    if (!parseUnsigned(header[3].text, address)) {
+        return fail("CHARACTERISTIC " + std::string(c.name) + " has an invalid address");
+    }
+    c.address = address;
+    if (!parseNumber(header[7].text, c.lower) || !parseNumber(header[8].text, c.upper)) {
+        return fail("CHARACTERISTIC " + std::string(c.name) + " has invalid limits");
+    }
+    
+    bool ok = parseBody("CHARACTERISTIC",
+        [&](std::string_view keyword) {
+            Token token;
+            if (keyword == "BYTE_ORDER") {
+                bool read = argument(token);
+                c.byteOrder = token.text;
+                return read;
+            }
+            if (keyword == "PHYS_UNIT") {
+                bool read = argument(token);
+                c.unit = token.text;
+                return read;
+            }
+            if (keyword == "NUMBER") {
+                return countArgument(c.number);
+            }
+            if (keyword == "EXTENDED_LIMITS") {
+                c.extended = true;
+                return numberArgument(c.extendedLower) && numberArgument(c.extendedUpper);
+            }
+            if (keyword == "MATRIX_DIM") {
+                // One to three dimensions before ASAP2 1.70, always three since
+                for (size_t i = 0; i < 3; ++i) {
+                    uint64_t dimension = 0;
+                    if (!next(token)) {
+                        return fail("Unexpected end of file in CHARACTERISTIC");
+                    }
+                    if (token.quoted || !parseUnsigned(token.text, dimension)) {
+                        m_tokens.pushBack(token);
+                        break;
+                    }
+                    if (i < 2) {
+                        c.matrixDim[i] = static_cast<size_t>(dimension);
+                    }
+                }
+            }
+            return true;
+        },
+        [&](std::string_view block) {
+            if (block == "AXIS_DESCR" && c.axisCount < 2) {
+                return parseAxisDescription(c.axes[c.axisCount++]);
+            }
+            return skipBlock(block);
+        });
+    if (ok) {
+        m_characteristics.push_back(c);
+        ++m_stats.characteristics;
+    }
+    return ok;
+}
+
+bool A2LParser::parseAxisDescription(AxisDescription& axis) {
+    Token header[6];
+    if (!fields(header, 6, "AXIS_DESCR")) {
+        return false;
+    }
+    axis.attribute = header[0].text;
+    axis.inputQuantity = header[1].text;
+    axis.conversion = header[2].text;
+    uint64_t maxPoints = 0;
+    if (!parseUnsigned(header[3].text, maxPoints)) {
+        return fail("AXIS_DESCR has an invalid point count");
+    }
+    axis.maxPoints = static_cast<size_t>(maxPoints);
+    
+    return parseBody("AXIS_DESCR",
+        [&](std::string_view keyword) {
+            Token token;
+            if (keyword == "AXIS_PTS_REF" || keyword == "CURVE_AXIS_REF") {
+                bool read = argument(token);
+                axis.reference = token.text;
+                return read;
+            }
+            if (keyword == "BYTE_ORDER") {
+                bool read = argument(token);
+                axis.byteOrder = token.text;
+                return read;
+            }
+            if (keyword == "PHYS_UNIT") {
+                bool read = argument(token);
+                axis.unit = token.text;
+                return read;
+            }
+            if (keyword == "FIX_AXIS_PAR" || keyword == "FIX_AXIS_PAR_DIST") {
+                double start = 0.0;
+                double step = 0.0;
+                return numberArgument(start) && numberArgument(step) && countArgument(axis.fixedPoints);
+            }
+            return true;
+        },
+        [&](std::string_view block) {
+            if (block != "FIX_AXIS_PAR_LIST") {
+                return skipBlock(block);
+            }
+            axis.fixedPoints = 0;
+            return parseBody(block,
+                [&](std::string_view) {
+                    ++axis.fixedPoints;
+                    return true;
+                },
+                [&](std::string_view nested) { return skipBlock(nested); });
+        });
+}
+
+bool A2LParser::parseAxisPoints() {
+    Token header[10];
+    if (!fields(header, 10, "AXIS_PTS")) {
+        return false;
+    }
+    AxisPointsRecord record;
+    record.inputQuantity = header[3].text;
+    record.deposit = header[4].text;
+    record.conversion = header[6].text;
+    uint64_t address = 0;
+    uint64_t maxPoints = 0;
+    if (!parseUnsigned(header[2].text, address) || !parseUnsigned(header[7].text, maxPoints)) {
+        return fail("AXIS_PTS " + std::string(header[0].text) + " has an invalid address or point count");
+    }
+    record.address = address;
+    record.maxPoints = static_cast<size_t>(maxPoints);
+    
+    bool ok = parseBody("AXIS_PTS",
+        [&](std::string_view keyword) {
+            Token token;
+            if (keyword == "BYTE_ORDER") {
+                bool read = argument(token);
+                record.byteOrder = token.text;
+                return read;
+            }
+            if (keyword == "PHYS_UNIT") {
+                bool read = argument(token);
+                record.unit = token.text;
+                return read;
+            }
+            return true;
+        },
+        [&](std::string_view block) { return skipBlock(block); });
+    if (ok) {
+        m_axisPoints[header[0].text] = record;
+        ++m_stats.axisPoints;
+    }
+    return ok;
+}
+
+bool A2LParser::parseCompuMethod() {
+    Token header[5];
+    if (!fields(header, 5, "COMPU_METHOD")) {
+        return false;
+    }
+    std::string_view type = header[2].text;
+    Conversion method;
+    method.unit = header[4].text;
+    // Lookup tables are kept as raw values; formulas and interpolated tables cannot be
+    method.linear = type == "IDENTICAL" || type == "LINEAR" || type == "RAT_FUNC" || type == "TAB_VERB";
+    
+    bool ok = parseBody("COMPU_METHOD",
+        [&](std::string_view keyword) {
+            if (keyword == "COEFFS_LINEAR") {
+                return numberArgument(method.factor) && numberArgument(method.offset);
+            }
+            if (keyword == "COEFFS") {
+                // Physical x from internal y = (a x^2 + b x + c) / (d x^2 + e x + f);
+                // linear when a = d = e = 0
+                double k[6];
+                for (double& coefficient : k) {
+                    if (!numberArgument(coefficient)) {
+                        return false;
+                    }
+                }
+                if (k[0] == 0.0 && k[3] == 0.0 && k[4] == 0.0 && k[1] != 0.0) {
+                    method.factor = k[5] / k[1];
+                    method.offset = -k[2] / k[1];
+                } else {
+                    method.linear = false;
+                }
+            }
+            return true;
+        },
+        [&](std::string_view block) { return skipBlock(block); });
+    if (ok) {
+        m_conversions[header[0].text] = method;
+        ++m_stats.compuMethods;
+    }
+    return ok;
+}
+
+bool A2LParser::parseRecordLayout() {
+    Token name;
+    if (!fields(&name, 1, "RECORD_LAYOUT")) {
+        return false;
+    }
+    RecordLayout layout;
+    bool ok = parseBody("RECORD_LAYOUT",
+        [&](std::string_view keyword) { return parseRecordLayoutItem(keyword, layout); },
+        [&](std::string_view block) { return skipBlock(block); });
+    if (ok) {
+        std::stable_sort(layout.items.begin(), layout.items.end(),
+                         [](const LayoutItem& a, const LayoutItem& b) { return a.position < b.position; });
+        m_layouts[name.text] = std::move(layout);
+        ++m_stats.recordLayouts;
+    }
+    return ok;
+}
+
+bool A2LParser::parseRecordLayoutItem(std::string_view keyword, RecordLayout& layout) {
+    uint8_t alignment = 0;
+    if (alignmentClass(keyword, alignment)) {
+        size_t bytes = 0;
+        if (!countArgument(bytes)) {
+            return false;
+        }
+        layout.alignment[alignment] = static_cast<uint8_t>(std::clamp<size_t>(bytes, 1, 8));
+        return true;
+    }
+    if (startsWith(keyword, "FIX_NO_AXIS_PTS_")) {
+        size_t count = 0;
+        if (!countArgument(count)) {
+            return false;
+        }
+        if (axisIndex(keyword) < 2) {
+            layout.fixedAxisPoints[axisIndex(keyword)] = count;
+        }
+        return true;
+    }
+    
+    LayoutItem item;
+    size_t extraArguments = 0;
+    bool reserved = keyword == "RESERVED";
+    if (keyword == "FNC_VALUES") {
+        item.kind = LayoutItem::Values;
+        extraArguments = 2;
+    } else if (startsWith(keyword, "AXIS_PTS_")) {
+        item.kind = LayoutItem::AxisPoints;
+        item.axis = axisIndex(keyword);
+        extraArguments = 2;
+    } else if (startsWith(keyword, "AXIS_RESCALE_")) {
+        extraArguments = 3;
+    } else if (!reserved && keyword != "IDENTIFICATION" && !startsWith(keyword, "NO_AXIS_PTS_") &&
+               !startsWith(keyword, "NO_RESCALE_") && !startsWith(keyword, "SRC_ADDR_") &&
+               !startsWith(keyword, "RIP_ADDR_") && !startsWith(keyword, "OFFSET_") &&
+               !startsWith(keyword, "SHIFT_OP_") && !startsWith(keyword, "DIST_OP_")) {
+        return true; // Not a positioned item
+    }
+    
+    size_t position = 0;
+    Token type;
+    if (!countArgument(position) || !argument(type)) {
+        return false;
+    }
+    item.position = static_cast<uint32_t>(position);
+    item.typeName = type.text;
+    if (!elementType(type.text, item.type) || (reserved && item.type.mapType != 0)) {
+        return fail("Unknown data type " + std::string(type.text) + " in " + std::string(keyword));
+    }
+    
+    Token arguments[3];
+    for (size_t i = 0; i < extraArguments; ++i) {
+        if (!argument(arguments[i])) {
+            return false;
+        }
+    }
+    if (item.kind == LayoutItem::Values) {
+        // Index mode, address type
+        item.columnDirection = arguments[0].text == "COLUMN_DIR";
+        item.supported = (arguments[0].text == "COLUMN_DIR" || arguments[0].text == "ROW_DIR") &&
+                         arguments[1].text == "DIRECT";
+    } else if (item.kind == LayoutItem::AxisPoints) {
+        // Index order, address type
+        item.supported = arguments[1].text == "DIRECT";
+    } else if (extraArguments == 3) {
+        // Rescale pairs: maximum count, index order, address type
+        uint64_t pairs = 0;
+        if (!parseUnsigned(arguments[0].text, pairs)) {
+            return fail("'" + std::string(arguments[0].text) + "' is not a count");
+        }
+        item.count = static_cast<uint32_t>(pairs * 2);
+    }
+    layout.items.push_back(item);
+    return true;
+}
+
+bool A2LParser::parseModCommon() {
+    Token description;
+    if (!fields(&description, 1, "MOD_COMMON")) {
+        return false;
+    }
+    return parseBody("MOD_COMMON",
+        [&](std::string_view keyword) {
+            Token token;
+            uint8_t alignment = 0;
+            if (keyword == "BYTE_ORDER") {
+                bool read = argument(token);
+                m_byteOrder = token.text;
+                return read;
+            }
+            if (alignmentClass(keyword, alignment)) {
+                size_t bytes = 0;
+                if (!countArgument(bytes)) {
+                    return false;
+                }
+                m_alignment[alignment] = static_cast<uint8_t>(std::clamp<size_t>(bytes, 1, 8));
+            }
+            return true;
+        },
+        [&](std::string_view block) { return skipBlock(block); });
+}
+
+bool A2LParser::parseModPar() {
+    Token description;
+    if (!fields(&description, 1, "MOD_PAR")) {
+        return false;
+    }
+    return parseBody("MOD_PAR",
+        [&](std::string_view keyword) {
+            Token token;
+            if (keyword == "ECU" || keyword == "EPK") {
+                bool read = argument(token);
+                (keyword == "ECU" ? m_ecu : m_epk) = token.text;
+                return read;
+            }
+            return true;
+        },
+        [&](std::string_view block) { return skipBlock(block); });
+}
+
+Conversion A2LParser::conversion(std::string_view name, std::string_view owner) {
+    if (name == "NO_COMPU_METHOD") {
+        return {};
+    }
+    auto it = m_conversions.find(name);
+    if (it == m_conversions.end()) {
+        warn(owner, "unknown COMPU_METHOD " + std::string(name) + ", showing raw values");
+        ++m_stats.approximated;
+        return {};
+    }
+    if (!it->second.linear) {
+        warn(owner, "COMPU_METHOD " + std::string(name) + " is not linear, showing raw values");
+        ++m_stats.approximated;
+        Conversion raw;
+        raw.unit = it->second.unit;
+        return raw;
+    }
+    return it->second;
+}
+
+// Byte offset of target within one record, laying out the items in position
+// order with their alignment
+size_t A2LParser::itemOffset(const RecordLayout& layout, const LayoutItem* target, const size_t axisCounts[2],
+                             size_t valueCount) const {
+    size_t offset = 0;
+    for (const LayoutItem& item : layout.items) {
+        uint8_t alignment = layout.alignment[item.type.alignment];
+        if (alignment == 0) {
+            alignment = m_alignment[item.type.alignment];
+        }
+        offset = (offset + alignment - 1) / alignment * alignment;
+        if (&item == target) {
+            break;
+        }
+        size_t count = item.count;
+        if (item.kind == LayoutItem::Values) {
+            count = valueCount;
+        } else if (item.kind == LayoutItem::AxisPoints) {
+            count = item.axis < 2 ? axisCounts[item.axis] : 1;
+        }
+        offset += count * item.type.size;
+    }
+    return offset;
+}
+
+bool A2LParser::resolveAxis(const Characteristic& characteristic, const AxisDescription& description,
+                            const RecordLayout& layout, uint8_t index, Endianness endianness, size_t baseAddress,
+                            ResolvedAxis& resolved, std::string& reason) {
+    MapAxis& axis = resolved.axis;
+    std::string_view attribute = description.attribute;
+    Conversion scaling = conversion(description.conversion, characteristic.name);
+    axis.setName(std::string(description.inputQuantity == "NO_INPUT_QUANTITY" ? description.reference
+                                                                               : description.inputQuantity));
+    axis.setUnit(std::string(description.unit.empty() ? scaling.unit : description.unit));
+    axis.setFactor(scaling.factor);
+    axis.setOffset(scaling.offset);
+    axis.setEndianness(byteOrder(description.byteOrder, endianness));
+    
+    if (attribute == "FIX_AXIS" || attribute == "CURVE_AXIS") {
+        // Computed or rescaled breakpoints, nothing stored to show
+        resolved.count = description.fixedPoints ? description.fixedPoints : description.maxPoints;
+        return true;
+    }
+    
+    if (attribute == "STD_AXIS") {
+        resolved.count = layout.fixedAxisPoints[index] ? layout.fixedAxisPoints[index] : description.maxPoints;
+        auto item = std::find_if(layout.items.begin(), layout.items.end(), [index](const LayoutItem& entry) {
+            return entry.kind == LayoutItem::AxisPoints && entry.axis == index;
+        });
+        if (item != layout.items.end() && item->supported && item->type.mapType != 0) {
+            resolved.inlineItem = &*item;
+            axis.setDataType(item->type.mapType);
+        }
+        return true;
+    }
+    if (attribute != "COM_AXIS" && attribute != "RES_AXIS") {
+        reason = std::string(attribute) + " axes are not supported";
+        return false;
+    }
+    
+    auto points = m_axisPoints.find(description.reference);
+    if (points == m_axisPoints.end()) {
+        reason = "unknown AXIS_PTS " + std::string(description.reference);
+        return false;
+    }
+    const AxisPointsRecord& record = points->second;
+    auto pointsLayout = m_layouts.find(record.deposit);
+    if (pointsLayout == m_layouts.end()) {
+        reason = "unknown RECORD_LAYOUT " + std::string(record.deposit);
+        return false;
+    }
+    const RecordLayout& axisLayout = pointsLayout->second;
+    size_t counts[2] = {axisLayout.fixedAxisPoints[0] ? axisLayout.fixedAxisPoints[0] : record.maxPoints, 0};
+    resolved.count = counts[0];
+    
+    Conversion pointsScaling = conversion(record.conversion, characteristic.name);
+    axis.setFactor(pointsScaling.factor);
+    axis.setOffset(pointsScaling.offset);
+    axis.setEndianness(byteOrder(record.byteOrder, byteOrder(m_byteOrder, Endianness::Little)));
+    if (record.inputQuantity != "NO_INPUT_QUANTITY") {
+        axis.setName(std::string(record.inputQuantity));
+    }
+    if (!record.unit.empty() || !pointsScaling.unit.empty()) {
+        axis.setUnit(std::string(record.unit.empty() ? pointsScaling.unit : record.unit));
+    }
+    
+    auto item = std::find_if(axisLayout.items.begin(), axisLayout.items.end(), [](const LayoutItem& entry) {
+        return entry.kind == LayoutItem::AxisPoints && entry.axis == 0;
+    });
+    if (item == axisLayout.items.end() || !item->supported || item->type.mapType == 0) {
+        // The shape is known but the breakpoints cannot be shown
+        return true;
+    }
+    uint64_t address = record.address + itemOffset(axisLayout, &*item, counts, 0);
+    if (record.address < baseAddress) {
+        reason = "AXIS_PTS " + std::string(description.reference) + " lies below the base address";
+        return false;
+    }
+    axis.setAddress(static_cast<size_t>(address - baseAddress));
+    axis.setCount(resolved.count);
+    axis.setDataType(item->type.mapType);
+    return true;
+}
+
+bool A2LParser::buildMap(const Characteristic& characteristic, size_t baseAddress, MapDefinition& map,
+                         std::string& reason) {
+    const Characteristic& c = characteristic;
+    size_t axesNeeded = 0;
+    if (c.type == "CURVE") {
+        axesNeeded = 1;
+    } else if (c.type == "MAP") {
+        axesNeeded = 2;
+    } else if (c.type != "VALUE" && c.type != "VAL_BLK") {
+        reason = std::string(c.type) + " characteristics are not supported";
+        return false;
+    }
+    if (c.axisCount < axesNeeded) {
+        reason = "missing AXIS_DESCR";
+        return false;
+    }
+    auto layoutEntry = m_layouts.find(c.deposit);
+    if (layoutEntry == m_layouts.end()) {
+        reason = "unknown RECORD_LAYOUT " + std::string(c.deposit);
+        return false;
+    }
+    const RecordLayout& layout = layoutEntry->second;
+    auto values = std::find_if(layout.items.begin(), layout.items.end(),
+                               [](const LayoutItem& item) { return item.kind == LayoutItem::Values; });
+    if (values == layout.items.end()) {
+        reason = "RECORD_LAYOUT " + std::string(c.deposit) + " has no FNC_VALUES";
+        return false;
+    }
+    if (values->type.mapType == 0) {
+        reason = std::string(values->typeName) + " values are not supported";
+        return false;
+    }
+    if (!values->supported) {
+        reason = "indirect or alternating FNC_VALUES are not supported";
+        return false;
+    }
+    
+    Endianness endianness = byteOrder(c.byteOrder, byteOrder(m_byteOrder, Endianness::Little));
+    ResolvedAxis axes[2];
+    size_t counts[2] = {1, 1};
+    for (uint8_t i = 0; i < axesNeeded; ++i) {
+        if (!resolveAxis(c, c.axes[i], layout, i, endianness, baseAddress, axes[i], reason)) {
+            return false;
+        }
+        counts[i] = axes[i].count;
+    }
+    if (c.type == "VAL_BLK") {
+        counts[0] = c.matrixDim[0] ? c.matrixDim[0] : std::max<size_t>(c.number, 1);
+        counts[1] = c.matrixDim[0] ? std::max<size_t>(c.matrixDim[1], 1) : 1;
+    }
+    if (counts[0] == 0 || counts[1] == 0) {
+        reason = "no points";
+        return false;
+    }
+    
+    if (c.address < baseAddress) {
+        reason = "address lies below the base address";
+        return false;
+    }
+    size_t recordAddress = static_cast<size_t>(c.address - baseAddress);
+    for (ResolvedAxis& axis : axes) {
+        if (axis.inlineItem) {
+            axis.axis.setAddress(recordAddress + itemOffset(layout, axis.inlineItem, counts, 0));
+            axis.axis.setCount(axis.count);
+        }
+    }
+    size_t address = recordAddress + itemOffset(layout, &*values, counts, counts[0] * counts[1]);
+    
+    Conversion scaling = conversion(c.conversion, c.name);
+    map.setName(std::string(c.name));
+    map.setAddress(address);
+    map.setDataType(values->type.mapType);
+    map.setEndianness(endianness);
+    map.setFactor(scaling.factor);
+    map.setOffset(scaling.offset);
+    map.setUnit(std::string(c.unit.empty() ? scaling.unit : c.unit));
+    map.setWarningMin(c.lower);
+    map.setWarningMax(c.upper);
+    map.setHardMin(c.extended ? c.extendedLower : c.lower);
+    map.setHardMax(c.extended ? c.extendedUpper : c.upper);
+    
+    // ROW_DIR stores x fastest, which is the editor's row-major order;
+    // COLUMN_DIR stores y fastest, so the record is the transposed grid
+    bool transposed = values->columnDirection && counts[1] > 1;
+    size_t xIndex = transposed ? 1 : 0;
+    map.setType(counts[1] > 1 ? MapType::Map3D : MapType::Map2D);
+    map.setColumns(counts[xIndex]);
+    map.setRows(counts[1 - xIndex]);
+    if (axesNeeded > xIndex) {
+        map.xAxis() = axes[xIndex].axis;
+    }
+    if (axesNeeded > 1 - xIndex) {
+        map.yAxis() = axes[1 - xIndex].axis;
+    }
+    map.xAxis().setType(AxisType::XAxis);
+    map.yAxis().setType(AxisType::YAxis);
+    return true;
+}
+
+void A2LParser::resolve(size_t baseAddress, std::vector<MapDefinition>& maps) {
+    maps.reserve(maps.size() + m_characteristics.size());
+    std::string reason;
+    for (const Characteristic& characteristic : m_characteristics) {
+        MapDefinition map;
+        reason.clear();
+        if (buildMap(characteristic, baseAddress, map, reason)) {
+            maps.push_back(std::move(map));
+            ++m_stats.imported;
+        } else {
+            warn(characteristic.name, reason);
+            ++m_stats.skipped;
+        }
+    }
+}
+
+void A2LParser::fillInfo(MapPackInfo& info) const {
+    auto fill = [](std::string& field, std::string_view value) {
+        if (field.empty()) {
+            field = std::string(value);
+        }
+    };
+    fill(info.name, m_moduleName);
+    fill(info.description, m_moduleDescription);
+    fill(info.ecuName, m_ecu);
+    fill(info.ecuId, m_epk);
+}
+
+} // namespace
+
+bool A2LImporter::importFile(const std::string& filepath, MapPack& pack, std::string& error) {
+    m_stats = A2LImportStats();
+    MemoryMapper mapper;
+    if (!mapper.open(filepath, true, MemoryMapper::AccessHint::Sequential)) {
+        error = "Cannot open " + filepath + " or it is empty";
+        return false;
+    }
+    return importText(std::string_view(reinterpret_cast<const char*>(mapper.data()), mapper.size()), pack, error);
+}
+
+bool A2LImporter::importText(std::string_view text, MapPack& pack, std::string& error) {
+    m_stats = A2LImportStats();
+    m_stats.bytes = text.size();
+    
+    A2LParser parser(text, m_stats);
+    if (!parser.parse(error)) {
+        return false;
+    }
+    std::vector<MapDefinition> maps;
+    parser.resolve(m_baseAddress, maps);
+    
+    parser.fillInfo(pack.info());
+    pack.maps().insert(pack.maps().end(), std::make_move_iterator(maps.begin()),
+                       std::make_move_iterator(maps.end()));
+    return true;
+}
+
+} // namespace WinMMM10
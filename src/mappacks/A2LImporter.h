@@ -0,0 +1,59 @@
+#pragma once
+
+#include "MapPack.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace WinMMM10 {
+
+struct A2LImportStats {
+    size_t bytes{0};
+    size_t characteristics{0};
+    size_t axisPoints{0};
+    size_t compuMethods{0};
+    size_t recordLayouts{0};
+    size_t imported{0};
+    size_t skipped{0};
+    size_t approximated{0}; // Imported with an identity conversion in place of a non-linear one
+    std::vector<std::string> warnings; // The first MaxWarnings reasons
+};
+
+// Imports map definitions from ASAP2 (A2L) description files.
+//
+// The file is memory-mapped read-only and tokenized in one forward pass.
+// Only the blocks that describe maps are kept, as small records viewing the
+// mapped text: COMPU_METHOD, RECORD_LAYOUT, AXIS_PTS and CHARACTERISTIC with
+// its AXIS_DESCRs. Everything else (MEASUREMENT, IF_DATA, A2ML, ...) is
+// skipped by nesting depth. Names are resolved once the pass is done, since
+// A2L allows references to blocks further down the file.
+//
+// Every VALUE, CURVE, MAP and VAL_BLK with an element type the editor knows
+// becomes one MapDefinition. Data and inline axis addresses are the ECU
+// address plus the offset of the item in the record layout, with the ASAP2
+// default alignment unless ALIGNMENT_* says otherwise; axes that store a
+// point count use their maximum. COLUMN_DIR maps are stored transposed, so
+// their A2L x axis becomes the editor's y axis. Lower and upper limits become
+// the warning limits and EXTENDED_LIMITS, if present, the hard limits.
+class A2LImporter {
+public:
+    static constexpr size_t MaxWarnings = 100;
+    
+    // ECU address that corresponds to offset 0 of the loaded binary
+    size_t baseAddress() const { return m_baseAddress; }
+    void setBaseAddress(size_t address) { m_baseAddress = address; }
+    
+    // Appends the definitions to pack and fills empty info fields from the
+    // MODULE and MOD_PAR blocks. On a syntax error nothing is added.
+    bool importFile(const std::string& filepath, MapPack& pack, std::string& error);
+    bool importText(std::string_view text, MapPack& pack, std::string& error);
+    
+    const A2LImportStats& stats() const { return m_stats; }
+
+private:
+    size_t m_baseAddress{0};
+    A2LImportStats m_stats;
+};
+
+} // namespace WinMMM10
@@ -1,15 +1,47 @@
 #include "MapPack.h"
+#include "MapPackFile.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QFile>
 #include <QIODevice>
 #include <QDir>
+#include <QFileInfo>
 #include <QStandardPaths>
+#include <algorithm>
 #include <stdexcept>
+#include <unordered_set>
 
 namespace WinMMM10 {
 
+namespace {
+
+QJsonObject axisToJson(const MapAxis& axis) {
+    QJsonObject axisObj;
+    axisObj["address"] = static_cast<qint64>(axis.address());
+    axisObj["count"] = static_cast<qint64>(axis.count());
+    axisObj["dataType"] = static_cast<int>(axis.dataType());
+    axisObj["endianness"] = (axis.endianness() == Endianness::Big) ? "big" : "little";
+    axisObj["factor"] = axis.factor();
+    axisObj["offset"] = axis.offset();
+    axisObj["name"] = QString::fromStdString(axis.name());
+    axisObj["unit"] = QString::fromStdString(axis.unit());
+    return axisObj;
+}
+
+void axisFromJson(const QJsonObject& axisObj, MapAxis& axis) {
+    axis.setAddress(static_cast<size_t>(axisObj["address"].toInteger()));
+    axis.setCount(static_cast<size_t>(axisObj["count"].toInteger()));
+    axis.setDataType(static_cast<uint16_t>(axisObj["dataType"].toInt()));
+    axis.setEndianness(axisObj["endianness"].toString() == "big" ? Endianness::Big : Endianness::Little);
+    axis.setFactor(axisObj["factor"].toDouble());
+    axis.setOffset(axisObj["offset"].toDouble());
+    axis.setName(axisObj["name"].toString().toStdString());
+    axis.setUnit(axisObj["unit"].toString().toStdString());
+}
+
+} // namespace
+
 MapPack::MapPack() = default;
 
 void MapPack::addMap(const MapDefinition& map) {
@@ -37,7 +69,12 @@ const MapDefinition& MapPack::getMap(size_t index) const {
     return m_maps[index];
 }
 
-bool MapPack::saveToFile(const std::string& filepath) const {
+bool MapPack::saveToFile(const std::string& filepath, MapPackFormat format) const {
+    if (format == MapPackFormat::Binary) {
+        std::string error;
+        return MapPackFile::write(*this, filepath, error);
+    }
+    
     QJsonObject root;
     
     // Save info
@@ -55,6 +92,13 @@ bool MapPack::saveToFile(const std::string& filepath) const {
         tagsArray.append(QString::fromStdString(tag));
     }
     infoObj["tags"] = tagsArray;
+    
+    // Hex strings, since JSON numbers cannot hold every 64-bit value
+    QJsonArray fingerprintsArray;
+    for (uint64_t fingerprint : m_info.fingerprints) {
+        fingerprintsArray.append(QString::number(fingerprint, 16));
+    }
+    infoObj["fingerprints"] = fingerprintsArray;
     root["info"] = infoObj;
     
     // Save maps
@@ -64,36 +108,20 @@ bool MapPack::saveToFile(const std::string& filepath) const {
         mapObj["name"] = QString::fromStdString(map.name());
         mapObj["address"] = static_cast<qint64>(map.address());
         mapObj["type"] = (map.type() == MapType::Map3D) ? "3D" : "2D";
-        mapObj["rows"] = static_cast<int>(map.rows());
-        mapObj["columns"] = static_cast<int>(map.columns());
+        mapObj["rows"] = static_cast<qint64>(map.rows());
+        mapObj["columns"] = static_cast<qint64>(map.columns());
         mapObj["dataType"] = static_cast<int>(map.dataType());
+        mapObj["endianness"] = (map.endianness() == Endianness::Big) ? "big" : "little";
         mapObj["factor"] = map.factor();
         mapObj["offset"] = map.offset();
         mapObj["unit"] = QString::fromStdString(map.unit());
         
-        QJsonObject xAxisObj;
-        const MapAxis& xAxis = map.xAxis();
-        xAxisObj["address"] = static_cast<qint64>(xAxis.address());
-        xAxisObj["count"] = static_cast<int>(xAxis.count());
-        xAxisObj["dataType"] = static_cast<int>(xAxis.dataType());
-        xAxisObj["factor"] = xAxis.factor();
-        xAxisObj["offset"] = xAxis.offset();
-        xAxisObj["name"] = QString::fromStdString(xAxis.name());
-        xAxisObj["unit"] = QString::fromStdString(xAxis.unit());
-        mapObj["xAxis"] = xAxisObj;
-        
-        if (map.type() == MapType::Map3D) {
-            QJsonObject yAxisObj;
-            const MapAxis& yAxis = map.yAxis();
-            yAxisObj["address"] = static_cast<qint64>(yAxis.address());
-            yAxisObj["count"] = static_cast<int>(yAxis.count());
-            yAxisObj["dataType"] = static_cast<int>(yAxis.dataType());
-            yAxisObj["factor"] = yAxis.factor();
-            yAxisObj["offset"] = yAxis.offset();
-            yAxisObj["name"] = QString::fromStdString(yAxis.name());
-            yAxisObj["unit"] = QString::fromStdString(yAxis.unit());
-            mapObj["yAxis"] = yAxisObj;
-        }
+        mapObj["hardMin"] = map.hardMin();
+        mapObj["hardMax"] = map.hardMax();
+        mapObj["warningMin"] = map.warningMin();
+        mapObj["warningMax"] = map.warningMax();
+        mapObj["xAxis"] = axisToJson(map.xAxis());
+        mapObj["yAxis"] = axisToJson(map.yAxis());
         
         mapsArray.append(mapObj);
     }
@@ -110,6 +138,16 @@ bool MapPack::saveToFile(const std::string& filepath) const {
 }
 
 bool MapPack::loadFromFile(const std::string& filepath) {
+    if (MapPackFile::isBinaryPack(filepath)) {
+        MapPackFile packFile;
+        std::string error;
+        if (!packFile.open(filepath, error)) {
+            return false;
+        }
+        packFile.toMapPack(*this);
+        return true;
+    }
+    
     QFile file(QString::fromStdString(filepath));
     if (!file.open(QIODevice::ReadOnly)) {
         return false;
@@ -139,6 +177,16 @@ bool MapPack::loadFromFile(const std::string& filepath) {
         m_info.tags.push_back(tagValue.toString().toStdString());
     }
     
+    QJsonArray fingerprintsArray = infoObj["fingerprints"].toArray();
+    m_info.fingerprints.clear();
+    for (const QJsonValue& fingerprintValue : fingerprintsArray) {
+        bool ok = false;
+        uint64_t fingerprint = fingerprintValue.toString().toULongLong(&ok, 16);
+        if (ok) {
+            m_info.fingerprints.push_back(fingerprint);
+        }
+    }
+    
     // Load maps
     m_maps.clear();
     QJsonArray mapsArray = root["maps"].toArray();
@@ -146,35 +194,24 @@ bool MapPack::loadFromFile(const std::string& filepath) {
         QJsonObject mapObj = mapValue.toObject();
         MapDefinition map;
         map.setName(mapObj["name"].toString().toStdString());
-        map.setAddress(static_cast<size_t>(mapObj["address"].toInt()));
+        map.setAddress(static_cast<size_t>(mapObj["address"].toInteger()));
         map.setType(mapObj["type"].toString() == "3D" ? MapType::Map3D : MapType::Map2D);
-        map.setRows(static_cast<size_t>(mapObj["rows"].toInt()));
-        map.setColumns(static_cast<size_t>(mapObj["columns"].toInt()));
+        map.setRows(static_cast<size_t>(mapObj["rows"].toInteger()));
+        map.setColumns(static_cast<size_t>(mapObj["columns"].toInteger()));
         map.setDataType(static_cast<uint16_t>(mapObj["dataType"].toInt()));
+        map.setEndianness(mapObj["endianness"].toString() == "big" ? Endianness::Big : Endianness::Little);
         map.setFactor(mapObj["factor"].toDouble());
         map.setOffset(mapObj["offset"].toDouble());
         map.setUnit(mapObj["unit"].toString().toStdString());
         
-        QJsonObject xAxisObj = mapObj["xAxis"].toObject();
-        MapAxis& xAxis = map.xAxis();
-        xAxis.setAddress(static_cast<size_t>(xAxisObj["address"].toInt()));
-        xAxis.setCount(static_cast<size_t>(xAxisObj["count"].toInt()));
-        xAxis.setDataType(static_cast<uint16_t>(xAxisObj["dataType"].toInt()));
-        xAxis.setFactor(xAxisObj["factor"].toDouble());
-        xAxis.setOffset(xAxisObj["offset"].toDouble());
-        xAxis.setName(xAxisObj["name"].toString().toStdString());
-        xAxis.setUnit(xAxisObj["unit"].toString().toStdString());
-        
-        if (map.type() == MapType::Map3D) {
-            QJsonObject yAxisObj = mapObj["yAxis"].toObject();
-            MapAxis& yAxis = map.yAxis();
-            yAxis.setAddress(static_cast<size_t>(yAxisObj["address"].toInt()));
-            yAxis.setCount(static_cast<size_t>(yAxisObj["count"].toInt()));
-            yAxis.setDataType(static_cast<uint16_t>(yAxisObj["dataType"].toInt()));
-            yAxis.setFactor(yAxisObj["factor"].toDouble());
-            yAxis.setOffset(yAxisObj["offset"].toDouble());
-            yAxis.setName(yAxisObj["name"].toString().toStdString());
-            yAxis.setUnit(yAxisObj["unit"].toString().toStdString());
+        // Packs written before limits were saved keep the defaults
+        map.setHardMin(mapObj["hardMin"].toDouble(map.hardMin()));
+        map.setHardMax(mapObj["hardMax"].toDouble(map.hardMax()));
+        map.setWarningMin(mapObj["warningMin"].toDouble(map.warningMin()));
+        map.setWarningMax(mapObj["warningMax"].toDouble(map.warningMax()));
+        axisFromJson(mapObj["xAxis"].toObject(), map.xAxis());
+        if (mapObj.contains("yAxis")) {
+            axisFromJson(mapObj["yAxis"].toObject(), map.yAxis());
         }
         
         m_maps.push_back(map);
@@ -188,26 +225,154 @@ MapPackManager& MapPackManager::instance() {
     return instance;
 }
 
+MapPackManager::MapPackManager() = default;
+MapPackManager::~MapPackManager() = default;
+
+bool MapPackManager::openPack(const std::string& filepath, InstalledPack& installed) {
+    installed.filepath = filepath;
+    if (MapPackFile::isBinaryPack(filepath)) {
+        installed.file = std::make_unique<MapPackFile>();
+        std::string error;
+        return installed.file->open(filepath, error);
+    }
+    return installed.pack.loadFromFile(filepath);
+}
+
+void MapPackManager::rebuildIndex() {
+    m_index.clear();
+    for (size_t i = 0; i < m_installedPacks.size(); ++i) {
+        m_index.add(i, packInfo(i));
+    }
+}
+
 bool MapPackManager::loadMapPack(const std::string& filepath) {
-    MapPack pack;
-    if (pack.loadFromFile(filepath)) {
-        m_installedPacks.push_back(pack);
-        return true;
+    InstalledPack installed;
+    if (!openPack(filepath, installed)) {
+        return false;
     }
-    return false;
+    m_index.add(m_installedPacks.size(), installed.file ? installed.file->info() : installed.pack.info());
+    m_installedPacks.push_back(std::move(installed));
+    return true;
+}
+
+size_t MapPackManager::loadInstalledPacks() {
+    QDir dir(QString::fromStdString(packDirectory()));
+    QStringList filters;
+    filters << QString::fromStdString("*" + MapPack::getBinaryFileExtension())
+            << QString::fromStdString("*" + MapPack::getFileExtension());
+    
+    std::unordered_set<std::string> installed;
+    for (const auto& pack : m_installedPacks) {
+        installed.insert(pack.filepath);
+    }
+    
+    size_t loaded = 0;
+    for (const QString& fileName : dir.entryList(filters, QDir::Files, QDir::Name)) {
+        std::string filepath = dir.absoluteFilePath(fileName).toStdString();
+        if (installed.count(filepath) == 0 && loadMapPack(filepath)) {
+            ++loaded;
+        }
+    }
+    return loaded;
+}
+
+std::string MapPackManager::packDirectory() {
+    return (QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/mappacks").toStdString();
+}
+
+std::vector<MapPackMatch> MapPackManager::rankMapPacks(const uint8_t* data, size_t size,
+                                                       std::string_view fileHash, size_t limit) const {
+    return m_index.rank(data, size, fileHash, limit);
 }
 
-bool MapPackManager::saveMapPack(const MapPack& pack, const std::string& filepath) {
-    return pack.saveToFile(filepath);
+std::vector<MapPackManager::InstalledPack>::iterator MapPackManager::findInstalled(const std::string& filepath) {
+    QFileInfo target(QString::fromStdString(filepath));
+    return std::find_if(m_installedPacks.begin(), m_installedPacks.end(), [&](const InstalledPack& p) {
+        return QFileInfo(QString::fromStdString(p.filepath)) == target;
+    });
+}
+
+bool MapPackManager::unloadMapPack(const std::string& filepath) {
+    auto installed = findInstalled(filepath);
+    if (installed == m_installedPacks.end()) {
+        return false;
+    }
+    m_installedPacks.erase(installed);
+    rebuildIndex();
+    return true;
+}
+
+bool MapPackManager::saveMapPack(const MapPack& pack, const std::string& filepath, MapPackFormat format) {
+    auto installed = findInstalled(filepath);
+    if (installed == m_installedPacks.end()) {
+        return pack.saveToFile(filepath, format);
+    }
+    
+    // Windows cannot replace a mapped file, so the old mapping goes first.
+    // Whether or not the save worked, the pack is read back from disk.
+    installed->file.reset();
+    bool saved = pack.saveToFile(filepath, format);
+    InstalledPack reloaded;
+    if (openPack(installed->filepath, reloaded)) {
+        *installed = std::move(reloaded);
+    } else {
+        m_installedPacks.erase(installed);
+    }
+    rebuildIndex();
+    return saved;
 }
 
 std::vector<MapPackInfo> MapPackManager::getInstalledMapPacks() const {
     std::vector<MapPackInfo> result;
-    for (const auto& pack : m_installedPacks) {
-        result.push_back(pack.info());
+    for (const auto& installed : m_installedPacks) {
+        result.push_back(installed.file ? installed.file->info() : installed.pack.info());
     }
     return result;
 }
 
+const MapPackInfo& MapPackManager::packInfo(size_t pack) const {
+    const InstalledPack& installed = m_installedPacks.at(pack);
+    return installed.file ? installed.file->info() : installed.pack.info();
+}
+
+size_t MapPackManager::mapCount(size_t pack) const {
+    if (pack >= m_installedPacks.size()) {
+        return 0;
+    }
+    const InstalledPack& installed = m_installedPacks[pack];
+    return installed.file ? installed.file->mapCount() : installed.pack.mapCount();
+}
+
+bool MapPackManager::getMap(size_t pack, size_t index, MapDefinition& map) const {
+    if (index >= mapCount(pack)) {
+        return false;
+    }
+    const InstalledPack& installed = m_installedPacks[pack];
+    map = installed.file ? installed.file->map(index) : installed.pack.getMap(index);
+    return true;
+}
+
+bool MapPackManager::findMap(size_t pack, std::string_view name, MapDefinition& map) const {
+    if (pack >= m_installedPacks.size()) {
+        return false;
+    }
+    const InstalledPack& installed = m_installedPacks[pack];
+    if (installed.file) {
+        size_t index = 0;
+        if (!installed.file->findByName(name, index)) {
+            return false;
+        }
+        map = installed.file->map(index);
+        return true;
+    }
+    for (const MapDefinition& candidate : installed.pack.maps()) {
+        if (candidate.name() == name) {
+            map = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
 } // namespace WinMMM10
 
@@ -1,13 +1,22 @@
 #pragma once
 
 #include "../maps/MapDefinition.h"
+#include "MapPackIndex.h"
 #include <string>
 #include <vector>
 #include <memory>
 #include <cstdint>
+#include <string_view>
 
 namespace WinMMM10 {
 
+class MapPackFile;
+
+enum class MapPackFormat {
+    Json,  // Interchange, readable and diffable
+    Binary // Memory-mapped, see MapPackFile
+};
+
 struct MapPackInfo {
     std::string name;
     std::string version;
@@ -15,8 +24,9 @@ struct MapPackInfo {
     std::string description;
     std::string ecuName;
     std::string ecuId;
-    std::string fileHash; // MD5/SHA256 of original binary
+    std::string fileHash; // SHA-256 hex of the original binary, see HashService::fileSha256()
     std::vector<std::string> tags;
+    std::vector<uint64_t> fingerprints; // Content sketch of the original binary, see MapPackIndex
 };
 
 class MapPack {
@@ -36,10 +46,12 @@ public:
     std::vector<MapDefinition>& maps() { return m_maps; }
     const std::vector<MapDefinition>& maps() const { return m_maps; }
     
-    bool saveToFile(const std::string& filepath) const;
+    // Both formats keep every field; loading detects the format
+    bool saveToFile(const std::string& filepath, MapPackFormat format = MapPackFormat::Json) const;
     bool loadFromFile(const std::string& filepath);
     
     static std::string getFileExtension() { return ".mappack"; }
+    static std::string getBinaryFileExtension() { return ".mpk"; }
 
 private:
     MapPackInfo m_info;
@@ -50,17 +62,53 @@ class MapPackManager {
 public:
     static MapPackManager& instance();
     
+    // Binary packs stay mapped and build definitions on access; JSON packs
+    // are parsed whole
     bool loadMapPack(const std::string& filepath);
-    bool saveMapPack(const MapPack& pack, const std::string& filepath);
+    // Saving over an installed pack unmaps it first and loads it again
+    // afterwards; if it can no longer be loaded it is dropped, which moves the
+    // ids of the packs after it
+    bool saveMapPack(const MapPack& pack, const std::string& filepath,
+                     MapPackFormat format = MapPackFormat::Binary);
+    // Drops the pack loaded from filepath and unmaps it; the ids of the packs
+    // after it move down by one
+    bool unloadMapPack(const std::string& filepath);
     std::vector<MapPackInfo> getInstalledMapPacks() const;
     
+    // Loads every pack in packDirectory() that is not loaded yet and returns
+    // how many were added
+    size_t loadInstalledPacks();
+    static std::string packDirectory();
+    
+    // Installed packs that fit a binary, best first; see MapPackIndex::rank
+    std::vector<MapPackMatch> rankMapPacks(const uint8_t* data, size_t size, std::string_view fileHash,
+                                           size_t limit = 10) const;
+    
+    size_t installedCount() const { return m_installedPacks.size(); }
+    const MapPackInfo& packInfo(size_t pack) const;
+    size_t mapCount(size_t pack) const;
+    bool getMap(size_t pack, size_t index, MapDefinition& map) const;
+    bool findMap(size_t pack, std::string_view name, MapDefinition& map) const;
+    
 private:
-    MapPackManager() = default;
-    ~MapPackManager() = default;
+    // Exactly one of file and pack is used
+    struct InstalledPack {
+        std::string filepath;
+        std::unique_ptr<MapPackFile> file;
+        MapPack pack;
+    };
+    
+    MapPackManager();
+    ~MapPackManager();
     MapPackManager(const MapPackManager&) = delete;
     MapPackManager& operator=(const MapPackManager&) = delete;
     
-    std::vector<MapPack> m_installedPacks;
+    static bool openPack(const std::string& filepath, InstalledPack& installed);
+    std::vector<InstalledPack>::iterator findInstalled(const std::string& filepath);
+    void rebuildIndex();
+    
+    std::vector<InstalledPack> m_installedPacks;
+    MapPackIndex m_index; // Pack ids are positions in m_installedPacks
 };
 
 } // namespace WinMMM10
@@ -0,0 +1,415 @@
+#include "MapPackFile.h"
+#include "../binary/Endianness.h"
+#include <QSaveFile>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+namespace WinMMM10 {
+
+namespace {
+
+// Section sizes and field offsets
+constexpr size_t HeaderSize = 80;
+constexpr size_t StringRefSize = 8; // u32 offset, u32 length
+constexpr size_t InfoStrings = 7;
+constexpr size_t AxisSize = 48;
+constexpr size_t RecordSize = 184;
+
+namespace Header {
+constexpr size_t Version = 8;
+constexpr size_t MapCount = 12;
+constexpr size_t RecordSize = 16;
+constexpr size_t TagCount = 20;
+constexpr size_t Records = 24;
+constexpr size_t NameIndex = 32;
+constexpr size_t AddressIndex = 40;
+constexpr size_t Strings = 48;
+constexpr size_t StringsSize = 56;
+constexpr size_t FingerprintCount = 64;
+constexpr size_t Fingerprints = 72;
+} // namespace Header
+
+namespace Record {
+constexpr size_t Name = 0;
+constexpr size_t Unit = 8;
+constexpr size_t Address = 16;
+constexpr size_t Rows = 24;
+constexpr size_t Columns = 28;
+constexpr size_t DataType = 32;
+constexpr size_t Type = 34;
+constexpr size_t Endian = 35;
+constexpr size_t Factor = 40;
+constexpr size_t Offset = 48;
+constexpr size_t HardMin = 56;
+constexpr size_t HardMax = 64;
+constexpr size_t WarningMin = 72;
+constexpr size_t WarningMax = 80;
+constexpr size_t XAxis = 88;
+constexpr size_t YAxis = XAxis + AxisSize;
+} // namespace Record
+
+namespace Axis {
+constexpr size_t Name = 0;
+constexpr size_t Unit = 8;
+constexpr size_t Address = 16;
+constexpr size_t Count = 24;
+constexpr size_t DataType = 28;
+constexpr size_t Endian = 30;
+constexpr size_t Type = 31;
+constexpr size_t Factor = 32;
+constexpr size_t Offset = 40;
+} // namespace Axis
+
+template<typename T>
+T load(const uint8_t* data) {
+    return EndiannessConverter::readLittleEndian<T>(data);
+}
+
+double loadDouble(const uint8_t* data) {
+    return std::bit_cast<double>(load<uint64_t>(data));
+}
+
+class Writer {
+public:
+    explicit Writer(size_t size) : m_bytes(size, 0) {}
+    
+    template<typename T>
+    void put(size_t offset, T value) {
+        EndiannessConverter::writeLittleEndian(m_bytes.data() + offset, value);
+    }
+    
+    void putDouble(size_t offset, double value) { put(offset, std::bit_cast<uint64_t>(value)); }
+    
+    // Strings are stored once however many records use them
+    void putString(size_t offset, const std::string& text) {
+        auto [it, added] = m_stringOffsets.try_emplace(text, static_cast<uint32_t>(m_strings.size()));
+        if (added) {
+            m_strings += text;
+        }
+        put(offset, it->second);
+        put(offset + 4, static_cast<uint32_t>(text.size()));
+    }
+    
+    std::vector<uint8_t>& bytes() { return m_bytes; }
+    const std::string& strings() const { return m_strings; }
+
+private:
+    std::vector<uint8_t> m_bytes;
+    std::string m_strings;
+    std::unordered_map<std::string, uint32_t> m_stringOffsets;
+};
+
+void putAxis(Writer& writer, size_t offset, const MapAxis& axis) {
+    writer.putString(offset + Axis::Name, axis.name());
+    writer.putString(offset + Axis::Unit, axis.unit());
+    writer.put(offset + Axis::Address, static_cast<uint64_t>(axis.address()));
+    writer.put(offset + Axis::Count, static_cast<uint32_t>(axis.count()));
+    writer.put(offset + Axis::DataType, axis.dataType());
+    writer.put(offset + Axis::Endian, static_cast<uint8_t>(axis.endianness() == Endianness::Big));
+    writer.put(offset + Axis::Type, static_cast<uint8_t>(axis.type()));
+    writer.putDouble(offset + Axis::Factor, axis.factor());
+    writer.putDouble(offset + Axis::Offset, axis.offset());
+}
+
+bool fitsRecord(const MapDefinition& map) {
+    constexpr size_t Max = std::numeric_limits<uint32_t>::max();
+    return map.rows() <= Max && map.columns() <= Max && map.xAxis().count() <= Max && map.yAxis().count() <= Max;
+}
+
+} // namespace
+
+bool MapPackFile::open(const std::string& filepath, std::string& error) {
+    close();
+    // Records are read on demand in any order, so no access hint
+    if (!m_mapper.open(filepath, true)) {
+        error = "Cannot open " + filepath;
+        return false;
+    }
+    const uint8_t* data = m_mapper.data();
+    size_t size = m_mapper.size();
+    if (size < HeaderSize || std::memcmp(data, Magic, sizeof(Magic)) != 0) {
+        error = filepath + " is not a binary map pack";
+        close();
+        return false;
+    }
+    if (load<uint32_t>(data + Header::Version) != Version ||
+        load<uint32_t>(data + Header::RecordSize) != RecordSize) {
+        error = filepath + " was written by an unsupported version";
+        close();
+        return false;
+    }
+    
+    // Every section must lie inside the file; records and strings are then
+    // read without further size checks except string references
+    uint64_t count = load<uint32_t>(data + Header::MapCount);
+    uint64_t tagCount = load<uint32_t>(data + Header::TagCount);
+    m_records = load<uint64_t>(data + Header::Records);
+    m_nameIndex = load<uint64_t>(data + Header::NameIndex);
+    m_addressIndex = load<uint64_t>(data + Header::AddressIndex);
+    m_strings = load<uint64_t>(data + Header::Strings);
+    m_stringsSize = load<uint64_t>(data + Header::StringsSize);
+    uint64_t fingerprintCount = load<uint32_t>(data + Header::FingerprintCount);
+    uint64_t fingerprints = load<uint64_t>(data + Header::Fingerprints);
+    auto inside = [size](uint64_t offset, uint64_t length) { return offset <= size && length <= size - offset; };
+    if (!inside(HeaderSize, (InfoStrings + tagCount) * StringRefSize) ||
+        !inside(m_records, count * RecordSize) || !inside(m_nameIndex, count * 4) ||
+        !inside(m_addressIndex, count * 4) || !inside(m_strings, m_stringsSize) ||
+        !inside(fingerprints, fingerprintCount * 8)) {
+        error = filepath + " is truncated or damaged";
+        close();
+        return false;
+    }
+    m_mapCount = static_cast<size_t>(count);
+    
+    const uint8_t* info = data + HeaderSize;
+    std::string* fields[InfoStrings] = {&m_info.name, &m_info.version, &m_info.author, &m_info.description,
+                                        &m_info.ecuName, &m_info.ecuId, &m_info.fileHash};
+    for (size_t i = 0; i < InfoStrings; ++i) {
+        *fields[i] = std::string(string(info + i * StringRefSize));
+    }
+    for (size_t i = 0; i < tagCount; ++i) {
+        m_info.tags.emplace_back(string(info + (InfoStrings + i) * StringRefSize));
+    }
+    m_info.fingerprints.resize(static_cast<size_t>(fingerprintCount));
+    for (size_t i = 0; i < fingerprintCount; ++i) {
+        m_info.fingerprints[i] = load<uint64_t>(data + fingerprints + i * 8);
+    }
+    return true;
+}
+
+void MapPackFile::close() {
+    m_mapper.close();
+    m_info = MapPackInfo();
+    m_mapCount = 0;
+    m_records = m_nameIndex = m_addressIndex = m_strings = m_stringsSize = 0;
+}
+
+const uint8_t* MapPackFile::record(size_t index) const {
+    return m_mapper.data() + m_records + index * RecordSize;
+}
+
+// A reference outside the string table reads as empty
+std::string_view MapPackFile::string(const uint8_t* reference) const {
+    uint64_t offset = load<uint32_t>(reference);
+    uint64_t length = load<uint32_t>(reference + 4);
+    if (offset > m_stringsSize || length > m_stringsSize - offset) {
+        return {};
+    }
+    return std::string_view(reinterpret_cast<const char*>(m_mapper.data() + m_strings + offset),
+                            static_cast<size_t>(length));
+}
+
+// A record number outside the pack reads as 0
+uint32_t MapPackFile::indexEntry(uint64_t section, size_t position) const {
+    uint32_t entry = load<uint32_t>(m_mapper.data() + section + position * 4);
+    return entry < m_mapCount ? entry : 0;
+}
+
+std::string_view MapPackFile::mapName(size_t index) const {
+    return index < m_mapCount ? string(record(index) + Record::Name) : std::string_view();
+}
+
+size_t MapPackFile::mapAddress(size_t index) const {
+    return index < m_mapCount ? static_cast<size_t>(load<uint64_t>(record(index) + Record::Address)) : 0;
+}
+
+MapDefinition MapPackFile::map(size_t index) const {
+    MapDefinition map;
+    if (index >= m_mapCount) {
+        return map;
+    }
+    const uint8_t* r = record(index);
+    map.setName(std::string(string(r + Record::Name)));
+    map.setUnit(std::string(string(r + Record::Unit)));
+    map.setAddress(static_cast<size_t>(load<uint64_t>(r + Record::Address)));
+    map.setRows(load<uint32_t>(r + Record::Rows));
+    map.setColumns(load<uint32_t>(r + Record::Columns));
+    map.setDataType(load<uint16_t>(r + Record::DataType));
+    map.setType(r[Record::Type] ? MapType::Map3D : MapType::Map2D);
+    map.setEndianness(r[Record::Endian] ? Endianness::Big : Endianness::Little);
+    map.setFactor(loadDouble(r + Record::Factor));
+    map.setOffset(loadDouble(r + Record::Offset));
+    map.setHardMin(loadDouble(r + Record::HardMin));
+    map.setHardMax(loadDouble(r + Record::HardMax));
+    map.setWarningMin(loadDouble(r + Record::WarningMin));
+    map.setWarningMax(loadDouble(r + Record::WarningMax));
+    
+    for (size_t offset : {Record::XAxis, Record::YAxis}) {
+        const uint8_t* a = r + offset;
+        MapAxis& axis = offset == Record::XAxis ? map.xAxis() : map.yAxis();
+        axis.setName(std::string(string(a + Axis::Name)));
+        axis.setUnit(std::string(string(a + Axis::Unit)));
+        axis.setAddress(static_cast<size_t>(load<uint64_t>(a + Axis::Address)));
+        axis.setCount(load<uint32_t>(a + Axis::Count));
+        axis.setDataType(load<uint16_t>(a + Axis::DataType));
+        axis.setEndianness(a[Axis::Endian] ? Endianness::Big : Endianness::Little);
+        axis.setType(static_cast<AxisType>(std::min<uint8_t>(a[Axis::Type], static_cast<uint8_t>(AxisType::ZAxis))));
+        axis.setFactor(loadDouble(a + Axis::Factor));
+        axis.setOffset(loadDouble(a + Axis::Offset));
+    }
+    return map;
+}
+
+bool MapPackFile::findByName(std::string_view name, size_t& index) const {
+    size_t low = 0;
+    size_t high = m_mapCount;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (mapName(indexEntry(m_nameIndex, middle)) < name) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low == m_mapCount || mapName(indexEntry(m_nameIndex, low)) != name) {
+        return false;
+    }
+    index = indexEntry(m_nameIndex, low);
+    return true;
+}
+
+std::vector<size_t> MapPackFile::findByAddress(size_t begin, size_t end) const {
+    size_t low = 0;
+    size_t high = m_mapCount;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (mapAddress(indexEntry(m_addressIndex, middle)) < begin) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    std::vector<size_t> found;
+    for (; low < m_mapCount; ++low) {
+        size_t index = indexEntry(m_addressIndex, low);
+        if (mapAddress(index) >= end) {
+            break;
+        }
+        found.push_back(index);
+    }
+    return found;
+}
+
+void MapPackFile::toMapPack(MapPack& pack) const {
+    pack.info() = m_info;
+    pack.maps().clear();
+    pack.maps().reserve(m_mapCount);
+    for (size_t i = 0; i < m_mapCount; ++i) {
+        pack.maps().push_back(map(i));
+    }
+}
+
+bool MapPackFile::write(const MapPack& pack, const std::string& filepath, std::string& error) {
+    const std::vector<MapDefinition>& maps = pack.maps();
+    const MapPackInfo& info = pack.info();
+    if (maps.size() > std::numeric_limits<uint32_t>::max()) {
+        error = "Too many maps for a binary pack";
+        return false;
+    }
+    size_t count = maps.size();
+    size_t records = (HeaderSize + (InfoStrings + info.tags.size()) * StringRefSize + 7) / 8 * 8;
+    size_t nameIndex = records + count * RecordSize;
+    size_t addressIndex = nameIndex + count * 4;
+    size_t fingerprints = (addressIndex + count * 4 + 7) / 8 * 8;
+    size_t strings = fingerprints + info.fingerprints.size() * 8;
+    
+    Writer writer(strings);
+    std::memcpy(writer.bytes().data(), Magic, sizeof(Magic));
+    writer.put(Header::Version, Version);
+    writer.put(Header::MapCount, static_cast<uint32_t>(count));
+    writer.put(Header::RecordSize, static_cast<uint32_t>(RecordSize));
+    writer.put(Header::TagCount, static_cast<uint32_t>(info.tags.size()));
+    writer.put(Header::Records, static_cast<uint64_t>(records));
+    writer.put(Header::NameIndex, static_cast<uint64_t>(nameIndex));
+    writer.put(Header::AddressIndex, static_cast<uint64_t>(addressIndex));
+    writer.put(Header::Strings, static_cast<uint64_t>(strings));
+    writer.put(Header::FingerprintCount, static_cast<uint32_t>(info.fingerprints.size()));
+    writer.put(Header::Fingerprints, static_cast<uint64_t>(fingerprints));
+    for (size_t i = 0; i < info.fingerprints.size(); ++i) {
+        writer.put(fingerprints + i * 8, info.fingerprints[i]);
+    }
+    
+    const std::string* fields[InfoStrings] = {&info.name, &info.version, &info.author, &info.description,
+                                              &info.ecuName, &info.ecuId, &info.fileHash};
+    for (size_t i = 0; i < InfoStrings; ++i) {
+        writer.putString(HeaderSize + i * StringRefSize, *fields[i]);
+    }
+    for (size_t i = 0; i < info.tags.size(); ++i) {
+        writer.putString(HeaderSize + (InfoStrings + i) * StringRefSize, info.tags[i]);
+    }
+    
+    for (size_t i = 0; i < count; ++i) {
+        const MapDefinition& map = maps[i];
+        if (!fitsRecord(map)) {
+            error = "Map " + map.name() + " is too large for a binary pack";
+            return false;
+        }
+        size_t r = records + i * RecordSize;
+        writer.putString(r + Record::Name, map.name());
+        writer.putString(r + Record::Unit, map.unit());
+        writer.put(r + Record::Address, static_cast<uint64_t>(map.address()));
+        writer.put(r + Record::Rows, static_cast<uint32_t>(map.rows()));
+        writer.put(r + Record::Columns, static_cast<uint32_t>(map.columns()));
+        writer.put(r + Record::DataType, map.dataType());
+        writer.put(r + Record::Type, static_cast<uint8_t>(map.type() == MapType::Map3D));
+        writer.put(r + Record::Endian, static_cast<uint8_t>(map.endianness() == Endianness::Big));
+        writer.putDouble(r + Record::Factor, map.factor());
+        writer.putDouble(r + Record::Offset, map.offset());
+        writer.putDouble(r + Record::HardMin, map.hardMin());
+        writer.putDouble(r + Record::HardMax, map.hardMax());
+        writer.putDouble(r + Record::WarningMin, map.warningMin());
+        writer.putDouble(r + Record::WarningMax, map.warningMax());
+        putAxis(writer, r + Record::XAxis, map.xAxis());
+        putAxis(writer, r + Record::YAxis, map.yAxis());
+    }
+    
+    // Name order compares the stored bytes, the order findByName searches in
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0u);
+    std::vector<std::string> names(count);
+    for (size_t i = 0; i < count; ++i) {
+        names[i] = maps[i].name();
+    }
+    std::stable_sort(order.begin(), order.end(), [&names](uint32_t a, uint32_t b) { return names[a] < names[b]; });
+    for (size_t i = 0; i < count; ++i) {
+        writer.put(nameIndex + i * 4, order[i]);
+    }
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(),
+                     [&maps](uint32_t a, uint32_t b) { return maps[a].address() < maps[b].address(); });
+    for (size_t i = 0; i < count; ++i) {
+        writer.put(addressIndex + i * 4, order[i]);
+    }
+    
+    if (writer.strings().size() > std::numeric_limits<uint32_t>::max()) {
+        error = "Too much text for a binary pack";
+        return false;
+    }
+    writer.put(Header::StringsSize, static_cast<uint64_t>(writer.strings().size()));
+    
+    // Written to a temporary file and renamed over the old one, so a mapped
+    // copy of the old pack is never truncated under its reader
+    QSaveFile file(QString::fromStdString(filepath));
+    qint64 stringsSize = static_cast<qint64>(writer.strings().size());
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(reinterpret_cast<const char*>(writer.bytes().data()), static_cast<qint64>(strings)) !=
+            static_cast<qint64>(strings) ||
+        file.write(writer.strings().data(), stringsSize) != stringsSize || !file.commit()) {
+        error = "Cannot write " + filepath + ": " + file.errorString().toStdString();
+        return false;
+    }
+    return true;
+}
+
+bool MapPackFile::isBinaryPack(const std::string& filepath) {
+    std::ifstream file(filepath, std::ios::binary);
+    char magic[sizeof(Magic)] = {};
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, Magic, sizeof(Magic)) == 0;
+}
+
+} // namespace WinMMM10
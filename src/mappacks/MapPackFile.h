@@ -0,0 +1,72 @@
+#pragma once
+
+#include "MapPack.h"
+#include "../binary/MemoryMapper.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace WinMMM10 {
+
+// Read-only view of a binary map pack.
+//
+// The file holds a header, the pack info, one fixed-size record per map, two
+// arrays of record numbers sorted by map name and by address, the content
+// fingerprints of the pack's binary, and a table of the strings the records
+// point into. All numbers are little-endian and
+// doubles are stored bit for bit, so a pack reads back exactly as written.
+//
+// open() maps the file and checks the header and section bounds only, so
+// opening costs the same for any number of maps. Names and addresses are read
+// straight from the mapping; a MapDefinition is built only when asked for.
+class MapPackFile {
+public:
+    static constexpr char Magic[8] = {'W', 'M', 'M', '1', '0', 'P', 'K', '\0'};
+    static constexpr uint32_t Version = 1;
+    
+    MapPackFile() = default;
+    MapPackFile(const MapPackFile&) = delete;
+    MapPackFile& operator=(const MapPackFile&) = delete;
+    
+    bool open(const std::string& filepath, std::string& error);
+    void close();
+    bool isOpen() const { return m_mapper.isOpen(); }
+    
+    const MapPackInfo& info() const { return m_info; }
+    size_t mapCount() const { return m_mapCount; }
+    
+    // Reads one field without building the whole definition
+    std::string_view mapName(size_t index) const;
+    size_t mapAddress(size_t index) const;
+    MapDefinition map(size_t index) const;
+    
+    // Binary search of the name index
+    bool findByName(std::string_view name, size_t& index) const;
+    // Maps starting in [begin, end), in address order
+    std::vector<size_t> findByAddress(size_t begin, size_t end) const;
+    
+    // Builds every definition
+    void toMapPack(MapPack& pack) const;
+    
+    static bool write(const MapPack& pack, const std::string& filepath, std::string& error);
+    // True if the file starts with the binary pack magic
+    static bool isBinaryPack(const std::string& filepath);
+
+private:
+    const uint8_t* record(size_t index) const;
+    std::string_view string(const uint8_t* reference) const;
+    uint32_t indexEntry(uint64_t section, size_t position) const;
+    
+    MemoryMapper m_mapper;
+    MapPackInfo m_info;
+    size_t m_mapCount{0};
+    uint64_t m_records{0};
+    uint64_t m_nameIndex{0};
+    uint64_t m_addressIndex{0};
+    uint64_t m_strings{0};
+    uint64_t m_stringsSize{0};
+};
+
+} // namespace WinMMM10
@@ -0,0 +1,177 @@
+#include "MapPackIndex.h"
+#include "MapPack.h"
+#include "../binary/HashService.h"
+#include <algorithm>
+#include <cstring>
+
+namespace WinMMM10 {
+
+namespace {
+
+bool isUniform(const uint8_t* block, size_t size) {
+    return std::memcmp(block, block + 1, size - 1) == 0;
+}
+
+bool isPrintable(uint8_t byte) {
+    return byte >= 0x20 && byte < 0x7F;
+}
+
+} // namespace
+
+std::vector<uint64_t> MapPackIndex::fingerprint(const uint8_t* data, size_t size) {
+    std::vector<uint64_t> hashes;
+    if (!data) {
+        return hashes;
+    }
+    hashes.reserve(size / BlockSize);
+    for (size_t offset = 0; offset + BlockSize <= size; offset += BlockSize) {
+        if (!isUniform(data + offset, BlockSize)) {
+            hashes.push_back(HashService::xxh3(data + offset, BlockSize, offset));
+        }
+    }
+    std::sort(hashes.begin(), hashes.end());
+    hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+    if (hashes.size() > SketchSize) {
+        hashes.resize(SketchSize);
+    }
+    return hashes;
+}
+
+void MapPackIndex::add(size_t pack, const MapPackInfo& info) {
+    uint32_t id = static_cast<uint32_t>(pack);
+    m_packCount = std::max(m_packCount, pack + 1);
+    if (m_sketchSizes.size() <= pack) {
+        m_sketchSizes.resize(pack + 1, 0);
+    }
+    
+    // Sketches from other tools may be longer or unsorted; keep the same bottom-k
+    std::vector<uint64_t> sketch = info.fingerprints;
+    std::sort(sketch.begin(), sketch.end());
+    sketch.erase(std::unique(sketch.begin(), sketch.end()), sketch.end());
+    if (sketch.size() > SketchSize) {
+        sketch.resize(SketchSize);
+    }
+    m_sketchSizes[pack] = static_cast<uint32_t>(sketch.size());
+    for (uint64_t hash : sketch) {
+        m_byFingerprint[hash].push_back(id);
+    }
+    
+    if (!info.fileHash.empty()) {
+        m_byFileHash[info.fileHash].push_back(id);
+    }
+    if (info.ecuId.size() >= MinEcuIdLength) {
+        m_byEcuId[info.ecuId].push_back(id);
+        auto length = std::lower_bound(m_ecuIdLengths.begin(), m_ecuIdLengths.end(), info.ecuId.size());
+        if (length == m_ecuIdLengths.end() || *length != info.ecuId.size()) {
+            m_ecuIdLengths.insert(length, info.ecuId.size());
+        }
+    }
+}
+
+void MapPackIndex::clear() {
+    m_packCount = 0;
+    m_sketchSizes.clear();
+    m_byFingerprint.clear();
+    m_byFileHash.clear();
+    m_byEcuId.clear();
+    m_ecuIdLengths.clear();
+}
+
+std::vector<MapPackMatch> MapPackIndex::rank(const uint8_t* data, size_t size, std::string_view fileHash,
+                                             size_t limit) const {
+    std::vector<uint32_t> shared(m_packCount, 0);
+    std::vector<uint8_t> flags(m_packCount, 0); // 1 = file hash, 2 = ECU id
+    std::vector<uint32_t> touched;
+    auto touch = [&](uint32_t pack) {
+        if (shared[pack] == 0 && flags[pack] == 0) {
+            touched.push_back(pack);
+        }
+    };
+    
+    std::vector<uint64_t> sketch = fingerprint(data, size);
+    for (uint64_t hash : sketch) {
+        auto packs = m_byFingerprint.find(hash);
+        if (packs != m_byFingerprint.end()) {
+            for (uint32_t pack : packs->second) {
+                touch(pack);
+                ++shared[pack];
+            }
+        }
+    }
+    
+    if (!fileHash.empty()) {
+        auto packs = m_byFileHash.find(fileHash);
+        if (packs != m_byFileHash.end()) {
+            for (uint32_t pack : packs->second) {
+                touch(pack);
+                flags[pack] |= 1;
+            }
+        }
+    }
+    
+    // Every window of an indexed id length inside runs of printable bytes.
+    // A run long enough to hold an id covers one of every shortest-th bytes,
+    // so only those are probed and the run is grown from there.
+    if (data && !m_ecuIdLengths.empty()) {
+        size_t shortest = m_ecuIdLengths.front();
+        size_t next = 0; // End of the last run found
+        for (size_t probe = shortest - 1; probe < size; probe += shortest) {
+            if (probe < next || !isPrintable(data[probe])) {
+                continue;
+            }
+            size_t begin = probe;
+            while (begin > next && isPrintable(data[begin - 1])) {
+                --begin;
+            }
+            size_t end = probe + 1;
+            while (end < size && isPrintable(data[end])) {
+                ++end;
+            }
+            next = end;
+            
+            const char* text = reinterpret_cast<const char*>(data + begin);
+            size_t run = end - begin;
+            for (size_t length : m_ecuIdLengths) {
+                if (length > run) {
+                    break;
+                }
+                for (size_t start = 0; start + length <= run; ++start) {
+                    auto packs = m_byEcuId.find(std::string_view(text + start, length));
+                    if (packs == m_byEcuId.end()) {
+                        continue;
+                    }
+                    for (uint32_t pack : packs->second) {
+                        touch(pack);
+                        flags[pack] |= 2;
+                    }
+                }
+            }
+        }
+    }
+    
+    std::vector<MapPackMatch> matches;
+    matches.reserve(touched.size());
+    for (uint32_t pack : touched) {
+        MapPackMatch match;
+        match.pack = pack;
+        size_t compared = std::min<size_t>(m_sketchSizes[pack], sketch.size());
+        match.similarity = compared > 0 ? std::min(1.0, static_cast<double>(shared[pack]) / compared) : 0.0;
+        match.fileHashMatch = flags[pack] & 1;
+        match.ecuIdMatch = flags[pack] & 2;
+        match.score = match.fileHashMatch ? 1.0 : 0.75 * match.similarity + (match.ecuIdMatch ? 0.25 : 0.0);
+        matches.push_back(match);
+    }
+    
+    auto better = [](const MapPackMatch& a, const MapPackMatch& b) {
+        return a.score != b.score ? a.score > b.score : a.pack < b.pack;
+    };
+    if (matches.size() > limit) {
+        std::partial_sort(matches.begin(), matches.begin() + limit, matches.end(), better);
+        matches.resize(limit);
+    } else {
+        std::sort(matches.begin(), matches.end(), better);
+    }
+    return matches;
+}
+
+} // namespace WinMMM10
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace WinMMM10 {
+
+struct MapPackInfo;
+
+struct MapPackMatch {
+    size_t pack{0};            // Id the pack was added with
+    double score{0.0};         // 1 for the very binary the pack was made from
+    double similarity{0.0};    // Share of content fingerprints in common
+    bool fileHashMatch{false};
+    bool ecuIdMatch{false};    // The pack's ECU id occurs as text in the binary
+};
+
+// Finds the installed map packs that fit an opened binary.
+//
+// Packs are indexed by file hash, by ECU id and by content fingerprints: the
+// XXH3 hashes of the binary's 256-byte blocks, seeded with the block offset,
+// of which only the SketchSize smallest are kept. Blocks of one repeated
+// byte (erased flash, zero fill) are left out. Editing maps changes only the
+// blocks they occupy, so a tuned binary still shares most of its sketch with
+// the stock one, while another software version shares almost nothing.
+//
+// rank() looks up each of the binary's fingerprints and ECU id candidates in
+// hash tables, so its cost depends on the binary and the number of hits, not
+// on the number of packs.
+class MapPackIndex {
+public:
+    static constexpr size_t BlockSize = 256;
+    static constexpr size_t SketchSize = 128;
+    static constexpr size_t MinEcuIdLength = 4;
+    
+    static std::vector<uint64_t> fingerprint(const uint8_t* data, size_t size);
+    
+    void add(size_t pack, const MapPackInfo& info);
+    void clear();
+    size_t size() const { return m_packCount; }
+    
+    // Best matches first, at most limit of them; fileHash is the SHA-256 hex
+    // of the binary from HashService::fileSha256(), or empty to skip that check
+    std::vector<MapPackMatch> rank(const uint8_t* data, size_t size, std::string_view fileHash,
+                                   size_t limit = 10) const;
+
+private:
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view text) const { return std::hash<std::string_view>{}(text); }
+    };
+    using StringTable = std::unordered_map<std::string, std::vector<uint32_t>, StringHash, std::equal_to<>>;
+    
+    size_t m_packCount{0};
+    std::vector<uint32_t> m_sketchSizes; // By pack id
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_byFingerprint;
+    StringTable m_byFileHash;
+    StringTable m_byEcuId;
+    std::vector<size_t> m_ecuIdLengths; // Distinct, ascending
+};
+
+} // namespace WinMMM10
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace WinMMM10 {
+
+// Segment of an ascending axis containing v: the largest i in [0, n-2] with
+// axis[i] <= v, or 0 below the axis. The loop has a fixed trip count and the
+// select compiles to a conditional move, so there is no data-dependent branch.
+inline size_t findSegment(const double* axis, size_t n, double v) {
+    const double* base = axis;
+    size_t length = n - 1;
+    while (length > 1) {
+        size_t half = length / 2;
+        base = (base[half] <= v) ? base + half : base;
+        length -= half;
+    }
+    return static_cast<size_t>(base - axis);
+}
+
+// Locates each input on an ascending axis as a segment index and a 0..1
+// weight within it. Inputs beyond either end clamp to the end breakpoint, as
+// ECU table lookups do. A single-point axis yields index 0, weight 0.
+inline void locateBreakpoints(std::span<const double> axis, std::span<const double> inputs,
+                              uint32_t* index, double* weight) {
+    size_t n = axis.size();
+    if (n < 2) {
+        std::fill_n(index, inputs.size(), 0u);
+        std::fill_n(weight, inputs.size(), 0.0);
+        return;
+    }
+    
+    const double* a = axis.data();
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        size_t segment = findSegment(a, n, inputs[i]);
+        double span = a[segment + 1] - a[segment];
+        double t = span > 0.0 ? (inputs[i] - a[segment]) / span : 0.0;
+        index[i] = static_cast<uint32_t>(segment);
+        weight[i] = std::min(std::max(t, 0.0), 1.0);
+    }
+}
+
+// The map's axis if it has one breakpoint per cell, otherwise 0..count-1 so
+// lookups fall back to fractional indices
+inline std::span<const double> axisOrIndices(const std::vector<double>& axis, size_t count,
+                                             std::vector<double>& scratch) {
+    if (axis.size() == count) {
+        return axis;
+    }
+    scratch.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        scratch[i] = static_cast<double>(i);
+    }
+    return scratch;
+}
+
+} // namespace WinMMM10
@@ -0,0 +1,183 @@
+#include "CubicSpline.h"
+#include "BreakpointSearch.h"
+#include <algorithm>
+#include <cmath>
+
+namespace WinMMM10 {
+
+bool CubicSpline::isAscending(std::span<const double> x) {
+    for (size_t i = 1; i < x.size(); ++i) {
+        if (!(x[i] > x[i - 1])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CubicSpline::fit(std::span<const double> x, std::span<const double> y, Kind kind) {
+    if (x.empty() || x.size() != y.size() || !isAscending(x)) {
+        m_x.clear();
+        m_y.clear();
+        m_slope.clear();
+        return false;
+    }
+    
+    m_x.assign(x.begin(), x.end());
+    m_y.assign(y.begin(), y.end());
+    m_slope.assign(x.size(), 0.0);
+    if (x.size() == 2) {
+        // Two knots: both kinds reduce to the straight line
+        m_slope[0] = m_slope[1] = (m_y[1] - m_y[0]) / (m_x[1] - m_x[0]);
+    } else if (x.size() > 2) {
+        if (kind == Kind::Natural) {
+            fitNatural();
+        } else {
+            fitMonotone();
+        }
+    }
+    return true;
+}
+
+void CubicSpline::fitNatural() {
+    // Second derivatives M from the tridiagonal system
+    //   h[i-1] M[i-1] + 2 (h[i-1] + h[i]) M[i] + h[i] M[i+1] = 6 (d[i] - d[i-1])
+    // with M[0] = M[n-1] = 0, solved by the Thomas algorithm
+    size_t n = m_x.size();
+    m_work.assign(2 * n, 0.0);
+    double* upper = m_work.data();     // Modified super-diagonal
+    double* second = m_work.data() + n; // Right-hand side, then M
+    
+    for (size_t i = 1; i + 1 < n; ++i) {
+        double h0 = m_x[i] - m_x[i - 1];
+        double h1 = m_x[i + 1] - m_x[i];
+        double rhs = 6.0 * ((m_y[i + 1] - m_y[i]) / h1 - (m_y[i] - m_y[i - 1]) / h0);
+        double diagonal = 2.0 * (h0 + h1) - h0 * upper[i - 1];
+        upper[i] = h1 / diagonal;
+        second[i] = (rhs - h0 * second[i - 1]) / diagonal;
+    }
+    second[n - 1] = 0.0;
+    for (size_t i = n - 2; i > 0; --i) {
+        second[i] -= upper[i] * second[i + 1];
+    }
+    
+    // Knot slopes reproduce the same cubic in Hermite form
+    for (size_t i = 0; i + 1 < n; ++i) {
+        double h = m_x[i + 1] - m_x[i];
+        m_slope[i] = (m_y[i + 1] - m_y[i]) / h - h * (2.0 * second[i] + second[i + 1]) / 6.0;
+    }
+    double h = m_x[n - 1] - m_x[n - 2];
+    m_slope[n - 1] = (m_y[n - 1] - m_y[n - 2]) / h + h * (second[n - 2] + 2.0 * second[n - 1]) / 6.0;
+}
+
+void CubicSpline::fitMonotone() {
+    size_t n = m_x.size();
+    m_work.resize(n - 1);
+    double* delta = m_work.data();
+    for (size_t i = 0; i + 1 < n; ++i) {
+        delta[i] = (m_y[i + 1] - m_y[i]) / (m_x[i + 1] - m_x[i]);
+    }
+    
+    m_slope[0] = delta[0];
+    m_slope[n - 1] = delta[n - 2];
+    for (size_t i = 1; i + 1 < n; ++i) {
+        // Flat at local extrema, otherwise the mean of the neighbouring secants
+        m_slope[i] = delta[i - 1] * delta[i] > 0.0 ? 0.5 * (delta[i - 1] + delta[i]) : 0.0;
+    }
+    
+    // Fritsch-Carlson: keep each segment's slopes inside the monotonicity region
+    for (size_t i = 0; i + 1 < n; ++i) {
+        if (delta[i] == 0.0) {
+            m_slope[i] = 0.0;
+            m_slope[i + 1] = 0.0;
+            continue;
+        }
+        double a = m_slope[i] / delta[i];
+        double b = m_slope[i + 1] / delta[i];
+        double r = a * a + b * b;
+        if (r > 9.0) {
+            double tau = 3.0 / std::sqrt(r);
+            m_slope[i] = tau * a * delta[i];
+            m_slope[i + 1] = tau * b * delta[i];
+        }
+    }
+}
+
+void CubicSpline::evaluate(const uint32_t* index, const double* weight, size_t count, double* out) const {
+    if (m_y.size() < 2) {
+        std::fill_n(out, count, m_y.empty() ? 0.0 : m_y[0]);
+        return;
+    }
+    
+    for (size_t k = 0; k < count; ++k) {
+        size_t i = index[k];
+        double t = weight[k];
+        double h = m_x[i + 1] - m_x[i];
+        double t2 = t * t;
+        double t3 = t2 * t;
+        double h00 = 2.0 * t3 - 3.0 * t2 + 1.0;
+        double h10 = t3 - 2.0 * t2 + t;
+        double h01 = 3.0 * t2 - 2.0 * t3;
+        double h11 = t3 - t2;
+        out[k] = h00 * m_y[i] + h01 * m_y[i + 1] + h * (h10 * m_slope[i] + h11 * m_slope[i + 1]);
+    }
+}
+
+void CubicSpline::evaluate(std::span<const double> x, std::span<double> out) const {
+    constexpr size_t BlockSize = 256;
+    uint32_t index[BlockSize];
+    double weight[BlockSize];
+    size_t count = std::min(x.size(), out.size());
+    for (size_t begin = 0; begin < count; begin += BlockSize) {
+        size_t n = std::min(BlockSize, count - begin);
+        locateBreakpoints(m_x, x.subspan(begin, n), index, weight);
+        evaluate(index, weight, n, out.data() + begin);
+    }
+}
+
+double CubicSpline::evaluate(double x) const {
+    double result = 0.0;
+    evaluate(std::span<const double>(&x, 1), std::span<double>(&result, 1));
+    return result;
+}
+
+bool CubicSpline::resample(std::span<const double> source,
+                           std::span<const double> sourceX, std::span<const double> sourceY,
+                           std::span<const double> targetX, std::span<const double> targetY,
+                           std::span<double> out, Kind kind) {
+    size_t sourceRows = sourceY.size();
+    size_t sourceColumns = sourceX.size();
+    size_t targetRows = targetY.size();
+    size_t targetColumns = targetX.size();
+    if (sourceRows == 0 || sourceColumns == 0 || source.size() < sourceRows * sourceColumns ||
+        out.size() < targetRows * targetColumns || !isAscending(sourceX) || !isAscending(sourceY)) {
+        return false;
+    }
+    
+    // Target positions are located once and shared by every row and column fit
+    std::vector<uint32_t> xIndex(targetColumns), yIndex(targetRows);
+    std::vector<double> xWeight(targetColumns), yWeight(targetRows);
+    locateBreakpoints(sourceX, targetX, xIndex.data(), xWeight.data());
+    locateBreakpoints(sourceY, targetY, yIndex.data(), yWeight.data());
+    
+    CubicSpline spline;
+    std::vector<double> rowsOnTargetX(sourceRows * targetColumns);
+    for (size_t r = 0; r < sourceRows; ++r) {
+        spline.fit(sourceX, source.subspan(r * sourceColumns, sourceColumns), kind);
+        spline.evaluate(xIndex.data(), xWeight.data(), targetColumns, rowsOnTargetX.data() + r * targetColumns);
+    }
+    
+    std::vector<double> column(sourceRows), result(targetRows);
+    for (size_t c = 0; c < targetColumns; ++c) {
+        for (size_t r = 0; r < sourceRows; ++r) {
+            column[r] = rowsOnTargetX[r * targetColumns + c];
+        }
+        spline.fit(sourceY, column, kind);
+        spline.evaluate(yIndex.data(), yWeight.data(), targetRows, result.data());
+        for (size_t r = 0; r < targetRows; ++r) {
+            out[r * targetColumns + c] = result[r];
+        }
+    }
+    return true;
+}
+
+} // namespace WinMMM10
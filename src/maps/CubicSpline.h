@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace WinMMM10 {
+
+// Piecewise cubic through (x, y) knots, stored as values and slopes at each
+// knot (Hermite form) so both spline kinds evaluate the same way. Fitting
+// solves the coefficient system once; the spline can then be evaluated any
+// number of times. Refitting reuses the object's buffers, so one instance can
+// be fitted row after row without allocating. Evaluation outside the knots
+// clamps to the end values, as ECU lookups do.
+class CubicSpline {
+public:
+    enum class Kind {
+        Natural,  // C2-smooth, zero curvature at the ends; may overshoot
+        Monotone  // Fritsch-Carlson; never overshoots between knots
+    };
+    
+    // False if x is not strictly ascending or the sizes differ
+    bool fit(std::span<const double> x, std::span<const double> y, Kind kind = Kind::Natural);
+    size_t size() const { return m_y.size(); }
+    
+    double evaluate(double x) const;
+    void evaluate(std::span<const double> x, std::span<double> out) const;
+    // Evaluates at positions already located on the knots with locateBreakpoints(),
+    // so a set of positions shared by many fits is only searched once
+    void evaluate(const uint32_t* index, const double* weight, size_t count, double* out) const;
+    
+    static bool isAscending(std::span<const double> x);
+    
+    // Tensor-product spline surface: each source row is fitted along x and
+    // evaluated at targetX, then each resulting column is fitted along y and
+    // evaluated at targetY. Axes must be strictly ascending.
+    static bool resample(std::span<const double> source,
+                         std::span<const double> sourceX, std::span<const double> sourceY,
+                         std::span<const double> targetX, std::span<const double> targetY,
+                         std::span<double> out, Kind kind = Kind::Natural);
+
+private:
+    void fitNatural();
+    void fitMonotone();
+    
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_slope;
+    std::vector<double> m_work; // Tridiagonal solver scratch
+};
+
+} // namespace WinMMM10
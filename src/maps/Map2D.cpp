@@ -1,5 +1,6 @@
 #include "Map2D.h"
 #include "ScalingEngine.h"
+#include "BreakpointSearch.h"
 #include "binary/Endianness.h"
 #include "../core/SafeModeManager.h"
 #include <cstring>
@@ -9,8 +10,11 @@ namespace WinMMM10 {
 
 Map2D::Map2D() = default;
 
-Map2D::Map2D(const MapDefinition& definition) : m_definition(definition) {
-    m_data.resize(definition.columns());
+Map2D::Map2D(const MapDefinition& definition)
+    : m_definition(definition)
+    , m_data(definition.dataType(), definition.columns(), definition.factor(), definition.offset(),
+             definition.endianness())
+{
     if (definition.hasXAxis()) {
         m_xAxis.resize(definition.xAxis().count());
     }
@@ -25,43 +29,18 @@ void Map2D::loadFromBinary(const uint8_t* data, size_t dataSize) {
     
     // Load X axis if present
     if (m_definition.hasXAxis()) {
-        size_t axisCount = m_definition.xAxis().count();
-        m_xAxis.resize(axisCount);
-        size_t axisElementSize = (m_definition.xAxis().dataType() == 1 ? 1 : 
-                                  (m_definition.xAxis().dataType() == 4 ? 4 : 2));
-        
-        for (size_t i = 0; i < axisCount && offset + axisElementSize <= dataSize; ++i) {
-            uint16_t rawValue = 0;
-            if (axisElementSize == 2) {
-                rawValue = EndiannessConverter::readLittleEndian<uint16_t>(data + offset);
-            } else if (axisElementSize == 1) {
-                rawValue = data[offset];
-            } else if (axisElementSize == 4) {
-                float fval = EndiannessConverter::readLittleEndian<float>(data + offset);
-                m_xAxis[i] = ScalingEngine::rawToPhysical(fval, m_definition.xAxis().factor(), m_definition.xAxis().offset());
-                offset += axisElementSize;
-                continue;
-            }
-            m_xAxis[i] = ScalingEngine::rawToPhysical(rawValue, m_definition.xAxis().factor(), m_definition.xAxis().offset());
-            offset += axisElementSize;
-        }
+        const MapAxis& axis = m_definition.xAxis();
+        size_t elementSize = dataTypeSize(axis.dataType());
+        size_t axisCount = std::min(axis.count(), dataSize / elementSize);
+        m_xAxis.assign(axis.count(), 0.0);
+        ScalingEngine::decode(axis.dataType(), data, axisCount, axis.endianness(),
+                              axis.factor(), axis.offset(), m_xAxis.data());
+        offset += axis.count() * elementSize;
     }
     
-    // Load data
-    size_t pointCount = m_definition.columns();
-    m_data.resize(pointCount);
-    size_t elementSize = m_definition.dataSize();
-    
-    for (size_t i = 0; i < pointCount && offset + elementSize <= dataSize; ++i) {
-        if (elementSize == 2) {
-            m_data[i] = EndiannessConverter::readLittleEndian<uint16_t>(data + offset);
-        } else if (elementSize == 1) {
-            m_data[i] = data[offset];
-        } else if (elementSize == 4) {
-            float fval = EndiannessConverter::readLittleEndian<float>(data + offset);
-            m_data[i] = static_cast<uint16_t>(ScalingEngine::rawToPhysical(fval, m_definition.factor(), m_definition.offset()) * 1000.0);
-        }
-        offset += elementSize;
+    // Load data in one typed pass
+    if (offset < dataSize) {
+        m_data.decode(data + offset, dataSize - offset);
     }
 }
 
@@ -74,59 +53,21 @@ void Map2D::writeToBinary(uint8_t* data, size_t dataSize) const {
     
     // Write X axis if present
     if (m_definition.hasXAxis()) {
-        size_t axisCount = m_definition.xAxis().count();
-        size_t axisElementSize = (m_definition.xAxis().dataType() == 1 ? 1 : 
-                                  (m_definition.xAxis().dataType() == 4 ? 4 : 2));
-        
-        for (size_t i = 0; i < axisCount && offset + axisElementSize <= dataSize; ++i) {
-            if (axisElementSize == 2) {
-                uint16_t rawValue = ScalingEngine::physicalToRaw<uint16_t>(m_xAxis[i], m_definition.xAxis().factor(), m_definition.xAxis().offset());
-                EndiannessConverter::writeLittleEndian<uint16_t>(data + offset, rawValue);
-            } else if (axisElementSize == 1) {
-                uint8_t rawValue = ScalingEngine::physicalToRaw<uint8_t>(m_xAxis[i], m_definition.xAxis().factor(), m_definition.xAxis().offset());
-                data[offset] = rawValue;
-            } else if (axisElementSize == 4) {
-                float rawValue = ScalingEngine::physicalToRaw<float>(m_xAxis[i], m_definition.xAxis().factor(), m_definition.xAxis().offset());
-                EndiannessConverter::writeLittleEndian<float>(data + offset, rawValue);
-            }
-            offset += axisElementSize;
-        }
+        const MapAxis& axis = m_definition.xAxis();
+        size_t elementSize = dataTypeSize(axis.dataType());
+        size_t axisCount = std::min(m_xAxis.size(), dataSize / elementSize);
+        ScalingEngine::encode(axis.dataType(), m_xAxis.data(), axisCount, axis.endianness(),
+                              axis.factor(), axis.offset(), data);
+        offset += axis.count() * elementSize;
     }
     
     // Write data
-    size_t pointCount = m_data.size();
-    size_t elementSize = m_definition.dataSize();
-    
-    for (size_t i = 0; i < pointCount && offset + elementSize <= dataSize; ++i) {
-        if (elementSize == 2) {
-            EndiannessConverter::writeLittleEndian<uint16_t>(data + offset, m_data[i]);
-        } else if (elementSize == 1) {
-            data[offset] = static_cast<uint8_t>(m_data[i]);
-        } else if (elementSize == 4) {
-            double physical = getPhysicalValue(i);
-            float rawValue = ScalingEngine::physicalToRaw<float>(physical, m_definition.factor(), m_definition.offset());
-            EndiannessConverter::writeLittleEndian<float>(data + offset, rawValue);
-        }
-        offset += elementSize;
+    if (offset < dataSize) {
+        m_data.encode(data + offset, dataSize - offset);
     }
 }
 
-uint16_t Map2D::getRawValue(size_t index) const {
-    if (index >= m_data.size()) {
-        return 0;
-    }
-    return m_data[index];
-}
-
-void Map2D::setRawValue(size_t index, uint16_t value) {
-    if (index >= m_data.size()) {
-        return;
-    }
-    
-    // Convert to physical value for Safe Mode validation
-    double physicalValue = ScalingEngine::rawToPhysical(value, m_definition.factor(), m_definition.offset());
-    
-    // Safe Mode validation
+bool Map2D::passesSafeMode(double physicalValue) const {
     SafeModeManager::ValueLimits limits;
     limits.hardMin = m_definition.hardMin();
     limits.hardMax = m_definition.hardMax();
@@ -139,51 +80,62 @@ void Map2D::setRawValue(size_t index, uint16_t value) {
     if (result == SafeModeManager::ValidationResult::Blocked) {
         SafeModeManager::instance().logBlock(reason);
         // Don't change the value
-        return;
+        return false;
     }
     
     if (result == SafeModeManager::ValidationResult::Warning) {
         SafeModeManager::instance().logWarning(reason);
         // Allow but warn
     }
-    
-    m_data[index] = value;
+    return true;
 }
 
-double Map2D::getPhysicalValue(size_t index) const {
+double Map2D::getRawValue(size_t index) const {
     if (index >= m_data.size()) {
         return 0.0;
     }
-    return ScalingEngine::rawToPhysical(m_data[index], m_definition.factor(), m_definition.offset());
+    return m_data.rawValue(index);
 }
 
-void Map2D::setPhysicalValue(size_t index, double value) {
+void Map2D::setRawValue(size_t index, double value) {
     if (index >= m_data.size()) {
         return;
     }
     
-    // Safe Mode validation
-    SafeModeManager::ValueLimits limits;
-    limits.hardMin = m_definition.hardMin();
-    limits.hardMax = m_definition.hardMax();
-    limits.warningMin = m_definition.warningMin();
-    limits.warningMax = m_definition.warningMax();
-    
-    std::string reason;
-    auto result = SafeModeManager::instance().validateValue(value, limits, reason);
+    // Convert to physical value for Safe Mode validation
+    double physicalValue = value * m_definition.factor() + m_definition.offset();
+    if (!passesSafeMode(physicalValue)) {
+        return;
+    }
     
-    if (result == SafeModeManager::ValidationResult::Blocked) {
-        SafeModeManager::instance().logBlock(reason);
-        // Don't change the value
+    m_data.setRawValue(index, value);
+}
+
+double Map2D::getPhysicalValue(size_t index) const {
+    if (index >= m_data.size()) {
+        return 0.0;
+    }
+    return m_data.physicalValue(index);
+}
+
+void Map2D::setPhysicalValue(size_t index, double value) {
+    if (index >= m_data.size()) {
         return;
     }
     
-    if (result == SafeModeManager::ValidationResult::Warning) {
-        SafeModeManager::instance().logWarning(reason);
-        // Allow but warn
+    if (!passesSafeMode(value)) {
+        return;
     }
     
-    m_data[index] = ScalingEngine::physicalToRaw<uint16_t>(value, m_definition.factor(), m_definition.offset());
+    m_data.setPhysicalValue(index, value);
+}
+
+size_t Map2D::memoryUsage() const {
+    return sizeof(Map2D)
+         + m_data.memoryUsage()
+         + m_xAxis.capacity() * sizeof(double)
+         + m_definition.name().capacity()
+         + m_definition.unit().capacity();
 }
 
 double Map2D::getXAxisValue(size_t index) const {
@@ -200,5 +152,36 @@ void Map2D::setXAxisValue(size_t index, double value) {
     m_xAxis[index] = value;
 }
 
-} // namespace WinMMM10
+void Map2D::lookup(std::span<const double> x, std::span<double> out) const {
+    size_t count = std::min(x.size(), out.size());
+    std::span<const double> values = physicalValues();
+    if (values.empty()) {
+        std::fill_n(out.begin(), count, 0.0);
+        return;
+    }
+    
+    std::vector<double> scratch;
+    std::span<const double> axis = axisOrIndices(m_xAxis, values.size(), scratch);
+    size_t step = values.size() > 1 ? 1 : 0;
+    
+    constexpr size_t BlockSize = 256;
+    uint32_t index[BlockSize];
+    double weight[BlockSize];
+    for (size_t begin = 0; begin < count; begin += BlockSize) {
+        size_t n = std::min(BlockSize, count - begin);
+        locateBreakpoints(axis, x.subspan(begin, n), index, weight);
+        
+        for (size_t i = 0; i < n; ++i) {
+            const double* p = values.data() + index[i];
+            out[begin + i] = p[0] + (p[step] - p[0]) * weight[i];
+        }
+    }
+}
 
+double Map2D::lookup(double x) const {
+    double result = 0.0;
+    lookup(std::span<const double>(&x, 1), std::span<double>(&result, 1));
+    return result;
+}
+
+} // namespace WinMMM10
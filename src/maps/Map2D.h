@@ -1,8 +1,10 @@
 #pragma once
 
 #include "MapDefinition.h"
+#include "TypedMapStorage.h"
 #include <vector>
 #include <cstdint>
+#include <span>
 
 namespace WinMMM10 {
 
@@ -18,8 +20,9 @@ public:
     void loadFromBinary(const uint8_t* data, size_t dataSize);
     void writeToBinary(uint8_t* data, size_t dataSize) const;
     
-    uint16_t getRawValue(size_t index) const;
-    void setRawValue(size_t index, uint16_t value);
+    // Raw values as stored in the binary, widened to double
+    double getRawValue(size_t index) const;
+    void setRawValue(size_t index, double value);
     
     double getPhysicalValue(size_t index) const;
     void setPhysicalValue(size_t index, double value);
@@ -29,15 +32,28 @@ public:
     
     size_t pointCount() const { return m_data.size(); }
     
-    std::vector<uint16_t>& rawData() { return m_data; }
-    const std::vector<uint16_t>& rawData() const { return m_data; }
+    // Curve output at each x, linearly interpolated between axis breakpoints
+    // and clamped at the axis ends like the ECU. The axis must be ascending;
+    // without one x is a fractional index.
+    void lookup(std::span<const double> x, std::span<double> out) const;
+    double lookup(double x) const;
+    
+    // Contiguous decoded values, index-aligned with the raw data
+    std::span<const double> physicalValues() const { return m_data.physicalValues(); }
+    
+    // Approximate heap + object footprint, used for cache budgeting
+    size_t memoryUsage() const;
+    
+    const MapStorage& storage() const { return m_data; }
     
     std::vector<double>& xAxisData() { return m_xAxis; }
     const std::vector<double>& xAxisData() const { return m_xAxis; }
 
 private:
+    bool passesSafeMode(double physicalValue) const;
+    
     MapDefinition m_definition;
-    std::vector<uint16_t> m_data;
+    MapStorage m_data;
     std::vector<double> m_xAxis;
 };
 
@@ -1,5 +1,6 @@
 #include "Map3D.h"
 #include "ScalingEngine.h"
+#include "BreakpointSearch.h"
 #include "binary/Endianness.h"
 #include "../core/SafeModeManager.h"
 #include <cstring>
@@ -9,11 +10,13 @@ namespace WinMMM10 {
 
 Map3D::Map3D() = default;
 
-Map3D::Map3D(const MapDefinition& definition) : m_definition(definition) {
-    m_rows = definition.rows();
-    m_columns = definition.columns();
-    m_data.resize(m_rows * m_columns);
-    
+Map3D::Map3D(const MapDefinition& definition)
+    : m_definition(definition)
+    , m_rows(definition.rows())
+    , m_columns(definition.columns())
+    , m_data(definition.dataType(), definition.rows() * definition.columns(), definition.factor(), definition.offset(),
+             definition.endianness())
+{
     if (definition.hasXAxis()) {
         m_xAxis.resize(definition.xAxis().count());
     }
@@ -29,64 +32,26 @@ void Map3D::loadFromBinary(const uint8_t* data, size_t dataSize) {
     
     size_t offset = 0;
     
-    // Load X axis if present
+    // Axes are stored X first, then Y, each decoded straight to physical values
+    auto loadAxis = [&](const MapAxis& axis, std::vector<double>& values) {
+        size_t elementSize = dataTypeSize(axis.dataType());
+        size_t available = offset < dataSize ? (dataSize - offset) / elementSize : 0;
+        values.assign(axis.count(), 0.0);
+        ScalingEngine::decode(axis.dataType(), data + offset, std::min(axis.count(), available),
+                              axis.endianness(), axis.factor(), axis.offset(), values.data());
+        offset += axis.count() * elementSize;
+    };
+    
     if (m_definition.hasXAxis()) {
-        size_t axisCount = m_definition.xAxis().count();
-        m_xAxis.resize(axisCount);
-        size_t axisElementSize = (m_definition.xAxis().dataType() == 1 ? 1 : 
-                                  (m_definition.xAxis().dataType() == 4 ? 4 : 2));
-        
-        for (size_t i = 0; i < axisCount && offset + axisElementSize <= dataSize; ++i) {
-            if (axisElementSize == 2) {
-                uint16_t rawValue = EndiannessConverter::readLittleEndian<uint16_t>(data + offset);
-                m_xAxis[i] = ScalingEngine::rawToPhysical(rawValue, m_definition.xAxis().factor(), m_definition.xAxis().offset());
-            } else if (axisElementSize == 1) {
-                uint8_t rawValue = data[offset];
-                m_xAxis[i] = ScalingEngine::rawToPhysical(rawValue, m_definition.xAxis().factor(), m_definition.xAxis().offset());
-            } else if (axisElementSize == 4) {
-                float fval = EndiannessConverter::readLittleEndian<float>(data + offset);
-                m_xAxis[i] = ScalingEngine::rawToPhysical(fval, m_definition.xAxis().factor(), m_definition.xAxis().offset());
-            }
-            offset += axisElementSize;
-        }
+        loadAxis(m_definition.xAxis(), m_xAxis);
     }
-    
-    // Load Y axis if present
     if (m_definition.hasYAxis()) {
-        size_t axisCount = m_definition.yAxis().count();
-        m_yAxis.resize(axisCount);
-        size_t axisElementSize = (m_definition.yAxis().dataType() == 1 ? 1 : 
-                                  (m_definition.yAxis().dataType() == 4 ? 4 : 2));
-        
-        for (size_t i = 0; i < axisCount && offset + axisElementSize <= dataSize; ++i) {
-            if (axisElementSize == 2) {
-                uint16_t rawValue = EndiannessConverter::readLittleEndian<uint16_t>(data + offset);
-                m_yAxis[i] = ScalingEngine::rawToPhysical(rawValue, m_definition.yAxis().factor(), m_definition.yAxis().offset());
-            } else if (axisElementSize == 1) {
-                uint8_t rawValue = data[offset];
-                m_yAxis[i] = ScalingEngine::rawToPhysical(rawValue, m_definition.yAxis().factor(), m_definition.yAxis().offset());
-            } else if (axisElementSize == 4) {
-                float fval = EndiannessConverter::readLittleEndian<float>(data + offset);
-                m_yAxis[i] = ScalingEngine::rawToPhysical(fval, m_definition.yAxis().factor(), m_definition.yAxis().offset());
-            }
-            offset += axisElementSize;
-        }
+        loadAxis(m_definition.yAxis(), m_yAxis);
     }
     
-    // Load data
-    size_t elementSize = m_definition.dataSize();
-    size_t dataCount = m_rows * m_columns;
-    
-    for (size_t i = 0; i < dataCount && offset + elementSize <= dataSize; ++i) {
-        if (elementSize == 2) {
-            m_data[i] = EndiannessConverter::readLittleEndian<uint16_t>(data + offset);
-        } else if (elementSize == 1) {
-            m_data[i] = data[offset];
-        } else if (elementSize == 4) {
-            float fval = EndiannessConverter::readLittleEndian<float>(data + offset);
-            m_data[i] = static_cast<uint16_t>(ScalingEngine::rawToPhysical(fval, m_definition.factor(), m_definition.offset()) * 1000.0);
-        }
-        offset += elementSize;
+    // Load data in one typed pass
+    if (offset < dataSize) {
+        m_data.decode(data + offset, dataSize - offset);
     }
 }
 
@@ -97,84 +62,28 @@ void Map3D::writeToBinary(uint8_t* data, size_t dataSize) const {
     
     size_t offset = 0;
     
-    // Write X axis if present
+    auto writeAxis = [&](const MapAxis& axis, const std::vector<double>& values) {
+        size_t elementSize = dataTypeSize(axis.dataType());
+        size_t available = offset < dataSize ? (dataSize - offset) / elementSize : 0;
+        ScalingEngine::encode(axis.dataType(), values.data(), std::min(values.size(), available),
+                              axis.endianness(), axis.factor(), axis.offset(), data + offset);
+        offset += values.size() * elementSize;
+    };
+    
     if (m_definition.hasXAxis()) {
-        size_t axisCount = m_xAxis.size();
-        size_t axisElementSize = (m_definition.xAxis().dataType() == 1 ? 1 : 
-                                  (m_definition.xAxis().dataType() == 4 ? 4 : 2));
-        
-        for (size_t i = 0; i < axisCount && offset + axisElementSize <= dataSize; ++i) {
-            if (axisElementSize == 2) {
-                uint16_t rawValue = ScalingEngine::physicalToRaw<uint16_t>(m_xAxis[i], m_definition.xAxis().factor(), m_definition.xAxis().offset());
-                EndiannessConverter::writeLittleEndian<uint16_t>(data + offset, rawValue);
-            } else if (axisElementSize == 1) {
-                uint8_t rawValue = ScalingEngine::physicalToRaw<uint8_t>(m_xAxis[i], m_definition.xAxis().factor(), m_definition.xAxis().offset());
-                data[offset] = rawValue;
-            } else if (axisElementSize == 4) {
-                float rawValue = ScalingEngine::physicalToRaw<float>(m_xAxis[i], m_definition.xAxis().factor(), m_definition.xAxis().offset());
-                EndiannessConverter::writeLittleEndian<float>(data + offset, rawValue);
-            }
-            offset += axisElementSize;
-        }
+        writeAxis(m_definition.xAxis(), m_xAxis);
     }
-    
-    // Write Y axis if present
     if (m_definition.hasYAxis()) {
-        size_t axisCount = m_yAxis.size();
-        size_t axisElementSize = (m_definition.yAxis().dataType() == 1 ? 1 : 
-                                  (m_definition.yAxis().dataType() == 4 ? 4 : 2));
-        
-        for (size_t i = 0; i < axisCount && offset + axisElementSize <= dataSize; ++i) {
-            if (axisElementSize == 2) {
-                uint16_t rawValue = ScalingEngine::physicalToRaw<uint16_t>(m_yAxis[i], m_definition.yAxis().factor(), m_definition.yAxis().offset());
-                EndiannessConverter::writeLittleEndian<uint16_t>(data + offset, rawValue);
-            } else if (axisElementSize == 1) {
-                uint8_t rawValue = ScalingEngine::physicalToRaw<uint8_t>(m_yAxis[i], m_definition.yAxis().factor(), m_definition.yAxis().offset());
-                data[offset] = rawValue;
-            } else if (axisElementSize == 4) {
-                float rawValue = ScalingEngine::physicalToRaw<float>(m_yAxis[i], m_definition.yAxis().factor(), m_definition.yAxis().offset());
-                EndiannessConverter::writeLittleEndian<float>(data + offset, rawValue);
-            }
-            offset += axisElementSize;
-        }
+        writeAxis(m_definition.yAxis(), m_yAxis);
     }
     
     // Write data
-    size_t elementSize = m_definition.dataSize();
-    size_t dataCount = m_data.size();
-    
-    for (size_t i = 0; i < dataCount && offset + elementSize <= dataSize; ++i) {
-        if (elementSize == 2) {
-            EndiannessConverter::writeLittleEndian<uint16_t>(data + offset, m_data[i]);
-        } else if (elementSize == 1) {
-            data[offset] = static_cast<uint8_t>(m_data[i]);
-        } else if (elementSize == 4) {
-            size_t row = i / m_columns;
-            size_t col = i % m_columns;
-            double physical = getPhysicalValue(row, col);
-            float rawValue = ScalingEngine::physicalToRaw<float>(physical, m_definition.factor(), m_definition.offset());
-            EndiannessConverter::writeLittleEndian<float>(data + offset, rawValue);
-        }
-        offset += elementSize;
+    if (offset < dataSize) {
+        m_data.encode(data + offset, dataSize - offset);
     }
 }
 
-uint16_t Map3D::getRawValue(size_t row, size_t col) const {
-    if (row >= m_rows || col >= m_columns) {
-        return 0;
-    }
-    return m_data[indexOf(row, col)];
-}
-
-void Map3D::setRawValue(size_t row, size_t col, uint16_t value) {
-    if (row >= m_rows || col >= m_columns) {
-        return;
-    }
-    
-    // Convert to physical value for Safe Mode validation
-    double physicalValue = ScalingEngine::rawToPhysical(value, m_definition.factor(), m_definition.offset());
-    
-    // Safe Mode validation
+bool Map3D::passesSafeMode(double physicalValue) const {
     SafeModeManager::ValueLimits limits;
     limits.hardMin = m_definition.hardMin();
     limits.hardMax = m_definition.hardMax();
@@ -187,51 +96,63 @@ void Map3D::setRawValue(size_t row, size_t col, uint16_t value) {
     if (result == SafeModeManager::ValidationResult::Blocked) {
         SafeModeManager::instance().logBlock(reason);
         // Don't change the value
-        return;
+        return false;
     }
     
     if (result == SafeModeManager::ValidationResult::Warning) {
         SafeModeManager::instance().logWarning(reason);
         // Allow but warn
     }
-    
-    m_data[indexOf(row, col)] = value;
+    return true;
 }
 
-double Map3D::getPhysicalValue(size_t row, size_t col) const {
+double Map3D::getRawValue(size_t row, size_t col) const {
     if (row >= m_rows || col >= m_columns) {
         return 0.0;
     }
-    return ScalingEngine::rawToPhysical(m_data[indexOf(row, col)], m_definition.factor(), m_definition.offset());
+    return m_data.rawValue(indexOf(row, col));
 }
 
-void Map3D::setPhysicalValue(size_t row, size_t col, double value) {
+void Map3D::setRawValue(size_t row, size_t col, double value) {
     if (row >= m_rows || col >= m_columns) {
         return;
     }
     
-    // Safe Mode validation
-    SafeModeManager::ValueLimits limits;
-    limits.hardMin = m_definition.hardMin();
-    limits.hardMax = m_definition.hardMax();
-    limits.warningMin = m_definition.warningMin();
-    limits.warningMax = m_definition.warningMax();
-    
-    std::string reason;
-    auto result = SafeModeManager::instance().validateValue(value, limits, reason);
+    // Convert to physical value for Safe Mode validation
+    double physicalValue = value * m_definition.factor() + m_definition.offset();
+    if (!passesSafeMode(physicalValue)) {
+        return;
+    }
     
-    if (result == SafeModeManager::ValidationResult::Blocked) {
-        SafeModeManager::instance().logBlock(reason);
-        // Don't change the value
+    m_data.setRawValue(indexOf(row, col), value);
+}
+
+double Map3D::getPhysicalValue(size_t row, size_t col) const {
+    if (row >= m_rows || col >= m_columns) {
+        return 0.0;
+    }
+    return m_data.physicalValue(indexOf(row, col));
+}
+
+void Map3D::setPhysicalValue(size_t row, size_t col, double value) {
+    if (row >= m_rows || col >= m_columns) {
         return;
     }
     
-    if (result == SafeModeManager::ValidationResult::Warning) {
-        SafeModeManager::instance().logWarning(reason);
-        // Allow but warn
+    if (!passesSafeMode(value)) {
+        return;
     }
     
-    m_data[indexOf(row, col)] = ScalingEngine::physicalToRaw<uint16_t>(value, m_definition.factor(), m_definition.offset());
+    m_data.setPhysicalValue(indexOf(row, col), value);
+}
+
+size_t Map3D::memoryUsage() const {
+    return sizeof(Map3D)
+         + m_data.memoryUsage()
+         + m_xAxis.capacity() * sizeof(double)
+         + m_yAxis.capacity() * sizeof(double)
+         + m_definition.name().capacity()
+         + m_definition.unit().capacity();
 }
 
 double Map3D::getXAxisValue(size_t index) const {
@@ -262,5 +183,44 @@ void Map3D::setYAxisValue(size_t index, double value) {
     m_yAxis[index] = value;
 }
 
-} // namespace WinMMM10
+void Map3D::lookup(std::span<const double> x, std::span<const double> y, std::span<double> out) const {
+    size_t count = std::min({x.size(), y.size(), out.size()});
+    std::span<const double> values = physicalValues();
+    if (m_rows == 0 || m_columns == 0 || values.size() < m_rows * m_columns) {
+        std::fill_n(out.begin(), count, 0.0);
+        return;
+    }
+    
+    std::vector<double> xScratch, yScratch;
+    std::span<const double> xAxis = axisOrIndices(m_xAxis, m_columns, xScratch);
+    std::span<const double> yAxis = axisOrIndices(m_yAxis, m_rows, yScratch);
+    
+    // Neighbour offsets are zero on a single-breakpoint axis, keeping the inner loop branch-free
+    size_t xStep = m_columns > 1 ? 1 : 0;
+    size_t yStep = m_rows > 1 ? m_columns : 0;
+    
+    // Locate a block of points on both axes, then interpolate it in one pass
+    constexpr size_t BlockSize = 256;
+    uint32_t xIndex[BlockSize], yIndex[BlockSize];
+    double xWeight[BlockSize], yWeight[BlockSize];
+    for (size_t begin = 0; begin < count; begin += BlockSize) {
+        size_t n = std::min(BlockSize, count - begin);
+        locateBreakpoints(xAxis, x.subspan(begin, n), xIndex, xWeight);
+        locateBreakpoints(yAxis, y.subspan(begin, n), yIndex, yWeight);
+        
+        for (size_t i = 0; i < n; ++i) {
+            const double* p = values.data() + yIndex[i] * m_columns + xIndex[i];
+            double top = p[0] + (p[xStep] - p[0]) * xWeight[i];
+            double bottom = p[yStep] + (p[yStep + xStep] - p[yStep]) * xWeight[i];
+            out[begin + i] = top + (bottom - top) * yWeight[i];
+        }
+    }
+}
+
+double Map3D::lookup(double x, double y) const {
+    double result = 0.0;
+    lookup(std::span<const double>(&x, 1), std::span<const double>(&y, 1), std::span<double>(&result, 1));
+    return result;
+}
 
+} // namespace WinMMM10
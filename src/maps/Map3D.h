@@ -1,8 +1,10 @@
 #pragma once
 
 #include "MapDefinition.h"
+#include "TypedMapStorage.h"
 #include <vector>
 #include <cstdint>
+#include <span>
 
 namespace WinMMM10 {
 
@@ -18,8 +20,9 @@ public:
     void loadFromBinary(const uint8_t* data, size_t dataSize);
     void writeToBinary(uint8_t* data, size_t dataSize) const;
     
-    uint16_t getRawValue(size_t row, size_t col) const;
-    void setRawValue(size_t row, size_t col, uint16_t value);
+    // Raw values as stored in the binary, widened to double
+    double getRawValue(size_t row, size_t col) const;
+    void setRawValue(size_t row, size_t col, double value);
     
     double getPhysicalValue(size_t row, size_t col) const;
     void setPhysicalValue(size_t row, size_t col, double value);
@@ -33,8 +36,19 @@ public:
     size_t rows() const { return m_rows; }
     size_t columns() const { return m_columns; }
     
-    std::vector<uint16_t>& rawData() { return m_data; }
-    const std::vector<uint16_t>& rawData() const { return m_data; }
+    // Table output at operating points (x[i], y[i]), bilinearly interpolated
+    // between axis breakpoints and clamped at the axis ends like the ECU.
+    // Axes must be ascending; without axes x/y are fractional column/row indices.
+    void lookup(std::span<const double> x, std::span<const double> y, std::span<double> out) const;
+    double lookup(double x, double y) const;
+    
+    // Contiguous decoded values in row-major order
+    std::span<const double> physicalValues() const { return m_data.physicalValues(); }
+    
+    // Approximate heap + object footprint, used for cache budgeting
+    size_t memoryUsage() const;
+    
+    const MapStorage& storage() const { return m_data; }
     
     std::vector<double>& xAxisData() { return m_xAxis; }
     const std::vector<double>& xAxisData() const { return m_xAxis; }
@@ -43,10 +57,12 @@ public:
     const std::vector<double>& yAxisData() const { return m_yAxis; }
 
 private:
+    bool passesSafeMode(double physicalValue) const;
+    
     MapDefinition m_definition;
     size_t m_rows{0};
     size_t m_columns{0};
-    std::vector<uint16_t> m_data;
+    MapStorage m_data;
     std::vector<double> m_xAxis;
     std::vector<double> m_yAxis;
     
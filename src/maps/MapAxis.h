@@ -1,6 +1,8 @@
 #pragma once
 
+#include "../binary/Endianness.h"
 #include <string>
+#include <utility>
 #include <vector>
 #include <cstdint>
 
@@ -26,26 +28,30 @@ public:
     size_t count() const { return m_count; }
     void setCount(size_t count) { m_count = count; }
     
-    uint16_t dataType() const { return m_dataType; } // 1=uint8, 2=uint16, 3=int16, 4=float
+    uint16_t dataType() const { return m_dataType; } // MapDataType: 1=uint8, 2=uint16, 3=int16, 4=float, 5=int8, 6=uint32, 7=int32
     void setDataType(uint16_t type) { m_dataType = type; }
     
+    Endianness endianness() const { return m_endianness; }
+    void setEndianness(Endianness endian) { m_endianness = endian; }
+    
     double factor() const { return m_factor; }
     void setFactor(double factor) { m_factor = factor; }
     
     double offset() const { return m_offset; }
     void setOffset(double offset) { m_offset = offset; }
     
-    std::string name() const { return m_name; }
-    void setName(const std::string& name) { m_name = name; }
+    const std::string& name() const { return m_name; }
+    void setName(std::string name) { m_name = std::move(name); }
     
-    std::string unit() const { return m_unit; }
-    void setUnit(const std::string& unit) { m_unit = unit; }
+    const std::string& unit() const { return m_unit; }
+    void setUnit(std::string unit) { m_unit = std::move(unit); }
 
 private:
     AxisType m_type{AxisType::XAxis};
     size_t m_address{0};
     size_t m_count{0};
     uint16_t m_dataType{2}; // uint16 default
+    Endianness m_endianness{Endianness::Little};
     double m_factor{1.0};
     double m_offset{0.0};
     std::string m_name;
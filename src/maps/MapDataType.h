@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace WinMMM10 {
+
+// Element type codes stored in MapDefinition/MapAxis::dataType()
+enum class MapDataType : uint16_t {
+    UInt8 = 1,
+    UInt16 = 2,
+    Int16 = 3,
+    Float32 = 4,
+    Int8 = 5,
+    UInt32 = 6,
+    Int32 = 7
+};
+
+// Size in bytes of one element; unknown codes fall back to uint16 like the rest of the editor
+inline size_t dataTypeSize(uint16_t code) {
+    switch (static_cast<MapDataType>(code)) {
+        case MapDataType::UInt8:
+        case MapDataType::Int8:
+            return 1;
+        case MapDataType::Float32:
+        case MapDataType::UInt32:
+        case MapDataType::Int32:
+            return 4;
+        default:
+            return 2;
+    }
+}
+
+// Calls func with a value-initialized element of the type matching the code
+template<typename Func>
+decltype(auto) dispatchDataType(uint16_t code, Func&& func) {
+    switch (static_cast<MapDataType>(code)) {
+        case MapDataType::UInt8: return func(uint8_t{});
+        case MapDataType::Int16: return func(int16_t{});
+        case MapDataType::Float32: return func(float{});
+        case MapDataType::Int8: return func(int8_t{});
+        case MapDataType::UInt32: return func(uint32_t{});
+        case MapDataType::Int32: return func(int32_t{});
+        default: return func(uint16_t{});
+    }
+}
+
+} // namespace WinMMM10
@@ -2,6 +2,7 @@
 
 #include "MapAxis.h"
 #include <string>
+#include <utility>
 #include <cstdint>
 #include <memory>
 
@@ -17,8 +18,8 @@ public:
     MapDefinition();
     ~MapDefinition() = default;
     
-    std::string name() const { return m_name; }
-    void setName(const std::string& name) { m_name = name; }
+    const std::string& name() const { return m_name; }
+    void setName(std::string name) { m_name = std::move(name); }
     
     size_t address() const { return m_address; }
     void setAddress(size_t address) { m_address = address; }
@@ -32,17 +33,21 @@ public:
     size_t columns() const { return m_columns; }
     void setColumns(size_t columns) { m_columns = columns; }
     
-    uint16_t dataType() const { return m_dataType; } // 1=uint8, 2=uint16, 3=int16, 4=float
+    uint16_t dataType() const { return m_dataType; } // MapDataType: 1=uint8, 2=uint16, 3=int16, 4=float, 5=int8, 6=uint32, 7=int32
     void setDataType(uint16_t type) { m_dataType = type; }
     
+    // Byte order of the map data; each axis carries its own
+    Endianness endianness() const { return m_endianness; }
+    void setEndianness(Endianness endian) { m_endianness = endian; }
+    
     double factor() const { return m_factor; }
     void setFactor(double factor) { m_factor = factor; }
     
     double offset() const { return m_offset; }
     void setOffset(double offset) { m_offset = offset; }
     
-    std::string unit() const { return m_unit; }
-    void setUnit(const std::string& unit) { m_unit = unit; }
+    const std::string& unit() const { return m_unit; }
+    void setUnit(std::string unit) { m_unit = std::move(unit); }
     
     MapAxis& xAxis() { return m_xAxis; }
     const MapAxis& xAxis() const { return m_xAxis; }
@@ -73,6 +78,7 @@ private:
     size_t m_rows{0};
     size_t m_columns{0};
     uint16_t m_dataType{2}; // uint16 default
+    Endianness m_endianness{Endianness::Little};
     double m_factor{1.0};
     double m_offset{0.0};
     std::string m_unit;
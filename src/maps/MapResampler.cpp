@@ -0,0 +1,157 @@
+#include "MapResampler.h"
+#include "MapView.h"
+#include "BreakpointSearch.h"
+#include "CubicSpline.h"
+#include <algorithm>
+
+namespace WinMMM10 {
+
+AxisLookup AxisLookup::build(std::span<const double> source, std::span<const double> target) {
+    AxisLookup lookup;
+    lookup.lower.resize(target.size());
+    lookup.upper.resize(target.size());
+    lookup.weight.resize(target.size());
+    if (source.empty()) {
+        return lookup;
+    }
+    
+    locateBreakpoints(source, target, lookup.lower.data(), lookup.weight.data());
+    uint32_t step = source.size() > 1 ? 1 : 0;
+    for (size_t i = 0; i < target.size(); ++i) {
+        lookup.upper[i] = lookup.lower[i] + step;
+    }
+    return lookup;
+}
+
+namespace {
+
+// Evenly spaced 0..1 coordinates, used when a dimension has no usable axis
+std::vector<double> relativeAxis(size_t count) {
+    std::vector<double> axis(count, 0.0);
+    for (size_t i = 1; i < count; ++i) {
+        axis[i] = static_cast<double>(i) / static_cast<double>(count - 1);
+    }
+    return axis;
+}
+
+double catmullRom(double p0, double p1, double p2, double p3, double t) {
+    double t2 = t * t;
+    double t3 = t2 * t;
+    return 0.5 * (2.0 * p1 + (-p0 + p2) * t + (2.0 * p0 - 5.0 * p1 + 4.0 * p2 - p3) * t2 +
+                  (-p0 + 3.0 * p1 - 3.0 * p2 + p3) * t3);
+}
+
+// Axis values for one dimension of a map, or empty if it has none of the
+// right length or its breakpoints are not ascending
+std::vector<double> readMapAxis(const MapAxis& axis, const BinaryFile* file, size_t count) {
+    std::vector<double> values;
+    if (!MapView::readAxis(axis, file, values) || values.size() != count ||
+        !std::is_sorted(values.begin(), values.end())) {
+        values.clear();
+    }
+    return values;
+}
+
+} // namespace
+
+bool MapResampler::resample(std::span<const double> source,
+                            std::span<const double> sourceX, std::span<const double> sourceY,
+                            std::span<const double> targetX, std::span<const double> targetY,
+                            std::span<double> out, Method method) {
+    size_t sourceColumns = sourceX.size();
+    size_t targetColumns = targetX.size();
+    if (sourceColumns == 0 || sourceY.empty() || source.size() < sourceColumns * sourceY.size() ||
+        out.size() < targetColumns * targetY.size()) {
+        return false;
+    }
+    
+    if (method == Method::Spline || method == Method::MonotoneSpline) {
+        return CubicSpline::resample(source, sourceX, sourceY, targetX, targetY, out,
+                                     method == Method::Spline ? CubicSpline::Kind::Natural
+                                                              : CubicSpline::Kind::Monotone);
+    }
+    
+    AxisLookup xs = AxisLookup::build(sourceX, targetX);
+    AxisLookup ys = AxisLookup::build(sourceY, targetY);
+    
+    if (method == Method::Bilinear) {
+        for (size_t r = 0; r < ys.size(); ++r) {
+            const double* row0 = source.data() + ys.lower[r] * sourceColumns;
+            const double* row1 = source.data() + ys.upper[r] * sourceColumns;
+            double wy = ys.weight[r];
+            double* dst = out.data() + r * targetColumns;
+            for (size_t c = 0; c < targetColumns; ++c) {
+                uint32_t x0 = xs.lower[c];
+                uint32_t x1 = xs.upper[c];
+                double wx = xs.weight[c];
+                double top = row0[x0] + (row0[x1] - row0[x0]) * wx;
+                double bottom = row1[x0] + (row1[x1] - row1[x0]) * wx;
+                dst[c] = top + (bottom - top) * wy;
+            }
+        }
+        return true;
+    }
+    
+    // Separable Catmull-Rom over the 4x4 neighbourhood, indices clamped at the edges
+    int lastRow = static_cast<int>(sourceY.size()) - 1;
+    int lastColumn = static_cast<int>(sourceColumns) - 1;
+    auto at = [&](int r, int c) {
+        r = std::clamp(r, 0, lastRow);
+        c = std::clamp(c, 0, lastColumn);
+        return source[static_cast<size_t>(r) * sourceColumns + static_cast<size_t>(c)];
+    };
+    
+    for (size_t r = 0; r < ys.size(); ++r) {
+        int y = static_cast<int>(ys.lower[r]);
+        double wy = ys.weight[r];
+        for (size_t c = 0; c < targetColumns; ++c) {
+            int x = static_cast<int>(xs.lower[c]);
+            double wx = xs.weight[c];
+            double rows[4];
+            for (int k = 0; k < 4; ++k) {
+                int sr = y - 1 + k;
+                rows[k] = catmullRom(at(sr, x - 1), at(sr, x), at(sr, x + 1), at(sr, x + 2), wx);
+            }
+            out[r * targetColumns + c] = catmullRom(rows[0], rows[1], rows[2], rows[3], wy);
+        }
+    }
+    return true;
+}
+
+bool MapResampler::resample(const MapDefinition& source, const BinaryFile* sourceFile,
+                            const MapDefinition& target, const BinaryFile* targetFile,
+                            std::vector<double>& out, Method method) {
+    MapView sourceView(source, sourceFile);
+    MapView targetView(target, targetFile);
+    if (!sourceView.isValid() || targetView.rows() == 0 || targetView.columns() == 0) {
+        return false;
+    }
+    
+    std::vector<double> sourceX = readMapAxis(source.xAxis(), sourceFile, sourceView.columns());
+    std::vector<double> sourceY = readMapAxis(source.yAxis(), sourceFile, sourceView.rows());
+    std::vector<double> targetX = readMapAxis(target.xAxis(), targetFile, targetView.columns());
+    std::vector<double> targetY = readMapAxis(target.yAxis(), targetFile, targetView.rows());
+    
+    // A dimension only uses real breakpoints if both maps have them
+    if (sourceX.empty() || targetX.empty()) {
+        sourceX = relativeAxis(sourceView.columns());
+        targetX = relativeAxis(targetView.columns());
+    }
+    if (sourceY.empty() || targetY.empty()) {
+        sourceY = relativeAxis(sourceView.rows());
+        targetY = relativeAxis(targetView.rows());
+    }
+    
+    if (sourceX == targetX && sourceY == targetY) {
+        return sourceView.read(out);
+    }
+    
+    std::vector<double> values;
+    if (!sourceView.read(values)) {
+        return false;
+    }
+    out.resize(targetView.size());
+    return resample(values, sourceX, sourceY, targetX, targetY, out, method);
+}
+
+} // namespace WinMMM10
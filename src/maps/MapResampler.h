@@ -0,0 +1,51 @@
+#pragma once
+
+#include "MapDefinition.h"
+#include "../binary/BinaryFile.h"
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace WinMMM10 {
+
+// Breakpoint lookup table mapping every target coordinate onto a source axis.
+// Built once per axis pair; afterwards each cell costs a fixed number of reads.
+// Coordinates outside the source range clamp to its end points, as ECUs do.
+struct AxisLookup {
+    std::vector<uint32_t> lower;  // Segment start, see locateBreakpoints()
+    std::vector<uint32_t> upper;  // lower + 1, or lower on a single-point axis
+    std::vector<double> weight;   // Position between lower and upper, 0..1
+    
+    // Both axes must be ascending
+    static AxisLookup build(std::span<const double> source, std::span<const double> target);
+    size_t size() const { return lower.size(); }
+};
+
+// Interpolates map values from one axis grid onto another, so maps with
+// different breakpoints or dimensions can be combined cell by cell.
+class MapResampler {
+public:
+    enum class Method {
+        Bilinear,
+        Bicubic,       // Catmull-Rom, may overshoot between steep breakpoints
+        Spline,        // Natural cubic spline surface over the axis breakpoints
+        MonotoneSpline // Fritsch-Carlson spline surface, no overshoot
+    };
+    
+    // Row-major source values on (sourceY x sourceX) resampled onto (targetY x targetX)
+    static bool resample(std::span<const double> source,
+                         std::span<const double> sourceX, std::span<const double> sourceY,
+                         std::span<const double> targetX, std::span<const double> targetY,
+                         std::span<double> out, Method method = Method::Bilinear);
+    
+    // Decodes source and resamples it onto target's grid. Axes are read from
+    // the binaries; a dimension on which either map lacks a matching ascending
+    // axis is resampled by relative position instead. Maps with identical
+    // grids are decoded directly without interpolation.
+    static bool resample(const MapDefinition& source, const BinaryFile* sourceFile,
+                         const MapDefinition& target, const BinaryFile* targetFile,
+                         std::vector<double>& out, Method method = Method::Bilinear);
+};
+
+} // namespace WinMMM10
@@ -0,0 +1,158 @@
+#include "MapThumbnail.h"
+#include "../binary/HashService.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+namespace WinMMM10 {
+
+namespace {
+
+// Same blue -> green -> red gradient as Map3DViewer
+void heatColor(double value, double minVal, double maxVal, uint8_t* out) {
+    double normalized = maxVal > minVal ? (value - minVal) / (maxVal - minVal) : 0.5;
+    normalized = std::clamp(normalized, 0.0, 1.0);
+    
+    double r, g, b;
+    if (normalized < 0.5) {
+        double t = normalized * 2.0;
+        r = 0.0; g = t; b = 1.0 - t;
+    } else {
+        double t = (normalized - 0.5) * 2.0;
+        r = t; g = 1.0 - t; b = 0.0;
+    }
+    out[0] = static_cast<uint8_t>(r * 255.0 + 0.5);
+    out[1] = static_cast<uint8_t>(g * 255.0 + 0.5);
+    out[2] = static_cast<uint8_t>(b * 255.0 + 0.5);
+}
+
+} // namespace
+
+MapThumbnail MapThumbnail::render(const Map3D& map, uint16_t size) {
+    MapThumbnail thumbnail;
+    size_t rows = map.rows();
+    size_t columns = map.columns();
+    if (size == 0 || rows == 0 || columns == 0) {
+        return thumbnail;
+    }
+    
+    // Convert once; sampling below touches each cell several times
+    std::vector<double> values(rows * columns);
+    double minVal = std::numeric_limits<double>::max();
+    double maxVal = std::numeric_limits<double>::lowest();
+    for (size_t row = 0; row < rows; ++row) {
+        for (size_t col = 0; col < columns; ++col) {
+            double value = map.getPhysicalValue(row, col);
+            values[row * columns + col] = value;
+            minVal = std::min(minVal, value);
+            maxVal = std::max(maxVal, value);
+        }
+    }
+    
+    thumbnail.width = size;
+    thumbnail.height = size;
+    thumbnail.rgb.resize(size_t(size) * size * 3);
+    
+    // Nearest-cell sampling; row 0 is drawn at the top like the table view
+    for (uint16_t y = 0; y < size; ++y) {
+        size_t row = std::min(rows - 1, size_t(y) * rows / size);
+        for (uint16_t x = 0; x < size; ++x) {
+            size_t col = std::min(columns - 1, size_t(x) * columns / size);
+            heatColor(values[row * columns + col], minVal, maxVal,
+                      &thumbnail.rgb[(size_t(y) * size + x) * 3]);
+        }
+    }
+    return thumbnail;
+}
+
+MapThumbnail MapThumbnail::render(const Map2D& map, uint16_t size) {
+    MapThumbnail thumbnail;
+    size_t count = map.pointCount();
+    if (size == 0 || count == 0) {
+        return thumbnail;
+    }
+    
+    std::vector<double> values(count);
+    double minVal = std::numeric_limits<double>::max();
+    double maxVal = std::numeric_limits<double>::lowest();
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = map.getPhysicalValue(i);
+        minVal = std::min(minVal, values[i]);
+        maxVal = std::max(maxVal, values[i]);
+    }
+    
+    thumbnail.width = size;
+    thumbnail.height = size;
+    thumbnail.rgb.assign(size_t(size) * size * 3, 32); // Dark background
+    
+    for (uint16_t x = 0; x < size; ++x) {
+        size_t index = std::min(count - 1, size_t(x) * count / size);
+        double value = values[index];
+        double normalized = maxVal > minVal ? (value - minVal) / (maxVal - minVal) : 0.5;
+        
+        // Fill from the bottom up to the curve height (at least one pixel)
+        uint16_t barHeight = static_cast<uint16_t>(std::max(1.0, std::round(normalized * size)));
+        uint8_t color[3];
+        heatColor(value, minVal, maxVal, color);
+        for (uint16_t y = size - barHeight; y < size; ++y) {
+            uint8_t* pixel = &thumbnail.rgb[(size_t(y) * size + x) * 3];
+            pixel[0] = color[0];
+            pixel[1] = color[1];
+            pixel[2] = color[2];
+        }
+    }
+    return thumbnail;
+}
+
+std::vector<uint8_t> MapThumbnail::serialize() const {
+    std::vector<uint8_t> bytes;
+    bytes.reserve(4 + rgb.size());
+    bytes.push_back(static_cast<uint8_t>(width & 0xFF));
+    bytes.push_back(static_cast<uint8_t>(width >> 8));
+    bytes.push_back(static_cast<uint8_t>(height & 0xFF));
+    bytes.push_back(static_cast<uint8_t>(height >> 8));
+    bytes.insert(bytes.end(), rgb.begin(), rgb.end());
+    return bytes;
+}
+
+bool MapThumbnail::deserialize(const std::vector<uint8_t>& bytes, MapThumbnail& thumbnail) {
+    if (bytes.size() < 4) {
+        return false;
+    }
+    uint16_t width = static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+    uint16_t height = static_cast<uint16_t>(bytes[2] | (bytes[3] << 8));
+    if (bytes.size() != 4 + size_t(width) * height * 3) {
+        return false;
+    }
+    
+    thumbnail.width = width;
+    thumbnail.height = height;
+    thumbnail.rgb.assign(bytes.begin() + 4, bytes.end());
+    return thumbnail.isValid();
+}
+
+std::string MapThumbnail::contentKey(const MapDefinition& definition, const uint8_t* data, size_t dataSize) {
+    // FNV-1a over the decoding parameters, used as the XXH3 seed for the raw bytes
+    uint64_t hash = HashService::Fnv1aBasis;
+    HashService::fnv1a(hash, static_cast<int>(definition.type()));
+    HashService::fnv1a(hash, definition.rows());
+    HashService::fnv1a(hash, definition.columns());
+    HashService::fnv1a(hash, definition.dataType());
+    HashService::fnv1a(hash, static_cast<int>(definition.endianness()));
+    HashService::fnv1a(hash, definition.factor());
+    HashService::fnv1a(hash, definition.offset());
+    HashService::fnv1a(hash, definition.xAxis().count());
+    HashService::fnv1a(hash, definition.xAxis().dataType());
+    HashService::fnv1a(hash, static_cast<int>(definition.xAxis().endianness()));
+    HashService::fnv1a(hash, definition.yAxis().count());
+    HashService::fnv1a(hash, definition.yAxis().dataType());
+    HashService::fnv1a(hash, static_cast<int>(definition.yAxis().endianness()));
+    hash = HashService::xxh3(data, dataSize, hash);
+    
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+    return buffer;
+}
+
+} // namespace WinMMM10
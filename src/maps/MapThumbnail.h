@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Map2D.h"
+#include "Map3D.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace WinMMM10 {
+
+// Small RGB heatmap preview of a map, rendered without any GUI dependency
+struct MapThumbnail {
+    uint16_t width{0};
+    uint16_t height{0};
+    std::vector<uint8_t> rgb; // width * height * 3, row-major, top row first
+    
+    bool isValid() const { return width > 0 && height > 0 && rgb.size() == size_t(width) * height * 3; }
+    
+    // 3D maps: value heatmap; 2D maps: filled curve colored by value
+    static MapThumbnail render(const Map3D& map, uint16_t size);
+    static MapThumbnail render(const Map2D& map, uint16_t size);
+    
+    // Storage format for the thumbnail cache: u16 width, u16 height, RGB bytes
+    std::vector<uint8_t> serialize() const;
+    static bool deserialize(const std::vector<uint8_t>& bytes, MapThumbnail& thumbnail);
+    
+    // Cache key derived from the map layout and its raw bytes
+    static std::string contentKey(const MapDefinition& definition, const uint8_t* data, size_t dataSize);
+};
+
+} // namespace WinMMM10
@@ -0,0 +1,212 @@
+#include "MapView.h"
+#include "ScalingEngine.h"
+
+namespace WinMMM10 {
+
+MapView::MapView(const MapDefinition& map, const BinaryFile* file)
+    : m_definition(map)
+    , m_file(file)
+{
+    resolve();
+}
+
+MapView::MapView(const MapDefinition& map, BinaryFile* file)
+    : m_definition(map)
+    , m_file(file)
+    , m_writableFile(file)
+{
+    resolve();
+}
+
+void MapView::resolve() {
+    m_rows = m_definition.rows();
+    m_columns = m_definition.columns();
+    m_elementSize = dataTypeSize(m_definition.dataType());
+    
+    if (!m_file || !m_file->isLoaded()) {
+        return;
+    }
+    
+    size_t address = m_definition.address();
+    m_valid = address <= m_file->size() && byteSize() <= m_file->size() - address;
+}
+
+bool MapView::read(std::vector<double>& values) const {
+    if (!m_valid) {
+        return false;
+    }
+    values.resize(size());
+    return read(0, values);
+}
+
+bool MapView::read(size_t first, std::span<double> out) const {
+    if (!m_valid || first > size() || out.size() > size() - first) {
+        return false;
+    }
+    
+    ScalingEngine::decode(m_definition.dataType(), m_file->at(m_definition.address()) + first * m_elementSize,
+                          out.size(), m_definition.endianness(), m_definition.factor(), m_definition.offset(),
+                          out.data());
+    return true;
+}
+
+bool MapView::readRow(size_t row, std::span<double> out) const {
+    if (row >= m_rows || out.size() < m_columns) {
+        return false;
+    }
+    return read(row * m_columns, out.first(m_columns));
+}
+
+bool MapView::readColumn(size_t column, std::span<double> out) const {
+    if (!m_valid || column >= m_columns || out.size() < m_rows) {
+        return false;
+    }
+    
+    double factor = m_definition.factor();
+    double offset = m_definition.offset();
+    visit([&](const auto& view) {
+        for (size_t i = 0; i < view.size(); ++i) {
+            out[i] = static_cast<double>(view[i]) * factor + offset;
+        }
+    }, column, m_rows, m_columns);
+    return true;
+}
+
+bool MapView::write(std::span<const double> values) {
+    return write(0, values);
+}
+
+bool MapView::write(size_t first, std::span<const double> values) {
+    if (!isWritable() || first > size() || values.size() > size() - first) {
+        return false;
+    }
+    
+    std::vector<double> clamped;
+    if (!passesLimits(values, clamped)) {
+        return false;
+    }
+    
+    std::vector<uint8_t> bytes(values.size() * m_elementSize);
+    ScalingEngine::encode(m_definition.dataType(), values.data(), values.size(), m_definition.endianness(),
+                          m_definition.factor(), m_definition.offset(), bytes.data());
+    return m_writableFile->writeBytes(m_definition.address() + first * m_elementSize, bytes);
+}
+
+bool MapView::writeRow(size_t row, std::span<const double> values) {
+    if (row >= m_rows || values.size() < m_columns) {
+        return false;
+    }
+    return write(row * m_columns, values.first(m_columns));
+}
+
+bool MapView::readRaw(size_t first, std::span<uint8_t> bytes) const {
+    if (!m_valid || bytes.size() % m_elementSize != 0 || first > size() ||
+        bytes.size() / m_elementSize > size() - first) {
+        return false;
+    }
+    std::memcpy(bytes.data(), m_file->at(m_definition.address()) + first * m_elementSize, bytes.size());
+    return true;
+}
+
+bool MapView::writeRaw(size_t first, std::span<const uint8_t> bytes) {
+    if (!isWritable() || bytes.size() % m_elementSize != 0 || first > size() ||
+        bytes.size() / m_elementSize > size() - first) {
+        return false;
+    }
+    
+    // Stored bytes are checked like any other write; if clamping changed
+    // something the clamped values are encoded instead
+    if (SafeModeManager::instance().isEnabled()) {
+        size_t count = bytes.size() / m_elementSize;
+        std::vector<double> values(count);
+        ScalingEngine::decode(m_definition.dataType(), bytes.data(), count, m_definition.endianness(),
+                              m_definition.factor(), m_definition.offset(), values.data());
+        std::span<const double> checked(values);
+        std::vector<double> clamped;
+        if (!passesLimits(checked, clamped)) {
+            return false;
+        }
+        if (m_limitReport.clamped > 0) {
+            std::vector<uint8_t> encoded(bytes.size());
+            ScalingEngine::encode(m_definition.dataType(), clamped.data(), count, m_definition.endianness(),
+                                  m_definition.factor(), m_definition.offset(), encoded.data());
+            return m_writableFile->writeBytes(m_definition.address() + first * m_elementSize, encoded);
+        }
+    } else {
+        m_limitReport = {};
+        m_limitReport.checked = bytes.size() / m_elementSize;
+    }
+    return m_writableFile->writeBytes(m_definition.address() + first * m_elementSize,
+                                      std::vector<uint8_t>(bytes.begin(), bytes.end()));
+}
+
+SafeModeManager::ValueLimits MapView::limits() const {
+    SafeModeManager::ValueLimits limits;
+    limits.hardMin = m_definition.hardMin();
+    limits.hardMax = m_definition.hardMax();
+    limits.warningMin = m_definition.warningMin();
+    limits.warningMax = m_definition.warningMax();
+    return limits;
+}
+
+bool MapView::passesLimits(std::span<const double>& values, std::vector<double>& clamped) {
+    const SafeModeManager& safeMode = SafeModeManager::instance();
+    if (!safeMode.isEnabled()) {
+        m_limitReport = {};
+        m_limitReport.checked = values.size();
+        return true;
+    }
+    
+    if (safeMode.limitPolicy() == SafeModeManager::LimitPolicy::Clamp) {
+        clamped.assign(values.begin(), values.end());
+        m_limitReport = safeMode.clampToLimits(clamped, limits());
+        values = clamped;
+    } else {
+        m_limitReport = safeMode.checkLimits(values, limits());
+    }
+    
+    // One log line per write, however many cells were affected
+    std::string message = m_definition.name().empty() ? m_limitReport.reason
+                                                      : m_definition.name() + ": " + m_limitReport.reason;
+    if (m_limitReport.result == SafeModeManager::ValidationResult::Blocked) {
+        safeMode.logBlock(message);
+        return false;
+    }
+    if (m_limitReport.result == SafeModeManager::ValidationResult::Warning) {
+        safeMode.logWarning(message);
+    }
+    return true;
+}
+
+double MapView::value(size_t row, size_t column) const {
+    double result = 0.0;
+    if (row < m_rows && column < m_columns) {
+        read(row * m_columns + column, std::span<double>(&result, 1));
+    }
+    return result;
+}
+
+bool MapView::setValue(size_t row, size_t column, double value) {
+    if (row >= m_rows || column >= m_columns) {
+        return false;
+    }
+    return write(row * m_columns + column, std::span<const double>(&value, 1));
+}
+
+bool MapView::readAxis(const MapAxis& axis, const BinaryFile* file, std::vector<double>& values) {
+    if (!file || !file->isLoaded() || axis.count() == 0) {
+        return false;
+    }
+    
+    size_t bytes = axis.count() * dataTypeSize(axis.dataType());
+    if (axis.address() > file->size() || bytes > file->size() - axis.address()) {
+        return false;
+    }
+    
+    values.resize(axis.count());
+    ScalingEngine::decode(axis.dataType(), file->at(axis.address()), axis.count(), axis.endianness(),
+                          axis.factor(), axis.offset(), values.data());
+    return true;
+}
+
+} // namespace WinMMM10
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "MapDefinition.h"
+#include "MapDataType.h"
+#include "../binary/BinaryFile.h"
+#include "../binary/Endianness.h"
+#include "../core/SafeModeManager.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace WinMMM10 {
+
+// Read-only view of every step-th element of type T stored in byte order E.
+// Element access never branches on byte order.
+template<typename T, Endianness E>
+class StridedView {
+public:
+    using value_type = T;
+    
+    StridedView() = default;
+    StridedView(const uint8_t* base, size_t count, size_t stride)
+        : m_base(base), m_count(count), m_stride(stride) {}
+    
+    size_t size() const { return m_count; }
+    size_t stride() const { return m_stride; }
+    
+    T operator[](size_t index) const {
+        T value;
+        std::memcpy(&value, m_base + index * m_stride, sizeof(T));
+        if constexpr (E != NativeEndianness && sizeof(T) > 1) {
+            value = EndiannessConverter::swapBytes(value);
+        }
+        return value;
+    }
+
+private:
+    const uint8_t* m_base{nullptr};
+    size_t m_count{0};
+    size_t m_stride{sizeof(T)};
+};
+
+// Accessor for the values of one map inside a BinaryFile. The layout (address,
+// element type, byte order, scaling) is resolved and bounds-checked once at
+// construction; reads and writes then move whole ranges through the batch
+// ScalingEngine kernels. Like the editors, the map's address is taken as the
+// start of its data. Writes go through BinaryFile::writeBytes so observers see
+// one notification per call, after the whole block has passed the Safe Mode
+// limit check of the definition (see SafeModeManager::LimitPolicy).
+class MapView {
+public:
+    MapView() = default;
+    MapView(const MapDefinition& map, const BinaryFile* file);
+    MapView(const MapDefinition& map, BinaryFile* file);
+    
+    // False if no binary is loaded or the map lies outside it
+    bool isValid() const { return m_valid; }
+    bool isWritable() const { return m_valid && m_writableFile; }
+    
+    const MapDefinition& definition() const { return m_definition; }
+    size_t rows() const { return m_rows; }
+    size_t columns() const { return m_columns; }
+    size_t size() const { return m_rows * m_columns; }
+    size_t elementSize() const { return m_elementSize; }
+    size_t byteSize() const { return size() * m_elementSize; }
+    
+    // Physical values in row-major order
+    bool read(std::vector<double>& values) const;
+    bool read(size_t first, std::span<double> out) const;
+    bool readRow(size_t row, std::span<double> out) const;
+    bool readColumn(size_t column, std::span<double> out) const;
+    
+    bool write(std::span<const double> values);
+    bool write(size_t first, std::span<const double> values);
+    bool writeRow(size_t row, std::span<const double> values);
+    
+    // Elements as stored (elementSize() bytes each), without scaling
+    bool readRaw(size_t first, std::span<uint8_t> bytes) const;
+    bool writeRaw(size_t first, std::span<const uint8_t> bytes);
+    
+    // Safe Mode outcome of the last write through this view
+    const SafeModeManager::LimitReport& limitReport() const { return m_limitReport; }
+    SafeModeManager::ValueLimits limits() const;
+    
+    double value(size_t row, size_t column) const;
+    bool setValue(size_t row, size_t column, double value);
+    
+    // Physical breakpoints of an axis stored at its own address; false if the
+    // axis is empty or lies outside the binary
+    static bool readAxis(const MapAxis& axis, const BinaryFile* file, std::vector<double>& values);
+    
+    // Calls visitor(StridedView<T, E>) over elements first, first + step, ...
+    // with T and E resolved from the definition, once per call
+    template<typename Visitor>
+    void visit(Visitor&& visitor, size_t first = 0, size_t count = static_cast<size_t>(-1), size_t step = 1) const {
+        if (!m_valid || first >= size() || step == 0) {
+            return;
+        }
+        count = std::min(count, (size() - first + step - 1) / step);
+        const uint8_t* base = m_file->at(m_definition.address()) + first * m_elementSize;
+        dispatchDataType(m_definition.dataType(), [&](auto tag) {
+            using T = decltype(tag);
+            if (m_definition.endianness() == Endianness::Big) {
+                visitor(StridedView<T, Endianness::Big>(base, count, step * sizeof(T)));
+            } else {
+                visitor(StridedView<T, Endianness::Little>(base, count, step * sizeof(T)));
+            }
+        });
+    }
+
+private:
+    void resolve();
+    // Runs the limit check; under Clamp, values is redirected to a clamped copy
+    bool passesLimits(std::span<const double>& values, std::vector<double>& clamped);
+    
+    MapDefinition m_definition;
+    const BinaryFile* m_file{nullptr};
+    BinaryFile* m_writableFile{nullptr};
+    size_t m_rows{0};
+    size_t m_columns{0};
+    size_t m_elementSize{0};
+    bool m_valid{false};
+    SafeModeManager::LimitReport m_limitReport;
+};
+
+} // namespace WinMMM10
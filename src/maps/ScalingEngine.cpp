@@ -0,0 +1,286 @@
+#include "ScalingEngine.h"
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WINMMM10_SCALING_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace WinMMM10 {
+
+namespace {
+
+template<typename T, bool Swap>
+T loadElement(const uint8_t* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    if constexpr (Swap && sizeof(T) > 1) {
+        value = EndiannessConverter::swapBytes(value);
+    }
+    return value;
+}
+
+template<typename T, bool Swap>
+void storeElement(uint8_t* p, T value) {
+    if constexpr (Swap && sizeof(T) > 1) {
+        value = EndiannessConverter::swapBytes(value);
+    }
+    std::memcpy(p, &value, sizeof(T));
+}
+
+// Scalar reference used for tails and non-SSE2 builds
+template<typename T>
+T toRaw(double physical, double factor, double offset) {
+    double raw = (physical - offset) / factor;
+    if constexpr (std::is_floating_point_v<T>) {
+        return static_cast<T>(raw);
+    } else {
+        constexpr double lo = static_cast<double>(std::numeric_limits<T>::min());
+        constexpr double hi = static_cast<double>(std::numeric_limits<T>::max());
+        if (!(raw >= lo)) return std::numeric_limits<T>::min();
+        if (raw > hi) return std::numeric_limits<T>::max();
+        return static_cast<T>(raw + (raw >= 0 ? 0.5 : -0.5));
+    }
+}
+
+#ifdef WINMMM10_SCALING_SSE2
+
+inline __m128i swap16(__m128i x) {
+    return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+}
+
+inline __m128i swap32(__m128i x) {
+    const __m128i mask1 = _mm_set1_epi32(0x00FF0000);
+    const __m128i mask2 = _mm_set1_epi32(0x0000FF00);
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(x, 24), _mm_srli_epi32(x, 24)),
+                        _mm_or_si128(_mm_and_si128(_mm_slli_epi32(x, 8), mask1),
+                                     _mm_and_si128(_mm_srli_epi32(x, 8), mask2)));
+}
+
+// Loads four elements widened to 32-bit lanes (raw bits for uint32/float)
+template<typename T, bool Swap>
+__m128i load4(const uint8_t* p) {
+    const __m128i zero = _mm_setzero_si128();
+    if constexpr (sizeof(T) == 1) {
+        int32_t packed;
+        std::memcpy(&packed, p, 4);
+        __m128i x = _mm_cvtsi32_si128(packed);
+        if constexpr (std::is_signed_v<T>) {
+            x = _mm_unpacklo_epi8(x, x);
+            x = _mm_unpacklo_epi16(x, x);
+            return _mm_srai_epi32(x, 24);
+        } else {
+            x = _mm_unpacklo_epi8(x, zero);
+            return _mm_unpacklo_epi16(x, zero);
+        }
+    } else if constexpr (sizeof(T) == 2) {
+        __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+        if constexpr (Swap) {
+            x = swap16(x);
+        }
+        if constexpr (std::is_signed_v<T>) {
+            return _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        } else {
+            return _mm_unpacklo_epi16(x, zero);
+        }
+    } else {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        if constexpr (Swap) {
+            x = swap32(x);
+        }
+        return x;
+    }
+}
+
+template<typename T, Endianness E>
+void decodeKernel(const uint8_t* bytes, size_t count, double factor, double offset, double* out) {
+    constexpr bool Swap = (E != NativeEndianness);
+    const __m128d vFactor = _mm_set1_pd(factor);
+    const __m128d vOffset = _mm_set1_pd(offset);
+    
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i x = load4<T, Swap>(bytes + i * sizeof(T));
+        __m128d lo, hi;
+        if constexpr (std::is_same_v<T, float>) {
+            __m128 f = _mm_castsi128_ps(x);
+            lo = _mm_cvtps_pd(f);
+            hi = _mm_cvtps_pd(_mm_movehl_ps(f, f));
+        } else {
+            lo = _mm_cvtepi32_pd(x);
+            hi = _mm_cvtepi32_pd(_mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+            if constexpr (std::is_same_v<T, uint32_t>) {
+                // Lanes were converted as signed; lift values >= 2^31 back up
+                const __m128d two32 = _mm_set1_pd(4294967296.0);
+                const __m128d zero = _mm_setzero_pd();
+                lo = _mm_add_pd(lo, _mm_and_pd(_mm_cmplt_pd(lo, zero), two32));
+                hi = _mm_add_pd(hi, _mm_and_pd(_mm_cmplt_pd(hi, zero), two32));
+            }
+        }
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_mul_pd(lo, vFactor), vOffset));
+        _mm_storeu_pd(out + i + 2, _mm_add_pd(_mm_mul_pd(hi, vFactor), vOffset));
+    }
+    
+    for (; i < count; ++i) {
+        T raw = loadElement<T, Swap>(bytes + i * sizeof(T));
+        out[i] = static_cast<double>(raw) * factor + offset;
+    }
+}
+
+// Saturates and rounds two values to int32 lanes 0..1 of the result
+template<typename T>
+__m128i toInt32x2(__m128d raw) {
+    constexpr double lo = static_cast<double>(std::numeric_limits<T>::min());
+    constexpr double hi = static_cast<double>(std::numeric_limits<T>::max());
+    // max_pd returns its second operand for NaN, so NaN saturates to lo
+    raw = _mm_min_pd(_mm_max_pd(raw, _mm_set1_pd(lo)), _mm_set1_pd(hi));
+    
+    if constexpr (std::is_same_v<T, uint32_t>) {
+        // Truncate in the signed domain, then correct toward floor and re-bias
+        __m128d shifted = _mm_sub_pd(_mm_add_pd(raw, _mm_set1_pd(0.5)), _mm_set1_pd(2147483648.0));
+        __m128i truncated = _mm_cvttpd_epi32(shifted);
+        __m128d roundedUp = _mm_cmpgt_pd(_mm_cvtepi32_pd(truncated), shifted);
+        __m128i adjust = _mm_shuffle_epi32(_mm_castpd_si128(roundedUp), _MM_SHUFFLE(3, 3, 2, 0));
+        truncated = _mm_add_epi32(truncated, adjust);
+        return _mm_xor_si128(truncated, _mm_set1_epi32(static_cast<int32_t>(0x80000000u)));
+    } else {
+        const __m128d signMask = _mm_set1_pd(-0.0);
+        __m128d half = _mm_or_pd(_mm_and_pd(raw, signMask), _mm_set1_pd(0.5));
+        return _mm_cvttpd_epi32(_mm_add_pd(raw, half));
+    }
+}
+
+template<typename T, Endianness E>
+void encodeKernel(const double* physical, size_t count, double factor, double offset, uint8_t* bytes) {
+    constexpr bool Swap = (E != NativeEndianness);
+    const __m128d vFactor = _mm_set1_pd(factor);
+    const __m128d vOffset = _mm_set1_pd(offset);
+    
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128d r0 = _mm_div_pd(_mm_sub_pd(_mm_loadu_pd(physical + i), vOffset), vFactor);
+        __m128d r1 = _mm_div_pd(_mm_sub_pd(_mm_loadu_pd(physical + i + 2), vOffset), vFactor);
+        uint8_t* dst = bytes + i * sizeof(T);
+        
+        if constexpr (std::is_same_v<T, float>) {
+            __m128 f = _mm_movelh_ps(_mm_cvtpd_ps(r0), _mm_cvtpd_ps(r1));
+            __m128i x = _mm_castps_si128(f);
+            if constexpr (Swap) {
+                x = swap32(x);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), x);
+        } else {
+            __m128i x = _mm_unpacklo_epi64(toInt32x2<T>(r0), toInt32x2<T>(r1));
+            if constexpr (sizeof(T) == 1) {
+                x = _mm_packs_epi32(x, x);
+                x = std::is_signed_v<T> ? _mm_packs_epi16(x, x) : _mm_packus_epi16(x, x);
+                int32_t packed = _mm_cvtsi128_si32(x);
+                std::memcpy(dst, &packed, 4);
+            } else if constexpr (sizeof(T) == 2) {
+                if constexpr (std::is_signed_v<T>) {
+                    x = _mm_packs_epi32(x, x);
+                } else {
+                    // Bias into int16 range so the signed pack cannot saturate
+                    x = _mm_packs_epi32(_mm_sub_epi32(x, _mm_set1_epi32(32768)), _mm_setzero_si128());
+                    x = _mm_xor_si128(x, _mm_set1_epi16(static_cast<int16_t>(0x8000)));
+                }
+                if constexpr (Swap) {
+                    x = swap16(x);
+                }
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), x);
+            } else {
+                if constexpr (Swap) {
+                    x = swap32(x);
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), x);
+            }
+        }
+    }
+    
+    for (; i < count; ++i) {
+        storeElement<T, Swap>(bytes + i * sizeof(T), toRaw<T>(physical[i], factor, offset));
+    }
+}
+
+#else
+
+template<typename T, Endianness E>
+void decodeKernel(const uint8_t* bytes, size_t count, double factor, double offset, double* out) {
+    constexpr bool Swap = (E != NativeEndianness);
+    for (size_t i = 0; i < count; ++i) {
+        T raw = loadElement<T, Swap>(bytes + i * sizeof(T));
+        out[i] = static_cast<double>(raw) * factor + offset;
+    }
+}
+
+template<typename T, Endianness E>
+void encodeKernel(const double* physical, size_t count, double factor, double offset, uint8_t* bytes) {
+    constexpr bool Swap = (E != NativeEndianness);
+    for (size_t i = 0; i < count; ++i) {
+        storeElement<T, Swap>(bytes + i * sizeof(T), toRaw<T>(physical[i], factor, offset));
+    }
+}
+
+#endif
+
+} // namespace
+
+template<typename T, Endianness E>
+void ScalingEngine::decode(const uint8_t* bytes, size_t count, double factor, double offset, double* out) {
+    decodeKernel<T, E>(bytes, count, factor, offset, out);
+}
+
+template<typename T, Endianness E>
+void ScalingEngine::encode(const double* physical, size_t count, double factor, double offset, uint8_t* bytes) {
+    encodeKernel<T, E>(physical, count, factor, offset, bytes);
+}
+
+void ScalingEngine::decode(uint16_t dataType, const uint8_t* bytes, size_t count, Endianness endian,
+                           double factor, double offset, double* out) {
+    dispatchDataType(dataType, [&](auto tag) {
+        decode<decltype(tag)>(bytes, count, endian, factor, offset, out);
+    });
+}
+
+void ScalingEngine::encode(uint16_t dataType, const double* physical, size_t count, Endianness endian,
+                           double factor, double offset, uint8_t* bytes) {
+    dispatchDataType(dataType, [&](auto tag) {
+        encode<decltype(tag)>(physical, count, endian, factor, offset, bytes);
+    });
+}
+
+// Explicit instantiations for every MapDataType in both byte orders
+template void ScalingEngine::decode<uint8_t, Endianness::Little>(const uint8_t*, size_t, double, double, double*);
+template void ScalingEngine::decode<int8_t, Endianness::Little>(const uint8_t*, size_t, double, double, double*);
+template void ScalingEngine::decode<uint16_t, Endianness::Little>(const uint8_t*, size_t, double, double, double*);
+template void ScalingEngine::decode<int16_t, Endianness::Little>(const uint8_t*, size_t, double, double, double*);
+template void ScalingEngine::decode<uint32_t, Endianness::Little>(const uint8_t*, size_t, double, double, double*);
+template void ScalingEngine::decode<int32_t, Endianness::Little>(const uint8_t*, size_t, double, double, double*);
+template void ScalingEngine::decode<float, Endianness::Little>(const uint8_t*, size_t, double, double, double*);
+
+template void ScalingEngine::decode<uint8_t, Endianness::Big>(const uint8_t*, size_t, double, double, double*);
+template void ScalingEngine::decode<int8_t, Endianness::Big>(const uint8_t*, size_t, double, double, double*);
+template void ScalingEngine::decode<uint16_t, Endianness::Big>(const uint8_t*, size_t, double, double, double*);
+template void ScalingEngine::decode<int16_t, Endianness::Big>(const uint8_t*, size_t, double, double, double*);
+template void ScalingEngine::decode<uint32_t, Endianness::Big>(const uint8_t*, size_t, double, double, double*);
+template void ScalingEngine::decode<int32_t, Endianness::Big>(const uint8_t*, size_t, double, double, double*);
+template void ScalingEngine::decode<float, Endianness::Big>(const uint8_t*, size_t, double, double, double*);
+
+template void ScalingEngine::encode<uint8_t, Endianness::Little>(const double*, size_t, double, double, uint8_t*);
+template void ScalingEngine::encode<int8_t, Endianness::Little>(const double*, size_t, double, double, uint8_t*);
+template void ScalingEngine::encode<uint16_t, Endianness::Little>(const double*, size_t, double, double, uint8_t*);
+template void ScalingEngine::encode<int16_t, Endianness::Little>(const double*, size_t, double, double, uint8_t*);
+template void ScalingEngine::encode<uint32_t, Endianness::Little>(const double*, size_t, double, double, uint8_t*);
+template void ScalingEngine::encode<int32_t, Endianness::Little>(const double*, size_t, double, double, uint8_t*);
+template void ScalingEngine::encode<float, Endianness::Little>(const double*, size_t, double, double, uint8_t*);
+
+template void ScalingEngine::encode<uint8_t, Endianness::Big>(const double*, size_t, double, double, uint8_t*);
+template void ScalingEngine::encode<int8_t, Endianness::Big>(const double*, size_t, double, double, uint8_t*);
+template void ScalingEngine::encode<uint16_t, Endianness::Big>(const double*, size_t, double, double, uint8_t*);
+template void ScalingEngine::encode<int16_t, Endianness::Big>(const double*, size_t, double, double, uint8_t*);
+template void ScalingEngine::encode<uint32_t, Endianness::Big>(const double*, size_t, double, double, uint8_t*);
+template void ScalingEngine::encode<int32_t, Endianness::Big>(const double*, size_t, double, double, uint8_t*);
+template void ScalingEngine::encode<float, Endianness::Big>(const double*, size_t, double, double, uint8_t*);
+
+} // namespace WinMMM10
@@ -1,7 +1,11 @@
 #pragma once
 
+#include "MapDataType.h"
+#include "../binary/Endianness.h"
+#include <algorithm>
 #include <cstdint>
 #include <cstddef>
+#include <span>
 #include <type_traits>
 
 namespace WinMMM10 {
@@ -21,6 +25,18 @@ public:
         return static_cast<double>(rawValue) * factor + offset;
     }
     
+    static double rawToPhysical(int8_t rawValue, double factor, double offset) {
+        return static_cast<double>(rawValue) * factor + offset;
+    }
+    
+    static double rawToPhysical(uint32_t rawValue, double factor, double offset) {
+        return static_cast<double>(rawValue) * factor + offset;
+    }
+    
+    static double rawToPhysical(int32_t rawValue, double factor, double offset) {
+        return static_cast<double>(rawValue) * factor + offset;
+    }
+    
     static double rawToPhysical(float rawValue, double factor, double offset) {
         return static_cast<double>(rawValue) * factor + offset;
     }
@@ -47,6 +63,27 @@ public:
         return static_cast<uint8_t>(raw + 0.5);
     }
     
+    static int8_t physicalToRawI8(double physicalValue, double factor, double offset) {
+        double raw = (physicalValue - offset) / factor;
+        if (raw < -128) return -128;
+        if (raw > 127) return 127;
+        return static_cast<int8_t>(raw + (raw >= 0 ? 0.5 : -0.5));
+    }
+    
+    static uint32_t physicalToRawU32(double physicalValue, double factor, double offset) {
+        double raw = (physicalValue - offset) / factor;
+        if (raw < 0) return 0;
+        if (raw > 4294967295.0) return 4294967295u;
+        return static_cast<uint32_t>(raw + 0.5);
+    }
+    
+    static int32_t physicalToRawI32(double physicalValue, double factor, double offset) {
+        double raw = (physicalValue - offset) / factor;
+        if (raw < -2147483648.0) return INT32_MIN;
+        if (raw > 2147483647.0) return INT32_MAX;
+        return static_cast<int32_t>(raw + (raw >= 0 ? 0.5 : -0.5));
+    }
+    
     static float physicalToRawFloat(double physicalValue, double factor, double offset) {
         return static_cast<float>((physicalValue - offset) / factor);
     }
@@ -60,12 +97,68 @@ public:
             return physicalToRawI16(physicalValue, factor, offset);
         } else if constexpr (std::is_same_v<T, uint8_t>) {
             return physicalToRawU8(physicalValue, factor, offset);
+        } else if constexpr (std::is_same_v<T, int8_t>) {
+            return physicalToRawI8(physicalValue, factor, offset);
+        } else if constexpr (std::is_same_v<T, uint32_t>) {
+            return physicalToRawU32(physicalValue, factor, offset);
+        } else if constexpr (std::is_same_v<T, int32_t>) {
+            return physicalToRawI32(physicalValue, factor, offset);
         } else if constexpr (std::is_same_v<T, float>) {
             return physicalToRawFloat(physicalValue, factor, offset);
         } else {
             static_assert(std::is_same_v<T, void>, "Unsupported type for physicalToRaw");
         }
     }
+    
+    // Batch conversions over packed binary data, SIMD-accelerated where available.
+    // Kernels are specialized per byte order at compile time, so there is no
+    // per-element branch on endianness. Encoding saturates to the range of T
+    // (NaN maps to its minimum) and rounds integers half away from zero, matching
+    // the scalar physicalToRaw functions.
+    template<typename T, Endianness E>
+    static void decode(const uint8_t* bytes, size_t count, double factor, double offset, double* out);
+    template<typename T, Endianness E>
+    static void encode(const double* physical, size_t count, double factor, double offset, uint8_t* bytes);
+    
+    // Runtime byte order, resolved once per call
+    template<typename T>
+    static void decode(const uint8_t* bytes, size_t count, Endianness endian,
+                       double factor, double offset, double* out) {
+        if (endian == Endianness::Big) {
+            decode<T, Endianness::Big>(bytes, count, factor, offset, out);
+        } else {
+            decode<T, Endianness::Little>(bytes, count, factor, offset, out);
+        }
+    }
+    
+    template<typename T>
+    static void encode(const double* physical, size_t count, Endianness endian,
+                       double factor, double offset, uint8_t* bytes) {
+        if (endian == Endianness::Big) {
+            encode<T, Endianness::Big>(physical, count, factor, offset, bytes);
+        } else {
+            encode<T, Endianness::Little>(physical, count, factor, offset, bytes);
+        }
+    }
+    
+    // Same, with T selected from a MapDataType code
+    static void decode(uint16_t dataType, const uint8_t* bytes, size_t count, Endianness endian,
+                       double factor, double offset, double* out);
+    static void encode(uint16_t dataType, const double* physical, size_t count, Endianness endian,
+                       double factor, double offset, uint8_t* bytes);
+    
+    // Span forms for raw values already in host byte order
+    template<typename T>
+    static void rawToPhysical(std::span<const T> raw, double factor, double offset, std::span<double> out) {
+        decode<T, NativeEndianness>(reinterpret_cast<const uint8_t*>(raw.data()), std::min(raw.size(), out.size()),
+                                    factor, offset, out.data());
+    }
+    
+    template<typename T>
+    static void physicalToRaw(std::span<const double> physical, double factor, double offset, std::span<T> out) {
+        encode<T, NativeEndianness>(physical.data(), std::min(physical.size(), out.size()),
+                                    factor, offset, reinterpret_cast<uint8_t*>(out.data()));
+    }
 };
 
 } // namespace WinMMM10
@@ -0,0 +1,79 @@
+#include "TypedMapStorage.h"
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+namespace WinMMM10 {
+
+namespace {
+
+template<typename T>
+T clampToRaw(double value) {
+    if constexpr (std::is_floating_point_v<T>) {
+        return static_cast<T>(value);
+    } else {
+        // NaN maps to the minimum, as in ScalingEngine::encode
+        if (std::isnan(value)) {
+            return std::numeric_limits<T>::min();
+        }
+        double clamped = std::clamp(value, static_cast<double>(std::numeric_limits<T>::min()),
+                                    static_cast<double>(std::numeric_limits<T>::max()));
+        return static_cast<T>(std::llround(clamped));
+    }
+}
+
+} // namespace
+
+MapStorage::MapStorage(uint16_t dataType, size_t count, double factor, double offset, Endianness endian)
+    : m_dataType(dataType)
+{
+    dispatchDataType(dataType, [&](auto tag) {
+        using T = decltype(tag);
+        m_storage = TypedMapStorage<T>(count, factor, offset, endian);
+    });
+}
+
+size_t MapStorage::size() const {
+    return visit([](const auto& storage) { return storage.size(); });
+}
+
+Endianness MapStorage::endianness() const {
+    return visit([](const auto& storage) { return storage.endianness(); });
+}
+
+void MapStorage::decode(const uint8_t* data, size_t dataSize) {
+    std::visit([&](auto& storage) { storage.decode(data, dataSize); }, m_storage);
+}
+
+void MapStorage::encode(uint8_t* data, size_t dataSize) const {
+    visit([&](const auto& storage) { storage.encode(data, dataSize); });
+}
+
+double MapStorage::rawValue(size_t index) const {
+    return visit([&](const auto& storage) { return static_cast<double>(storage.raw(index)); });
+}
+
+double MapStorage::physicalValue(size_t index) const {
+    return visit([&](const auto& storage) { return storage.physical(index); });
+}
+
+void MapStorage::setRawValue(size_t index, double value) {
+    std::visit([&](auto& storage) {
+        using T = typename std::decay_t<decltype(storage)>::value_type;
+        storage.setRaw(index, clampToRaw<T>(value));
+    }, m_storage);
+}
+
+void MapStorage::setPhysicalValue(size_t index, double value) {
+    std::visit([&](auto& storage) { storage.setPhysical(index, value); }, m_storage);
+}
+
+std::span<const double> MapStorage::physicalValues() const {
+    return visit([](const auto& storage) { return storage.physicalValues(); });
+}
+
+size_t MapStorage::memoryUsage() const {
+    return visit([](const auto& storage) { return storage.memoryUsage(); });
+}
+
+} // namespace WinMMM10
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "MapDataType.h"
+#include "ScalingEngine.h"
+#include "../binary/Endianness.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace WinMMM10 {
+
+// Map values of one compile-time element type. Raw values are kept exactly as
+// stored in the binary; physical values are decoded alongside them in a single
+// pass and exposed as one contiguous span.
+template<typename T>
+class TypedMapStorage {
+public:
+    using value_type = T;
+    
+    TypedMapStorage() = default;
+    TypedMapStorage(size_t count, double factor, double offset, Endianness endian = Endianness::Little)
+        : m_raw(count), m_physical(count, offset), m_factor(factor), m_offset(offset), m_endian(endian) {}
+    
+    size_t size() const { return m_raw.size(); }
+    Endianness endianness() const { return m_endian; }
+    
+    // Decodes as many elements as dataSize holds; the rest stay zero
+    void decode(const uint8_t* data, size_t dataSize) {
+        size_t count = std::min(m_raw.size(), dataSize / sizeof(T));
+        if (m_endian == Endianness::Big) {
+            decodeAs<Endianness::Big>(data, count);
+        } else {
+            decodeAs<Endianness::Little>(data, count);
+        }
+    }
+    
+    void encode(uint8_t* data, size_t dataSize) const {
+        size_t count = std::min(m_raw.size(), dataSize / sizeof(T));
+        if (m_endian == Endianness::Big) {
+            encodeAs<Endianness::Big>(data, count);
+        } else {
+            encodeAs<Endianness::Little>(data, count);
+        }
+    }
+    
+    T raw(size_t index) const { return m_raw[index]; }
+    double physical(size_t index) const { return m_physical[index]; }
+    
+    void setRaw(size_t index, T value) {
+        m_raw[index] = value;
+        m_physical[index] = ScalingEngine::rawToPhysical(value, m_factor, m_offset);
+    }
+    
+    // Quantizes through the element type so the physical span matches what gets written
+    void setPhysical(size_t index, double value) {
+        setRaw(index, ScalingEngine::physicalToRaw<T>(value, m_factor, m_offset));
+    }
+    
+    std::span<const T> rawValues() const { return m_raw; }
+    std::span<const double> physicalValues() const { return m_physical; }
+    
+    size_t memoryUsage() const {
+        return m_raw.capacity() * sizeof(T) + m_physical.capacity() * sizeof(double);
+    }
+
+private:
+    // Stored and physical values in one pass over the bytes
+    template<Endianness E>
+    void decodeAs(const uint8_t* data, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            T value;
+            std::memcpy(&value, data + i * sizeof(T), sizeof(T));
+            if constexpr (E != NativeEndianness && sizeof(T) > 1) {
+                value = EndiannessConverter::swapBytes(value);
+            }
+            m_raw[i] = value;
+            m_physical[i] = ScalingEngine::rawToPhysical(value, m_factor, m_offset);
+        }
+    }
+    
+    template<Endianness E>
+    void encodeAs(uint8_t* data, size_t count) const {
+        if constexpr (E != NativeEndianness && sizeof(T) > 1) {
+            for (size_t i = 0; i < count; ++i) {
+                T value = EndiannessConverter::swapBytes(m_raw[i]);
+                std::memcpy(data + i * sizeof(T), &value, sizeof(T));
+            }
+        } else {
+            std::memcpy(data, m_raw.data(), count * sizeof(T));
+        }
+    }
+    
+    std::vector<T> m_raw;
+    std::vector<double> m_physical;
+    double m_factor{1.0};
+    double m_offset{0.0};
+    Endianness m_endian{Endianness::Little};
+};
+
+// Runtime wrapper over the supported element types. The type is chosen once
+// from the data type code; bulk work dispatches once per call via visit().
+class MapStorage {
+public:
+    MapStorage() = default;
+    MapStorage(uint16_t dataType, size_t count, double factor, double offset,
+               Endianness endian = Endianness::Little);
+    
+    uint16_t dataType() const { return m_dataType; }
+    Endianness endianness() const;
+    size_t size() const;
+    
+    void decode(const uint8_t* data, size_t dataSize);
+    void encode(uint8_t* data, size_t dataSize) const;
+    
+    // Raw values widened to double (exact for all supported types)
+    double rawValue(size_t index) const;
+    double physicalValue(size_t index) const;
+    void setRawValue(size_t index, double value);
+    void setPhysicalValue(size_t index, double value);
+    
+    std::span<const double> physicalValues() const;
+    size_t memoryUsage() const;
+    
+    template<typename Visitor>
+    decltype(auto) visit(Visitor&& visitor) const {
+        return std::visit(std::forward<Visitor>(visitor), m_storage);
+    }
+
+private:
+    using Variant = std::variant<TypedMapStorage<uint16_t>,
+                                 TypedMapStorage<uint8_t>,
+                                 TypedMapStorage<int16_t>,
+                                 TypedMapStorage<float>,
+                                 TypedMapStorage<int8_t>,
+                                 TypedMapStorage<uint32_t>,
+                                 TypedMapStorage<int32_t>>;
+    
+    uint16_t m_dataType{static_cast<uint16_t>(MapDataType::UInt16)};
+    Variant m_storage;
+};
+
+} // namespace WinMMM10
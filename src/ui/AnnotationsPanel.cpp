@@ -5,6 +5,7 @@
 #include <QLabel>
 #include <sstream>
 #include <iomanip>
+#include <limits>
 
 namespace WinMMM10 {
 
@@ -35,6 +36,11 @@ void AnnotationsPanel::setupUI() {
     m_addressEdit = new QLineEdit(this);
     m_addressEdit->setPlaceholderText("0x00000000");
     addrLayout->addWidget(m_addressEdit);
+    addrLayout->addWidget(new QLabel("Length:", this));
+    m_lengthSpin = new QSpinBox(this);
+    m_lengthSpin->setRange(1, std::numeric_limits<int>::max());
+    m_lengthSpin->setSuffix(" bytes");
+    addrLayout->addWidget(m_lengthSpin);
     addLayout->addLayout(addrLayout);
     
     m_noteEdit = new QTextEdit(this);
@@ -85,6 +91,9 @@ void AnnotationsPanel::populateAnnotations() {
     for (const auto& annotation : annotations) {
         std::ostringstream oss;
         oss << "0x" << std::hex << std::uppercase << std::setfill('0') << std::setw(8) << annotation.address;
+        if (annotation.length > 1) {
+            oss << " (+" << std::dec << annotation.length << ")";
+        }
         QString text = QString::fromStdString(oss.str()) + ": " + QString::fromStdString(annotation.note);
         
         auto* item = new QListWidgetItem(text, m_annotationList);
@@ -133,9 +142,11 @@ void AnnotationsPanel::onAddAnnotation() {
     annotation.address = address;
     annotation.note = note.toStdString();
     annotation.color = m_currentColor.name().toStdString();
+    annotation.length = static_cast<size_t>(m_lengthSpin->value());
     
     m_annotationManager->addAnnotation(annotation);
     refreshAnnotations();
+    emit annotationsChanged();
     
     m_noteEdit->clear();
 }
@@ -147,6 +158,7 @@ void AnnotationsPanel::onDeleteAnnotation() {
     size_t address = item->data(Qt::UserRole).toULongLong();
     m_annotationManager->removeAnnotation(address);
     refreshAnnotations();
+    emit annotationsChanged();
 }
 
 void AnnotationsPanel::onAnnotationSelected() {
@@ -6,6 +6,7 @@
 #include <QTextEdit>
 #include <QColorDialog>
 #include <QLineEdit>
+#include <QSpinBox>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include "../core/AnnotationManager.h"
@@ -26,6 +27,7 @@ public:
 signals:
     void annotationSelected(size_t address);
     void annotationDoubleClicked(size_t address);
+    void annotationsChanged();
 
 private slots:
     void onAddAnnotation();
@@ -42,6 +44,7 @@ private:
     AnnotationManager* m_annotationManager{nullptr};
     QListWidget* m_annotationList{nullptr};
     QLineEdit* m_addressEdit{nullptr};
+    QSpinBox* m_lengthSpin{nullptr};
     QTextEdit* m_noteEdit{nullptr};
     QPushButton* m_colorButton{nullptr};
     QPushButton* m_addButton{nullptr};
@@ -1,9 +1,13 @@
 #include "CacheSettingsDialog.h"
 #include "../cache/CacheManager.h"
+#include "../core/Settings.h"
 #include <QMessageBox>
 #include <QGroupBox>
 #include <QFormLayout>
+#include <QGridLayout>
 #include <QDialogButtonBox>
+#include <QApplication>
+#include <QPointer>
 
 namespace WinMMM10 {
 
@@ -31,6 +35,7 @@ void CacheSettingsDialog::setupUI() {
     m_totalSizeLabel = new QLabel("0 B", this);
     m_recentProjectsLabel = new QLabel("0", this);
     m_recentBinariesLabel = new QLabel("0", this);
+    m_decodedMapsLabel = new QLabel("0 maps", this);
     
     infoLayout->addRow("Application Cache:", m_appCacheSizeLabel);
     infoLayout->addRow("Project Cache:", m_projectCacheSizeLabel);
@@ -38,6 +43,7 @@ void CacheSettingsDialog::setupUI() {
     infoLayout->addRow("Total Cache Size:", m_totalSizeLabel);
     infoLayout->addRow("Recent Projects:", m_recentProjectsLabel);
     infoLayout->addRow("Recent Binaries:", m_recentBinariesLabel);
+    infoLayout->addRow("Decoded Maps (memory):", m_decodedMapsLabel);
     
     layout->addWidget(infoGroup);
     
@@ -55,7 +61,7 @@ void CacheSettingsDialog::setupUI() {
     connect(m_clearProjectCacheButton, &QPushButton::clicked, this, &CacheSettingsDialog::onClearProjectCache);
     connect(m_clearTempButton, &QPushButton::clicked, this, &CacheSettingsDialog::onClearTempFiles);
     connect(m_clearAllButton, &QPushButton::clicked, this, &CacheSettingsDialog::onClearAll);
-    connect(m_refreshButton, &QPushButton::clicked, this, &CacheSettingsDialog::updateCacheInfo);
+    connect(m_refreshButton, &QPushButton::clicked, this, &CacheSettingsDialog::onRefresh);
     
     actionsLayout->addWidget(m_clearAppCacheButton);
     actionsLayout->addWidget(m_clearProjectCacheButton);
@@ -65,6 +71,64 @@ void CacheSettingsDialog::setupUI() {
     
     layout->addWidget(actionsGroup);
     
+    // Decoded map cache
+    auto* mapCacheGroup = new QGroupBox("Decoded Map Cache", this);
+    auto* mapCacheLayout = new QFormLayout(mapCacheGroup);
+    
+    m_mapCacheBudgetSpin = new QSpinBox(this);
+    m_mapCacheBudgetSpin->setRange(1, 4096);
+    m_mapCacheBudgetSpin->setSuffix(" MB");
+    m_mapCacheBudgetSpin->setValue(Settings::instance().mapCacheBudgetMB());
+    connect(m_mapCacheBudgetSpin, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &CacheSettingsDialog::onMapCacheBudgetChanged);
+    connect(m_mapCacheBudgetSpin, &QSpinBox::editingFinished, this, &CacheSettingsDialog::saveSettings);
+    mapCacheLayout->addRow("Memory Budget:", m_mapCacheBudgetSpin);
+    
+    layout->addWidget(mapCacheGroup);
+    
+    // Disk cache limits
+    auto* evictionGroup = new QGroupBox("Disk Cache Limits (0 = unlimited)", this);
+    auto* evictionLayout = new QGridLayout(evictionGroup);
+    evictionLayout->addWidget(new QLabel("Max Size", this), 0, 1);
+    evictionLayout->addWidget(new QLabel("Max Age", this), 0, 2);
+    
+    const CacheCategory categories[] = {CacheCategory::Thumbnails, CacheCategory::Temp, CacheCategory::Projects};
+    const char* categoryNames[] = {"Thumbnails:", "Temporary Files:", "Project Caches:"};
+    auto& eviction = CacheManager::instance().evictionService();
+    for (size_t i = 0; i < m_evictionSizeSpins.size(); ++i) {
+        EvictionPolicy policy = eviction.policy(categories[i]);
+        
+        auto* sizeSpin = new QSpinBox(this);
+        sizeSpin->setRange(0, 65536);
+        sizeSpin->setSuffix(" MB");
+        sizeSpin->setValue(static_cast<int>(policy.maxBytes / (1024 * 1024)));
+        
+        auto* ageSpin = new QSpinBox(this);
+        ageSpin->setRange(0, 3650);
+        ageSpin->setSuffix(" days");
+        ageSpin->setValue(static_cast<int>(policy.maxAgeSeconds / (24 * 60 * 60)));
+        
+        connect(sizeSpin, QOverload<int>::of(&QSpinBox::valueChanged),
+                this, &CacheSettingsDialog::onEvictionPolicyChanged);
+        connect(ageSpin, QOverload<int>::of(&QSpinBox::valueChanged),
+                this, &CacheSettingsDialog::onEvictionPolicyChanged);
+        connect(sizeSpin, &QSpinBox::editingFinished, this, &CacheSettingsDialog::saveSettings);
+        connect(ageSpin, &QSpinBox::editingFinished, this, &CacheSettingsDialog::saveSettings);
+        
+        int row = static_cast<int>(i) + 1;
+        evictionLayout->addWidget(new QLabel(categoryNames[i], this), row, 0);
+        evictionLayout->addWidget(sizeSpin, row, 1);
+        evictionLayout->addWidget(ageSpin, row, 2);
+        m_evictionSizeSpins[i] = sizeSpin;
+        m_evictionAgeSpins[i] = ageSpin;
+    }
+    
+    m_evictNowButton = new QPushButton("Evict Now", this);
+    connect(m_evictNowButton, &QPushButton::clicked, this, &CacheSettingsDialog::onEvictNow);
+    evictionLayout->addWidget(m_evictNowButton, static_cast<int>(m_evictionSizeSpins.size()) + 1, 2);
+    
+    layout->addWidget(evictionGroup);
+    
     // Options
     m_autoCleanupCheckBox = new QCheckBox("Auto-cleanup on exit", this);
     layout->addWidget(m_autoCleanupCheckBox);
@@ -100,6 +164,96 @@ void CacheSettingsDialog::updateCacheInfo() {
     
     m_recentProjectsLabel->setText(QString::number(stats.recentProjectsCount));
     m_recentBinariesLabel->setText(QString::number(stats.recentBinariesCount));
+    
+    m_decodedMapsLabel->setText(QString("%1 maps, %2 / %3 MB")
+                                .arg(stats.decodedMapsCount)
+                                .arg(stats.decodedMapsSize / (1024.0 * 1024.0), 0, 'f', 2)
+                                .arg(stats.decodedMapsBudget / (1024 * 1024)));
+}
+
+void CacheSettingsDialog::onRefresh() {
+    // Re-scan the cache directories in the background, then show the corrected sizes
+    m_refreshButton->setEnabled(false);
+    m_refreshButton->setText("Scanning...");
+    
+    QPointer<CacheSettingsDialog> self(this);
+    bool started = CacheManager::instance().applicationCache().reconcileSizes([self]() {
+        QMetaObject::invokeMethod(qApp, [self]() {
+            if (!self) {
+                return;
+            }
+            self->m_refreshButton->setEnabled(true);
+            self->m_refreshButton->setText("Refresh");
+            self->updateCacheInfo();
+        }, Qt::QueuedConnection);
+    });
+    
+    if (!started) {
+        m_refreshButton->setEnabled(true);
+        m_refreshButton->setText("Refresh");
+        updateCacheInfo();
+    }
+}
+
+void CacheSettingsDialog::onMapCacheBudgetChanged(int megabytes) {
+    Settings::instance().setMapCacheBudgetMB(megabytes);
+    m_settingsChanged = true;
+    CacheManager::instance().mapDataCache().setByteBudget(static_cast<uint64_t>(megabytes) * 1024 * 1024);
+    updateCacheInfo();
+}
+
+void CacheSettingsDialog::onEvictionPolicyChanged() {
+    const CacheCategory categories[] = {CacheCategory::Thumbnails, CacheCategory::Temp, CacheCategory::Projects};
+    auto& eviction = CacheManager::instance().evictionService();
+    for (size_t i = 0; i < m_evictionSizeSpins.size(); ++i) {
+        EvictionPolicy policy;
+        policy.maxBytes = static_cast<uint64_t>(m_evictionSizeSpins[i]->value()) * 1024 * 1024;
+        policy.maxAgeSeconds = static_cast<int64_t>(m_evictionAgeSpins[i]->value()) * 24 * 60 * 60;
+        eviction.setPolicy(categories[i], policy);
+    }
+    m_settingsChanged = true; // Saved once editing finishes, not on every step
+}
+
+void CacheSettingsDialog::saveSettings() {
+    if (!m_settingsChanged) {
+        return;
+    }
+    m_settingsChanged = false;
+    Settings::instance().save();
+    CacheManager::instance().evictionService().save();
+}
+
+void CacheSettingsDialog::done(int result) {
+    saveSettings();
+    QDialog::done(result);
+}
+
+void CacheSettingsDialog::onEvictNow() {
+    // The pass runs on the eviction service thread; deleting files can take a while
+    m_evictNowButton->setEnabled(false);
+    m_evictNowButton->setText("Evicting...");
+    
+    QPointer<CacheSettingsDialog> self(this);
+    auto onFinished = [self](const CacheEvictionService::Result& result) {
+        QMetaObject::invokeMethod(qApp, [self, result]() {
+            if (!self) {
+                return;
+            }
+            self->m_evictNowButton->setEnabled(true);
+            self->m_evictNowButton->setText("Evict Now");
+            self->updateCacheInfo();
+            QMessageBox::information(self, "Cache Eviction",
+                                     QString("Removed %1 file(s), freed %2 MB.")
+                                     .arg(result.filesRemoved)
+                                     .arg(result.bytesFreed / (1024.0 * 1024.0), 0, 'f', 2));
+        }, Qt::QueuedConnection);
+    };
+    
+    auto& eviction = CacheManager::instance().evictionService();
+    if (!eviction.requestPass(onFinished)) {
+        // Not started yet; the pass start() runs right away is the one reported
+        eviction.start(CacheEvictionService::DefaultInterval, onFinished);
+    }
 }
 
 void CacheSettingsDialog::onClearApplicationCache() {
@@ -8,6 +8,8 @@
 #include <QProgressBar>
 #include <QGroupBox>
 #include <QCheckBox>
+#include <QSpinBox>
+#include <array>
 
 namespace WinMMM10 {
 
@@ -17,13 +19,20 @@ class CacheSettingsDialog : public QDialog {
 public:
     explicit CacheSettingsDialog(QWidget* parent = nullptr);
     ~CacheSettingsDialog() override = default;
+    
+    void done(int result) override; // Saves the limits edited in the dialog
 
 private slots:
     void updateCacheInfo();
+    void onRefresh();
     void onClearApplicationCache();
     void onClearProjectCache();
     void onClearTempFiles();
     void onClearAll();
+    void onMapCacheBudgetChanged(int megabytes);
+    void onEvictionPolicyChanged();
+    void onEvictNow();
+    void saveSettings();
     void formatSize(QLabel* label, uint64_t bytes);
 
 private:
@@ -35,6 +44,7 @@ private:
     QLabel* m_totalSizeLabel{nullptr};
     QLabel* m_recentProjectsLabel{nullptr};
     QLabel* m_recentBinariesLabel{nullptr};
+    QLabel* m_decodedMapsLabel{nullptr};
     
     QPushButton* m_clearAppCacheButton{nullptr};
     QPushButton* m_clearProjectCacheButton{nullptr};
@@ -43,6 +53,13 @@ private:
     QPushButton* m_refreshButton{nullptr};
     
     QCheckBox* m_autoCleanupCheckBox{nullptr};
+    QSpinBox* m_mapCacheBudgetSpin{nullptr};
+    
+    // Per-category eviction limits: thumbnails, temp, project caches
+    std::array<QSpinBox*, 3> m_evictionSizeSpins{};
+    std::array<QSpinBox*, 3> m_evictionAgeSpins{};
+    QPushButton* m_evictNowButton{nullptr};
+    bool m_settingsChanged{false};
 };
 
 } // namespace WinMMM10
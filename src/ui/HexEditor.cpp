@@ -5,8 +5,11 @@
 #include <QApplication>
 #include <QClipboard>
 #include <QMessageBox>
+#include <QToolTip>
+#include <algorithm>
 #include <sstream>
 #include <iomanip>
+#include <vector>
 
 namespace WinMMM10 {
 
@@ -39,6 +42,11 @@ void HexEditor::setBinaryFile(BinaryFile* file) {
     update();
 }
 
+void HexEditor::setAnnotationManager(const AnnotationManager* manager) {
+    m_annotationManager = manager;
+    update();
+}
+
 void HexEditor::refresh() {
     update();
 }
@@ -83,6 +91,24 @@ void HexEditor::paintEvent(QPaintEvent* event) {
     // Draw address column background
     painter.fillRect(0, 0, ADDRESS_WIDTH, height(), palette().color(QPalette::AlternateBase));
     
+    // One interval query for the visible window; later annotations paint over earlier ones
+    size_t visibleLines = static_cast<size_t>(height() / m_lineHeight) + 1;
+    size_t visibleEnd = std::min(fileSize, address + visibleLines * m_bytesPerLine);
+    std::vector<QColor> shading;
+    if (m_annotationManager && visibleEnd > address) {
+        shading.resize(visibleEnd - address);
+        m_annotationManager->visitRange(address, visibleEnd, [&](const Annotation& annotation) {
+            QColor color(QString::fromStdString(annotation.color));
+            color.setAlpha(96);
+            size_t first = std::max(annotation.address, address);
+            size_t last = std::min(annotation.end(), visibleEnd);
+            std::fill(shading.begin() + (first - address), shading.begin() + (last - address), color);
+        });
+    }
+    auto shadeAt = [&](size_t byteAddr) {
+        return byteAddr - m_firstVisibleAddress < shading.size() ? shading[byteAddr - m_firstVisibleAddress] : QColor();
+    };
+    
     while (y < height() && address < fileSize) {
         // Draw address
         std::ostringstream addrStr;
@@ -98,9 +124,11 @@ void HexEditor::paintEvent(QPaintEvent* event) {
             
             QRect byteRect = getByteRect(byteAddr);
             
-            // Highlight cursor
+            // Highlight cursor, otherwise the annotation shade
             if (byteAddr == m_cursorAddress && hasFocus()) {
                 painter.fillRect(byteRect, palette().color(QPalette::Highlight));
+            } else if (QColor shade = shadeAt(byteAddr); shade.isValid()) {
+                painter.fillRect(byteRect, shade);
             }
             
             // Draw hex value
@@ -130,6 +158,9 @@ void HexEditor::paintEvent(QPaintEvent* event) {
                 painter.fillRect(byteRect, palette().color(QPalette::Highlight));
                 painter.setPen(palette().color(QPalette::HighlightedText));
             } else {
+                if (QColor shade = shadeAt(byteAddr); shade.isValid()) {
+                    painter.fillRect(byteRect, shade);
+                }
                 painter.setPen(palette().color(QPalette::Text));
             }
             
@@ -159,6 +190,22 @@ void HexEditor::mousePressEvent(QMouseEvent* event) {
 void HexEditor::mouseMoveEvent(QMouseEvent* event) {
     // Could implement selection/drag here
     QWidget::mouseMoveEvent(event);
+    
+    // Notes of the annotations under the pointer
+    if (!m_annotationManager || !m_binaryFile || !m_binaryFile->isLoaded() ||
+        event->position().x() < ADDRESS_WIDTH) {
+        return;
+    }
+    size_t address = posToAddress(event->position().toPoint());
+    QStringList notes;
+    for (const Annotation* annotation : m_annotationManager->getAnnotationsAt(address)) {
+        notes << QString::fromStdString(annotation->note);
+    }
+    if (notes.isEmpty()) {
+        QToolTip::hideText();
+    } else {
+        QToolTip::showText(event->globalPosition().toPoint(), notes.join("\n"), this);
+    }
 }
 
 void HexEditor::setReadOnly(bool readOnly) {
@@ -344,14 +391,47 @@ bool HexEditor::canRedo() const {
     return m_editHistory.canRedo();
 }
 
+namespace {
+
+// Writes the edits of one undo step in order, one writeBytes() per run of
+// adjacent offsets. Offsets within a run are distinct, so only the order of
+// the runs matters when a step changed a byte more than once.
+void writeEdits(BinaryFile* file, const std::vector<Edit>& edits, bool oldValues) {
+    std::vector<uint8_t> run;
+    size_t i = 0;
+    while (i < edits.size()) {
+        size_t end = i + 1;
+        bool descending = end < edits.size() && edits[end].offset + 1 == edits[i].offset;
+        while (end < edits.size() &&
+               (descending ? edits[end].offset + 1 == edits[end - 1].offset
+                           : edits[end].offset == edits[end - 1].offset + 1)) {
+            ++end;
+        }
+        
+        run.clear();
+        for (size_t k = i; k < end; ++k) {
+            run.push_back(oldValues ? edits[k].oldValue : edits[k].newValue);
+        }
+        if (descending) {
+            std::reverse(run.begin(), run.end());
+        }
+        file->writeBytes(descending ? edits[end - 1].offset : edits[i].offset, run);
+        i = end;
+    }
+}
+
+} // namespace
+
 void HexEditor::undo() {
     if (!m_binaryFile || !canUndo()) {
         return;
     }
     
-    auto edit = m_editHistory.undo();
-    m_binaryFile->writeByte(edit.offset, edit.oldValue);
-    m_cursorAddress = edit.offset;
+    std::vector<Edit> edits = m_editHistory.undo();
+    writeEdits(m_binaryFile, edits, true);
+    if (!edits.empty()) {
+        m_cursorAddress = edits.back().offset;
+    }
     emit dataChanged();
     update();
 }
@@ -361,9 +441,11 @@ void HexEditor::redo() {
         return;
     }
     
-    auto edit = m_editHistory.redo();
-    m_binaryFile->writeByte(edit.offset, edit.newValue);
-    m_cursorAddress = edit.offset;
+    std::vector<Edit> edits = m_editHistory.redo();
+    writeEdits(m_binaryFile, edits, false);
+    if (!edits.empty()) {
+        m_cursorAddress = edits.back().offset;
+    }
     emit dataChanged();
     update();
 }
@@ -10,6 +10,7 @@
 #include <cstddef>
 #include "../binary/BinaryFile.h"
 #include "../binary/EditHistory.h"
+#include "../core/AnnotationManager.h"
 
 namespace WinMMM10 {
 
@@ -23,6 +24,9 @@ public:
     void setBinaryFile(BinaryFile* file);
     BinaryFile* binaryFile() const { return m_binaryFile; }
     
+    // Annotated ranges are shaded in their colour; call refresh() after changes
+    void setAnnotationManager(const AnnotationManager* manager);
+    
     void setAddress(size_t address);
     size_t currentAddress() const { return m_cursorAddress; }
     
@@ -30,6 +34,8 @@ public:
     
     bool canUndo() const;
     bool canRedo() const;
+    // Whole-map edits record here too, so they undo from the hex view
+    EditHistory& editHistory() { return m_editHistory; }
     
     void setReadOnly(bool readOnly);
     bool isReadOnly() const { return m_readOnly; }
@@ -61,6 +67,7 @@ private:
     void deleteByte();
     
     BinaryFile* m_binaryFile{nullptr};
+    const AnnotationManager* m_annotationManager{nullptr};
     EditHistory m_editHistory;
     
     size_t m_firstVisibleAddress{0};
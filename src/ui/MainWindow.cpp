@@ -2,15 +2,30 @@
 #include "CacheSettingsDialog.h"
 #include "../cache/CacheManager.h"
 #include "../core/SafeModeManager.h"
+#include "../core/ProjectSerializer.h"
+#include "../mappacks/A2LImporter.h"
+#include "../maps/MapView.h"
+#include "../validation/Validator.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QCloseEvent>
 #include <QFileDialog>
+#include <QFile>
 #include <QFileInfo>
 #include <QMessageBox>
 #include <QInputDialog>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QLabel>
+#include <QSpinBox>
+#include <QApplication>
+#include <QClipboard>
+#include <QMimeData>
 #include <QTimer>
 #include <QDebug>
+#include <algorithm>
+#include <atomic>
 #include <sstream>
 #include <iomanip>
 #include <exception>
@@ -22,7 +37,7 @@ MainWindow::MainWindow(QWidget* parent)
 {
     qDebug() << "MainWindow: Constructor body entered - QMainWindow base class constructed";
     qDebug() << "MainWindow: All member variables should be initialized by now";
-
+    
     // ==== SAFE HEAP ALLOCATION FOR VALUE MEMBERS ====
     m_projectManager = new ProjectManager();
     m_binaryFile = new BinaryFile();
@@ -34,26 +49,32 @@ MainWindow::MainWindow(QWidget* parent)
     m_batchOps = new BatchOperations(m_binaryFile);
     m_mapMath = new MapMath(m_binaryFile);
     m_interpolationEngine = new InterpolationEngine(m_binaryFile);
-
+    m_mapClipboard = new MapClipboard();
+    m_hashService = new HashService(*m_binaryFile);
+    m_journal = new EditJournal();
+    
+    // Decoded maps are cached per binary and invalidated by its writes
+    CacheManager::instance().mapDataCache().attach(m_binaryFile);
+    
     qDebug() << "MainWindow: Editing engines and core objects allocated";
-
+    
     // UI setup
     qDebug() << "MainWindow: Setting up UI...";
     setupUI();
     qDebug() << "MainWindow: UI setup complete";
-
+    
     qDebug() << "MainWindow: Setting up menus...";
     setupMenus();
     qDebug() << "MainWindow: Menus setup complete";
-
+    
     qDebug() << "MainWindow: Setting up toolbars...";
     setupToolbars();
     qDebug() << "MainWindow: Toolbars setup complete";
-
+    
     qDebug() << "MainWindow: Setting up docks...";
     setupDocks();
     qDebug() << "MainWindow: Docks setup complete";
-
+    
     updateWindowTitle();
     
     // Better window sizing and constraints
@@ -73,31 +94,46 @@ MainWindow::MainWindow(QWidget* parent)
     }
     
     qDebug() << "MainWindow: Window properties set";
-
+    
+    // Unsaved edits go to the recovery journal every few seconds
+    m_journalTimer = new QTimer(this);
+    connect(m_journalTimer, &QTimer::timeout, this, &MainWindow::flushJournal);
+    m_journalTimer->start(JournalIntervalMs);
+    
     // Load Settings and Cache after UI is fully set up using QTimer
     QTimer::singleShot(0, this, [this]() {
         qDebug() << "MainWindow: Loading settings (deferred)...";
         try {
             Settings::instance().load();
+            CacheManager::instance().mapDataCache().setByteBudget(
+                static_cast<uint64_t>(Settings::instance().mapCacheBudgetMB()) * 1024 * 1024);
             qDebug() << "MainWindow: Settings loaded successfully";
         }
         catch (const std::exception& e) {
             qWarning() << "MainWindow: Failed to load settings:" << e.what();
         }
-
+    
         qDebug() << "MainWindow: Loading cache (deferred)...";
         try {
             CacheManager::instance().applicationCache().load();
+            CacheManager::instance().evictionService().load();
+            CacheManager::instance().evictionService().start();
             qDebug() << "MainWindow: Cache loaded successfully";
         }
         catch (const std::exception& e) {
             qWarning() << "MainWindow: Failed to load cache:" << e.what();
         }
         
+        size_t packs = MapPackManager::instance().loadInstalledPacks();
+        qDebug() << "MainWindow: Loaded" << packs << "installed map packs";
+        
         // Initialize Safe Mode from settings AFTER both are loaded
         try {
             bool safeModeEnabled = Settings::instance().safeModeEnabled();
             SafeModeManager::instance().setEnabled(safeModeEnabled);
+            bool clampValues = Settings::instance().safeModeClampValues();
+            SafeModeManager::instance().setLimitPolicy(clampValues ? SafeModeManager::LimitPolicy::Clamp
+                                                                   : SafeModeManager::LimitPolicy::Block);
             
             // Update Safe Mode status in UI
             updateSafeModeStatus();
@@ -112,7 +148,8 @@ MainWindow::MainWindow(QWidget* parent)
             for (QAction* action : actions) {
                 if (action->text() == "Safe Mode (WinOLS Style)") {
                     action->setChecked(safeModeEnabled);
-                    break;
+                } else if (action->text() == "Clamp Values to Safe Mode Limits") {
+                    action->setChecked(clampValues);
                 }
             }
         }
@@ -127,8 +164,11 @@ MainWindow::MainWindow(QWidget* parent)
         if (m_annotationsPanel && m_annotationManager) {
             m_annotationsPanel->setAnnotationManager(m_annotationManager);
         }
+        if (m_hexEditor && m_hexEditor->hexEditor()) {
+            m_hexEditor->hexEditor()->setAnnotationManager(m_annotationManager);
+        }
     });
-
+    
     qDebug() << "MainWindow: Constructor complete";
 }
 
@@ -211,6 +251,10 @@ void MainWindow::setupMenus() {
     QMenu* editMenu = menuBar()->addMenu("&Edit");
     m_searchAction = editMenu->addAction("&Search and Replace...", this, &MainWindow::showSearchReplace, QKeySequence::Find);
     editMenu->addSeparator();
+    editMenu->addAction("&Copy Map Values", this, &MainWindow::copyMapValues, QKeySequence("Ctrl+Shift+C"));
+    editMenu->addAction("&Paste Map Values", this, &MainWindow::pasteMapValues, QKeySequence("Ctrl+Shift+V"));
+    editMenu->addAction("Paste Map Values by A&xis", this, &MainWindow::pasteMapValuesByAxis);
+    editMenu->addSeparator();
     m_addBookmarkAction = editMenu->addAction("Add &Bookmark...", this, &MainWindow::addBookmark, QKeySequence("Ctrl+B"));
     m_addAnnotationAction = editMenu->addAction("Add &Annotation...", this, &MainWindow::addAnnotation, QKeySequence("Ctrl+A"));
     
@@ -219,12 +263,17 @@ void MainWindow::setupMenus() {
     QAction* cacheSettingsAction = new QAction("&Cache Settings...", this);
     connect(cacheSettingsAction, &QAction::triggered, this, &MainWindow::showCacheSettings);
     toolsMenu->addAction(cacheSettingsAction);
+    toolsMenu->addAction("Binary &Hashes...", this, &MainWindow::showBinaryHashes);
     toolsMenu->addSeparator();
     QAction* safeModeAction = new QAction("Safe Mode (WinOLS Style)", this);
     safeModeAction->setCheckable(true);
     safeModeAction->setChecked(true); // Default: enabled (will be updated after settings load)
     connect(safeModeAction, &QAction::triggered, this, &MainWindow::toggleSafeMode);
     toolsMenu->addAction(safeModeAction);
+    QAction* clampValuesAction = new QAction("Clamp Values to Safe Mode Limits", this);
+    clampValuesAction->setCheckable(true);
+    connect(clampValuesAction, &QAction::triggered, this, &MainWindow::toggleSafeModeClamping);
+    toolsMenu->addAction(clampValuesAction);
     
     // Help menu
     QMenu* helpMenu = menuBar()->addMenu("&Help");
@@ -281,6 +330,7 @@ void MainWindow::setupDocks() {
     mapsDock->setMinimumWidth(250);
     mapsDock->setMinimumHeight(200);
     m_mapList = new MapListWidget(this);
+    m_mapList->setBinaryFile(m_binaryFile);
     connect(m_mapList, &MapListWidget::mapSelected, this, &MainWindow::onMapSelected);
     connect(m_mapList, &MapListWidget::mapDoubleClicked, this, &MainWindow::onMapDoubleClicked);
     connect(m_mapList, &MapListWidget::mapDeleteRequested, this, [this](int) { deleteMap(); });
@@ -333,6 +383,16 @@ void MainWindow::setupDocks() {
             m_hexEditor->hexEditor()->goToAddress(address);
         }
     });
+    connect(m_annotationsPanel, &AnnotationsPanel::annotationsChanged, this, [this]() {
+        if (m_hexEditor && m_hexEditor->hexEditor()) {
+            m_hexEditor->hexEditor()->refresh();
+        }
+        // Annotations are saved with the project
+        if (m_projectManager->hasCurrentProject()) {
+            m_projectManager->markChanged();
+            updateWindowTitle();
+        }
+    });
     addDockWidget(Qt::LeftDockWidgetArea, m_annotationsPanel);
     tabifyDockWidget(m_bookmarksPanel, m_annotationsPanel); // Tabify for better space usage
     m_bookmarksPanel->raise(); // Show Bookmarks tab first
@@ -383,6 +443,7 @@ void MainWindow::newProject() {
             m_mapList->clearMaps();
             m_map2DViewer->setMap(MapDefinition(), nullptr);
             m_map3DViewer->setMap(MapDefinition(), nullptr);
+            restoreProjectNotes();
         }
     }
 }
@@ -412,12 +473,13 @@ void MainWindow::openProject() {
             for (size_t i = 0; i < project->mapCount(); ++i) {
                 m_mapList->addMap(project->getMap(i));
             }
+            restoreProjectNotes();
             
             updateWindowTitle();
             m_saveProjectAction->setEnabled(true);
             m_addMapAction->setEnabled(true);
             m_detectMapsAction->setEnabled(m_binaryFile->isLoaded());
-            m_compareMapsAction->setEnabled(m_projectManager->currentProject()->mapCount() >= 2);
+            m_compareMapsAction->setEnabled(m_projectManager->currentProject()->mapCount() > 0);
             m_batchOpsAction->setEnabled(true);
             m_mapMathAction->setEnabled(true);
             m_interpolateAction->setEnabled(true);
@@ -426,28 +488,66 @@ void MainWindow::openProject() {
             // Update recent files menus
             updateRecentFilesMenus();
         } else {
-            QMessageBox::critical(this, "Error", "Failed to open project file.");
+            QMessageBox::critical(this, "Error", "Failed to open project file.\n\n" +
+                                  QString::fromStdString(m_projectManager->lastError()));
         }
     }
 }
 
 void MainWindow::saveProject() {
-    if (m_projectManager->saveProject()) {
-        updateWindowTitle();
-    } else {
-        QMessageBox::critical(this, "Error", "Failed to save project.");
+    storeProjectNotes();
+    // Written on a worker thread; the UI stays responsive for large projects
+    bool started = m_projectManager->saveProjectInBackground([this](bool ok, const std::string& error) {
+        QMetaObject::invokeMethod(this, [this, ok, error]() {
+            updateWindowTitle();
+            if (ok) {
+                m_statusBar->setMessage("Project saved.");
+            } else {
+                QMessageBox::critical(this, "Error", "Failed to save project.\n\n" + QString::fromStdString(error));
+            }
+        });
+    });
+    if (started) {
+        m_statusBar->setMessage("Saving project...");
     }
 }
 
 void MainWindow::saveProjectAs() {
     QString filepath = QFileDialog::getSaveFileName(this, "Save Project As", "", "Project Files (*.wmm10)");
     if (!filepath.isEmpty()) {
+        storeProjectNotes();
         if (m_projectManager->saveProjectAs(filepath.toStdString())) {
             updateWindowTitle();
         } else {
-            QMessageBox::critical(this, "Error", "Failed to save project.");
+            QMessageBox::critical(this, "Error", "Failed to save project.\n\n" +
+                                  QString::fromStdString(m_projectManager->lastError()));
+        }
+    }
+}
+
+void MainWindow::storeProjectNotes() {
+    if (Project* project = m_projectManager->currentProject()) {
+        project->annotations() = m_annotationManager->getAllAnnotations();
+        project->bookmarks() = m_bookmarkManager->getAllBookmarks();
+    }
+}
+
+void MainWindow::restoreProjectNotes() {
+    m_annotationManager->clear();
+    m_bookmarkManager->clear();
+    if (const Project* project = m_projectManager->currentProject()) {
+        for (const Annotation& annotation : project->annotations()) {
+            m_annotationManager->addAnnotation(annotation);
+        }
+        for (const Bookmark& bookmark : project->bookmarks()) {
+            m_bookmarkManager->addBookmark(bookmark);
         }
     }
+    m_annotationsPanel->refreshAnnotations();
+    m_bookmarksPanel->refreshBookmarks();
+    if (m_hexEditor && m_hexEditor->hexEditor()) {
+        m_hexEditor->hexEditor()->refresh();
+    }
 }
 
 void MainWindow::loadBinary() {
@@ -461,8 +561,11 @@ void MainWindow::loadBinary() {
 }
 
 void MainWindow::loadBinaryFile(const QString& filepath) {
+    // Edits to the binary being replaced are given up with it
+    m_journal->stop(true);
     if (m_binaryFile->load(filepath.toStdString())) {
         m_hexEditor->setBinaryFile(m_binaryFile);
+        m_mapList->refreshThumbnails();
         m_statusBar->setFileInfo(QFileInfo(filepath).fileName(), m_binaryFile->size());
         m_saveBinaryAction->setEnabled(true);
         m_detectMapsAction->setEnabled(true);
@@ -471,11 +574,139 @@ void MainWindow::loadBinaryFile(const QString& filepath) {
         Settings::instance().save();
         
         CacheManager::instance().applicationCache().addRecentBinary(filepath.toStdString());
+        suggestMapPacks();
+        recoverJournal();
     } else {
         QMessageBox::critical(this, "Error", "Failed to load binary file.");
     }
 }
 
+void MainWindow::suggestMapPacks() {
+    MapPackManager& manager = MapPackManager::instance();
+    if (manager.installedCount() == 0) {
+        return;
+    }
+    
+    std::string fileHash = m_hashService->fileSha256().toHex();
+    std::vector<MapPackMatch> matches = manager.rankMapPacks(m_binaryFile->data(), m_binaryFile->size(), fileHash, 1);
+    if (matches.empty()) {
+        m_statusBar->setMessage("No installed map pack matches this binary.");
+        return;
+    }
+    
+    const MapPackMatch& best = matches.front();
+    const MapPackInfo& info = manager.packInfo(best.pack);
+    QString reason = best.fileHashMatch ? "same file" : QString("%1% similar").arg(qRound(best.similarity * 100));
+    if (best.ecuIdMatch && !best.fileHashMatch) {
+        reason += ", ECU id found";
+    }
+    m_statusBar->setMessage(QString("Matching map pack: %1 (%2)").arg(QString::fromStdString(info.name), reason));
+}
+
+void MainWindow::recoverJournal() {
+    // A journal set aside by a recovery that did not finish is older than any
+    // journal written since, so it is offered first
+    std::string path = EditJournal::journalPathFor(m_binaryFile->filepath());
+    QString setAside = QString::fromStdString(path) + ".recovering";
+    std::string source = QFile::exists(setAside) ? setAside.toStdString() : path;
+    EditJournal::Contents contents;
+    std::string error;
+    bool recover = false;
+    if (QFile::exists(QString::fromStdString(source))) {
+        if (EditJournal::read(source, contents, error)) {
+            recover = (!contents.edits.empty() || !contents.projectJson.empty()) &&
+                      QMessageBox::question(this, "Recover Unsaved Changes",
+                          "The editor did not close properly while this binary had unsaved changes.\n"
+                          "Do you want to recover them?") == QMessageBox::Yes;
+        } else {
+            qWarning() << "MainWindow: Ignoring recovery journal:" << QString::fromStdString(error);
+        }
+    }
+    
+    // The old journal is kept aside until its edits are applied, since the
+    // new one replaces it on disk
+    if (!recover) {
+        QFile::remove(setAside);
+    } else if (source == path && !QFile::rename(QString::fromStdString(path), setAside)) {
+        QMessageBox::warning(this, "Recovery Failed", "Cannot keep the recovery journal " +
+                             QString::fromStdString(path) + " while recovering.");
+        return;
+    }
+    
+    // The new journal starts from the image on disk and records what is replayed
+    startJournal();
+    if (!recover) {
+        return;
+    }
+    
+    if (!EditJournal::replay(contents, *m_binaryFile, error)) {
+        QMessageBox::warning(this, "Recovery Failed", QString::fromStdString(error) +
+                             "\n\nThe journal was kept and will be offered again when this binary is opened.");
+        return;
+    }
+    if (m_hexEditor && m_hexEditor->hexEditor()) {
+        m_hexEditor->hexEditor()->refresh();
+    }
+    m_mapList->refreshThumbnails();
+    
+    Project* project = m_projectManager->currentProject();
+    if (project && !contents.projectJson.empty() && contents.projectPath == project->filepath()) {
+        Project recovered;
+        if (ProjectSerializer::fromJson(contents.projectJson, recovered, error)) {
+            recovered.setFilepath(project->filepath());
+            *project = std::move(recovered);
+            m_projectManager->markChanged();
+            m_mapList->clearMaps();
+            for (size_t i = 0; i < project->mapCount(); ++i) {
+                m_mapList->addMap(project->getMap(i));
+            }
+            restoreProjectNotes();
+            updateWindowTitle();
+        } else {
+            qWarning() << "MainWindow: Cannot recover project:" << QString::fromStdString(error);
+        }
+    }
+    
+    // The replayed edits are on disk in the new journal before the old one goes
+    flushJournal();
+    m_journal->waitForWrites();
+    if (m_journal->isActive() && m_journal->lastError().empty()) {
+        QFile::remove(setAside);
+    }
+    m_statusBar->setMessage("Recovered unsaved changes.");
+}
+
+void MainWindow::startJournal() {
+    std::string error;
+    if (!m_journal->start(*m_binaryFile, EditJournal::journalPathFor(m_binaryFile->filepath()), error)) {
+        qWarning() << "MainWindow: Recovery journal disabled:" << QString::fromStdString(error);
+    }
+    // Recorded again with the next flush if it has unsaved changes
+    m_journaledRevision = ~uint64_t(0);
+}
+
+void MainWindow::flushJournal() {
+    if (!m_journal->isActive()) {
+        return;
+    }
+    
+    // The project is written whole, so only when it changed since the last time
+    if (m_projectManager->hasCurrentProject() && m_projectManager->hasUnsavedChanges() &&
+        m_projectManager->revision() != m_journaledRevision) {
+        storeProjectNotes();
+        m_journal->recordProject(*m_projectManager->currentProject());
+        m_journaledRevision = m_projectManager->revision();
+    }
+    m_journal->flush();
+    
+    // Records after a failed write would not be read back
+    std::string error = m_journal->lastError();
+    if (!error.empty()) {
+        qWarning() << "MainWindow: Recovery journal disabled:" << QString::fromStdString(error);
+        m_journal->stop(false);
+    }
+}
+
 void MainWindow::saveBinary() {
     // Safe Mode: Validate checksum before export
     if (SafeModeManager::instance().isEnabled()) {
@@ -507,6 +738,9 @@ void MainWindow::saveBinary() {
     }
     
     if (m_binaryFile->save()) {
+        // The saved image is the journal's new base
+        m_journal->stop(true);
+        startJournal();
         m_statusBar->setMessage("Binary file saved.");
     } else {
         QMessageBox::critical(this, "Error", "Failed to save binary file.");
@@ -546,6 +780,8 @@ void MainWindow::saveBinaryAs() {
         }
         
         if (m_binaryFile->save(filepath.toStdString())) {
+            m_journal->stop(true);
+            startJournal();
             m_statusBar->setMessage("Binary file saved.");
         } else {
             QMessageBox::critical(this, "Error", "Failed to save binary file.");
@@ -684,13 +920,103 @@ void MainWindow::onMapDoubleClicked(int index) {
 }
 
 void MainWindow::exportMapDefinitions() {
-    // Implementation for exporting map definitions
-    QMessageBox::information(this, "Export", "Export functionality to be implemented.");
+    if (!m_projectManager->hasCurrentProject()) {
+        QMessageBox::information(this, "Export", "Open or create a project first.");
+        return;
+    }
+    
+    QString filter = QString("Binary Map Packs (*%1);;Map Packs (*%2)")
+                         .arg(QString::fromStdString(MapPack::getBinaryFileExtension()),
+                              QString::fromStdString(MapPack::getFileExtension()));
+    QString filepath = QFileDialog::getSaveFileName(this, "Export Map Definitions", "", filter);
+    if (filepath.isEmpty()) {
+        return;
+    }
+    
+    Project* project = m_projectManager->currentProject();
+    MapPack pack;
+    pack.info().name = project->name();
+    pack.info().description = project->description();
+    pack.info().ecuName = project->ecuName();
+    pack.maps() = project->maps();
+    
+    // Lets the pack be matched to this binary and its tuned versions later
+    if (m_binaryFile->isLoaded()) {
+        pack.info().fileHash = m_hashService->fileSha256().toHex();
+        pack.info().fingerprints = MapPackIndex::fingerprint(m_binaryFile->data(), m_binaryFile->size());
+    }
+    
+    MapPackFormat format = filepath.endsWith(QString::fromStdString(MapPack::getFileExtension()))
+                               ? MapPackFormat::Json
+                               : MapPackFormat::Binary;
+    if (!MapPackManager::instance().saveMapPack(pack, filepath.toStdString(), format)) {
+        QMessageBox::warning(this, "Export", "Failed to write " + filepath + ".");
+        return;
+    }
+    m_statusBar->setMessage(QString("Exported %1 map definitions.").arg(pack.mapCount()));
 }
 
 void MainWindow::importMapDefinitions() {
-    // Implementation for importing map definitions
-    QMessageBox::information(this, "Import", "Import functionality to be implemented.");
+    if (!m_projectManager->hasCurrentProject()) {
+        QMessageBox::information(this, "Import", "Open or create a project first.");
+        return;
+    }
+    
+    QString filepath = QFileDialog::getOpenFileName(this, "Import Map Definitions", "",
+                                                    "ASAP2 Files (*.a2l);;All Files (*)");
+    if (filepath.isEmpty()) {
+        return;
+    }
+    bool ok = false;
+    QString base = QInputDialog::getText(this, "Import Map Definitions",
+                                         "ECU address of the first byte of the binary (hex):",
+                                         QLineEdit::Normal, "0", &ok);
+    if (!ok) {
+        return;
+    }
+    size_t baseAddress = static_cast<size_t>(base.trimmed().toULongLong(&ok, 16));
+    if (!ok) {
+        QMessageBox::warning(this, "Import", "'" + base + "' is not a hexadecimal address.");
+        return;
+    }
+    
+    A2LImporter importer;
+    importer.setBaseAddress(baseAddress);
+    MapPack pack;
+    std::string error;
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    ok = importer.importFile(filepath.toStdString(), pack, error);
+    QApplication::restoreOverrideCursor();
+    if (!ok) {
+        QMessageBox::warning(this, "Import", QString::fromStdString(error));
+        return;
+    }
+    
+    Project* project = m_projectManager->currentProject();
+    for (const MapDefinition& map : pack.maps()) {
+        project->addMap(map);
+        m_mapList->addMap(map);
+    }
+    if (pack.mapCount() > 0) {
+        m_projectManager->markChanged();
+        updateWindowTitle();
+    }
+    
+    const A2LImportStats& stats = importer.stats();
+    QMessageBox box(QMessageBox::Information, "Import",
+                    QString("Imported %1 of %2 characteristics.").arg(stats.imported).arg(stats.characteristics),
+                    QMessageBox::Ok, this);
+    if (stats.skipped > 0 || stats.approximated > 0) {
+        box.setInformativeText(QString("%1 skipped; %2 conversions are not linear and show raw values.")
+                                   .arg(stats.skipped)
+                                   .arg(stats.approximated));
+        QStringList warnings;
+        for (const std::string& warning : stats.warnings) {
+            warnings << QString::fromStdString(warning);
+        }
+        box.setDetailedText(warnings.join("\n"));
+    }
+    box.exec();
 }
 
 void MainWindow::showCacheSettings() {
@@ -732,27 +1058,276 @@ void MainWindow::addAnnotation() {
 }
 
 void MainWindow::compareMaps() {
-    QMessageBox::information(this, "Map Comparison", "Map comparison feature - to be fully implemented with UI.");
+    if (!m_projectManager->hasCurrentProject() || !m_binaryFile->isLoaded()) {
+        return;
+    }
+    
+    QString filename = QFileDialog::getOpenFileName(this, "Compare With Binary", "",
+                                                    "Binary Files (*.bin *.hex);;All Files (*.*)");
+    if (filename.isEmpty()) {
+        return;
+    }
+    
+    BinaryFile other;
+    if (!other.load(filename.toStdString())) {
+        QMessageBox::critical(this, "Error", "Failed to load binary file.");
+        return;
+    }
+    
+    Project* project = m_projectManager->currentProject();
+    ProjectComparator::Report report = ProjectComparator::compare(*project, m_binaryFile, &other);
+    
+    ProjectCompareDialog dialog(report, QFileInfo(filename).fileName(), this);
+    connect(&dialog, &ProjectCompareDialog::mapActivated, this, [this](int index) {
+        m_mapList->setCurrentRow(index);
+        onMapSelected(index);
+    });
+    dialog.exec();
 }
 
 void MainWindow::batchOperations() {
-    QMessageBox::information(this, "Batch Operations", "Batch operations feature - to be fully implemented with UI.");
+    if (!m_projectManager->hasCurrentProject() || !m_binaryFile->isLoaded()) {
+        return;
+    }
+    
+    // e.g. every map named "*Torque limit*" multiplied by 1.05
+    bool ok = false;
+    QString filter = QInputDialog::getText(this, "Batch Operations", "Maps whose name contains (empty for all):",
+                                           QLineEdit::Normal, QString(), &ok);
+    if (!ok) {
+        return;
+    }
+    QStringList operations = {"Multiply by", "Add"};
+    QString operation = QInputDialog::getItem(this, "Batch Operations", "Operation:", operations, 0, false, &ok);
+    if (!ok) {
+        return;
+    }
+    bool multiply = operation == operations[0];
+    double value = QInputDialog::getDouble(this, "Batch Operations", operation + ":", multiply ? 1.0 : 0.0,
+                                           -1e9, 1e9, 4, &ok);
+    if (!ok) {
+        return;
+    }
+    
+    Project* project = m_projectManager->currentProject();
+    std::vector<MapDefinition> maps;
+    for (const MapDefinition& map : project->maps()) {
+        if (QString::fromStdString(map.name()).contains(filter.trimmed(), Qt::CaseInsensitive)) {
+            maps.push_back(map);
+        }
+    }
+    if (maps.empty()) {
+        QMessageBox::information(this, "Batch Operations", "No map matches \"" + filter + "\".");
+        return;
+    }
+    
+    auto transform = [multiply, value](std::vector<double>& values) {
+        for (double& v : values) {
+            v = multiply ? v * value : v + value;
+        }
+    };
+    
+    // Flagged cells are confirmed before anything is written; only the ones
+    // listed get a message
+    Validator validator;
+    size_t flaggedCells = 0;
+    QStringList details;
+    for (const MapDefinition& map : maps) {
+        MapView view(map, m_binaryFile);
+        std::vector<double> before;
+        if (!view.read(before)) {
+            continue;
+        }
+        std::vector<double> after = before;
+        transform(after);
+        ValidationFlags flags = validator.validateBatch(before, after);
+        flaggedCells += flags.count();
+        for (size_t cell : flags.flaggedCells(5 - static_cast<size_t>(details.size()))) {
+            auto warnings = validator.describe(map.address() + cell * view.elementSize(), before[cell], after[cell],
+                                               flags.at(cell));
+            details << QString::fromStdString(map.name()) + ": " + QString::fromStdString(warnings[0].message);
+        }
+    }
+    if (flaggedCells > 0) {
+        QString message = QString("%1 cells fail validation:\n").arg(flaggedCells) + details.join("\n");
+        if (flaggedCells > static_cast<size_t>(details.size())) {
+            message += "\n...";
+        }
+        if (QMessageBox::question(this, "Batch Operations", message + "\n\nApply anyway?") != QMessageBox::Yes) {
+            return;
+        }
+    }
+    
+    // Maps run on worker threads; the whole batch is one undo step in the hex editor
+    std::atomic<size_t> rejected{0};
+    EditHistory* history = m_hexEditor && m_hexEditor->hexEditor() ? &m_hexEditor->hexEditor()->editHistory() : nullptr;
+    std::vector<size_t> skipped;
+    m_batchOps->applyToAllMaps(maps, [&](const MapDefinition& map, BinaryFile* file) {
+        MapView view(map, file);
+        std::vector<double> values;
+        if (!view.read(values)) {
+            ++rejected;
+            return;
+        }
+        transform(values);
+        if (!view.write(values)) {
+            ++rejected; // Blocked by Safe Mode
+        }
+    }, history, 0, &skipped);
+    
+    if (!skipped.empty() || rejected > 0) {
+        QStringList reasons;
+        if (!skipped.empty()) {
+            reasons << QString("%1 outside the binary").arg(skipped.size());
+        }
+        if (rejected > 0) {
+            reasons << QString("%1 blocked by Safe Mode").arg(rejected.load());
+        }
+        QMessageBox::warning(this, "Batch Operations",
+                             QString("%1 of %2 maps were not changed (%3).")
+                                 .arg(skipped.size() + rejected.load()).arg(maps.size()).arg(reasons.join(", ")));
+    }
+    
+    m_projectManager->markChanged();
+    updateWindowTitle();
+    if (m_hexEditor && m_hexEditor->hexEditor()) {
+        m_hexEditor->hexEditor()->refresh();
+    }
+    int index = m_mapList->currentMapIndex();
+    if (index >= 0) {
+        onMapSelected(index); // Refresh view
+    }
 }
 
 void MainWindow::mapMathOperations() {
-    QMessageBox::information(this, "Map Math", "Map math operations feature - to be fully implemented with UI.");
+    if (!m_projectManager->hasCurrentProject() || !m_binaryFile->isLoaded()) {
+        return;
+    }
+    
+    Project* project = m_projectManager->currentProject();
+    int index = m_mapList->currentMapIndex();
+    
+    // Offer the selected map as the assignment target
+    QString prefill;
+    if (index >= 0) {
+        prefill = "\"" + QString::fromStdString(project->getMap(index).name()) + "\" = ";
+    }
+    
+    bool ok = false;
+    QString formula = QInputDialog::getText(this, "Map Math",
+                                            "Formula (e.g. out = a * 1.08 + clamp(b - 3, 0, 20)):",
+                                            QLineEdit::Normal, prefill, &ok);
+    if (!ok || formula.trimmed().isEmpty()) {
+        return;
+    }
+    
+    // A result with flagged cells is confirmed before it is written
+    std::string error;
+    Validator validator;
+    if (!m_mapMath->applyFormula(*project, formula.toStdString(), error, std::string(), &validator)) {
+        if (!m_mapMath->lastValidation().any()) {
+            QMessageBox::warning(this, "Map Math", QString::fromStdString(error));
+            return;
+        }
+        if (QMessageBox::question(this, "Map Math", QString::fromStdString(error) + "\n\nApply anyway?") !=
+            QMessageBox::Yes) {
+            return;
+        }
+        if (!m_mapMath->applyFormula(*project, formula.toStdString(), error)) {
+            QMessageBox::warning(this, "Map Math", QString::fromStdString(error));
+            return;
+        }
+    }
+    
+    m_projectManager->markChanged();
+    updateWindowTitle();
+    if (index >= 0) {
+        onMapSelected(index); // Refresh view
+    }
 }
 
+namespace {
+
+// Asks for the cells a spline interpolation rebuilds, as 1-based inclusive
+// ranges; the border of the range is kept. Defaults to all but the outer ring.
+bool askInterpolationRegion(QWidget* parent, const MapDefinition& map, size_t& startRow, size_t& startCol,
+                            size_t& endRow, size_t& endCol) {
+    QDialog dialog(parent);
+    dialog.setWindowTitle("Interpolate Map");
+    auto* layout = new QFormLayout(&dialog);
+    layout->addRow(new QLabel("Region to rebuild (its border cells are kept):"));
+    
+    auto addSpin = [&](const QString& label, size_t count, size_t value) {
+        auto* spin = new QSpinBox(&dialog);
+        spin->setRange(1, static_cast<int>(std::max<size_t>(count, 1)));
+        spin->setValue(static_cast<int>(value));
+        layout->addRow(label, spin);
+        return spin;
+    };
+    size_t rows = map.rows();
+    size_t cols = map.columns();
+    QSpinBox* firstRow = addSpin("First row:", rows, rows > 2 ? 2 : 1);
+    QSpinBox* lastRow = addSpin("Last row:", rows, rows > 2 ? rows - 1 : rows);
+    QSpinBox* firstCol = addSpin("First column:", cols, cols > 2 ? 2 : 1);
+    QSpinBox* lastCol = addSpin("Last column:", cols, cols > 2 ? cols - 1 : cols);
+    
+    auto* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    QObject::connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    QObject::connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    layout->addRow(buttons);
+    if (dialog.exec() != QDialog::Accepted) {
+        return false;
+    }
+    
+    startRow = static_cast<size_t>(std::min(firstRow->value(), lastRow->value()) - 1);
+    endRow = static_cast<size_t>(std::max(firstRow->value(), lastRow->value()) - 1);
+    startCol = static_cast<size_t>(std::min(firstCol->value(), lastCol->value()) - 1);
+    endCol = static_cast<size_t>(std::max(firstCol->value(), lastCol->value()) - 1);
+    return true;
+}
+
+} // namespace
+
 void MainWindow::interpolateMap() {
     int index = m_mapList->currentMapIndex();
     if (index < 0 || !m_projectManager->hasCurrentProject() || !m_binaryFile->isLoaded()) {
         return;
     }
     
+    QStringList methods = {"Linear (whole map from corners)", "Monotone cubic (region)", "Natural spline (region)"};
+    bool ok = false;
+    QString method = QInputDialog::getItem(this, "Interpolate Map", "Method:", methods, 0, false, &ok);
+    if (!ok) {
+        return;
+    }
+    
+    static const InterpolationType types[] = {InterpolationType::Linear, InterpolationType::Cubic,
+                                              InterpolationType::Spline};
+    InterpolationType type = types[methods.indexOf(method)];
+    
     Project* project = m_projectManager->currentProject();
     MapDefinition& map = project->getMap(index);
     
-    if (m_interpolationEngine->interpolateMap(map)) {
+    bool interpolated = false;
+    if (type == InterpolationType::Linear) {
+        interpolated = m_interpolationEngine->interpolateMap(map);
+    } else {
+        // The splines are fitted through the cells outside the region, so it
+        // must leave some along at least one dimension
+        size_t startRow = 0, startCol = 0, endRow = 0, endCol = 0;
+        if (!askInterpolationRegion(this, map, startRow, startCol, endRow, endCol)) {
+            return;
+        }
+        if (!InterpolationEngine::hasInteriorKnots(map, startRow, startCol, endRow, endCol)) {
+            QMessageBox::warning(this, "Interpolate Map",
+                                 "The region must leave cells outside it along a row or a column for a "
+                                 "spline to fit through; over the whole map use Linear.");
+            return;
+        }
+        interpolated = m_interpolationEngine->interpolateRegion(map, startRow, startCol, endRow, endCol, type);
+    }
+    
+    if (interpolated) {
         m_projectManager->markChanged();
         updateWindowTitle();
         onMapSelected(index); // Refresh view
@@ -765,16 +1340,106 @@ void MainWindow::smoothMap() {
         return;
     }
     
+    QStringList filters = {"Box", "Gaussian", "Bilateral (preserve edges)", "Median (remove spikes)"};
+    bool ok = false;
+    QString filter = QInputDialog::getItem(this, "Smooth Map", "Filter:", filters, 0, false, &ok);
+    if (!ok) {
+        return;
+    }
+    int kernelSize = QInputDialog::getInt(this, "Smooth Map", "Kernel size (odd):", 3, 3, 15, 2, &ok);
+    if (!ok) {
+        return;
+    }
+    
+    static const MapFilters::Type types[] = {MapFilters::Type::Box, MapFilters::Type::Gaussian,
+                                             MapFilters::Type::Bilateral, MapFilters::Type::Median};
+    MapFilters::Type type = types[filters.indexOf(filter)];
+    
     Project* project = m_projectManager->currentProject();
     MapDefinition& map = project->getMap(index);
     
-    if (m_interpolationEngine->smoothMap(map)) {
+    if (m_interpolationEngine->smoothMap(map, kernelSize | 1, type)) {
+        m_projectManager->markChanged();
+        updateWindowTitle();
+        onMapSelected(index); // Refresh view
+    }
+}
+
+namespace {
+
+// Marks clipboard contents placed by copyMapValues(), whose full block (raw
+// bytes, scaling) is kept in m_mapClipboard rather than in the text
+const char* MapBlockMimeType = "application/x-winmmm10-map-block";
+
+} // namespace
+
+void MainWindow::copyMapValues() {
+    int index = m_mapList->currentMapIndex();
+    if (index < 0 || !m_projectManager->hasCurrentProject() || !m_binaryFile->isLoaded()) {
+        return;
+    }
+    
+    const MapDefinition& map = m_projectManager->currentProject()->getMap(index);
+    if (!m_mapClipboard->copy(map, m_binaryFile)) {
+        QMessageBox::warning(this, "Copy Map Values", "The map lies outside the loaded binary.");
+        return;
+    }
+    
+    auto* mimeData = new QMimeData();
+    mimeData->setText(QString::fromStdString(m_mapClipboard->toTsv()));
+    mimeData->setData(MapBlockMimeType, QByteArray());
+    QApplication::clipboard()->setMimeData(mimeData);
+}
+
+bool MainWindow::takeClipboardBlock() {
+    const QMimeData* mimeData = QApplication::clipboard()->mimeData();
+    if (mimeData && mimeData->hasFormat(MapBlockMimeType) && !m_mapClipboard->isEmpty()) {
+        return true;
+    }
+    
+    // Text from elsewhere, e.g. a spreadsheet
+    std::string error;
+    QString text = mimeData ? mimeData->text() : QString();
+    if (!m_mapClipboard->fromTsv(text.toStdString(), error)) {
+        QMessageBox::warning(this, "Paste Map Values", QString::fromStdString(error));
+        return false;
+    }
+    return true;
+}
+
+void MainWindow::pasteMapValues() {
+    int index = m_mapList->currentMapIndex();
+    if (index < 0 || !m_projectManager->hasCurrentProject() || !m_binaryFile->isLoaded() ||
+        !takeClipboardBlock()) {
+        return;
+    }
+    
+    const MapDefinition& map = m_projectManager->currentProject()->getMap(index);
+    if (m_mapClipboard->paste(map, m_binaryFile)) {
         m_projectManager->markChanged();
         updateWindowTitle();
         onMapSelected(index); // Refresh view
     }
 }
 
+void MainWindow::pasteMapValuesByAxis() {
+    int index = m_mapList->currentMapIndex();
+    if (index < 0 || !m_projectManager->hasCurrentProject() || !m_binaryFile->isLoaded() ||
+        !takeClipboardBlock()) {
+        return;
+    }
+    
+    const MapDefinition& map = m_projectManager->currentProject()->getMap(index);
+    if (!m_mapClipboard->pasteResampled(map, m_binaryFile)) {
+        QMessageBox::warning(this, "Paste Map Values by Axis",
+                             "The copied breakpoints do not overlap this map's axes.");
+        return;
+    }
+    m_projectManager->markChanged();
+    updateWindowTitle();
+    onMapSelected(index); // Refresh view
+}
+
 void MainWindow::about() {
     QMessageBox::about(this, "About WinMMM10 Editor",
                       "WinMMM10 Editor v1.0.0\n\n"
@@ -790,7 +1455,13 @@ bool MainWindow::maybeSave() {
                                       "Do you want to save your changes?",
                                       QMessageBox::Save | QMessageBox::Discard | QMessageBox::Cancel);
         if (ret == QMessageBox::Save) {
-            saveProject();
+            // Saved before returning, since the caller may discard the project
+            storeProjectNotes();
+            if (!m_projectManager->saveProject()) {
+                QMessageBox::critical(this, "Error", "Failed to save project.\n\n" +
+                                      QString::fromStdString(m_projectManager->lastError()));
+                return false;
+            }
             return true;
         } else if (ret == QMessageBox::Cancel) {
             return false;
@@ -864,6 +1535,42 @@ void MainWindow::toggleSafeMode() {
     }
 }
 
+void MainWindow::toggleSafeModeClamping(bool clamp) {
+    // Map writes outside the hard limits are either rejected whole or clamped
+    SafeModeManager::instance().setLimitPolicy(clamp ? SafeModeManager::LimitPolicy::Clamp
+                                                     : SafeModeManager::LimitPolicy::Block);
+    Settings::instance().setSafeModeClampValues(clamp);
+    Settings::instance().save();
+}
+
+void MainWindow::showBinaryHashes() {
+    if (!m_binaryFile->isLoaded()) {
+        QMessageBox::information(this, "Binary Hashes", "No binary loaded.");
+        return;
+    }
+    
+    // XXH3 chunk digests are cached, so repeated calls only rehash edited
+    // regions; SHA-256 is the plain digest that sha256sum prints
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    std::string xxh3 = m_hashService->hash(HashAlgorithm::XXH3).toHex();
+    std::string sha256 = m_hashService->fileSha256().toHex();
+    QApplication::restoreOverrideCursor();
+    
+    bool tree = m_binaryFile->size() > HashService::ChunkSize;
+    QMessageBox box(QMessageBox::Information, "Binary Hashes",
+                    QString("Size: %1 bytes\n\n%2: %3\nSHA-256: %4")
+                        .arg(m_binaryFile->size())
+                        .arg(tree ? "XXH3 tree" : "XXH3")
+                        .arg(QString::fromStdString(xxh3))
+                        .arg(QString::fromStdString(sha256)),
+                    QMessageBox::Ok, this);
+    if (tree) {
+        box.setInformativeText("Images over 1 MiB are hashed with XXH3 as a tree of 1 MiB chunks.");
+    }
+    box.setTextInteractionFlags(Qt::TextSelectableByMouse);
+    box.exec();
+}
+
 void MainWindow::updateSafeModeStatus() {
     bool enabled = SafeModeManager::instance().isEnabled();
     m_statusBar->setSafeModeStatus(enabled);
@@ -878,6 +1585,10 @@ void MainWindow::closeEvent(QCloseEvent* event) {
         
         CacheManager::instance().applicationCache().save();
         
+        // Closed cleanly, so nothing to recover next time
+        m_journalTimer->stop();
+        m_journal->stop(true);
+        
         // Auto-cleanup if enabled
         if (Settings::instance().autoCleanupCache()) {
             CacheManager::instance().clearTempFiles();
@@ -890,7 +1601,14 @@ void MainWindow::closeEvent(QCloseEvent* event) {
 }
 
 MainWindow::~MainWindow() {
-    // Delete heap members
+    // The map cache observes m_binaryFile, so release it first
+    CacheManager::instance().mapDataCache().detach();
+    CacheManager::instance().evictionService().stop();
+    
+    // Delete heap members; the map list, hash service and journal observe m_binaryFile
+    m_mapList->setBinaryFile(nullptr);
+    delete m_hashService;
+    delete m_journal;
     delete m_projectManager;
     delete m_binaryFile;
     delete m_mapDetector;
@@ -901,6 +1619,7 @@ MainWindow::~MainWindow() {
     delete m_batchOps;
     delete m_mapMath;
     delete m_interpolationEngine;
+    delete m_mapClipboard;
 }
 
 } // namespace WinMMM10
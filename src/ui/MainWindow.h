@@ -9,7 +9,9 @@
 #include <QAction>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QTimer>
 #include "../core/ProjectManager.h"
+#include "../core/EditJournal.h"
 #include "../core/Settings.h"
 #include "../core/SafeModeManager.h"
 #include "../binary/BinaryFile.h"
@@ -25,15 +27,18 @@
 #include "RecentFilesMenu.h"
 #include "SearchReplaceDialog.h"
 #include "CacheSettingsDialog.h"
+#include "ProjectCompareDialog.h"
 #include "../heuristics/MapDetector.h"
 #include "../cache/CacheManager.h"
 #include "../core/BookmarkManager.h"
 #include "../core/AnnotationManager.h"
 #include "../binary/HexSearch.h"
+#include "../binary/HashService.h"
 #include "../editing/MapComparator.h"
 #include "../editing/BatchOperations.h"
 #include "../editing/MapMath.h"
 #include "../editing/InterpolationEngine.h"
+#include "../editing/MapClipboard.h"
 
 namespace WinMMM10 {
 
@@ -66,6 +71,8 @@ private slots:
     void showCacheSettings();
     void showSearchReplace();
     void toggleSafeMode();
+    void toggleSafeModeClamping(bool clamp);
+    void showBinaryHashes();
     void addBookmark();
     void addAnnotation();
     void compareMaps();
@@ -73,7 +80,11 @@ private slots:
     void mapMathOperations();
     void interpolateMap();
     void smoothMap();
+    void copyMapValues();
+    void pasteMapValues();
+    void pasteMapValuesByAxis();
     void about();
+    void flushJournal();
 
 private:
     void setupUI();
@@ -83,9 +94,15 @@ private:
     void updateWindowTitle();
     bool maybeSave();
     void loadBinaryFile(const QString& filepath);
+    void suggestMapPacks();
+    void recoverJournal();      // Offers the edits a crash left behind, then starts the journal
+    void startJournal();
+    void storeProjectNotes();   // Annotations and bookmarks into the project
+    void restoreProjectNotes(); // And back into their managers
     void updateRecentFilesMenus();
     void updateSafeModeStatus();
-
+    bool takeClipboardBlock();
+    
     // ==== VALUE TYPE MEMBERS MOVED TO POINTERS (SAFE) ====
     ProjectManager* m_projectManager{nullptr};
     BinaryFile* m_binaryFile{nullptr};
@@ -97,7 +114,13 @@ private:
     BatchOperations* m_batchOps{nullptr};
     MapMath* m_mapMath{nullptr};
     InterpolationEngine* m_interpolationEngine{nullptr};
-
+    MapClipboard* m_mapClipboard{nullptr};
+    HashService* m_hashService{nullptr};
+    EditJournal* m_journal{nullptr};
+    QTimer* m_journalTimer{nullptr};
+    uint64_t m_journaledRevision{0};    // Project revision last written to the journal
+    static constexpr int JournalIntervalMs = 2000;
+    
     // ==== UI COMPONENTS (pointers, unchanged) ====
     HexEditorWidget* m_hexEditor{nullptr};
     MapListWidget* m_mapList{nullptr};
@@ -110,7 +133,7 @@ private:
     RecentFilesMenu* m_recentProjectsMenu{nullptr};
     RecentFilesMenu* m_recentBinariesMenu{nullptr};
     SearchReplaceDialog* m_searchReplaceDialog{nullptr};
-
+    
     // ==== ACTIONS (pointers, unchanged) ====
     QAction* m_newProjectAction{nullptr};
     QAction* m_openProjectAction{nullptr};
@@ -1,4 +1,5 @@
 #include "Map2DViewer.h"
+#include "../cache/CacheManager.h"
 #include <QMessageBox>
 #include <QPainter>
 #include <QtMath>
@@ -7,6 +8,7 @@ namespace WinMMM10 {
 
 Map2DViewer::Map2DViewer(QWidget* parent)
     : QWidget(parent)
+    , m_map(std::make_shared<Map2D>())
     , m_binaryFile(nullptr)
 {
     auto* layout = new QVBoxLayout(this);
@@ -23,7 +25,7 @@ Map2DViewer::Map2DViewer(QWidget* parent)
 
 void Map2DViewer::setMap(const MapDefinition& definition, BinaryFile* file) {
     m_binaryFile = file;
-    m_map = Map2D(definition);
+    m_map = std::make_shared<Map2D>(definition);
     
     if (!m_binaryFile || !m_binaryFile->isLoaded()) {
         m_infoLabel->setText("No binary file loaded");
@@ -39,14 +41,26 @@ void Map2DViewer::setMap(const MapDefinition& definition, BinaryFile* file) {
         return;
     }
     
-    const uint8_t* data = m_binaryFile->at(address);
-    m_map.loadFromBinary(data, dataSize);
+    // Reuse the decoded map if the cache is attached to this binary
+    MapDataCache& cache = CacheManager::instance().mapDataCache();
+    std::shared_ptr<const Map2D> cached;
+    if (cache.binaryFile() == m_binaryFile) {
+        cached = cache.get2D(definition);
+    }
+    
+    if (cached) {
+        m_map = cached;
+    } else {
+        auto map = std::make_shared<Map2D>(definition);
+        map->loadFromBinary(m_binaryFile->at(address), dataSize);
+        m_map = map;
+    }
     
     updateMap();
 }
 
 void Map2DViewer::updateMap() {
-    size_t pointCount = m_map.pointCount();
+    size_t pointCount = m_map->pointCount();
     if (pointCount == 0) {
         m_infoLabel->setText("No data points");
         return;
@@ -55,8 +69,8 @@ void Map2DViewer::updateMap() {
     double minX = 0, maxX = 0, minY = 0, maxY = 0;
     
     for (size_t i = 0; i < pointCount; ++i) {
-        double x = m_map.getXAxisValue(i);
-        double y = m_map.getPhysicalValue(i);
+        double x = m_map->getXAxisValue(i);
+        double y = m_map->getPhysicalValue(i);
         
         if (i == 0) {
             minX = maxX = x;
@@ -86,7 +100,7 @@ void Map2DViewer::paintEvent(QPaintEvent* event) {
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
     
-    if (m_map.pointCount() == 0) {
+    if (m_map->pointCount() == 0) {
         return;
     }
     
@@ -97,11 +111,11 @@ void Map2DViewer::paintEvent(QPaintEvent* event) {
     
     // Calculate ranges
     double minX = 0, maxX = 0, minY = 0, maxY = 0;
-    size_t pointCount = m_map.pointCount();
+    size_t pointCount = m_map->pointCount();
     
     for (size_t i = 0; i < pointCount; ++i) {
-        double x = m_map.getXAxisValue(i);
-        double y = m_map.getPhysicalValue(i);
+        double x = m_map->getXAxisValue(i);
+        double y = m_map->getPhysicalValue(i);
         
         if (i == 0) {
             minX = maxX = x;
@@ -132,8 +146,8 @@ void Map2DViewer::paintEvent(QPaintEvent* event) {
     bool first = true;
     
     for (size_t i = 0; i < pointCount; ++i) {
-        double x = m_map.getXAxisValue(i);
-        double y = m_map.getPhysicalValue(i);
+        double x = m_map->getXAxisValue(i);
+        double y = m_map->getPhysicalValue(i);
         
         double normX = (x - minX) / xRange;
         double normY = 1.0 - (y - minY) / yRange; // Flip Y
@@ -153,8 +167,8 @@ void Map2DViewer::paintEvent(QPaintEvent* event) {
     painter.setBrush(palette().color(QPalette::Highlight));
     painter.setPen(Qt::NoPen);
     for (size_t i = 0; i < pointCount; ++i) {
-        double x = m_map.getXAxisValue(i);
-        double y = m_map.getPhysicalValue(i);
+        double x = m_map->getXAxisValue(i);
+        double y = m_map->getPhysicalValue(i);
         
         double normX = (x - minX) / xRange;
         double normY = 1.0 - (y - minY) / yRange;
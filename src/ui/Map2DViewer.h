@@ -7,6 +7,7 @@
 #include <QPaintEvent>
 #include "../maps/Map2D.h"
 #include "../binary/BinaryFile.h"
+#include <memory>
 
 namespace WinMMM10 {
 
@@ -27,7 +28,7 @@ protected:
     void paintEvent(QPaintEvent* event) override;
 
 private:
-    Map2D m_map;
+    std::shared_ptr<const Map2D> m_map; // Shared with MapDataCache, never null
     BinaryFile* m_binaryFile{nullptr};
     QLabel* m_infoLabel{nullptr};
 };
@@ -1,4 +1,5 @@
 #include "Map3DViewer.h"
+#include "../cache/CacheManager.h"
 #include <QMatrix4x4>
 #include <QtMath>
 
@@ -6,6 +7,7 @@ namespace WinMMM10 {
 
 Map3DViewer::Map3DViewer(QWidget* parent)
     : QOpenGLWidget(parent)
+    , m_map(std::make_shared<Map3D>())
     , m_binaryFile(nullptr)
 {
     setMinimumSize(400, 300);
@@ -31,7 +33,7 @@ void Map3DViewer::resizeGL(int w, int h) {
 void Map3DViewer::paintGL() {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
-    if (m_map.rows() == 0 || m_map.columns() == 0) {
+    if (m_map->rows() == 0 || m_map->columns() == 0) {
         return;
     }
     
@@ -61,8 +63,8 @@ void Map3DViewer::paintGL() {
 }
 
 void Map3DViewer::drawSurface() {
-    size_t rows = m_map.rows();
-    size_t cols = m_map.columns();
+    size_t rows = m_map->rows();
+    size_t cols = m_map->columns();
     
     if (rows == 0 || cols == 0) {
         return;
@@ -82,25 +84,25 @@ void Map3DViewer::drawSurface() {
         for (size_t col = 0; col < cols - 1; ++col) {
             double x1 = (static_cast<double>(col) - cols/2.0) * xScale;
             double y1 = (static_cast<double>(row) - rows/2.0) * yScale;
-            double z1 = (m_map.getPhysicalValue(row, col) + zOffset) * zScale;
+            double z1 = (m_map->getPhysicalValue(row, col) + zOffset) * zScale;
             
             double x2 = (static_cast<double>(col + 1) - cols/2.0) * xScale;
             double y2 = (static_cast<double>(row) - rows/2.0) * yScale;
-            double z2 = (m_map.getPhysicalValue(row, col + 1) + zOffset) * zScale;
+            double z2 = (m_map->getPhysicalValue(row, col + 1) + zOffset) * zScale;
             
             double x3 = (static_cast<double>(col) - cols/2.0) * xScale;
             double y3 = (static_cast<double>(row + 1) - rows/2.0) * yScale;
-            double z3 = (m_map.getPhysicalValue(row + 1, col) + zOffset) * zScale;
+            double z3 = (m_map->getPhysicalValue(row + 1, col) + zOffset) * zScale;
             
             double x4 = (static_cast<double>(col + 1) - cols/2.0) * xScale;
             double y4 = (static_cast<double>(row + 1) - rows/2.0) * yScale;
-            double z4 = (m_map.getPhysicalValue(row + 1, col + 1) + zOffset) * zScale;
+            double z4 = (m_map->getPhysicalValue(row + 1, col + 1) + zOffset) * zScale;
             
             // Normalize values for color
-            QVector3D color1 = getColorForValue(m_map.getPhysicalValue(row, col), m_minValue, m_maxValue);
-            QVector3D color2 = getColorForValue(m_map.getPhysicalValue(row, col + 1), m_minValue, m_maxValue);
-            QVector3D color3 = getColorForValue(m_map.getPhysicalValue(row + 1, col), m_minValue, m_maxValue);
-            QVector3D color4 = getColorForValue(m_map.getPhysicalValue(row + 1, col + 1), m_minValue, m_maxValue);
+            QVector3D color1 = getColorForValue(m_map->getPhysicalValue(row, col), m_minValue, m_maxValue);
+            QVector3D color2 = getColorForValue(m_map->getPhysicalValue(row, col + 1), m_minValue, m_maxValue);
+            QVector3D color3 = getColorForValue(m_map->getPhysicalValue(row + 1, col), m_minValue, m_maxValue);
+            QVector3D color4 = getColorForValue(m_map->getPhysicalValue(row + 1, col + 1), m_minValue, m_maxValue);
             
             // First triangle
             glColor3f(color1.x(), color1.y(), color1.z());
@@ -179,7 +181,7 @@ void Map3DViewer::wheelEvent(QWheelEvent* event) {
 
 void Map3DViewer::setMap(const MapDefinition& definition, BinaryFile* file) {
     m_binaryFile = file;
-    m_map = Map3D(definition);
+    m_map = std::make_shared<Map3D>(definition);
     
     if (!m_binaryFile || !m_binaryFile->isLoaded()) {
         return;
@@ -192,14 +194,26 @@ void Map3DViewer::setMap(const MapDefinition& definition, BinaryFile* file) {
         return;
     }
     
-    const uint8_t* data = m_binaryFile->at(address);
-    m_map.loadFromBinary(data, dataSize);
+    // Reuse the decoded map if the cache is attached to this binary
+    MapDataCache& cache = CacheManager::instance().mapDataCache();
+    std::shared_ptr<const Map3D> cached;
+    if (cache.binaryFile() == m_binaryFile) {
+        cached = cache.get3D(definition);
+    }
+    
+    if (cached) {
+        m_map = cached;
+    } else {
+        auto map = std::make_shared<Map3D>(definition);
+        map->loadFromBinary(m_binaryFile->at(address), dataSize);
+        m_map = map;
+    }
     
     // Calculate min/max
-    m_minValue = m_maxValue = m_map.getPhysicalValue(0, 0);
-    for (size_t row = 0; row < m_map.rows(); ++row) {
-        for (size_t col = 0; col < m_map.columns(); ++col) {
-            double val = m_map.getPhysicalValue(row, col);
+    m_minValue = m_maxValue = m_map->getPhysicalValue(0, 0);
+    for (size_t row = 0; row < m_map->rows(); ++row) {
+        for (size_t col = 0; col < m_map->columns(); ++col) {
+            double val = m_map->getPhysicalValue(row, col);
             if (val < m_minValue) m_minValue = val;
             if (val > m_maxValue) m_maxValue = val;
         }
@@ -8,6 +8,7 @@
 #include <QVector3D>
 #include "../maps/Map3D.h"
 #include "../binary/BinaryFile.h"
+#include <memory>
 
 namespace WinMMM10 {
 
@@ -34,7 +35,7 @@ private:
     void drawSurface();
     QVector3D getColorForValue(double value, double minVal, double maxVal);
     
-    Map3D m_map;
+    std::shared_ptr<const Map3D> m_map; // Shared with MapDataCache, never null
     BinaryFile* m_binaryFile{nullptr};
     
     float m_rotationX{30.0f};
@@ -47,9 +47,17 @@ MapDefinitionDialog::MapDefinitionDialog(QWidget* parent)
     m_dataTypeCombo->addItem("uint16", 2);
     m_dataTypeCombo->addItem("int16", 3);
     m_dataTypeCombo->addItem("float", 4);
+    m_dataTypeCombo->addItem("int8", 5);
+    m_dataTypeCombo->addItem("uint32", 6);
+    m_dataTypeCombo->addItem("int32", 7);
     m_dataTypeCombo->setCurrentIndex(1);
     layout->addRow("Data Type:", m_dataTypeCombo);
     
+    m_byteOrderCombo = new QComboBox();
+    m_byteOrderCombo->addItem("Little Endian (Intel)", static_cast<int>(Endianness::Little));
+    m_byteOrderCombo->addItem("Big Endian (Motorola)", static_cast<int>(Endianness::Big));
+    layout->addRow("Byte Order:", m_byteOrderCombo);
+    
     m_factorSpin = new QDoubleSpinBox();
     m_factorSpin->setDecimals(6);
     m_factorSpin->setMinimum(0.000001);
@@ -98,6 +106,7 @@ void MapDefinitionDialog::setMapDefinition(const MapDefinition& map) {
             break;
         }
     }
+    m_byteOrderCombo->setCurrentIndex(map.endianness() == Endianness::Big ? 1 : 0);
     
     m_factorSpin->setValue(map.factor());
     m_offsetSpin->setValue(map.offset());
@@ -128,6 +137,11 @@ MapDefinition MapDefinitionDialog::getMapDefinition() const {
     map.setRows(static_cast<size_t>(m_rowsSpin->value()));
     map.setColumns(static_cast<size_t>(m_columnsSpin->value()));
     map.setDataType(static_cast<uint16_t>(m_dataTypeCombo->currentData().toInt()));
+    // One byte order per ECU; axes follow the map
+    Endianness endian = static_cast<Endianness>(m_byteOrderCombo->currentData().toInt());
+    map.setEndianness(endian);
+    map.xAxis().setEndianness(endian);
+    map.yAxis().setEndianness(endian);
     map.setFactor(m_factorSpin->value());
     map.setOffset(m_offsetSpin->value());
     map.setUnit(m_unitEdit->text().toStdString());
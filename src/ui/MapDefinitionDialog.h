@@ -33,6 +33,7 @@ private:
     QSpinBox* m_rowsSpin{nullptr};
     QSpinBox* m_columnsSpin{nullptr};
     QComboBox* m_dataTypeCombo{nullptr};
+    QComboBox* m_byteOrderCombo{nullptr};
     QDoubleSpinBox* m_factorSpin{nullptr};
     QDoubleSpinBox* m_offsetSpin{nullptr};
     QLineEdit* m_unitEdit{nullptr};
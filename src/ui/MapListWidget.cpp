@@ -1,6 +1,12 @@
 #include "MapListWidget.h"
 #include <QMenu>
 #include <QMessageBox>
+#include <QImage>
+#include <QPixmap>
+#include <QIcon>
+#include <QTimer>
+#include <algorithm>
+#include <memory>
 
 namespace WinMMM10 {
 
@@ -8,6 +14,36 @@ MapListWidget::MapListWidget(QWidget* parent)
     : QListWidget(parent)
 {
     connect(this, &QListWidget::itemSelectionChanged, this, &MapListWidget::onItemSelectionChanged);
+    setIconSize(QSize(ThumbnailRenderer::ThumbnailSize, ThumbnailRenderer::ThumbnailSize));
+}
+
+MapListWidget::~MapListWidget() {
+    setBinaryFile(nullptr);
+}
+
+void MapListWidget::setBinaryFile(BinaryFile* file) {
+    if (m_binaryFile) {
+        m_binaryFile->removeWriteObserver(m_writeObserverId);
+    }
+    m_binaryFile = file;
+    m_writtenRanges.clear();
+    if (!file) {
+        return;
+    }
+    
+    // Writes come in bursts of single values; collect them and refresh once
+    m_writeObserverId = file->addWriteObserver([this](size_t offset, size_t length) {
+        size_t end = length == BinaryFile::WholeFile ? BinaryFile::WholeFile : offset + length;
+        m_writtenRanges.emplace_back(length == BinaryFile::WholeFile ? 0 : offset, end);
+        if (!m_writeRefreshScheduled) {
+            m_writeRefreshScheduled = true;
+            QTimer::singleShot(WriteRefreshDelayMs, this, [this]() {
+                m_writeRefreshScheduled = false;
+                markWrittenMapsStale();
+                renderStaleThumbnails();
+            });
+        }
+    });
 }
 
 void MapListWidget::addMap(const MapDefinition& map) {
@@ -16,10 +52,104 @@ void MapListWidget::addMap(const MapDefinition& map) {
     text += " @ 0x" + QString::number(map.address(), 16).toUpper();
     
     addItem(text);
+    m_maps.push_back(map);
+    m_staleThumbnails.push_back(true);
+    scheduleThumbnailRefresh();
 }
 
 void MapListWidget::clearMaps() {
     clear();
+    m_maps.clear();
+    m_staleThumbnails.clear();
+    m_thumbnailRenderer.cancel();
+    ++m_thumbnailGeneration;
+}
+
+void MapListWidget::scheduleThumbnailRefresh() {
+    // Maps are usually added in bulk; render once after the list is populated
+    if (m_refreshScheduled) {
+        return;
+    }
+    m_refreshScheduled = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_refreshScheduled = false;
+        renderStaleThumbnails();
+    });
+}
+
+void MapListWidget::refreshThumbnails() {
+    std::fill(m_staleThumbnails.begin(), m_staleThumbnails.end(), true);
+    renderStaleThumbnails();
+}
+
+void MapListWidget::markWrittenMapsStale() {
+    if (m_writtenRanges.empty()) {
+        return;
+    }
+    
+    // Merge the ranges, then look each map up in them
+    std::sort(m_writtenRanges.begin(), m_writtenRanges.end());
+    std::vector<std::pair<size_t, size_t>> merged;
+    for (const auto& range : m_writtenRanges) {
+        if (!merged.empty() && range.first <= merged.back().second) {
+            merged.back().second = std::max(merged.back().second, range.second);
+        } else {
+            merged.push_back(range);
+        }
+    }
+    m_writtenRanges.clear();
+    
+    for (size_t i = 0; i < m_maps.size(); ++i) {
+        size_t begin = m_maps[i].address();
+        size_t end = begin + m_maps[i].totalSize();
+        // First merged range ending after the map starts
+        auto range = std::upper_bound(merged.begin(), merged.end(), begin,
+                                      [](size_t value, const auto& r) { return value < r.second; });
+        if (range != merged.end() && range->first < end) {
+            m_staleThumbnails[i] = true;
+        }
+    }
+}
+
+void MapListWidget::renderStaleThumbnails() {
+    // Replaces the pending request; what it had not rendered yet is still stale
+    uint64_t generation = ++m_thumbnailGeneration;
+    if (!m_binaryFile || !m_binaryFile->isLoaded() || m_maps.empty()) {
+        m_thumbnailRenderer.cancel();
+        return;
+    }
+    
+    std::vector<MapDefinition> maps;
+    auto indices = std::make_shared<std::vector<size_t>>(); // Shared; workers copy the callback per map
+    for (size_t i = 0; i < m_maps.size(); ++i) {
+        if (m_staleThumbnails[i]) {
+            maps.push_back(m_maps[i]);
+            indices->push_back(i);
+        }
+    }
+    if (maps.empty()) {
+        m_thumbnailRenderer.cancel();
+        return;
+    }
+    
+    m_thumbnailRenderer.request(maps, *m_binaryFile,
+                                [this, generation, indices](size_t index, const MapThumbnail& thumbnail) {
+        // Hop to the UI thread; queued calls are dropped if the widget is gone
+        QMetaObject::invokeMethod(this, [this, generation, index = (*indices)[index], thumbnail]() {
+            applyThumbnail(generation, index, thumbnail);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MapListWidget::applyThumbnail(uint64_t generation, size_t index, const MapThumbnail& thumbnail) {
+    if (generation != m_thumbnailGeneration || index >= static_cast<size_t>(count())) {
+        return;
+    }
+    m_staleThumbnails[index] = false;
+    
+    QImage image(thumbnail.rgb.data(), thumbnail.width, thumbnail.height,
+                 thumbnail.width * 3, QImage::Format_RGB888);
+    item(static_cast<int>(index))->setIcon(QIcon(QPixmap::fromImage(image)));
 }
 
 void MapListWidget::contextMenuEvent(QContextMenuEvent* event) {
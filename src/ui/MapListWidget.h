@@ -3,6 +3,10 @@
 #include <QListWidget>
 #include <QContextMenuEvent>
 #include "../maps/MapDefinition.h"
+#include "../maps/MapThumbnail.h"
+#include "../cache/ThumbnailRenderer.h"
+#include <utility>
+#include <vector>
 
 namespace WinMMM10 {
 
@@ -11,11 +15,17 @@ class MapListWidget : public QListWidget {
 
 public:
     explicit MapListWidget(QWidget* parent = nullptr);
-    ~MapListWidget() override = default;
+    ~MapListWidget() override;
     
     void addMap(const MapDefinition& map);
     void clearMaps();
     int currentMapIndex() const { return currentRow(); }
+    
+    // Thumbnails are rendered in the background from this binary and
+    // rendered again when writes touch their map. Pass nullptr to detach
+    // before the file is destroyed.
+    void setBinaryFile(BinaryFile* file);
+    void refreshThumbnails();
 
 signals:
     void mapSelected(int index);
@@ -29,6 +39,24 @@ protected:
 private slots:
     void onItemSelectionChanged();
     void onDeleteMap();
+
+private:
+    void scheduleThumbnailRefresh();
+    void renderStaleThumbnails();
+    void markWrittenMapsStale();
+    void applyThumbnail(uint64_t generation, size_t index, const MapThumbnail& thumbnail);
+    
+    BinaryFile* m_binaryFile{nullptr};
+    size_t m_writeObserverId{0};
+    std::vector<std::pair<size_t, size_t>> m_writtenRanges; // begin, end since the last refresh
+    bool m_writeRefreshScheduled{false};
+    std::vector<MapDefinition> m_maps;
+    std::vector<bool> m_staleThumbnails; // By map; rendered with the next request
+    ThumbnailRenderer m_thumbnailRenderer;
+    uint64_t m_thumbnailGeneration{0};
+    bool m_refreshScheduled{false};
+    
+    static constexpr int WriteRefreshDelayMs = 250;
 };
 
 } // namespace WinMMM10
@@ -0,0 +1,106 @@
+#include "ProjectCompareDialog.h"
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <QDialogButtonBox>
+
+namespace WinMMM10 {
+
+namespace {
+
+enum Column {
+    NameColumn,
+    ChangedCellsColumn,
+    PercentColumn,
+    MaxDeltaColumn,
+    AverageDeltaColumn,
+    ColumnCount
+};
+
+// Numeric cells sort by value rather than by text
+QTableWidgetItem* numberItem(double value, int precision) {
+    auto* item = new QTableWidgetItem();
+    item->setData(Qt::DisplayRole, QString::number(value, 'f', precision).toDouble());
+    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return item;
+}
+
+} // namespace
+
+ProjectCompareDialog::ProjectCompareDialog(const ProjectComparator::Report& report, const QString& otherFile,
+                                           QWidget* parent)
+    : QDialog(parent)
+    , m_report(report)
+{
+    setWindowTitle("Project Comparison");
+    resize(720, 520);
+    
+    auto* layout = new QVBoxLayout(this);
+    
+    m_summaryLabel = new QLabel(QString("Compared with %1: %2 of %3 maps changed")
+                                    .arg(otherFile)
+                                    .arg(report.changedMaps)
+                                    .arg(report.comparedMaps));
+    layout->addWidget(m_summaryLabel);
+    
+    m_changedOnlyCheck = new QCheckBox("Show changed maps only");
+    m_changedOnlyCheck->setChecked(true);
+    connect(m_changedOnlyCheck, &QCheckBox::toggled, this, &ProjectCompareDialog::updateRowVisibility);
+    layout->addWidget(m_changedOnlyCheck);
+    
+    m_table = new QTableWidget(0, ColumnCount);
+    m_table->setHorizontalHeaderLabels({"Map", "Cells Changed", "% Changed", "Max Delta", "Avg Delta"});
+    m_table->horizontalHeader()->setSectionResizeMode(NameColumn, QHeaderView::Stretch);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->verticalHeader()->setVisible(false);
+    connect(m_table, &QTableWidget::cellDoubleClicked, this, [this](int row, int) {
+        emit mapActivated(m_table->item(row, NameColumn)->data(Qt::UserRole).toInt());
+    });
+    layout->addWidget(m_table);
+    
+    auto* buttonBox = new QDialogButtonBox(QDialogButtonBox::Close);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttonBox);
+    
+    populate();
+    updateRowVisibility();
+}
+
+void ProjectCompareDialog::populate() {
+    // Largest changes first until the user picks another column
+    m_report.sort(ProjectComparator::SortKey::MaxDelta);
+    
+    m_table->setSortingEnabled(false);
+    m_table->setRowCount(static_cast<int>(m_report.maps.size()));
+    for (size_t i = 0; i < m_report.maps.size(); ++i) {
+        const MapComparisonSummary& summary = m_report.maps[i];
+        int row = static_cast<int>(i);
+        
+        auto* nameItem = new QTableWidgetItem(QString::fromStdString(summary.name));
+        nameItem->setData(Qt::UserRole, static_cast<int>(summary.mapIndex));
+        if (!summary.compared) {
+            nameItem->setToolTip("Map lies outside one of the binaries");
+            nameItem->setForeground(Qt::gray);
+        }
+        m_table->setItem(row, NameColumn, nameItem);
+        
+        auto* changedItem = new QTableWidgetItem();
+        changedItem->setData(Qt::DisplayRole, static_cast<qulonglong>(summary.changedCells));
+        changedItem->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        m_table->setItem(row, ChangedCellsColumn, changedItem);
+        m_table->setItem(row, PercentColumn, numberItem(summary.percentChanged(), 1));
+        m_table->setItem(row, MaxDeltaColumn, numberItem(summary.maxDelta, 4));
+        m_table->setItem(row, AverageDeltaColumn, numberItem(summary.averageDelta, 4));
+    }
+    m_table->setSortingEnabled(true);
+}
+
+void ProjectCompareDialog::updateRowVisibility() {
+    bool changedOnly = m_changedOnlyCheck->isChecked();
+    for (int row = 0; row < m_table->rowCount(); ++row) {
+        bool changed = m_table->item(row, ChangedCellsColumn)->data(Qt::DisplayRole).toULongLong() > 0;
+        m_table->setRowHidden(row, changedOnly && !changed);
+    }
+}
+
+} // namespace WinMMM10
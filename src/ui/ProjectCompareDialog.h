@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QDialog>
+#include <QTableWidget>
+#include <QCheckBox>
+#include <QLabel>
+#include "../editing/ProjectComparator.h"
+
+namespace WinMMM10 {
+
+// Sortable table of a project comparison, one row per map
+class ProjectCompareDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    ProjectCompareDialog(const ProjectComparator::Report& report, const QString& otherFile,
+                         QWidget* parent = nullptr);
+    ~ProjectCompareDialog() override = default;
+
+signals:
+    // Emitted when a row is double-clicked, with the map's project index
+    void mapActivated(int index);
+
+private slots:
+    void updateRowVisibility();
+
+private:
+    void populate();
+    
+    ProjectComparator::Report m_report;
+    QLabel* m_summaryLabel{nullptr};
+    QCheckBox* m_changedOnlyCheck{nullptr};
+    QTableWidget* m_table{nullptr};
+};
+
+} // namespace WinMMM10
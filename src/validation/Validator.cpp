@@ -1,20 +1,143 @@
 #include "Validator.h"
 #include <cmath>
 #include <algorithm>
+#include <bit>
 
 namespace WinMMM10 {
 
+ValidationFlags::ValidationFlags(size_t cellCount)
+    : m_size(cellCount)
+{
+    for (auto& bits : m_bits) {
+        bits.assign((cellCount + 63) / 64, 0);
+    }
+}
+
+size_t ValidationFlags::slot(Flag flag) {
+    switch (flag) {
+        case AboveMaximum: return 1;
+        case ChangeTooLarge: return 2;
+        default: return 0;
+    }
+}
+
+bool ValidationFlags::test(size_t cell, Flag flag) const {
+    const auto& bits = m_bits[slot(flag)];
+    return cell < m_size && (bits[cell / 64] >> (cell % 64)) & 1;
+}
+
+uint8_t ValidationFlags::at(size_t cell) const {
+    uint8_t flags = None;
+    for (Flag flag : {BelowMinimum, AboveMaximum, ChangeTooLarge}) {
+        if (test(cell, flag)) {
+            flags |= flag;
+        }
+    }
+    return flags;
+}
+
+const std::vector<uint64_t>& ValidationFlags::bitmap(Flag flag) const {
+    return m_bits[slot(flag)];
+}
+
+bool ValidationFlags::any() const {
+    for (const auto& bits : m_bits) {
+        if (std::any_of(bits.begin(), bits.end(), [](uint64_t word) { return word != 0; })) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t ValidationFlags::count(Flag flag) const {
+    size_t total = 0;
+    for (uint64_t word : m_bits[slot(flag)]) {
+        total += static_cast<size_t>(std::popcount(word));
+    }
+    return total;
+}
+
+size_t ValidationFlags::count() const {
+    size_t total = 0;
+    for (size_t w = 0; w < m_bits[0].size(); ++w) {
+        total += static_cast<size_t>(std::popcount(m_bits[0][w] | m_bits[1][w] | m_bits[2][w]));
+    }
+    return total;
+}
+
+std::vector<size_t> ValidationFlags::flaggedCells(size_t limit) const {
+    std::vector<size_t> cells;
+    size_t words = m_bits[0].size();
+    for (size_t w = 0; w < words && cells.size() < limit; ++w) {
+        uint64_t word = m_bits[0][w] | m_bits[1][w] | m_bits[2][w];
+        while (word != 0 && cells.size() < limit) {
+            cells.push_back(w * 64 + static_cast<size_t>(std::countr_zero(word)));
+            word &= word - 1;
+        }
+    }
+    return cells;
+}
+
 Validator::Validator() = default;
 
+uint8_t Validator::check(double oldValue, double newValue) const {
+    // Change percent is compared without dividing: |new - old| * 100 > max * |old|
+    double magnitude = std::abs(oldValue);
+    bool changeTooLarge = magnitude > 0.0001 &&
+                          std::abs(newValue - oldValue) * 100.0 > m_maxChangePercent * magnitude;
+    return (newValue < m_minValue ? ValidationFlags::BelowMinimum : 0) |
+           (newValue > m_maxValue ? ValidationFlags::AboveMaximum : 0) |
+           (changeTooLarge ? ValidationFlags::ChangeTooLarge : 0);
+}
+
 std::vector<ValidationWarning> Validator::validateChange(
     size_t address,
     double oldValue,
     double newValue)
 {
+    return describe(address, oldValue, newValue, check(oldValue, newValue));
+}
+
+ValidationFlags Validator::validateBatch(std::span<const double> oldValues,
+                                         std::span<const double> newValues) const {
+    size_t count = std::min(oldValues.size(), newValues.size());
+    ValidationFlags flags(count);
+    
+    const double* oldData = oldValues.data();
+    const double* newData = newValues.data();
+    double minValue = m_minValue;
+    double maxValue = m_maxValue;
+    double maxChange = m_maxChangePercent;
+    
+    // Each word of 64 cells is built from comparisons only, so the inner loop
+    // has no data-dependent branches
+    for (size_t base = 0; base < count; base += 64) {
+        size_t n = std::min<size_t>(64, count - base);
+        uint64_t below = 0;
+        uint64_t above = 0;
+        uint64_t change = 0;
+        for (size_t j = 0; j < n; ++j) {
+            double oldValue = oldData[base + j];
+            double newValue = newData[base + j];
+            double magnitude = std::abs(oldValue);
+            bool tooLarge = (magnitude > 0.0001) & (std::abs(newValue - oldValue) * 100.0 > maxChange * magnitude);
+            below |= static_cast<uint64_t>(newValue < minValue) << j;
+            above |= static_cast<uint64_t>(newValue > maxValue) << j;
+            change |= static_cast<uint64_t>(tooLarge) << j;
+        }
+        flags.m_bits[0][base / 64] = below;
+        flags.m_bits[1][base / 64] = above;
+        flags.m_bits[2][base / 64] = change;
+    }
+    return flags;
+}
+
+std::vector<ValidationWarning> Validator::describe(size_t address, double oldValue, double newValue,
+                                                   uint8_t flags) const {
     std::vector<ValidationWarning> warnings;
     
     // Check value range
-    if (newValue < m_minValue) {
+    if (flags & ValidationFlags::BelowMinimum) {
         ValidationWarning warning;
         warning.address = address;
         warning.oldValue = oldValue;
@@ -23,7 +146,7 @@ std::vector<ValidationWarning> Validator::validateChange(
         warnings.push_back(warning);
     }
     
-    if (newValue > m_maxValue) {
+    if (flags & ValidationFlags::AboveMaximum) {
         ValidationWarning warning;
         warning.address = address;
         warning.oldValue = oldValue;
@@ -33,22 +156,19 @@ std::vector<ValidationWarning> Validator::validateChange(
     }
     
     // Check change percentage
-    if (std::abs(oldValue) > 0.0001) {
+    if (flags & ValidationFlags::ChangeTooLarge) {
         double changePercent = std::abs((newValue - oldValue) / oldValue) * 100.0;
-        if (changePercent > m_maxChangePercent) {
-            ValidationWarning warning;
-            warning.address = address;
-            warning.oldValue = oldValue;
-            warning.newValue = newValue;
-            warning.changePercent = changePercent;
-            warning.message = "Change exceeds " + std::to_string(m_maxChangePercent) + "% (" + 
-                            std::to_string(changePercent) + "%)";
-            warnings.push_back(warning);
-        }
+        ValidationWarning warning;
+        warning.address = address;
+        warning.oldValue = oldValue;
+        warning.newValue = newValue;
+        warning.changePercent = changePercent;
+        warning.message = "Change exceeds " + std::to_string(m_maxChangePercent) + "% (" + 
+                        std::to_string(changePercent) + "%)";
+        warnings.push_back(warning);
     }
     
     return warnings;
 }
 
 } // namespace WinMMM10
-
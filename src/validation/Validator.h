@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -15,6 +16,42 @@ struct ValidationWarning {
     double changePercent{0.0};
 };
 
+// Outcome of Validator::validateBatch(): one bitmap per check, one bit per
+// cell, so a large edit costs a few bits per cell rather than a warning each
+class ValidationFlags {
+public:
+    enum Flag : uint8_t {
+        None = 0,
+        BelowMinimum = 1 << 0,
+        AboveMaximum = 1 << 1,
+        ChangeTooLarge = 1 << 2
+    };
+    
+    ValidationFlags() = default;
+    explicit ValidationFlags(size_t cellCount);
+    
+    size_t size() const { return m_size; }
+    // Combination of Flag bits for one cell
+    uint8_t at(size_t cell) const;
+    bool test(size_t cell, Flag flag) const;
+    const std::vector<uint64_t>& bitmap(Flag flag) const;
+    
+    bool any() const;
+    size_t count(Flag flag) const;
+    // Cells with at least one flag
+    size_t count() const;
+    // Cells with at least one flag, in order, stopping after limit
+    std::vector<size_t> flaggedCells(size_t limit = static_cast<size_t>(-1)) const;
+
+private:
+    friend class Validator;
+    
+    static size_t slot(Flag flag);
+    
+    size_t m_size{0};
+    std::vector<uint64_t> m_bits[3];
+};
+
 class Validator {
 public:
     Validator();
@@ -29,12 +66,21 @@ public:
         double oldValue,
         double newValue
     );
+    
+    // Checks whole arrays of old and new values in one branch-free pass per
+    // 64 cells. No messages are built; use describe() for the cells shown.
+    ValidationFlags validateBatch(std::span<const double> oldValues, std::span<const double> newValues) const;
+    
+    // Warnings for one cell whose flags came from validateBatch()
+    std::vector<ValidationWarning> describe(size_t address, double oldValue, double newValue,
+                                            uint8_t flags) const;
 
 private:
+    uint8_t check(double oldValue, double newValue) const;
+    
     double m_maxChangePercent{50.0};
     double m_minValue{-1000000.0};
     double m_maxValue{1000000.0};
 };
 
 } // namespace WinMMM10
-
@@ -0,0 +1,177 @@
+#include "TestAnnotationManager.h"
+#include <QTest>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+using WinMMM10::Annotation;
+using WinMMM10::AnnotationManager;
+
+namespace {
+
+// Addresses of the annotations visitRange() reports, sorted
+std::vector<size_t> visited(const AnnotationManager& manager, size_t start, size_t end) {
+    std::vector<size_t> addresses;
+    manager.visitRange(start, end, [&addresses](const Annotation& annotation) {
+        addresses.push_back(annotation.address);
+    });
+    std::sort(addresses.begin(), addresses.end());
+    return addresses;
+}
+
+std::vector<size_t> at(const AnnotationManager& manager, size_t address) {
+    std::vector<size_t> addresses;
+    for (const Annotation* annotation : manager.getAnnotationsAt(address)) {
+        addresses.push_back(annotation->address);
+    }
+    std::sort(addresses.begin(), addresses.end());
+    return addresses;
+}
+
+} // namespace
+
+void TestAnnotationManager::testOverlapping() {
+    // [100, 200) holds [120, 130) and overlaps [190, 250), which holds [200, 201)
+    AnnotationManager manager;
+    manager.addAnnotation(Annotation(100, "Fuel block", "#FF0000", 100));
+    manager.addAnnotation(Annotation(120, "Fuel map", "#00FF00", 10));
+    manager.addAnnotation(Annotation(190, "Spark block", "#0000FF", 60));
+    manager.addAnnotation(Annotation(200, "Flag", "#FFFF00", 1));
+    
+    QVERIFY(at(manager, 99).empty());
+    QVERIFY(at(manager, 100) == std::vector<size_t>({100}));
+    QVERIFY(at(manager, 125) == std::vector<size_t>({100, 120}));
+    QVERIFY(at(manager, 130) == std::vector<size_t>({100}));
+    QVERIFY(at(manager, 195) == std::vector<size_t>({100, 190}));
+    QVERIFY(at(manager, 199) == std::vector<size_t>({100, 190}));
+    QVERIFY(at(manager, 200) == std::vector<size_t>({190, 200}));
+    QVERIFY(at(manager, 249) == std::vector<size_t>({190}));
+    QVERIFY(at(manager, 250).empty());
+    
+    // Ranges are half-open
+    QVERIFY(visited(manager, 0, 100).empty());
+    QVERIFY(visited(manager, 0, 101) == std::vector<size_t>({100}));
+    QVERIFY(visited(manager, 130, 190) == std::vector<size_t>({100}));
+    QVERIFY(visited(manager, 129, 191) == std::vector<size_t>({100, 120, 190}));
+    QVERIFY(visited(manager, 201, 1000) == std::vector<size_t>({190}));
+    QVERIFY(visited(manager, 0, static_cast<size_t>(-1)) == std::vector<size_t>({100, 120, 190, 200}));
+    QVERIFY(visited(manager, 150, 150).empty());
+    
+    // getAnnotationsInRange() is inclusive and sorted
+    std::vector<Annotation> inRange = manager.getAnnotationsInRange(130, 200);
+    QCOMPARE(inRange.size(), static_cast<size_t>(3));
+    QCOMPARE(inRange[0].address, static_cast<size_t>(100));
+    QCOMPARE(inRange[1].address, static_cast<size_t>(190));
+    QCOMPARE(inRange[2].address, static_cast<size_t>(200));
+    QVERIFY(manager.getAnnotationsInRange(300, 200).empty());
+    
+    // A length running past the top of the address space ends there
+    const size_t top = std::numeric_limits<size_t>::max();
+    Annotation tail(top - 10, "Tail", "#FFFF00", 100);
+    QCOMPARE(tail.end(), top);
+    manager.addAnnotation(tail);
+    QVERIFY(at(manager, top - 1) == std::vector<size_t>({top - 10}));
+    QVERIFY(visited(manager, top - 5, top) == std::vector<size_t>({top - 10}));
+}
+
+void TestAnnotationManager::testZeroLength() {
+    // A zero length covers its own byte, like a length of one
+    AnnotationManager manager;
+    manager.addAnnotation(Annotation(50, "Marker", "#FFFF00", 0));
+    manager.addAnnotation(Annotation(40, "Around", "#FFFF00", 20));
+    
+    QVERIFY(at(manager, 49) == std::vector<size_t>({40}));
+    QVERIFY(at(manager, 50) == std::vector<size_t>({40, 50}));
+    QVERIFY(at(manager, 51) == std::vector<size_t>({40}));
+    QVERIFY(visited(manager, 50, 51) == std::vector<size_t>({40, 50}));
+    QVERIFY(visited(manager, 51, 60) == std::vector<size_t>({40}));
+    QVERIFY(visited(manager, 0, 50) == std::vector<size_t>({40}));
+    
+    // An empty query range matches nothing, even at the marker
+    QVERIFY(visited(manager, 50, 50).empty());
+}
+
+void TestAnnotationManager::testAddRemoveInvalidates() {
+    AnnotationManager manager;
+    manager.addAnnotation(Annotation(10, "A", "#FFFF00", 10));
+    manager.addAnnotation(Annotation(30, "B", "#FFFF00", 10));
+    QVERIFY(at(manager, 15) == std::vector<size_t>({10}));
+    
+    // Added after the index was built
+    manager.addAnnotation(Annotation(12, "C", "#FFFF00", 4));
+    QVERIFY(at(manager, 15) == std::vector<size_t>({10, 12}));
+    QVERIFY(at(manager, 16) == std::vector<size_t>({10}));
+    
+    // Replacing an annotation at the same address replaces its range
+    manager.addAnnotation(Annotation(10, "A2", "#FFFF00", 1));
+    QVERIFY(at(manager, 15) == std::vector<size_t>({12}));
+    QCOMPARE(manager.getAnnotationsAt(10).front()->note, std::string("A2"));
+    QCOMPARE(manager.count(), static_cast<size_t>(3));
+    
+    // Removed ones are gone from every query
+    manager.removeAnnotation(12);
+    QVERIFY(at(manager, 15).empty());
+    QVERIFY(visited(manager, 0, 100) == std::vector<size_t>({10, 30}));
+    manager.removeAnnotation(999); // Not there; nothing changes
+    QVERIFY(visited(manager, 0, 100) == std::vector<size_t>({10, 30}));
+    
+    // Lengths changed through findAnnotation() are picked up
+    manager.findAnnotation(30)->length = 100;
+    QVERIFY(at(manager, 120) == std::vector<size_t>({30}));
+    
+    manager.clear();
+    QVERIFY(at(manager, 30).empty());
+    QVERIFY(visited(manager, 0, static_cast<size_t>(-1)).empty());
+}
+
+void TestAnnotationManager::testMatchesLinearScan() {
+    // Random overlapping annotations, some added and removed between queries
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<size_t> address(0, 2000);
+    std::uniform_int_distribution<size_t> length(0, 300);
+    AnnotationManager manager;
+    std::vector<Annotation> reference;
+    
+    auto expected = [&reference](size_t start, size_t end) {
+        std::vector<size_t> addresses;
+        if (start >= end) {
+            return addresses;
+        }
+        for (const Annotation& annotation : reference) {
+            if (annotation.address < end && start < annotation.end()) {
+                addresses.push_back(annotation.address);
+            }
+        }
+        std::sort(addresses.begin(), addresses.end());
+        return addresses;
+    };
+    
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 30; ++i) {
+            Annotation annotation(address(rng), "note", "#FFFF00", length(rng));
+            manager.addAnnotation(annotation);
+            auto existing = std::find_if(reference.begin(), reference.end(), [&](const Annotation& other) {
+                return other.address == annotation.address;
+            });
+            if (existing != reference.end()) {
+                *existing = annotation;
+            } else {
+                reference.push_back(annotation);
+            }
+        }
+        for (int i = 0; i < 10 && !reference.empty(); ++i) {
+            size_t victim = rng() % reference.size();
+            manager.removeAnnotation(reference[victim].address);
+            reference.erase(reference.begin() + static_cast<std::ptrdiff_t>(victim));
+        }
+        QCOMPARE(manager.count(), reference.size());
+        
+        for (int q = 0; q < 50; ++q) {
+            size_t start = address(rng);
+            size_t end = start + length(rng);
+            QVERIFY(visited(manager, start, end) == expected(start, end));
+            QVERIFY(at(manager, start) == expected(start, start + 1));
+        }
+    }
+}
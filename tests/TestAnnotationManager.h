@@ -0,0 +1,14 @@
+#pragma once
+
+#include <QtTest/QtTest>
+#include "../src/core/AnnotationManager.h"
+
+class TestAnnotationManager : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testOverlapping();
+    void testZeroLength();
+    void testAddRemoveInvalidates();
+    void testMatchesLinearScan();
+};
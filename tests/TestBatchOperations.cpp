@@ -0,0 +1,87 @@
+#include "TestBatchOperations.h"
+#include "TestHelpers.h"
+#include <QTest>
+#include <atomic>
+#include <vector>
+
+using WinMMM10::BatchOperations;
+using WinMMM10::BinaryFile;
+using WinMMM10::EditHistory;
+using WinMMM10::MapDefinition;
+using TestHelpers::loadBytes;
+using TestHelpers::makeMap;
+
+void TestBatchOperations::testApplyToAllMapsInParallel() {
+    // 64 disjoint 16-byte maps, then three chained overlapping ones and one
+    // outside the image; every byte of a map is incremented, so overlapping
+    // bytes must end up incremented once per map covering them
+    const size_t fileSize = 64 * 16 + 64;
+    std::vector<uint8_t> image(fileSize);
+    for (size_t i = 0; i < image.size(); ++i) {
+        image[i] = static_cast<uint8_t>(i * 7);
+    }
+    
+    std::vector<MapDefinition> maps;
+    for (size_t i = 0; i < 64; ++i) {
+        maps.push_back(makeMap({.address = i * 16, .columns = 16}));
+    }
+    const size_t overlapBase = 64 * 16;
+    maps.push_back(makeMap({.address = overlapBase, .columns = 24}));
+    maps.push_back(makeMap({.address = overlapBase + 16, .columns = 24}));
+    maps.push_back(makeMap({.address = overlapBase + 32, .columns = 24}));
+    maps.push_back(makeMap({.address = fileSize - 4, .columns = 16}));
+    
+    std::vector<uint8_t> expected = image;
+    for (size_t m = 0; m + 1 < maps.size(); ++m) {
+        for (size_t i = 0; i < maps[m].columns(); ++i) {
+            ++expected[maps[m].address() + i];
+        }
+    }
+    
+    for (size_t workers : {1, 4, 16}) {
+        BinaryFile file;
+        QVERIFY(loadBytes(file, image));
+        
+        size_t notifications = 0;
+        file.addWriteObserver([&](size_t, size_t) { ++notifications; });
+        
+        std::atomic<size_t> calls{0};
+        std::atomic<size_t> outside{0};
+        EditHistory history;
+        BatchOperations batch(&file);
+        std::vector<size_t> skipped;
+        size_t processed = batch.applyToAllMaps(maps, [&](const MapDefinition& map, BinaryFile* target) {
+            ++calls;
+            if (map.address() + map.columns() > target->size()) {
+                ++outside;
+                return;
+            }
+            std::vector<uint8_t> bytes = target->readBytes(map.address(), map.columns());
+            for (uint8_t& b : bytes) {
+                ++b;
+            }
+            target->writeBytes(map.address(), bytes);
+        }, &history, workers, &skipped);
+        
+        // The map outside the image is reported, not run
+        QCOMPARE(processed, maps.size() - 1);
+        QCOMPARE(calls.load(), maps.size() - 1);
+        QCOMPARE(outside.load(), static_cast<size_t>(0));
+        QVERIFY(skipped == std::vector<size_t>({maps.size() - 1}));
+        QVERIFY(file.readBytes(0, fileSize) == expected);
+        QCOMPARE(notifications, maps.size() - 1); // One per write, after the workers finish
+        
+        // One undo step restores the original image
+        QCOMPARE(history.undoCount(), static_cast<size_t>(1));
+        for (const auto& edit : history.undo()) {
+            file.writeByte(edit.offset, edit.oldValue);
+        }
+        QVERIFY(file.readBytes(0, fileSize) == image);
+        QVERIFY(!history.canUndo());
+        
+        for (const auto& edit : history.redo()) {
+            file.writeByte(edit.offset, edit.newValue);
+        }
+        QVERIFY(file.readBytes(0, fileSize) == expected);
+    }
+}
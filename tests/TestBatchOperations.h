@@ -0,0 +1,11 @@
+#pragma once
+
+#include <QtTest/QtTest>
+#include "../src/editing/BatchOperations.h"
+
+class TestBatchOperations : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testApplyToAllMapsInParallel();
+};
@@ -1,5 +1,6 @@
 #include "TestChecksum.h"
 #include <QTest>
+#include <vector>
 
 void TestChecksum::testSimpleSum() {
     uint8_t data[] = {0x01, 0x02, 0x03, 0x04, 0x05};
@@ -36,3 +37,21 @@ void TestChecksum::testVerifyChecksum() {
     QVERIFY(valid);
 }
 
+
+void TestChecksum::testContentHashes() {
+    const uint8_t abc[] = {'a', 'b', 'c'};
+    QCOMPARE(WinMMM10::HashService::xxh3(abc, 0), static_cast<uint64_t>(0x2D06800538D394C2ULL));
+    QCOMPARE(WinMMM10::HashService::xxh3(abc, 3), static_cast<uint64_t>(0x78AF5F94892F3950ULL));
+    
+    // 1000 bytes takes the long-input path
+    std::vector<uint8_t> bytes(1000);
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<uint8_t>(i * 7);
+    }
+    QCOMPARE(WinMMM10::HashService::xxh3(bytes.data(), bytes.size()), static_cast<uint64_t>(0x10AD30264426C830ULL));
+    
+    WinMMM10::HashDigest digest = WinMMM10::HashService::hashBuffer(abc, 3, WinMMM10::HashAlgorithm::SHA256);
+    QCOMPARE(digest.toHex(), std::string("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+    QCOMPARE(WinMMM10::HashService::hashBuffer(abc, 3, WinMMM10::HashAlgorithm::XXH3).toHex(),
+             std::string("78af5f94892f3950"));
+}
@@ -2,6 +2,7 @@
 
 #include <QtTest/QtTest>
 #include "../src/binary/Checksum.h"
+#include "../src/binary/HashService.h"
 
 class TestChecksum : public QObject {
     Q_OBJECT
@@ -12,5 +13,6 @@ private slots:
     void testCRC32();
     void testXOR();
     void testVerifyChecksum();
+    void testContentHashes();
 };
 
@@ -0,0 +1,166 @@
+#include "TestEditJournal.h"
+#include "../src/core/ProjectSerializer.h"
+#include <QTest>
+#include <QTemporaryFile>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using WinMMM10::BinaryFile;
+using WinMMM10::EditJournal;
+
+namespace {
+
+qint64 fileSize(const std::string& path) {
+    return QFileInfo(QString::fromStdString(path)).size();
+}
+
+} // namespace
+
+void TestEditJournal::testRecoverFromJournal() {
+    std::vector<uint8_t> image(64 * 1024);
+    for (size_t i = 0; i < image.size(); ++i) {
+        image[i] = static_cast<uint8_t>(i * 31);
+    }
+    QTemporaryFile binaryFile;
+    QVERIFY(binaryFile.open());
+    binaryFile.write(reinterpret_cast<const char*>(image.data()), static_cast<qint64>(image.size()));
+    binaryFile.close();
+    std::string binaryPath = binaryFile.fileName().toStdString();
+    QTemporaryFile journalFile;
+    QVERIFY(journalFile.open());
+    std::string journalPath = journalFile.fileName().toStdString();
+    journalFile.close();
+    
+    BinaryFile binary;
+    QVERIFY(binary.load(binaryPath));
+    EditJournal journal;
+    std::string error;
+    QVERIFY(journal.start(binary, journalPath, error));
+    
+    // Neighbouring writes become one edit
+    for (size_t i = 0; i < 64; ++i) {
+        binary.writeByte(0x100 + i, 0xA5);
+    }
+    binary.writeUInt32(0x140, 0xDEADBEEF);
+    binary.writeUInt16(0x8000, 0x1234);
+    WinMMM10::Project project;
+    project.setName("Unsaved");
+    project.setFilepath("stage1.wmm10");
+    journal.recordProject(project);
+    journal.flush();
+    binary.writeByte(0x100, 0x5A);
+    journal.flush();
+    journal.waitForWrites();
+    QVERIFY(journal.lastError().empty());
+    
+    // As after a crash: the journal is left behind and the binary reloaded
+    EditJournal::Contents contents;
+    QVERIFY(EditJournal::read(journalPath, contents, error));
+    QCOMPARE(contents.edits.size(), static_cast<size_t>(3));
+    QCOMPARE(contents.edits[0].bytes.size(), static_cast<size_t>(68));
+    QCOMPARE(contents.binaryPath, binaryPath);
+    QCOMPARE(contents.projectPath, std::string("stage1.wmm10"));
+    BinaryFile recovered;
+    QVERIFY(recovered.load(binaryPath));
+    QVERIFY(EditJournal::replay(contents, recovered, error));
+    QVERIFY(std::equal(recovered.data(), recovered.data() + recovered.size(), binary.data(), binary.data() + binary.size()));
+    WinMMM10::Project recoveredProject;
+    QVERIFY(WinMMM10::ProjectSerializer::fromJson(contents.projectJson, recoveredProject, error));
+    QCOMPARE(recoveredProject.name(), std::string("Unsaved"));
+    
+    // A write the crash cut short loses only itself
+    QVERIFY(QFile::resize(QString::fromStdString(journalPath), QFileInfo(QString::fromStdString(journalPath)).size() - 1));
+    QVERIFY(EditJournal::read(journalPath, contents, error));
+    QVERIFY(contents.torn);
+    QCOMPARE(contents.edits.size(), static_cast<size_t>(2));
+    QVERIFY(!contents.projectJson.empty());
+    
+    // Never replayed onto a binary that changed since
+    BinaryFile changed;
+    QVERIFY(changed.load(binaryPath));
+    changed.writeByte(0, static_cast<uint8_t>(~image[0]));
+    QVERIFY(!EditJournal::replay(contents, changed, error));
+    
+    journal.stop(true);
+    QVERIFY(!QFile::exists(QString::fromStdString(journalPath)));
+}
+
+void TestEditJournal::testCompaction() {
+    // 4 MiB image; 3 MiB of it is rewritten once, then one 64 KiB block over
+    // and over
+    const size_t imageSize = 4 << 20;
+    const size_t bulkSize = 3 << 20;
+    const size_t blockOffset = 3584 * 1024;
+    const size_t blockSize = 64 * 1024;
+    std::vector<uint8_t> image(imageSize);
+    for (size_t i = 0; i < image.size(); ++i) {
+        image[i] = static_cast<uint8_t>(i * 31);
+    }
+    QTemporaryFile binaryFile;
+    QVERIFY(binaryFile.open());
+    binaryFile.write(reinterpret_cast<const char*>(image.data()), static_cast<qint64>(image.size()));
+    binaryFile.close();
+    std::string binaryPath = binaryFile.fileName().toStdString();
+    QTemporaryFile journalFile;
+    QVERIFY(journalFile.open());
+    std::string journalPath = journalFile.fileName().toStdString();
+    journalFile.close();
+    
+    BinaryFile binary;
+    QVERIFY(binary.load(binaryPath));
+    EditJournal journal;
+    std::string error;
+    QVERIFY(journal.start(binary, journalPath, error));
+    
+    QVERIFY(binary.writeBytes(0, std::vector<uint8_t>(bulkSize, 0x11)));
+    journal.flush();
+    journal.waitForWrites();
+    qint64 size = fileSize(journalPath);
+    QVERIFY(size > static_cast<qint64>(bulkSize));
+    QVERIFY(size < static_cast<qint64>(EditJournal::MinCompactBytes));
+    
+    // Record the journal size after each flush; a rewrite shows as a drop
+    std::vector<qint64> compactedSizes;
+    qint64 largest = size;
+    qint64 largestBeforeSecond = 0;
+    for (int round = 0; round < 200 && compactedSizes.size() < 2; ++round) {
+        QVERIFY(binary.writeBytes(blockOffset, std::vector<uint8_t>(blockSize, static_cast<uint8_t>(round))));
+        journal.flush();
+        journal.waitForWrites();
+        QVERIFY(journal.lastError().empty());
+        qint64 next = fileSize(journalPath);
+        if (next < size) {
+            compactedSizes.push_back(next);
+            largestBeforeSecond = largest;
+            
+            // One record per dirty range, split at MaxEditBytes
+            EditJournal::Contents contents;
+            QVERIFY(EditJournal::read(journalPath, contents, error));
+            QVERIFY(!contents.torn);
+            QCOMPARE(contents.edits.size(), bulkSize / EditJournal::MaxEditBytes + 1);
+            BinaryFile recovered;
+            QVERIFY(recovered.load(binaryPath));
+            QVERIFY(EditJournal::replay(contents, recovered, error));
+            QVERIFY(std::equal(recovered.data(), recovered.data() + recovered.size(), binary.data(),
+                               binary.data() + binary.size()));
+        }
+        largest = std::max(largest, next);
+        size = next;
+    }
+    QCOMPARE(compactedSizes.size(), static_cast<size_t>(2));
+    
+    // The first rewrite comes at MinCompactBytes; the second only once the
+    // journal reaches twice the size it was compacted to
+    QVERIFY(compactedSizes[0] > static_cast<qint64>(bulkSize));
+    QVERIFY(compactedSizes[0] < static_cast<qint64>(bulkSize + 2 * blockSize));
+    QCOMPARE(compactedSizes[1], compactedSizes[0]);
+    QVERIFY(largestBeforeSecond > static_cast<qint64>(EditJournal::MinCompactBytes));
+    QVERIFY(largestBeforeSecond <= 2 * compactedSizes[0]);
+    QVERIFY(largestBeforeSecond > 2 * compactedSizes[0] - static_cast<qint64>(2 * blockSize));
+    
+    journal.stop(true);
+    QVERIFY(!QFile::exists(QString::fromStdString(journalPath)));
+}
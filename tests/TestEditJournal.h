@@ -0,0 +1,12 @@
+#pragma once
+
+#include <QtTest/QtTest>
+#include "../src/core/EditJournal.h"
+
+class TestEditJournal : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testRecoverFromJournal();
+    void testCompaction();
+};
@@ -0,0 +1,183 @@
+#include "TestHashService.h"
+#include "TestHelpers.h"
+#include <QTest>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using WinMMM10::BinaryFile;
+using WinMMM10::HashAlgorithm;
+using WinMMM10::HashDigest;
+using WinMMM10::HashService;
+using TestHelpers::loadBytes;
+
+namespace {
+
+// Two and a half chunks of a pattern that differs from chunk to chunk
+std::vector<uint8_t> makeImage() {
+    std::vector<uint8_t> bytes(HashService::ChunkSize * 5 / 2);
+    uint32_t state = 12345;
+    for (uint8_t& byte : bytes) {
+        state = state * 1103515245u + 12345u;
+        byte = static_cast<uint8_t>(state >> 16);
+    }
+    return bytes;
+}
+
+HashDigest plainSha256(const std::vector<uint8_t>& bytes) {
+    HashDigest digest;
+    digest.algorithm = HashAlgorithm::SHA256;
+    digest.bytes = HashService::sha256(bytes.data(), bytes.size());
+    return digest;
+}
+
+// The documented tree: chunk digests, then the input length little-endian
+HashDigest treeSha256(const std::vector<uint8_t>& bytes) {
+    std::vector<uint8_t> joined;
+    for (size_t offset = 0; offset < bytes.size(); offset += HashService::ChunkSize) {
+        size_t length = std::min(HashService::ChunkSize, bytes.size() - offset);
+        auto chunk = HashService::sha256(bytes.data() + offset, length);
+        joined.insert(joined.end(), chunk.begin(), chunk.end());
+    }
+    for (size_t i = 0; i < 8; ++i) {
+        joined.push_back(static_cast<uint8_t>(static_cast<uint64_t>(bytes.size()) >> (8 * i)));
+    }
+    return plainSha256(joined);
+}
+
+} // namespace
+
+void TestHashService::testSha256() {
+    const char* abc = "abc";
+    HashDigest digest;
+    digest.algorithm = HashAlgorithm::SHA256;
+    digest.bytes = HashService::sha256(reinterpret_cast<const uint8_t*>(abc), 3);
+    QCOMPARE(digest.toHex(), std::string("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+    
+    // Streaming in uneven pieces gives the one-shot digest
+    std::vector<uint8_t> bytes = makeImage();
+    WinMMM10::Sha256 hasher;
+    for (size_t offset = 0, step = 1; offset < bytes.size(); offset += step, step = step * 3 + 7) {
+        hasher.update(bytes.data() + offset, std::min(step, bytes.size() - offset));
+    }
+    QVERIFY(hasher.finish() == HashService::sha256(bytes.data(), bytes.size()));
+}
+
+void TestHashService::testXxh3KnownAnswers() {
+    // Vectors from the reference XXH3_64bits_withSeed over its sanity-check
+    // buffer, one or two lengths from every size class
+    std::vector<uint8_t> bytes(4096);
+    uint64_t state = 2654435761u;
+    for (uint8_t& byte : bytes) {
+        byte = static_cast<uint8_t>(state >> 56);
+        state *= 11400714785074694797ull;
+    }
+    
+    struct Vector {
+        size_t length;
+        uint64_t unseeded;
+        uint64_t seeded; // Seed 0x9E3779B185EBCA8D
+    };
+    const Vector vectors[] = {
+        {0, 0x2D06800538D394C2ull, 0xA8A6B918B2F0364Aull},
+        {1, 0xC44BDFF4074EECDBull, 0x032BE332DD766EF8ull},
+        {3, 0x54247382A8D6B94Dull, 0x634B8990B4976373ull},
+        {4, 0xE5DC74BC51848A51ull, 0xAA2E7ECCB0C8F747ull},
+        {8, 0x24CCC9ACAA9F65E4ull, 0x8F973410999B8F6Bull},
+        {9, 0x14D5001C15DD3F2Bull, 0xB3AE7333D9013F60ull},
+        {16, 0x981B17D36C7498C9ull, 0x663F29333B4DB6B1ull},
+        {17, 0x796F5ACD3A60F862ull, 0xF3EC5067F4306DB3ull},
+        {128, 0xFCFF24126754D861ull, 0x73FDE75280646649ull},
+        {129, 0x98F1B0A679A2CA29ull, 0x21FFFDBCA099C844ull},
+        {240, 0x81C3C2B67F568CCFull, 0xCC0F58C27EF3D8EEull},
+        {241, 0xC5A639ECD2030E5Eull, 0xDDA9B0A161D4829Aull},
+        {1024, 0xDD85C9B5C1109C5Cull, 0xEF368A8A2EBABAEFull},
+        {2048, 0xDD59E2C3A5F038E0ull, 0x66F81670669ABABCull},
+        {2367, 0xCB37AEB9E5D361EDull, 0xD2DB3415B942B42Aull},
+        {4096, 0xE91206429D1F48F9ull, 0x2A3BBB20A5439DCDull},
+    };
+    for (const Vector& vector : vectors) {
+        QCOMPARE(HashService::xxh3(bytes.data(), vector.length), vector.unseeded);
+        QCOMPARE(HashService::xxh3(bytes.data(), vector.length, 0x9E3779B185EBCA8Dull), vector.seeded);
+    }
+}
+
+void TestHashService::testTreeDigest() {
+    std::vector<uint8_t> bytes = makeImage();
+    BinaryFile file;
+    QVERIFY(loadBytes(file, bytes));
+    HashService service(file, 4);
+    
+    // Over ChunkSize the SHA-256 digest is the tree, not the plain hash
+    HashDigest tree = service.hash(HashAlgorithm::SHA256);
+    QVERIFY(tree == treeSha256(bytes));
+    QVERIFY(!(tree == plainSha256(bytes)));
+    QVERIFY(tree == HashService::hashBuffer(bytes.data(), bytes.size(), HashAlgorithm::SHA256, 1));
+    QCOMPARE(service.cachedChunks(HashAlgorithm::SHA256), static_cast<size_t>(3));
+    QCOMPARE(service.cachedChunks(HashAlgorithm::XXH3), static_cast<size_t>(0));
+    
+    // The file hash is the plain one at any size
+    QVERIFY(service.fileSha256() == plainSha256(bytes));
+    
+    // Up to ChunkSize both are the plain hash
+    HashDigest head = service.hashRange(0, HashService::ChunkSize, HashAlgorithm::SHA256);
+    QVERIFY(head.bytes == HashService::sha256(bytes.data(), HashService::ChunkSize));
+    QVERIFY(service.hashRange(0, HashService::ChunkSize + 1, HashAlgorithm::SHA256) ==
+            treeSha256(std::vector<uint8_t>(bytes.begin(), bytes.begin() + HashService::ChunkSize + 1)));
+    
+    uint64_t xxh3 = 0;
+    HashDigest flat = service.hashRange(10, 1000, HashAlgorithm::XXH3);
+    for (size_t i = 0; i < 8; ++i) {
+        xxh3 = (xxh3 << 8) | flat.bytes[i];
+    }
+    QCOMPARE(xxh3, HashService::xxh3(bytes.data() + 10, 1000));
+    QCOMPARE(flat.toHex().size(), static_cast<size_t>(16));
+}
+
+void TestHashService::testInvalidationAfterWrite() {
+    std::vector<uint8_t> bytes = makeImage();
+    BinaryFile file;
+    QVERIFY(loadBytes(file, bytes));
+    HashService service(file, 4);
+    
+    HashDigest tree = service.hash(HashAlgorithm::SHA256);
+    HashDigest xxh3 = service.hash(HashAlgorithm::XXH3);
+    HashDigest whole = service.fileSha256();
+    HashDigest range = service.hashRange(HashService::ChunkSize + 100, 64, HashAlgorithm::SHA256);
+    HashDigest untouched = service.hashRange(0, 64, HashAlgorithm::SHA256);
+    QCOMPARE(service.cachedChunks(HashAlgorithm::SHA256), static_cast<size_t>(3));
+    
+    // A write inside the second chunk drops only that chunk
+    size_t offset = HashService::ChunkSize + 120;
+    QVERIFY(file.writeBytes(offset, {1, 2, 3, 4}));
+    std::memcpy(bytes.data() + offset, "\x01\x02\x03\x04", 4);
+    QCOMPARE(service.cachedChunks(HashAlgorithm::SHA256), static_cast<size_t>(2));
+    QCOMPARE(service.cachedChunks(HashAlgorithm::XXH3), static_cast<size_t>(2));
+    
+    HashDigest newTree = service.hash(HashAlgorithm::SHA256);
+    QVERIFY(!(newTree == tree));
+    QVERIFY(newTree == treeSha256(bytes));
+    QVERIFY(!(service.hash(HashAlgorithm::XXH3) == xxh3));
+    QVERIFY(service.hash(HashAlgorithm::XXH3) == HashService::hashBuffer(bytes.data(), bytes.size(),
+                                                                         HashAlgorithm::XXH3));
+    QVERIFY(!(service.fileSha256() == whole));
+    QVERIFY(service.fileSha256() == plainSha256(bytes));
+    QVERIFY(!(service.hashRange(HashService::ChunkSize + 100, 64, HashAlgorithm::SHA256) == range));
+    QVERIFY(service.hashRange(0, 64, HashAlgorithm::SHA256) == untouched);
+    QCOMPARE(service.cachedChunks(HashAlgorithm::SHA256), static_cast<size_t>(3));
+    
+    // A write across a chunk boundary drops both chunks
+    offset = 2 * HashService::ChunkSize - 2;
+    QVERIFY(file.writeBytes(offset, {9, 9, 9, 9}));
+    std::memset(bytes.data() + offset, 9, 4);
+    QCOMPARE(service.cachedChunks(HashAlgorithm::SHA256), static_cast<size_t>(1));
+    QVERIFY(service.hash(HashAlgorithm::SHA256) == treeSha256(bytes));
+    QVERIFY(service.fileSha256() == plainSha256(bytes));
+    
+    // Reloading drops everything
+    bytes[0] ^= 0xFF;
+    QVERIFY(loadBytes(file, bytes));
+    QCOMPARE(service.cachedChunks(HashAlgorithm::SHA256), static_cast<size_t>(0));
+    QVERIFY(service.hash(HashAlgorithm::SHA256) == treeSha256(bytes));
+    QVERIFY(service.fileSha256() == plainSha256(bytes));
+}
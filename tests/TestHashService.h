@@ -0,0 +1,14 @@
+#pragma once
+
+#include <QtTest/QtTest>
+#include "../src/binary/HashService.h"
+
+class TestHashService : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testSha256();
+    void testXxh3KnownAnswers();
+    void testTreeDigest();
+    void testInvalidationAfterWrite();
+};
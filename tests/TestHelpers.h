@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../src/binary/BinaryFile.h"
+#include "../src/maps/MapDataType.h"
+#include "../src/maps/MapDefinition.h"
+#include <QTemporaryFile>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Fixtures shared by the test classes
+namespace TestHelpers {
+
+// Loads bytes into file through a temporary file
+inline bool loadBytes(WinMMM10::BinaryFile& file, const std::vector<uint8_t>& bytes) {
+    QTemporaryFile tempFile;
+    if (!tempFile.open()) {
+        return false;
+    }
+    tempFile.write(reinterpret_cast<const char*>(bytes.data()), static_cast<qint64>(bytes.size()));
+    tempFile.flush();
+    return file.load(tempFile.fileName().toStdString());
+}
+
+// Fields of a test map; set the ones that matter, e.g. {.address = 16, .rows = 2, .columns = 3}
+struct MapShape {
+    std::string name;
+    size_t address{0};
+    size_t rows{1};
+    size_t columns{1};
+    WinMMM10::MapDataType dataType{WinMMM10::MapDataType::UInt8};
+    WinMMM10::MapType type{WinMMM10::MapType::Map3D};
+};
+
+// A map without axes or scaling
+inline WinMMM10::MapDefinition makeMap(const MapShape& shape) {
+    WinMMM10::MapDefinition map;
+    map.setName(shape.name);
+    map.setType(shape.type);
+    map.setAddress(shape.address);
+    map.setRows(shape.rows);
+    map.setColumns(shape.columns);
+    map.setDataType(static_cast<uint16_t>(shape.dataType));
+    return map;
+}
+
+} // namespace TestHelpers
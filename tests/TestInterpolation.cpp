@@ -0,0 +1,265 @@
+#include "TestInterpolation.h"
+#include "TestHelpers.h"
+#include "../src/core/SafeModeManager.h"
+#include "../src/maps/MapDataType.h"
+#include "../src/maps/MapView.h"
+#include <QTest>
+#include <cmath>
+#include <vector>
+
+using WinMMM10::BinaryFile;
+using WinMMM10::CubicSpline;
+using WinMMM10::InterpolationEngine;
+using WinMMM10::InterpolationType;
+using WinMMM10::MapDefinition;
+using WinMMM10::MapView;
+using WinMMM10::SafeModeManager;
+using TestHelpers::loadBytes;
+using TestHelpers::makeMap;
+
+namespace {
+
+// Natural spline second derivatives by Gaussian elimination of the full
+// (n x n) system, independent of the tridiagonal solver
+std::vector<double> denseSecondDerivatives(const std::vector<double>& x, const std::vector<double>& y) {
+    size_t n = x.size();
+    std::vector<std::vector<double>> a(n, std::vector<double>(n + 1, 0.0));
+    a[0][0] = 1.0;
+    a[n - 1][n - 1] = 1.0;
+    for (size_t i = 1; i + 1 < n; ++i) {
+        double h0 = x[i] - x[i - 1];
+        double h1 = x[i + 1] - x[i];
+        a[i][i - 1] = h0;
+        a[i][i] = 2.0 * (h0 + h1);
+        a[i][i + 1] = h1;
+        a[i][n] = 6.0 * ((y[i + 1] - y[i]) / h1 - (y[i] - y[i - 1]) / h0);
+    }
+    for (size_t col = 0; col < n; ++col) {
+        size_t pivot = col;
+        for (size_t r = col + 1; r < n; ++r) {
+            if (std::abs(a[r][col]) > std::abs(a[pivot][col])) {
+                pivot = r;
+            }
+        }
+        std::swap(a[col], a[pivot]);
+        for (size_t r = 0; r < n; ++r) {
+            if (r != col) {
+                double f = a[r][col] / a[col][col];
+                for (size_t k = col; k <= n; ++k) {
+                    a[r][k] -= f * a[col][k];
+                }
+            }
+        }
+    }
+    std::vector<double> m(n);
+    for (size_t i = 0; i < n; ++i) {
+        m[i] = a[i][n] / a[i][i];
+    }
+    return m;
+}
+
+double evaluateSecondDerivativeForm(const std::vector<double>& x, const std::vector<double>& y,
+                                    const std::vector<double>& m, double v) {
+    size_t i = 0;
+    while (i + 2 < x.size() && v > x[i + 1]) {
+        ++i;
+    }
+    double h = x[i + 1] - x[i];
+    double a = (x[i + 1] - v) / h;
+    double b = (v - x[i]) / h;
+    return a * y[i] + b * y[i + 1] + ((a * a * a - a) * m[i] + (b * b * b - b) * m[i + 1]) * h * h / 6.0;
+}
+
+// Writes f(row, column) into a uint16 map at address 0 of file
+template <typename F>
+void fillMap(BinaryFile& file, const MapDefinition& map, F f) {
+    MapView view(map, &file);
+    std::vector<double> values(map.rows() * map.columns());
+    for (size_t r = 0; r < map.rows(); ++r) {
+        for (size_t c = 0; c < map.columns(); ++c) {
+            values[r * map.columns() + c] = f(r, c);
+        }
+    }
+    view.write(values);
+}
+
+} // namespace
+
+void TestInterpolation::testNaturalSplineMatchesDenseSolve() {
+    const std::vector<double> x = {0.0, 0.5, 2.0, 2.5, 4.0, 7.0, 7.5, 10.0};
+    const std::vector<double> y = {3.0, -1.0, 4.0, 4.5, 0.0, 8.0, 2.0, 2.5};
+    
+    CubicSpline spline;
+    QVERIFY(spline.fit(x, y, CubicSpline::Kind::Natural));
+    std::vector<double> m = denseSecondDerivatives(x, y);
+    for (double v = 0.0; v <= 10.0; v += 0.05) {
+        double expected = evaluateSecondDerivativeForm(x, y, m, v);
+        QVERIFY(std::abs(spline.evaluate(v) - expected) < 1e-9);
+    }
+    
+    // Passes through the knots and clamps outside them
+    for (size_t i = 0; i < x.size(); ++i) {
+        QVERIFY(std::abs(spline.evaluate(x[i]) - y[i]) < 1e-12);
+    }
+    QCOMPARE(spline.evaluate(-5.0), 3.0);
+    QCOMPARE(spline.evaluate(50.0), 2.5);
+    
+    // Reproduces a straight line exactly
+    std::vector<double> line(x.size());
+    for (size_t i = 0; i < x.size(); ++i) {
+        line[i] = 2.0 * x[i] - 1.0;
+    }
+    QVERIFY(spline.fit(x, line));
+    QVERIFY(std::abs(spline.evaluate(3.3) - 5.6) < 1e-12);
+    
+    // Non-ascending or mismatched knots are refused
+    QVERIFY(!spline.fit(std::vector<double>{0.0, 1.0, 1.0}, std::vector<double>{1.0, 2.0, 3.0}));
+    QVERIFY(!spline.fit(x, std::span<const double>(y).first(3)));
+}
+
+void TestInterpolation::testMonotoneSplineDoesNotOvershoot() {
+    // Flat stretches and a steep step, where a natural spline rings
+    const std::vector<double> x = {0.0, 1.0, 2.0, 3.0, 3.5, 6.0, 8.0};
+    const std::vector<double> y = {0.0, 0.0, 1.0, 20.0, 20.0, 21.0, 21.0};
+    
+    CubicSpline monotone;
+    QVERIFY(monotone.fit(x, y, CubicSpline::Kind::Monotone));
+    CubicSpline natural;
+    QVERIFY(natural.fit(x, y, CubicSpline::Kind::Natural));
+    
+    double previous = monotone.evaluate(0.0);
+    bool naturalOvershoots = false;
+    for (double v = 0.0; v <= 8.0; v += 0.01) {
+        double value = monotone.evaluate(v);
+        QVERIFY(value >= previous - 1e-12);
+        previous = value;
+        
+        // Stays within the values of the segment's own knots
+        size_t i = 0;
+        while (i + 2 < x.size() && v > x[i + 1]) {
+            ++i;
+        }
+        QVERIFY(value >= std::min(y[i], y[i + 1]) - 1e-12);
+        QVERIFY(value <= std::max(y[i], y[i + 1]) + 1e-12);
+        
+        double n = natural.evaluate(v);
+        naturalOvershoots = naturalOvershoots || n < std::min(y[i], y[i + 1]) - 1e-6 ||
+                            n > std::max(y[i], y[i + 1]) + 1e-6;
+    }
+    QVERIFY(naturalOvershoots);
+    
+    for (size_t i = 0; i < x.size(); ++i) {
+        QVERIFY(std::abs(monotone.evaluate(x[i]) - y[i]) < 1e-12);
+    }
+}
+
+void TestInterpolation::testSplineRegionReproducesSurface() {
+    // 6x7 uint16 map at 0 with an uneven uint8 x axis at 84
+    BinaryFile file;
+    std::vector<uint8_t> bytes(84, 0);
+    const std::vector<uint8_t> xAxis = {0, 1, 3, 6, 10, 15, 21};
+    bytes.insert(bytes.end(), xAxis.begin(), xAxis.end());
+    QVERIFY(loadBytes(file, bytes));
+    
+    MapDefinition map = makeMap({.rows = 6, .columns = 7, .dataType = WinMMM10::MapDataType::UInt16});
+    map.xAxis().setAddress(84);
+    map.xAxis().setCount(7);
+    map.xAxis().setDataType(static_cast<uint16_t>(WinMMM10::MapDataType::UInt8));
+    
+    SafeModeManager& safeMode = SafeModeManager::instance();
+    bool wasEnabled = safeMode.isEnabled();
+    safeMode.setEnabled(false);
+    
+    // Bilinear in the axis value and the row index, which every method reproduces
+    auto surface = [&](size_t r, size_t c) { return 10.0 + 3.0 * xAxis[c] + 5.0 * r + 2.0 * r * xAxis[c]; };
+    InterpolationEngine engine(&file);
+    for (InterpolationType type : {InterpolationType::Cubic, InterpolationType::Spline}) {
+        fillMap(file, map, [&](size_t r, size_t c) {
+            bool interior = r >= 2 && r <= 3 && c >= 2 && c <= 4;
+            return interior ? 0.0 : surface(r, c);
+        });
+        QVERIFY(engine.interpolateRegion(map, 1, 1, 4, 5, type));
+        
+        std::vector<double> values;
+        QVERIFY(MapView(map, &file).read(values));
+        for (size_t r = 0; r < 6; ++r) {
+            for (size_t c = 0; c < 7; ++c) {
+                QCOMPARE(values[r * 7 + c], surface(r, c));
+            }
+        }
+    }
+    
+    safeMode.setEnabled(wasEnabled);
+}
+
+void TestInterpolation::testSplineRegionOnCurve() {
+    // One-row map: the region's interior follows the spline through every
+    // cell outside it, not the line between the region's ends
+    BinaryFile file;
+    QVERIFY(loadBytes(file, std::vector<uint8_t>(16, 0)));
+    MapDefinition map = makeMap({.columns = 8, .dataType = WinMMM10::MapDataType::UInt16});
+    
+    SafeModeManager& safeMode = SafeModeManager::instance();
+    bool wasEnabled = safeMode.isEnabled();
+    safeMode.setEnabled(false);
+    
+    const std::vector<double> curve = {0, 100, 400, 0, 0, 2500, 3600, 4900};
+    fillMap(file, map, [&](size_t, size_t c) { return curve[c]; });
+    
+    InterpolationEngine engine(&file);
+    QVERIFY(InterpolationEngine::hasInteriorKnots(map, 0, 2, 0, 5));
+    QVERIFY(engine.interpolateRegion(map, 0, 2, 0, 5, InterpolationType::Spline));
+    
+    const std::vector<double> knotX = {0, 1, 2, 5, 6, 7};
+    const std::vector<double> knotY = {0, 100, 400, 2500, 3600, 4900};
+    CubicSpline spline;
+    QVERIFY(spline.fit(knotX, knotY));
+    
+    std::vector<double> values;
+    QVERIFY(MapView(map, &file).read(values));
+    QCOMPARE(values[2], 400.0);
+    QCOMPARE(values[5], 2500.0);
+    for (size_t c = 3; c <= 4; ++c) {
+        QCOMPARE(values[c], std::round(spline.evaluate(static_cast<double>(c))));
+        double straight = 400.0 + (2500.0 - 400.0) * (static_cast<double>(c) - 2.0) / 3.0;
+        QVERIFY(std::abs(values[c] - straight) > 1.0);
+    }
+    
+    safeMode.setEnabled(wasEnabled);
+}
+
+void TestInterpolation::testWholeMapHasNoInteriorKnots() {
+    BinaryFile file;
+    QVERIFY(loadBytes(file, std::vector<uint8_t>(40, 0)));
+    MapDefinition map = makeMap({.rows = 4, .columns = 5, .dataType = WinMMM10::MapDataType::UInt16});
+    
+    SafeModeManager& safeMode = SafeModeManager::instance();
+    bool wasEnabled = safeMode.isEnabled();
+    safeMode.setEnabled(false);
+    
+    fillMap(file, map, [](size_t r, size_t c) { return static_cast<double>((r * 7 + c * 3) % 11); });
+    std::vector<double> before;
+    QVERIFY(MapView(map, &file).read(before));
+    
+    // The whole map leaves only its edges as knots
+    QVERIFY(!InterpolationEngine::hasInteriorKnots(map, 0, 0, 3, 4));
+    InterpolationEngine engine(&file);
+    QVERIFY(!engine.interpolateMap(map, InterpolationType::Spline));
+    QVERIFY(!engine.interpolateMap(map, InterpolationType::Cubic));
+    std::vector<double> after;
+    QVERIFY(MapView(map, &file).read(after));
+    QVERIFY(after == before);
+    
+    // Leaving one column outside is enough along the rows
+    QVERIFY(InterpolationEngine::hasInteriorKnots(map, 0, 0, 3, 3));
+    QVERIFY(InterpolationEngine::hasInteriorKnots(map, 1, 0, 3, 4));
+    QVERIFY(!InterpolationEngine::hasInteriorKnots(map, 0, 0, 4, 4)); // Out of range
+    
+    // Linear still rebuilds the whole map from its corners
+    QVERIFY(engine.interpolateMap(map));
+    QVERIFY(MapView(map, &file).read(after));
+    QCOMPARE(after[0], before[0]);
+    QCOMPARE(after[19], before[19]);
+    
+    safeMode.setEnabled(wasEnabled);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <QtTest/QtTest>
+#include "../src/editing/InterpolationEngine.h"
+#include "../src/maps/CubicSpline.h"
+
+class TestInterpolation : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testNaturalSplineMatchesDenseSolve();
+    void testMonotoneSplineDoesNotOvershoot();
+    void testSplineRegionReproducesSurface();
+    void testSplineRegionOnCurve();
+    void testWholeMapHasNoInteriorKnots();
+};
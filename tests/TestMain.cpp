@@ -1,22 +1,82 @@
 #include <QtTest/QtTest>
+#include "TestAnnotationManager.h"
+#include "TestBatchOperations.h"
 #include "TestChecksum.h"
+#include "TestEditJournal.h"
+#include "TestHashService.h"
+#include "TestInterpolation.h"
+#include "TestMapClipboard.h"
 #include "TestMapDetection.h"
+#include "TestMapExpression.h"
+#include "TestMapFilters.h"
+#include "TestMapLookup.h"
 #include "TestMapPack.h"
+#include "TestMapResampler.h"
+#include "TestMapView.h"
+#include "TestProjectComparator.h"
+#include "TestProjectSerializer.h"
+#include "TestScalingEngine.h"
+#include "TestValidator.h"
 
 int main(int argc, char* argv[]) {
     QCoreApplication app(argc, argv);
     
     int result = 0;
     
+    TestAnnotationManager testAnnotationManager;
+    result |= QTest::qExec(&testAnnotationManager, argc, argv);
+    
+    TestBatchOperations testBatchOperations;
+    result |= QTest::qExec(&testBatchOperations, argc, argv);
+    
     TestChecksum testChecksum;
     result |= QTest::qExec(&testChecksum, argc, argv);
     
+    TestEditJournal testEditJournal;
+    result |= QTest::qExec(&testEditJournal, argc, argv);
+    
+    TestHashService testHashService;
+    result |= QTest::qExec(&testHashService, argc, argv);
+    
+    TestInterpolation testInterpolation;
+    result |= QTest::qExec(&testInterpolation, argc, argv);
+    
+    TestMapClipboard testMapClipboard;
+    result |= QTest::qExec(&testMapClipboard, argc, argv);
+    
     TestMapDetection testMapDetection;
     result |= QTest::qExec(&testMapDetection, argc, argv);
     
+    TestMapExpression testMapExpression;
+    result |= QTest::qExec(&testMapExpression, argc, argv);
+    
+    TestMapFilters testMapFilters;
+    result |= QTest::qExec(&testMapFilters, argc, argv);
+    
+    TestMapLookup testMapLookup;
+    result |= QTest::qExec(&testMapLookup, argc, argv);
+    
     TestMapPack testMapPack;
     result |= QTest::qExec(&testMapPack, argc, argv);
     
+    TestMapResampler testMapResampler;
+    result |= QTest::qExec(&testMapResampler, argc, argv);
+    
+    TestMapView testMapView;
+    result |= QTest::qExec(&testMapView, argc, argv);
+    
+    TestProjectComparator testProjectComparator;
+    result |= QTest::qExec(&testProjectComparator, argc, argv);
+    
+    TestProjectSerializer testProjectSerializer;
+    result |= QTest::qExec(&testProjectSerializer, argc, argv);
+    
+    TestScalingEngine testScalingEngine;
+    result |= QTest::qExec(&testScalingEngine, argc, argv);
+    
+    TestValidator testValidator;
+    result |= QTest::qExec(&testValidator, argc, argv);
+    
     return result;
 }
 
@@ -0,0 +1,133 @@
+#include "TestMapClipboard.h"
+#include "TestHelpers.h"
+#include "../src/maps/MapDataType.h"
+#include <QTest>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using WinMMM10::BinaryFile;
+using WinMMM10::MapClipboard;
+using WinMMM10::MapDefinition;
+using TestHelpers::loadBytes;
+using TestHelpers::makeMap;
+
+namespace {
+
+// 2x3 uint8 map at 0 scaled by 0.5, x axis (3) at 6 and y axis (2) at 9
+MapDefinition clipboardMap(bool xAxis, bool yAxis) {
+    MapDefinition map = makeMap({.rows = 2, .columns = 3});
+    map.setFactor(0.5);
+    if (xAxis) {
+        map.xAxis().setAddress(6);
+        map.xAxis().setCount(3);
+        map.xAxis().setDataType(static_cast<uint16_t>(WinMMM10::MapDataType::UInt8));
+    }
+    if (yAxis) {
+        map.yAxis().setAddress(9);
+        map.yAxis().setCount(2);
+        map.yAxis().setDataType(static_cast<uint16_t>(WinMMM10::MapDataType::UInt8));
+        map.yAxis().setFactor(10.0);
+    }
+    return map;
+}
+
+const std::vector<uint8_t> Image = {1, 2, 3, 4, 5, 7,
+                                    10, 20, 40,
+                                    1, 3};
+
+// Copies the map, writes it as text and reads it back
+bool roundTrip(const MapDefinition& map, MapClipboard& copied, MapClipboard& pasted, std::string& text) {
+    BinaryFile file;
+    if (!loadBytes(file, Image) || !copied.copy(map, &file)) {
+        return false;
+    }
+    text = copied.toTsv();
+    std::string error;
+    return pasted.fromTsv(text, error);
+}
+
+} // namespace
+
+void TestMapClipboard::testLabelledRoundTrip() {
+    for (int axes = 1; axes < 4; ++axes) {
+        MapClipboard copied, pasted;
+        std::string text;
+        QVERIFY(roundTrip(clipboardMap(axes & 1, axes & 2), copied, pasted, text));
+        QVERIFY(text.rfind("y\\x\t", 0) == 0);
+        QCOMPARE(pasted.rows(), static_cast<size_t>(2));
+        QCOMPARE(pasted.columns(), static_cast<size_t>(3));
+        QVERIFY(pasted.physicalValues() == copied.physicalValues());
+        QVERIFY(pasted.xAxis() == copied.xAxis());
+        QVERIFY(pasted.yAxis() == copied.yAxis());
+        QCOMPARE(pasted.xAxis().size(), static_cast<size_t>((axes & 1) ? 3 : 0));
+        QCOMPARE(pasted.yAxis().size(), static_cast<size_t>((axes & 2) ? 2 : 0));
+    }
+    
+    MapClipboard block;
+    std::string error;
+    QVERIFY(block.fromTsv("y\\x\t10\t20\r\n1\t0,5\t1\r\n", error));
+    QVERIFY(block.xAxis() == std::vector<double>({10, 20}));
+    QVERIFY(block.yAxis() == std::vector<double>({1}));
+    QVERIFY(block.physicalValues() == std::vector<double>({0.5, 1}));
+}
+
+void TestMapClipboard::testUnlabelledRoundTrip() {
+    MapClipboard copied, pasted;
+    std::string text;
+    QVERIFY(roundTrip(clipboardMap(false, false), copied, pasted, text));
+    QCOMPARE(text, std::string("0.5\t1\t1.5\n2\t2.5\t3.5\n"));
+    QCOMPARE(pasted.rows(), static_cast<size_t>(2));
+    QVERIFY(pasted.physicalValues() == copied.physicalValues());
+    QVERIFY(pasted.xAxis().empty());
+    QVERIFY(pasted.yAxis().empty());
+    
+    // A single line is never a header
+    MapClipboard line;
+    std::string error;
+    QVERIFY(line.fromTsv("4\t5\t6", error));
+    QCOMPARE(line.rows(), static_cast<size_t>(1));
+    QCOMPARE(line.columns(), static_cast<size_t>(3));
+}
+
+void TestMapClipboard::testEmptyCornerCell() {
+    // Leading empty cells are values to keep, not an axis header
+    MapClipboard block;
+    std::string error;
+    QVERIFY(block.fromTsv("\t5\t6\n7\t8\t9\n", error));
+    QCOMPARE(block.rows(), static_cast<size_t>(2));
+    QCOMPARE(block.columns(), static_cast<size_t>(3));
+    QVERIFY(std::isnan(block.physicalValues()[0]));
+    QCOMPARE(block.physicalValues()[1], 5.0);
+    QCOMPARE(block.physicalValues()[3], 7.0);
+    QVERIFY(block.xAxis().empty());
+    QVERIFY(block.yAxis().empty());
+    
+    QVERIFY(block.fromTsv("\t1\t2\n\t3\t4\n", error));
+    QCOMPARE(block.rows(), static_cast<size_t>(2));
+    QCOMPARE(block.columns(), static_cast<size_t>(3));
+    QVERIFY(block.xAxis().empty());
+    
+    // Pasting leaves the empty cell's target unchanged
+    BinaryFile file;
+    QVERIFY(loadBytes(file, Image));
+    QVERIFY(block.fromTsv("\t5\t6\n7\t8\t9\n", error));
+    QVERIFY(block.paste(clipboardMap(false, false), &file));
+    QVERIFY(file.readBytes(0, 6) == std::vector<uint8_t>({1, 10, 12, 14, 16, 18}));
+}
+
+void TestMapClipboard::testHeaderWithoutCorner() {
+    // One cell fewer than every row below: x breakpoints without a corner cell
+    MapClipboard block;
+    std::string error;
+    QVERIFY(block.fromTsv("1000\t2000\n10\t1\t2\n20\t3\t4\n", error));
+    QCOMPARE(block.rows(), static_cast<size_t>(2));
+    QCOMPARE(block.columns(), static_cast<size_t>(2));
+    QVERIFY(block.xAxis() == std::vector<double>({1000, 2000}));
+    QVERIFY(block.yAxis() == std::vector<double>({10, 20}));
+    QVERIFY(block.physicalValues() == std::vector<double>({1, 2, 3, 4}));
+    
+    // Ragged rows are still an error
+    QVERIFY(!block.fromTsv("1\t2\n3\t4\t5\n6\n", error));
+    QVERIFY(block.isEmpty());
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <QtTest/QtTest>
+#include "../src/editing/MapClipboard.h"
+
+class TestMapClipboard : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testLabelledRoundTrip();
+    void testUnlabelledRoundTrip();
+    void testEmptyCornerCell();
+    void testHeaderWithoutCorner();
+};
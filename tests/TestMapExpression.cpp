@@ -0,0 +1,183 @@
+#include "TestMapExpression.h"
+#include "TestHelpers.h"
+#include "../src/core/SafeModeManager.h"
+#include <QTest>
+#include <clocale>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using WinMMM10::BinaryFile;
+using WinMMM10::MapDefinition;
+using WinMMM10::MapExpression;
+using WinMMM10::SafeModeManager;
+using TestHelpers::loadBytes;
+using TestHelpers::makeMap;
+
+namespace {
+
+// Value of a formula without references, or NaN if it does not compile
+double evaluateConstant(const std::string& formula) {
+    MapExpression expression;
+    if (!expression.compile(formula)) {
+        return std::nan("");
+    }
+    MapExpression::Inputs inputs;
+    inputs.rows = 1;
+    inputs.columns = 1;
+    double out = 0.0;
+    if (!expression.evaluate(inputs, std::span<double>(&out, 1))) {
+        return std::nan("");
+    }
+    return out;
+}
+
+std::string compileError(const std::string& formula) {
+    MapExpression expression;
+    return expression.compile(formula) ? std::string() : expression.errorString();
+}
+
+} // namespace
+
+void TestMapExpression::testNumbers() {
+    QCOMPARE(evaluateConstant("1.08"), 1.08);
+    QCOMPARE(evaluateConstant(".5"), 0.5);
+    QCOMPARE(evaluateConstant("2."), 2.0);
+    QCOMPARE(evaluateConstant("1e3"), 1000.0);
+    QCOMPARE(evaluateConstant("2.5E-1"), 0.25);
+    
+    // Only decimal numbers; hex, inf and nan forms are not part of the grammar
+    QVERIFY(!compileError("0x10").empty());
+    QVERIFY(!compileError("1e").empty());
+    QVERIFY(!compileError(".").empty());
+    
+    // Parsing does not depend on the C locale's decimal separator
+    const char* locales[] = {"de_DE.UTF-8", "de_DE", "German"};
+    for (const char* locale : locales) {
+        if (std::setlocale(LC_NUMERIC, locale)) {
+            QCOMPARE(evaluateConstant("2*1.5"), 3.0);
+            break;
+        }
+    }
+    std::setlocale(LC_NUMERIC, "C");
+}
+
+void TestMapExpression::testPrecedence() {
+    QCOMPARE(evaluateConstant("2 + 3 * 4"), 14.0);
+    QCOMPARE(evaluateConstant("(2 + 3) * 4"), 20.0);
+    QCOMPARE(evaluateConstant("10 - 4 - 3"), 3.0);
+    QCOMPARE(evaluateConstant("16 / 4 / 2"), 2.0);
+    QCOMPARE(evaluateConstant("2 ^ 3 ^ 2"), 512.0); // Right-associative
+    QCOMPARE(evaluateConstant("-2 ^ 2"), -4.0);     // ^ binds tighter than unary minus
+    QCOMPARE(evaluateConstant("2 ^ -1"), 0.5);
+    QCOMPARE(evaluateConstant("1 + 1 == 2"), 1.0);
+    QCOMPARE(evaluateConstant("3 < 2 + 2"), 1.0);
+    QCOMPARE(evaluateConstant("--3"), 3.0);
+}
+
+void TestMapExpression::testFunctionsAndAxes() {
+    QCOMPARE(evaluateConstant("clamp(25, 0, 20)"), 20.0);
+    QCOMPARE(evaluateConstant("if(2 > 1, 7, 9)"), 7.0);
+    QCOMPARE(evaluateConstant("min(3, max(1, 2))"), 2.0);
+    QCOMPARE(evaluateConstant("round(2.5) + floor(-0.5) + abs(-3)"), 5.0);
+    
+    // 20x20 cells span two evaluation blocks
+    MapExpression expression;
+    QVERIFY(expression.compile("out = a * 2 + x + y * 100 + row + col"));
+    QCOMPARE(expression.target(), std::string("out"));
+    QCOMPARE(expression.references().size(), static_cast<size_t>(1));
+    
+    const size_t rows = 20;
+    const size_t columns = 20;
+    std::vector<double> a(rows * columns);
+    std::vector<double> xAxis(columns);
+    std::vector<double> yAxis(rows);
+    for (size_t i = 0; i < a.size(); ++i) {
+        a[i] = static_cast<double>(i);
+    }
+    for (size_t i = 0; i < columns; ++i) {
+        xAxis[i] = 1000.0 * i;
+    }
+    for (size_t i = 0; i < rows; ++i) {
+        yAxis[i] = 0.5 * i;
+    }
+    
+    MapExpression::Inputs inputs;
+    inputs.maps.push_back(a);
+    inputs.xAxis = xAxis;
+    inputs.yAxis = yAxis;
+    inputs.rows = rows;
+    inputs.columns = columns;
+    std::vector<double> out(rows * columns);
+    QVERIFY(expression.evaluate(inputs, out));
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t c = 0; c < columns; ++c) {
+            double expected = a[r * columns + c] * 2 + xAxis[c] + yAxis[r] * 100 + r + c;
+            QCOMPARE(out[r * columns + c], expected);
+        }
+    }
+    
+    // Without axes x and y are the indices
+    inputs.xAxis = {};
+    inputs.yAxis = {};
+    QVERIFY(expression.evaluate(inputs, out));
+    QCOMPARE(out[3 * columns + 5], a[3 * columns + 5] * 2 + 5 + 300 + 3 + 5);
+    
+    // Too few inputs is refused rather than read out of bounds
+    inputs.maps.clear();
+    QVERIFY(!expression.evaluate(inputs, out));
+}
+
+void TestMapExpression::testErrorPositions() {
+    QCOMPARE(compileError("1 + * 2"), std::string("Unexpected '*' at position 5"));
+    QCOMPARE(compileError("(1 + 2"), std::string("Expected ')' at position 7"));
+    QCOMPARE(compileError("abs(1, 2)"), std::string("'abs' takes 1 argument(s) at position 9"));
+    QCOMPARE(compileError("foo(1)"), std::string("Unknown function 'foo' at position 4"));
+    QCOMPARE(compileError("a +"), std::string("Unexpected end of formula at position 4"));
+    QCOMPARE(compileError("a $ b"), std::string("Unexpected '$' at position 3"));
+    QCOMPARE(compileError("\"Map"), std::string("Unexpected '\"' at position 1"));
+    
+    MapExpression expression;
+    QVERIFY(!expression.compile("1 +"));
+    QVERIFY(!expression.isCompiled());
+}
+
+void TestMapExpression::testApplyToProject() {
+    // Two 2x2 uint8 maps side by side
+    BinaryFile file;
+    QVERIFY(loadBytes(file, {10, 20, 30, 40, 0, 0, 0, 0}));
+    WinMMM10::Project project;
+    project.addMap(makeMap({.name = "Boost base", .rows = 2, .columns = 2}));
+    project.addMap(makeMap({.name = "out", .address = 4, .rows = 2, .columns = 2}));
+    
+    SafeModeManager& safeMode = SafeModeManager::instance();
+    bool wasEnabled = safeMode.isEnabled();
+    safeMode.setEnabled(false);
+    
+    MapExpression expression;
+    QVERIFY(expression.compile("out = \"Boost base\" * 1.5 + col"));
+    QVERIFY(expression.apply(project, &file));
+    QCOMPARE(file.readByte(4), static_cast<uint8_t>(15));
+    QCOMPARE(file.readByte(5), static_cast<uint8_t>(31));
+    QCOMPARE(file.readByte(6), static_cast<uint8_t>(45));
+    QCOMPARE(file.readByte(7), static_cast<uint8_t>(61));
+    
+    // With a validator a result with flagged cells is not written
+    WinMMM10::Validator validator;
+    QVERIFY(expression.compile("out = out * 2"));
+    QVERIFY(!expression.apply(project, &file, std::string(), &validator));
+    QCOMPARE(expression.validation().count(WinMMM10::ValidationFlags::ChangeTooLarge), static_cast<size_t>(4));
+    QCOMPARE(expression.errorString(),
+             std::string("4 cell(s) of 'out' fail validation, e.g. (1, 1): Change exceeds 50.000000% (100.000000%)"));
+    QCOMPARE(file.readByte(4), static_cast<uint8_t>(15));
+    QVERIFY(expression.compile("out = out + 1"));
+    QVERIFY(expression.apply(project, &file, std::string(), &validator));
+    QVERIFY(!expression.validation().any());
+    QCOMPARE(file.readByte(7), static_cast<uint8_t>(62));
+    
+    QVERIFY(expression.compile("out = missing + 1"));
+    QVERIFY(!expression.apply(project, &file));
+    QCOMPARE(expression.errorString(), std::string("Unknown map 'missing'"));
+    
+    safeMode.setEnabled(wasEnabled);
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <QtTest/QtTest>
+#include "../src/editing/MapExpression.h"
+
+class TestMapExpression : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testNumbers();
+    void testPrecedence();
+    void testFunctionsAndAxes();
+    void testErrorPositions();
+    void testApplyToProject();
+};
@@ -0,0 +1,128 @@
+#include "TestMapFilters.h"
+#include <QTest>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using WinMMM10::MapFilters;
+
+namespace {
+
+const MapFilters::Type Types[] = {
+    MapFilters::Type::Box, MapFilters::Type::Gaussian,
+    MapFilters::Type::Bilateral, MapFilters::Type::Median
+};
+
+// Straightforward 2D filter over the window around (r, c) clipped to the map,
+// the behaviour the separable and running-sum versions must reproduce
+double referenceCell(MapFilters::Type type, const std::vector<double>& values, size_t rows, size_t columns,
+                     int kernelSize, size_t r, size_t c) {
+    int half = kernelSize / 2;
+    double sigma = MapFilters::defaultSigma(kernelSize);
+    auto [minIt, maxIt] = std::minmax_element(values.begin(), values.end());
+    double rangeSigma = (*maxIt - *minIt) * 0.1;
+    double center = values[r * columns + c];
+    
+    double sum = 0.0;
+    double norm = 0.0;
+    std::vector<double> window;
+    for (int dr = -half; dr <= half; ++dr) {
+        for (int dc = -half; dc <= half; ++dc) {
+            int k = static_cast<int>(r) + dr;
+            int j = static_cast<int>(c) + dc;
+            if (k < 0 || j < 0 || k >= static_cast<int>(rows) || j >= static_cast<int>(columns)) {
+                continue;
+            }
+            double v = values[static_cast<size_t>(k) * columns + static_cast<size_t>(j)];
+            double w = 1.0;
+            if (type != MapFilters::Type::Box) {
+                w = std::exp(-(dr * dr + dc * dc) / (2.0 * sigma * sigma));
+            }
+            if (type == MapFilters::Type::Bilateral) {
+                w *= std::exp(-(v - center) * (v - center) / (2.0 * rangeSigma * rangeSigma));
+            }
+            sum += w * v;
+            norm += w;
+            window.push_back(v);
+        }
+    }
+    
+    if (type != MapFilters::Type::Median) {
+        return sum / norm;
+    }
+    std::sort(window.begin(), window.end());
+    size_t mid = window.size() / 2;
+    return window.size() % 2 == 1 ? window[mid] : 0.5 * (window[mid - 1] + window[mid]);
+}
+
+} // namespace
+
+void TestMapFilters::testConstantMapUnchanged() {
+    const std::pair<size_t, size_t> shapes[] = {{1, 1}, {1, 6}, {6, 1}, {4, 5}, {9, 3}};
+    for (MapFilters::Type type : Types) {
+        for (int kernelSize : {3, 5, 7}) {
+            for (auto [rows, columns] : shapes) {
+                std::vector<double> values(rows * columns, 42.5);
+                std::vector<double> out(values.size(), 0.0);
+                QVERIFY(MapFilters::apply(type, values, rows, columns, kernelSize, out));
+                for (double v : out) {
+                    QVERIFY(std::abs(v - 42.5) < 1e-12);
+                }
+            }
+        }
+    }
+}
+
+void TestMapFilters::testBorderWindows() {
+    // Windows wider than half the map, so nearly every cell is clipped
+    const size_t rows = 4;
+    const size_t columns = 6;
+    std::mt19937 random(37);
+    std::vector<double> values(rows * columns);
+    for (double& v : values) {
+        v = std::uniform_int_distribution<int>(0, 200)(random) * 0.5;
+    }
+    
+    for (MapFilters::Type type : Types) {
+        for (int kernelSize : {3, 5, 9}) {
+            std::vector<double> out(values.size());
+            QVERIFY(MapFilters::apply(type, values, rows, columns, kernelSize, out));
+            for (size_t r = 0; r < rows; ++r) {
+                for (size_t c = 0; c < columns; ++c) {
+                    double expected = referenceCell(type, values, rows, columns, kernelSize, r, c);
+                    QVERIFY(std::abs(out[r * columns + c] - expected) < 1e-9);
+                }
+            }
+        }
+    }
+    
+    // Corner of a 3x3 box sees only its 2x2 neighbourhood
+    const std::vector<double> small = {1, 2, 3,
+                                       4, 5, 6};
+    std::vector<double> out(small.size());
+    QVERIFY(MapFilters::box(small, 2, 3, 3, out));
+    QCOMPARE(out[0], 3.0);
+    QCOMPARE(out[1], 3.5);
+    QCOMPARE(out[5], 4.0);
+    
+    // Median removes a single spike, also on the edge
+    std::vector<double> spiky(25, 10.0);
+    spiky[2] = 500.0;
+    spiky[12] = -500.0;
+    std::vector<double> smoothed(spiky.size());
+    QVERIFY(MapFilters::median(spiky, 5, 5, 3, smoothed));
+    QVERIFY(std::all_of(smoothed.begin(), smoothed.end(), [](double v) { return v == 10.0; }));
+}
+
+void TestMapFilters::testRejectsInvalidArguments() {
+    std::vector<double> values(12, 1.0);
+    std::vector<double> out(12);
+    for (MapFilters::Type type : Types) {
+        QVERIFY(!MapFilters::apply(type, values, 3, 4, 4, out));  // Even kernel
+        QVERIFY(!MapFilters::apply(type, values, 3, 4, 1, out));  // Too small
+        QVERIFY(!MapFilters::apply(type, values, 4, 4, 3, out));  // Too few values
+        QVERIFY(!MapFilters::apply(type, values, 0, 4, 3, out));
+        QVERIFY(!MapFilters::apply(type, values, 3, 4, 3, std::span<double>(out.data(), 11)));
+    }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <QtTest/QtTest>
+#include "../src/editing/MapFilters.h"
+
+class TestMapFilters : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testConstantMapUnchanged();
+    void testBorderWindows();
+    void testRejectsInvalidArguments();
+};
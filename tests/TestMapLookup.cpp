@@ -0,0 +1,194 @@
+#include "TestMapLookup.h"
+#include "TestHelpers.h"
+#include "../src/core/SafeModeManager.h"
+#include "../src/maps/MapDataType.h"
+#include <QTest>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using WinMMM10::Map2D;
+using WinMMM10::Map3D;
+using WinMMM10::MapDefinition;
+using WinMMM10::SafeModeManager;
+using TestHelpers::makeMap;
+
+namespace {
+
+// Float32 map with in-memory axes of matching length
+MapDefinition lookupMap(WinMMM10::MapType type, size_t rows, size_t columns) {
+    MapDefinition map = makeMap({.rows = rows, .columns = columns, .dataType = WinMMM10::MapDataType::Float32,
+                                 .type = type});
+    map.xAxis().setCount(columns);
+    if (type == WinMMM10::MapType::Map3D) {
+        map.yAxis().setCount(rows);
+    }
+    return map;
+}
+
+// Segment and weight of v on an ascending axis read through the scalar
+// getters, by linear search and clamped at the ends
+template <typename AxisValue>
+void locate(AxisValue axisValue, size_t count, double v, size_t& segment, double& weight) {
+    segment = 0;
+    weight = 0.0;
+    if (count < 2 || v <= axisValue(0)) {
+        return;
+    }
+    if (v >= axisValue(count - 1)) {
+        segment = count - 2;
+        weight = 1.0;
+        return;
+    }
+    while (axisValue(segment + 1) <= v) {
+        ++segment;
+    }
+    weight = (v - axisValue(segment)) / (axisValue(segment + 1) - axisValue(segment));
+}
+
+double scalarLookup(const Map2D& map, double x) {
+    size_t count = map.pointCount();
+    size_t i;
+    double t;
+    locate([&](size_t k) { return map.getXAxisValue(k); }, count, x, i, t);
+    double v0 = map.getPhysicalValue(i);
+    double v1 = map.getPhysicalValue(count > 1 ? i + 1 : i);
+    return v0 + (v1 - v0) * t;
+}
+
+double scalarLookup(const Map3D& map, double x, double y) {
+    size_t c, r;
+    double tx, ty;
+    locate([&](size_t k) { return map.getXAxisValue(k); }, map.columns(), x, c, tx);
+    locate([&](size_t k) { return map.getYAxisValue(k); }, map.rows(), y, r, ty);
+    size_t c1 = map.columns() > 1 ? c + 1 : c;
+    size_t r1 = map.rows() > 1 ? r + 1 : r;
+    double top = map.getPhysicalValue(r, c) + (map.getPhysicalValue(r, c1) - map.getPhysicalValue(r, c)) * tx;
+    double bottom = map.getPhysicalValue(r1, c) + (map.getPhysicalValue(r1, c1) - map.getPhysicalValue(r1, c)) * tx;
+    return top + (bottom - top) * ty;
+}
+
+// Every breakpoint, points beyond both ends and random points in between;
+// more than one lookup block in total
+std::vector<double> probePoints(const std::vector<double>& axis, std::mt19937& random, size_t count) {
+    std::vector<double> points(axis.begin(), axis.end());
+    points.push_back(axis.front() - 1000.0);
+    points.push_back(axis.back() + 1000.0);
+    std::uniform_real_distribution<double> distribution(axis.front() - 50.0, axis.back() + 50.0);
+    while (points.size() < count) {
+        points.push_back(distribution(random));
+    }
+    std::shuffle(points.begin(), points.end(), random);
+    return points;
+}
+
+} // namespace
+
+void TestMapLookup::testMap2DBatchMatchesScalar() {
+    SafeModeManager& safeMode = SafeModeManager::instance();
+    bool wasEnabled = safeMode.isEnabled();
+    safeMode.setEnabled(false);
+    
+    std::mt19937 random(36);
+    Map2D map(lookupMap(WinMMM10::MapType::Map2D, 1, 7));
+    const std::vector<double> axis = {-20.0, 0.0, 0.0, 15.0, 40.0, 41.0, 100.0};
+    for (size_t i = 0; i < axis.size(); ++i) {
+        map.setXAxisValue(i, axis[i]);
+        map.setPhysicalValue(i, std::uniform_int_distribution<int>(-500, 500)(random) * 0.25);
+    }
+    
+    std::vector<double> x = probePoints(axis, random, 700);
+    std::vector<double> out(x.size());
+    map.lookup(x, out);
+    for (size_t i = 0; i < x.size(); ++i) {
+        double expected = scalarLookup(map, x[i]);
+        QVERIFY(std::abs(out[i] - expected) < 1e-9);
+        QCOMPARE(map.lookup(x[i]), out[i]);
+    }
+    
+    safeMode.setEnabled(wasEnabled);
+}
+
+void TestMapLookup::testMap3DBatchMatchesScalar() {
+    SafeModeManager& safeMode = SafeModeManager::instance();
+    bool wasEnabled = safeMode.isEnabled();
+    safeMode.setEnabled(false);
+    
+    std::mt19937 random(360);
+    Map3D map(lookupMap(WinMMM10::MapType::Map3D, 5, 6));
+    const std::vector<double> xAxis = {500.0, 1000.0, 1500.0, 2500.0, 4000.0, 6500.0};
+    const std::vector<double> yAxis = {0.0, 12.5, 25.0, 50.0, 100.0};
+    for (size_t c = 0; c < xAxis.size(); ++c) {
+        map.setXAxisValue(c, xAxis[c]);
+    }
+    for (size_t r = 0; r < yAxis.size(); ++r) {
+        map.setYAxisValue(r, yAxis[r]);
+        for (size_t c = 0; c < xAxis.size(); ++c) {
+            map.setPhysicalValue(r, c, std::uniform_int_distribution<int>(0, 4000)(random) * 0.5);
+        }
+    }
+    
+    std::vector<double> x = probePoints(xAxis, random, 600);
+    std::vector<double> y = probePoints(yAxis, random, 600);
+    // Every pair of breakpoints exactly
+    for (double xb : xAxis) {
+        for (double yb : yAxis) {
+            x.push_back(xb);
+            y.push_back(yb);
+        }
+    }
+    
+    std::vector<double> out(x.size());
+    map.lookup(x, y, out);
+    for (size_t i = 0; i < x.size(); ++i) {
+        double expected = scalarLookup(map, x[i], y[i]);
+        QVERIFY(std::abs(out[i] - expected) < 1e-9);
+        QCOMPARE(map.lookup(x[i], y[i]), out[i]);
+    }
+    
+    // Exactly on a breakpoint the stored value comes back
+    QCOMPARE(map.lookup(1500.0, 25.0), map.getPhysicalValue(2, 2));
+    QCOMPARE(map.lookup(0.0, -5.0), map.getPhysicalValue(0, 0));
+    QCOMPARE(map.lookup(1e6, 1e6), map.getPhysicalValue(4, 5));
+    
+    safeMode.setEnabled(wasEnabled);
+}
+
+void TestMapLookup::testWithoutAxes() {
+    SafeModeManager& safeMode = SafeModeManager::instance();
+    bool wasEnabled = safeMode.isEnabled();
+    safeMode.setEnabled(false);
+    
+    // No axes: x and y are fractional indices
+    MapDefinition definition = lookupMap(WinMMM10::MapType::Map3D, 2, 3);
+    definition.xAxis().setCount(0);
+    definition.yAxis().setCount(0);
+    Map3D map(definition);
+    for (size_t r = 0; r < 2; ++r) {
+        for (size_t c = 0; c < 3; ++c) {
+            map.setPhysicalValue(r, c, static_cast<double>(r * 10 + c));
+        }
+    }
+    
+    const std::vector<double> x = {0.5, 2.0, -3.0, 1.25, 9.0};
+    const std::vector<double> y = {0.5, 1.0, 0.0, 0.25, -1.0};
+    std::vector<double> out(x.size());
+    map.lookup(x, y, out);
+    for (size_t i = 0; i < x.size(); ++i) {
+        QVERIFY(std::abs(out[i] - scalarLookup(map, x[i], y[i])) < 1e-9);
+    }
+    QCOMPARE(out[0], 5.5);
+    QCOMPARE(out[1], 12.0);
+    QCOMPARE(out[4], 2.0);
+    
+    // A single-row, single-point map is constant everywhere
+    Map3D point(lookupMap(WinMMM10::MapType::Map3D, 1, 1));
+    point.setXAxisValue(0, 10.0);
+    point.setYAxisValue(0, 10.0);
+    point.setPhysicalValue(0, 0, 7.0);
+    QCOMPARE(point.lookup(-100.0, 100.0), 7.0);
+    QCOMPARE(point.lookup(10.0, 10.0), 7.0);
+    
+    safeMode.setEnabled(wasEnabled);
+}
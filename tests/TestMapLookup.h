@@ -0,0 +1,14 @@
+#pragma once
+
+#include <QtTest/QtTest>
+#include "../src/maps/Map2D.h"
+#include "../src/maps/Map3D.h"
+
+class TestMapLookup : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testMap2DBatchMatchesScalar();
+    void testMap3DBatchMatchesScalar();
+    void testWithoutAxes();
+};
@@ -3,6 +3,9 @@
 #include <QTemporaryFile>
 #include <QDir>
 #include <QFile>
+#include <cstdio>
+#include <string>
+#include <vector>
 
 void TestMapPack::testCreateMapPack() {
     WinMMM10::MapPack pack;
@@ -24,10 +27,13 @@ void TestMapPack::testSaveLoadMapPack() {
     pack.info().name = "Test Pack";
     pack.info().version = "1.0.0";
     pack.info().author = "Test Author";
+    pack.info().fingerprints = {0x1234, 0xFEDCBA9876543210ull};
     
     WinMMM10::MapDefinition map;
     map.setName("Test Map");
-    map.setAddress(0x1000);
+    map.setAddress(0x80001000); // Past the 32-bit signed range
+    map.setWarningMax(123.25);
+    map.yAxis().setCount(4);
     pack.addMap(map);
     
     QTemporaryFile tempFile;
@@ -42,6 +48,260 @@ void TestMapPack::testSaveLoadMapPack() {
     QVERIFY(loadedPack.loadFromFile(filepath.toStdString()));
     QCOMPARE(loadedPack.info().name, std::string("Test Pack"));
     QCOMPARE(loadedPack.mapCount(), pack.mapCount());
+    QCOMPARE(loadedPack.getMap(0).address(), static_cast<size_t>(0x80001000));
+    QCOMPARE(loadedPack.getMap(0).warningMax(), 123.25);
+    QCOMPARE(loadedPack.getMap(0).yAxis().count(), static_cast<size_t>(4));
+    QVERIFY(loadedPack.info().fingerprints == pack.info().fingerprints);
     
     QFile::remove(filepath);
 }
+
+void TestMapPack::testBinaryMapPack() {
+    WinMMM10::MapPack pack;
+    pack.info().name = "Binary Pack";
+    pack.info().tags = {"ecu", "stage1"};
+    pack.info().fingerprints = {7, 0xFFFFFFFFFFFFFFFFull};
+    const char* names[] = {"Torque Limit", "Boost Target", "Ignition Base"};
+    for (size_t i = 0; i < 3; ++i) {
+        WinMMM10::MapDefinition map;
+        map.setName(names[i]);
+        map.setAddress(0x300000000ull - i * 0x100); // Beyond 32 bits
+        map.setType(WinMMM10::MapType::Map3D);
+        map.setRows(8);
+        map.setColumns(12);
+        map.setFactor(0.1 + i);
+        map.setHardMax(250.5);
+        map.setWarningMin(-1.0 / 3.0);
+        map.setUnit("Nm");
+        map.yAxis().setCount(8);
+        map.yAxis().setName("rpm");
+        map.yAxis().setEndianness(WinMMM10::Endianness::Big);
+        pack.addMap(map);
+    }
+    
+    QTemporaryFile tempFile;
+    tempFile.setAutoRemove(false);
+    QVERIFY(tempFile.open());
+    std::string filepath = tempFile.fileName().toStdString();
+    tempFile.close();
+    QVERIFY(pack.saveToFile(filepath, WinMMM10::MapPackFormat::Binary));
+    
+    WinMMM10::MapPackFile packFile;
+    std::string error;
+    QVERIFY(packFile.open(filepath, error));
+    QCOMPARE(packFile.mapCount(), static_cast<size_t>(3));
+    QCOMPARE(packFile.info().tags.size(), static_cast<size_t>(2));
+    QVERIFY(packFile.info().fingerprints == pack.info().fingerprints);
+    
+    size_t index = 0;
+    QVERIFY(packFile.findByName("Ignition Base", index));
+    QCOMPARE(index, static_cast<size_t>(2));
+    QVERIFY(!packFile.findByName("Fuel", index));
+    std::vector<size_t> found = packFile.findByAddress(0x300000000ull - 0x100, 0x300000001ull);
+    QCOMPARE(found.size(), static_cast<size_t>(2));
+    QCOMPARE(found[0], static_cast<size_t>(1));
+    
+    WinMMM10::MapDefinition map = packFile.map(1);
+    QCOMPARE(map.name(), std::string("Boost Target"));
+    QCOMPARE(map.address(), static_cast<size_t>(0x300000000ull - 0x100));
+    QCOMPARE(map.factor(), 1.1);
+    QCOMPARE(map.warningMin(), -1.0 / 3.0);
+    QCOMPARE(map.yAxis().name(), std::string("rpm"));
+    QVERIFY(map.yAxis().endianness() == WinMMM10::Endianness::Big);
+    
+    // Loading detects the format
+    WinMMM10::MapPack loaded;
+    QVERIFY(loaded.loadFromFile(filepath));
+    QCOMPARE(loaded.info().name, std::string("Binary Pack"));
+    QCOMPARE(loaded.getMap(0).hardMax(), 250.5);
+    packFile.close();
+    
+    // Saving over an installed pack replaces the file and reloads the pack
+    WinMMM10::MapPackManager& manager = WinMMM10::MapPackManager::instance();
+    QVERIFY(manager.loadMapPack(filepath));
+    size_t id = manager.installedCount() - 1;
+    WinMMM10::MapDefinition fuel;
+    fuel.setName("Fuel");
+    fuel.setAddress(0x1000);
+    pack.addMap(fuel);
+    pack.info().name = "Binary Pack v2";
+    QVERIFY(manager.saveMapPack(pack, filepath));
+    QCOMPARE(manager.installedCount(), id + 1);
+    QCOMPARE(manager.packInfo(id).name, std::string("Binary Pack v2"));
+    QCOMPARE(manager.mapCount(id), static_cast<size_t>(4));
+    QVERIFY(manager.findMap(id, "Fuel", map));
+    QCOMPARE(map.address(), static_cast<size_t>(0x1000));
+    QVERIFY(manager.findMap(id, "Boost Target", map));
+    
+    // As JSON the pack is no longer mapped, so the file can be removed
+    QVERIFY(manager.saveMapPack(pack, filepath, WinMMM10::MapPackFormat::Json));
+    QCOMPARE(manager.mapCount(id), static_cast<size_t>(4));
+    QVERIFY(manager.unloadMapPack(filepath));
+    QCOMPARE(manager.installedCount(), id);
+    QVERIFY(!manager.unloadMapPack(filepath));
+    QVERIFY(QFile::remove(QString::fromStdString(filepath)));
+}
+
+void TestMapPack::testImportA2L() {
+    const char* a2l = R"(
+ASAP2_VERSION 1 61
+/begin PROJECT P ""
+  /begin MODULE ECU1 "Engine"
+    /begin MOD_COMMON "" BYTE_ORDER MSB_FIRST /end MOD_COMMON
+    /begin COMPU_METHOD CM_RPM "" RAT_FUNC "%8.2" "rpm" COEFFS 0 4 0 0 0 1 /end COMPU_METHOD
+    /begin COMPU_METHOD CM_LIN "" LINEAR "%8.2" "degC" COEFFS_LINEAR 0.5 -40 /end COMPU_METHOD
+    /begin RECORD_LAYOUT RL_MAP
+      NO_AXIS_PTS_X 1 UBYTE NO_AXIS_PTS_Y 2 UBYTE
+      AXIS_PTS_X 3 UWORD INDEX_INCR DIRECT AXIS_PTS_Y 4 UWORD INDEX_INCR DIRECT
+      FNC_VALUES 5 UWORD COLUMN_DIR DIRECT
+    /end RECORD_LAYOUT
+    /begin RECORD_LAYOUT RL_AXIS NO_AXIS_PTS_X 1 UBYTE AXIS_PTS_X 2 SWORD INDEX_INCR DIRECT /end RECORD_LAYOUT
+    /begin RECORD_LAYOUT RL_F32 FNC_VALUES 1 FLOAT32_IEEE ROW_DIR DIRECT /end RECORD_LAYOUT
+    /begin CHARACTERISTIC KF_IGN "" MAP 0x1000 RL_MAP 0 CM_LIN -10 50
+      /begin AXIS_DESCR STD_AXIS nmot CM_RPM 8 0 8000 /end AXIS_DESCR
+      /begin AXIS_DESCR STD_AXIS rl NO_COMPU_METHOD 4 0 100 /end AXIS_DESCR
+      /begin IF_DATA ETK /begin NESTED 1 /end NESTED /end IF_DATA
+      EXTENDED_LIMITS -20 60
+    /end CHARACTERISTIC
+    /begin AXIS_PTS AX_TMOT "" 0x2000 tmot RL_AXIS 0 CM_LIN 6 -40 120 BYTE_ORDER MSB_LAST /end AXIS_PTS
+    /begin CHARACTERISTIC KL_CURVE "" CURVE 0x3000 RL_F32 0 NO_COMPU_METHOD 0 1
+      /begin AXIS_DESCR COM_AXIS tmot CM_LIN 6 -40 120 AXIS_PTS_REF AX_TMOT /end AXIS_DESCR
+    /end CHARACTERISTIC
+    /begin CHARACTERISTIC K_CUB "" CUBOID 0x6000 RL_F32 0 NO_COMPU_METHOD 0 1 /end CHARACTERISTIC
+  /end MODULE
+/end PROJECT
+)";
+    WinMMM10::A2LImporter importer;
+    WinMMM10::MapPack pack;
+    std::string error;
+    QVERIFY(importer.importText(a2l, pack, error));
+    QCOMPARE(importer.stats().imported, static_cast<size_t>(2));
+    QCOMPARE(importer.stats().skipped, static_cast<size_t>(1));
+    QCOMPARE(pack.info().name, std::string("ECU1"));
+    
+    // COLUMN_DIR: the A2L y axis (4 points) runs along the columns
+    const WinMMM10::MapDefinition& map = pack.getMap(0);
+    QCOMPARE(map.rows(), static_cast<size_t>(8));
+    QCOMPARE(map.columns(), static_cast<size_t>(4));
+    QCOMPARE(map.address(), static_cast<size_t>(0x101A));
+    QCOMPARE(map.yAxis().address(), static_cast<size_t>(0x1002));
+    QCOMPARE(map.yAxis().factor(), 0.25);
+    QCOMPARE(map.xAxis().address(), static_cast<size_t>(0x1012));
+    QVERIFY(map.endianness() == WinMMM10::Endianness::Big);
+    QCOMPARE(map.offset(), -40.0);
+    QCOMPARE(map.warningMax(), 50.0);
+    QCOMPARE(map.hardMax(), 60.0);
+    
+    const WinMMM10::MapDefinition& curve = pack.getMap(1);
+    QCOMPARE(curve.columns(), static_cast<size_t>(6));
+    QCOMPARE(curve.dataType(), static_cast<uint16_t>(4));
+    QCOMPARE(curve.xAxis().address(), static_cast<size_t>(0x2002));
+    QCOMPARE(curve.xAxis().dataType(), static_cast<uint16_t>(3));
+    QVERIFY(curve.xAxis().endianness() == WinMMM10::Endianness::Little);
+    
+    WinMMM10::MapPack truncated;
+    QVERIFY(!importer.importText("/begin PROJECT P \"\" /begin MODULE M \"\"", truncated, error));
+    QCOMPARE(truncated.mapCount(), static_cast<size_t>(0));
+    
+    // A backslash ending the text inside a string must not be read past
+    const std::string cut = "/begin PROJECT P \"text\\";
+    std::vector<char> exact(cut.begin(), cut.end());
+    QVERIFY(!importer.importText(std::string_view(exact.data(), exact.size()), truncated, error));
+    QCOMPARE(error, std::string("Line 1: Unterminated string"));
+}
+
+void TestMapPack::benchmarkImportA2L() {
+    // About 23 MB of maps with the IF_DATA and MEASUREMENT noise of real
+    // files, imported from disk as the editor does
+    std::string a2l = "/begin PROJECT P \"\" /begin MODULE M \"\"\n"
+                      "/begin COMPU_METHOD CM \"\" LINEAR \"%6.2\" \"-\" COEFFS_LINEAR 0.1 0 /end COMPU_METHOD\n"
+                      "/begin RECORD_LAYOUT RL AXIS_PTS_X 1 UWORD INDEX_INCR DIRECT AXIS_PTS_Y 2 UWORD INDEX_INCR DIRECT "
+                      "FNC_VALUES 3 UWORD COLUMN_DIR DIRECT /end RECORD_LAYOUT\n";
+    const size_t count = 60000;
+    char block[1024];
+    for (size_t i = 0; i < count; ++i) {
+        int length = std::snprintf(block, sizeof(block),
+            "/begin CHARACTERISTIC KF_%zu \"Synthetic map %zu\" MAP 0x%zX RL 0 CM -100 100\n"
+            "  /begin AXIS_DESCR STD_AXIS nmot CM 16 0 8000 /end AXIS_DESCR\n"
+            "  /begin AXIS_DESCR STD_AXIS rl CM 12 0 100 /end AXIS_DESCR\n"
+            "  /begin IF_DATA ETK KP_BLOB 0x%zX INTERN 0x200 /end IF_DATA\n"
+            "/end CHARACTERISTIC\n"
+            "/begin MEASUREMENT m_%zu \"\" UWORD CM 1 100 0 8000 ECU_ADDRESS 0x%zX /end MEASUREMENT\n",
+            i, i, i * 512, i * 512, i, i * 2);
+        a2l.append(block, static_cast<size_t>(length));
+    }
+    a2l += "/end MODULE /end PROJECT\n";
+    
+    QTemporaryFile tempFile;
+    QVERIFY(tempFile.open());
+    QCOMPARE(tempFile.write(a2l.data(), static_cast<qint64>(a2l.size())), static_cast<qint64>(a2l.size()));
+    tempFile.close();
+    std::string filepath = tempFile.fileName().toStdString();
+    
+    WinMMM10::A2LImporter importer;
+    std::string error;
+    QBENCHMARK {
+        WinMMM10::MapPack pack;
+        QVERIFY(importer.importFile(filepath, pack, error));
+        QCOMPARE(pack.mapCount(), count);
+    }
+}
+
+void TestMapPack::testMapPackMatching() {
+    // Two software versions with an ECU id string and an erased region
+    auto makeBinary = [](uint32_t seed) {
+        std::vector<uint8_t> data(64 * 1024, 0xFF);
+        for (size_t i = 0; i < 48 * 1024; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            data[i] = static_cast<uint8_t>(seed >> 24);
+        }
+        const char id[] = "0261S12345";
+        std::copy(id, id + 10, data.begin() + 0x2000);
+        return data;
+    };
+    std::vector<uint8_t> stock = makeBinary(1);
+    std::vector<uint8_t> other = makeBinary(2);
+    
+    std::vector<uint8_t> erased(32 * 1024, 0xFF);
+    QVERIFY(WinMMM10::MapPackIndex::fingerprint(erased.data(), erased.size()).empty());
+    
+    WinMMM10::MapPackIndex index;
+    WinMMM10::MapPackInfo info;
+    info.ecuId = "0261S12345";
+    info.fileHash = "stock";
+    info.fingerprints = WinMMM10::MapPackIndex::fingerprint(stock.data(), stock.size());
+    QCOMPARE(info.fingerprints.size(), WinMMM10::MapPackIndex::SketchSize);
+    index.add(0, info);
+    info.ecuId = "0261S99999";
+    info.fileHash = "other";
+    info.fingerprints = WinMMM10::MapPackIndex::fingerprint(other.data(), other.size());
+    index.add(1, info);
+    info.ecuId = "0261S12345";
+    info.fileHash.clear();
+    info.fingerprints.clear();
+    index.add(2, info); // Known by ECU id only
+    QCOMPARE(index.size(), static_cast<size_t>(3));
+    
+    std::vector<WinMMM10::MapPackMatch> matches = index.rank(stock.data(), stock.size(), "stock");
+    QVERIFY(!matches.empty());
+    QCOMPARE(matches[0].pack, static_cast<size_t>(0));
+    QVERIFY(matches[0].fileHashMatch);
+    QCOMPARE(matches[0].score, 1.0);
+    
+    // A tuned binary: a few maps edited, so the hash no longer matches
+    std::vector<uint8_t> tuned = stock;
+    for (size_t offset : {0x4000, 0x4100, 0x9000}) {
+        tuned[offset] ^= 0x5A;
+    }
+    matches = index.rank(tuned.data(), tuned.size(), "tuned");
+    QCOMPARE(matches.size(), static_cast<size_t>(2));
+    QCOMPARE(matches[0].pack, static_cast<size_t>(0));
+    QVERIFY(!matches[0].fileHashMatch);
+    QVERIFY(matches[0].ecuIdMatch);
+    QVERIFY(matches[0].similarity > 0.9);
+    QCOMPARE(matches[1].pack, static_cast<size_t>(2));
+    QCOMPARE(matches[1].score, 0.25);
+    
+    matches = index.rank(tuned.data(), tuned.size(), "", 1);
+    QCOMPARE(matches.size(), static_cast<size_t>(1));
+}
@@ -2,6 +2,9 @@
 
 #include <QtTest/QtTest>
 #include "../src/mappacks/MapPack.h"
+#include "../src/mappacks/A2LImporter.h"
+#include "../src/mappacks/MapPackFile.h"
+#include "../src/mappacks/MapPackIndex.h"
 
 class TestMapPack : public QObject {
     Q_OBJECT
@@ -9,5 +12,9 @@ class TestMapPack : public QObject {
 private slots:
     void testCreateMapPack();
     void testSaveLoadMapPack();
+    void testBinaryMapPack();
+    void testImportA2L();
+    void benchmarkImportA2L();
+    void testMapPackMatching();
 };
 
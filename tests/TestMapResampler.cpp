@@ -0,0 +1,113 @@
+#include "TestMapResampler.h"
+#include "TestHelpers.h"
+#include "../src/maps/MapDataType.h"
+#include <QTest>
+#include <cmath>
+#include <vector>
+
+using WinMMM10::BinaryFile;
+using WinMMM10::MapDefinition;
+using WinMMM10::MapResampler;
+using TestHelpers::loadBytes;
+using TestHelpers::makeMap;
+
+namespace {
+
+void setXAxis(MapDefinition& map, size_t address, size_t count) {
+    map.xAxis().setAddress(address);
+    map.xAxis().setCount(count);
+    map.xAxis().setDataType(static_cast<uint16_t>(WinMMM10::MapDataType::UInt8));
+}
+
+const MapResampler::Method Methods[] = {
+    MapResampler::Method::Bilinear, MapResampler::Method::Bicubic,
+    MapResampler::Method::Spline, MapResampler::Method::MonotoneSpline
+};
+
+} // namespace
+
+void TestMapResampler::testIdentityAxes() {
+    // 3x4 source, resampled onto its own breakpoints by every method
+    const std::vector<double> xAxis = {0.0, 10.0, 20.0, 30.0};
+    const std::vector<double> yAxis = {100.0, 200.0, 300.0};
+    const std::vector<double> source = {5, 9, 2, 7,
+                                        1, 8, 8, 3,
+                                        6, 0, 4, 9};
+    
+    for (MapResampler::Method method : Methods) {
+        std::vector<double> out(source.size());
+        QVERIFY(MapResampler::resample(source, xAxis, yAxis, xAxis, yAxis, out, method));
+        for (size_t i = 0; i < source.size(); ++i) {
+            QVERIFY(std::abs(out[i] - source[i]) < 1e-9);
+        }
+    }
+    
+    // Too small an output or a source without breakpoints is refused
+    std::vector<double> small(source.size() - 1);
+    QVERIFY(!MapResampler::resample(source, xAxis, yAxis, xAxis, yAxis, small));
+    std::vector<double> out(source.size());
+    QVERIFY(!MapResampler::resample(source, {}, yAxis, xAxis, yAxis, out));
+}
+
+void TestMapResampler::testClampsOutOfRange() {
+    // 2x2 source; targets beyond either end take the edge values
+    const std::vector<double> xAxis = {0.0, 10.0};
+    const std::vector<double> yAxis = {0.0, 10.0};
+    const std::vector<double> source = {1, 2,
+                                        3, 4};
+    const std::vector<double> targetX = {-50.0, 5.0, 45.0};
+    const std::vector<double> targetY = {-1.0, 1000.0};
+    
+    for (MapResampler::Method method : Methods) {
+        std::vector<double> out(targetX.size() * targetY.size());
+        QVERIFY(MapResampler::resample(source, xAxis, yAxis, targetX, targetY, out, method));
+        QVERIFY(std::abs(out[0] - 1.0) < 1e-9);
+        QVERIFY(std::abs(out[1] - 1.5) < 1e-9);
+        QVERIFY(std::abs(out[2] - 2.0) < 1e-9);
+        QVERIFY(std::abs(out[3] - 3.0) < 1e-9);
+        QVERIFY(std::abs(out[5] - 4.0) < 1e-9);
+    }
+}
+
+void TestMapResampler::testFallbackToRelativePosition() {
+    // 2x3 source at 0, 2x5 target at 6, x axes at 16 (3 points) and 19 (5 points)
+    BinaryFile file;
+    QVERIFY(loadBytes(file, {0, 10, 20, 30, 40, 50,
+                             0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                             0, 10, 20,
+                             0, 2, 4, 6, 20}));
+    
+    MapDefinition source = makeMap({.rows = 2, .columns = 3});
+    MapDefinition target = makeMap({.address = 6, .rows = 2, .columns = 5});
+    std::vector<double> out;
+    
+    // Neither map has axes: columns map by relative position, 0 0.5 1 1.5 2
+    const std::vector<double> relative = {0, 5, 10, 15, 20, 30, 35, 40, 45, 50};
+    QVERIFY(MapResampler::resample(source, &file, target, &file, out));
+    QVERIFY(out == relative);
+    
+    // Only the target has an axis
+    setXAxis(target, 19, 5);
+    QVERIFY(MapResampler::resample(source, &file, target, &file, out));
+    QVERIFY(out == relative);
+    
+    // Both have ascending axes, so the breakpoints are used
+    setXAxis(source, 16, 3);
+    QVERIFY(MapResampler::resample(source, &file, target, &file, out));
+    QVERIFY(out == std::vector<double>({0, 2, 4, 6, 20, 30, 32, 34, 36, 50}));
+    
+    // A non-monotonic source axis is not usable
+    file.writeByte(17, 25);
+    QVERIFY(MapResampler::resample(source, &file, target, &file, out));
+    QVERIFY(out == relative);
+    
+    // Nor is one of the wrong length
+    file.writeByte(17, 10);
+    setXAxis(source, 16, 2);
+    QVERIFY(MapResampler::resample(source, &file, target, &file, out));
+    QVERIFY(out == relative);
+    
+    // Identical grids decode directly
+    QVERIFY(MapResampler::resample(source, &file, source, &file, out));
+    QVERIFY(out == std::vector<double>({0, 10, 20, 30, 40, 50}));
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <QtTest/QtTest>
+#include "../src/maps/MapResampler.h"
+
+class TestMapResampler : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testIdentityAxes();
+    void testClampsOutOfRange();
+    void testFallbackToRelativePosition();
+};
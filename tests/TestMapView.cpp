@@ -0,0 +1,146 @@
+#include "TestMapView.h"
+#include "TestHelpers.h"
+#include <QTest>
+#include <vector>
+
+using WinMMM10::BinaryFile;
+using WinMMM10::Endianness;
+using WinMMM10::MapDataType;
+using WinMMM10::MapDefinition;
+using WinMMM10::MapView;
+using WinMMM10::SafeModeManager;
+using TestHelpers::loadBytes;
+using TestHelpers::makeMap;
+
+void TestMapView::testBulkReadWriteBigEndian() {
+    // 2x3 int16 map at offset 2, stored big-endian
+    BinaryFile file;
+    QVERIFY(loadBytes(file, {0xAA, 0xBB, 0xFF, 0xFE, 0x01, 0x00, 0x00, 0x01,
+                             0x00, 0x00, 0x7F, 0xFF, 0x80, 0x00, 0xCC}));
+    
+    MapDefinition map = makeMap({.address = 2, .rows = 2, .columns = 3, .dataType = MapDataType::Int16});
+    map.setEndianness(Endianness::Big);
+    map.setFactor(0.5);
+    map.setHardMin(-20000.0);
+    map.setWarningMin(-20000.0);
+    map.setHardMax(20000.0);
+    map.setWarningMax(20000.0);
+    
+    MapView view(map, &file);
+    QVERIFY(view.isWritable());
+    
+    std::vector<double> values;
+    QVERIFY(view.read(values));
+    QCOMPARE(values.size(), static_cast<size_t>(6));
+    QCOMPARE(values[0], -1.0);
+    QCOMPARE(values[1], 128.0);
+    QCOMPARE(values[4], 16383.5);
+    QCOMPARE(values[5], -16384.0);
+    
+    size_t notifications = 0;
+    file.addWriteObserver([&](size_t offset, size_t length) {
+        ++notifications;
+        QCOMPARE(offset, static_cast<size_t>(2));
+        QCOMPARE(length, static_cast<size_t>(12));
+    });
+    
+    for (double& value : values) {
+        value += 1.0;
+    }
+    QVERIFY(view.write(values));
+    QCOMPARE(notifications, static_cast<size_t>(1));
+    QCOMPARE(file.readInt16(2, Endianness::Big), static_cast<int16_t>(0));
+    QCOMPARE(file.readInt16(4, Endianness::Big), static_cast<int16_t>(258));
+    QCOMPARE(file.readByte(0), static_cast<uint8_t>(0xAA));
+    QCOMPARE(file.readByte(14), static_cast<uint8_t>(0xCC));
+}
+
+void TestMapView::testRowsColumnsAndVisit() {
+    // 3x2 uint8 map: row-major 1 2 / 3 4 / 5 6
+    BinaryFile file;
+    QVERIFY(loadBytes(file, {1, 2, 3, 4, 5, 6}));
+    
+    MapView view(makeMap({.rows = 3, .columns = 2}), &file);
+    
+    double row[2];
+    QVERIFY(view.readRow(1, row));
+    QCOMPARE(row[0], 3.0);
+    QCOMPARE(row[1], 4.0);
+    
+    double column[3];
+    QVERIFY(view.readColumn(1, column));
+    QCOMPARE(column[0], 2.0);
+    QCOMPARE(column[2], 6.0);
+    
+    double sum = 0.0;
+    view.visit([&](const auto& elements) {
+        for (size_t i = 0; i < elements.size(); ++i) {
+            sum += elements[i];
+        }
+    }, 0, 3, 2);
+    QCOMPARE(sum, 9.0);
+    
+    QVERIFY(view.setValue(2, 0, 50.0));
+    QCOMPARE(view.value(2, 0), 50.0);
+    QCOMPARE(file.readByte(4), static_cast<uint8_t>(50));
+}
+
+void TestMapView::testOutOfRangeIsInvalid() {
+    BinaryFile file;
+    QVERIFY(loadBytes(file, {0, 0, 0, 0}));
+    
+    std::vector<double> values;
+    QVERIFY(!MapView(makeMap({.address = 2, .columns = 2, .dataType = MapDataType::UInt16}), &file).read(values));
+    QVERIFY(!MapView(makeMap({.columns = 2, .dataType = MapDataType::UInt16}),
+                     static_cast<BinaryFile*>(nullptr)).isValid());
+    
+    const BinaryFile& readOnly = file;
+    MapView view(makeMap({.columns = 2, .dataType = MapDataType::UInt16}), &readOnly);
+    QVERIFY(view.read(values));
+    QVERIFY(!view.write(values));
+}
+
+void TestMapView::testSafeModeLimits() {
+    BinaryFile file;
+    QVERIFY(loadBytes(file, {10, 20, 30, 40}));
+    
+    MapDefinition map = makeMap({.rows = 2, .columns = 2});
+    map.setHardMax(100.0);
+    map.setWarningMax(50.0);
+    MapView view(map, &file);
+    
+    SafeModeManager& safeMode = SafeModeManager::instance();
+    bool wasEnabled = safeMode.isEnabled();
+    safeMode.setEnabled(true);
+    
+    // One value over the hard limit blocks the whole write
+    std::vector<double> values = {60.0, 120.0, 70.0, 80.0};
+    QVERIFY(!view.write(values));
+    QCOMPARE(view.limitReport().result, SafeModeManager::ValidationResult::Blocked);
+    QCOMPARE(view.limitReport().outsideHard, static_cast<size_t>(1));
+    QCOMPARE(view.limitReport().highest, 120.0);
+    QCOMPARE(file.readByte(0), static_cast<uint8_t>(10));
+    
+    std::vector<uint8_t> raw = {1, 2, 200, 4};
+    QVERIFY(!view.writeRaw(0, raw));
+    QCOMPARE(file.readByte(2), static_cast<uint8_t>(30));
+    
+    // Clamping writes the limit instead and reports a warning
+    safeMode.setLimitPolicy(SafeModeManager::LimitPolicy::Clamp);
+    QVERIFY(view.write(values));
+    QCOMPARE(view.limitReport().result, SafeModeManager::ValidationResult::Warning);
+    QCOMPARE(view.limitReport().clamped, static_cast<size_t>(1));
+    QCOMPARE(view.limitReport().outsideWarning, static_cast<size_t>(4));
+    QCOMPARE(file.readByte(1), static_cast<uint8_t>(100));
+    QVERIFY(view.writeRaw(0, raw));
+    QCOMPARE(file.readByte(2), static_cast<uint8_t>(100));
+    safeMode.setLimitPolicy(SafeModeManager::LimitPolicy::Block);
+    
+    // Values inside the warning range pass silently
+    values = {1.0, 2.0, 3.0, 4.0};
+    QVERIFY(view.write(values));
+    QCOMPARE(view.limitReport().result, SafeModeManager::ValidationResult::Allowed);
+    QVERIFY(view.limitReport().reason.empty());
+    
+    safeMode.setEnabled(wasEnabled);
+}
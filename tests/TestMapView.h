@@ -0,0 +1,14 @@
+#pragma once
+
+#include <QtTest/QtTest>
+#include "../src/maps/MapView.h"
+
+class TestMapView : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testBulkReadWriteBigEndian();
+    void testRowsColumnsAndVisit();
+    void testOutOfRangeIsInvalid();
+    void testSafeModeLimits();
+};
@@ -0,0 +1,133 @@
+#include "TestProjectComparator.h"
+#include "TestHelpers.h"
+#include <string>
+#include <vector>
+
+using WinMMM10::BinaryFile;
+using WinMMM10::MapComparisonSummary;
+using WinMMM10::MapDefinition;
+using WinMMM10::ProjectComparator;
+using TestHelpers::loadBytes;
+using TestHelpers::makeMap;
+
+namespace {
+
+// 4x20 "Fuel" at 0, 2x2 "Spark" at 80, 2x2 "Trim" at 84 scaled below the
+// tolerance, 2x2 "Lambda" at 88 and "Outside" past the end of the image
+WinMMM10::Project makeProject() {
+    WinMMM10::Project project;
+    project.addMap(makeMap({.name = "Fuel", .rows = 4, .columns = 20}));
+    project.addMap(makeMap({.name = "Spark", .address = 80, .rows = 2, .columns = 2}));
+    MapDefinition trim = makeMap({.name = "Trim", .address = 84, .rows = 2, .columns = 2});
+    trim.setFactor(0.00001);
+    project.addMap(trim);
+    project.addMap(makeMap({.name = "Lambda", .address = 88, .rows = 2, .columns = 2}));
+    project.addMap(makeMap({.name = "Outside", .address = 1000, .rows = 2, .columns = 2}));
+    return project;
+}
+
+// Fuel cells 3 (+5), 70 (-10) and 79 (+1), Trim cell 0 (+1), Lambda cell 2 (+50)
+void loadPair(BinaryFile& original, BinaryFile& modified) {
+    std::vector<uint8_t> bytes(92);
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<uint8_t>(100 + i % 50);
+    }
+    QVERIFY(loadBytes(original, bytes));
+    bytes[3] += 5;
+    bytes[70] -= 10;
+    bytes[79] += 1;
+    bytes[84] += 1;
+    bytes[90] += 50;
+    QVERIFY(loadBytes(modified, bytes));
+}
+
+} // namespace
+
+void TestProjectComparator::testChangedCells() {
+    BinaryFile original;
+    BinaryFile modified;
+    loadPair(original, modified);
+    WinMMM10::Project project = makeProject();
+    
+    // The mask spans two words, with bits in both
+    MapComparisonSummary fuel = ProjectComparator::compareMap(project.maps()[0], &original, &modified);
+    QVERIFY(fuel.compared);
+    QVERIFY(fuel.isChanged());
+    QCOMPARE(fuel.cellCount, static_cast<size_t>(80));
+    QCOMPARE(fuel.changedCells, static_cast<size_t>(3));
+    QCOMPARE(fuel.changedMask.size(), static_cast<size_t>(2));
+    QCOMPARE(fuel.changedMask[0], uint64_t(1) << 3);
+    QCOMPARE(fuel.changedMask[1], (uint64_t(1) << (70 - 64)) | (uint64_t(1) << (79 - 64)));
+    for (size_t cell = 0; cell < fuel.cellCount; ++cell) {
+        QCOMPARE(fuel.isCellChanged(cell), cell == 3 || cell == 70 || cell == 79);
+    }
+    QCOMPARE(fuel.maxDelta, 10.0);
+    QCOMPARE(fuel.averageDelta, 16.0 / 3.0);
+    QCOMPARE(fuel.percentChanged(), 100.0 * 3.0 / 80.0);
+    
+    MapComparisonSummary spark = ProjectComparator::compareMap(project.maps()[1], &original, &modified);
+    QVERIFY(spark.compared);
+    QVERIFY(!spark.isChanged());
+    QVERIFY(spark.changedMask.empty());
+    QCOMPARE(spark.maxDelta, 0.0);
+    
+    // A changed byte whose scaled difference is within the tolerance
+    MapComparisonSummary trim = ProjectComparator::compareMap(project.maps()[2], &original, &modified);
+    QVERIFY(trim.compared);
+    QVERIFY(!trim.isChanged());
+    QVERIFY(trim.changedMask.empty());
+    QVERIFY(!trim.isCellChanged(0));
+    trim = ProjectComparator::compareMap(project.maps()[2], &original, &modified, 0.0);
+    QCOMPARE(trim.changedCells, static_cast<size_t>(1));
+    QVERIFY(trim.isCellChanged(0));
+    
+    MapComparisonSummary outside = ProjectComparator::compareMap(project.maps()[4], &original, &modified);
+    QVERIFY(!outside.compared);
+    QVERIFY(!outside.isChanged());
+    QCOMPARE(outside.percentChanged(), 0.0);
+}
+
+void TestProjectComparator::testReportAndSort() {
+    BinaryFile original;
+    BinaryFile modified;
+    loadPair(original, modified);
+    WinMMM10::Project project = makeProject();
+    
+    // Any number of workers gives the same report as comparing map by map
+    for (size_t workers : {1, 3, 16}) {
+        ProjectComparator::Report report = ProjectComparator::compare(project, &original, &modified, 0.0001, workers);
+        QCOMPARE(report.maps.size(), static_cast<size_t>(5));
+        QCOMPARE(report.comparedMaps, static_cast<size_t>(4));
+        QCOMPARE(report.changedMaps, static_cast<size_t>(2));
+        for (size_t i = 0; i < report.maps.size(); ++i) {
+            MapComparisonSummary expected = ProjectComparator::compareMap(project.maps()[i], &original, &modified);
+            QCOMPARE(report.maps[i].mapIndex, i);
+            QCOMPARE(report.maps[i].name, expected.name);
+            QCOMPARE(report.maps[i].changedCells, expected.changedCells);
+            QVERIFY(report.maps[i].changedMask == expected.changedMask);
+            QCOMPARE(report.maps[i].maxDelta, expected.maxDelta);
+            QCOMPARE(report.maps[i].averageDelta, expected.averageDelta);
+        }
+    }
+    
+    ProjectComparator::Report report = ProjectComparator::compare(project, &original, &modified);
+    auto order = [&report]() {
+        std::vector<size_t> indices;
+        for (const auto& summary : report.maps) {
+            indices.push_back(summary.mapIndex);
+        }
+        return indices;
+    };
+    
+    // Lambda has one changed cell of four with a delta of 50; ties keep project order
+    report.sort(ProjectComparator::SortKey::MaxDelta, true);
+    QVERIFY(order() == std::vector<size_t>({3, 0, 1, 2, 4}));
+    report.sort(ProjectComparator::SortKey::ChangedCells, true);
+    QVERIFY(order() == std::vector<size_t>({0, 3, 1, 2, 4}));
+    report.sort(ProjectComparator::SortKey::PercentChanged, true);
+    QVERIFY(order() == std::vector<size_t>({3, 0, 1, 2, 4}));
+    report.sort(ProjectComparator::SortKey::Name, false);
+    QVERIFY(order() == std::vector<size_t>({0, 3, 4, 1, 2}));
+    report.sort(ProjectComparator::SortKey::Index, false);
+    QVERIFY(order() == std::vector<size_t>({0, 1, 2, 3, 4}));
+}
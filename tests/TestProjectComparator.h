@@ -0,0 +1,12 @@
+#pragma once
+
+#include <QtTest/QtTest>
+#include "../src/editing/ProjectComparator.h"
+
+class TestProjectComparator : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testChangedCells();
+    void testReportAndSort();
+};
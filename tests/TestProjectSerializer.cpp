@@ -0,0 +1,181 @@
+#include "TestProjectSerializer.h"
+#include <QTest>
+#include <QTemporaryFile>
+#include <QFile>
+#include <string>
+
+namespace {
+
+// 10k maps with their axes, plus notes, as a large tuning project has
+WinMMM10::Project makeLargeProject() {
+    WinMMM10::Project project;
+    project.setName("Large Project");
+    project.setEcuName("EDC17C46");
+    for (size_t i = 0; i < 10000; ++i) {
+        WinMMM10::MapDefinition map;
+        map.setName("KF_Map_" + std::to_string(i));
+        map.setAddress(0x80000000 + i * 0x200);
+        map.setType(WinMMM10::MapType::Map3D);
+        map.setRows(16);
+        map.setColumns(16);
+        map.setFactor(0.01 * (i % 7 + 1));
+        map.setUnit("mg/stroke");
+        map.xAxis().setName("Engine speed");
+        map.xAxis().setUnit("rpm");
+        map.xAxis().setCount(16);
+        map.yAxis().setName("Injection quantity");
+        map.yAxis().setUnit("mg");
+        map.yAxis().setCount(16);
+        project.addMap(map);
+    }
+    for (size_t i = 0; i < 1000; ++i) {
+        project.annotations().emplace_back(0x80000000 + i * 0x40, "Note " + std::to_string(i));
+        project.bookmarks().emplace_back("Bookmark " + std::to_string(i), 0x80000000 + i * 0x80, "Fuel");
+    }
+    return project;
+}
+
+} // namespace
+
+void TestProjectSerializer::testRoundTrip() {
+    WinMMM10::Project project;
+    project.setName("Stage \"1\"\\n");
+    project.setBinaryFilepath("C:\\Tuning\\ecu.bin");
+    project.setDescription("Line one\nLine two\t\x01 \xC3\xA9t\xC3\xA9");
+    
+    WinMMM10::MapDefinition map;
+    map.setName("Boost \xE2\x86\x92 target");
+    map.setAddress(0x3FFFFFFFFull); // Beyond 32 bits
+    map.setType(WinMMM10::MapType::Map3D);
+    map.setRows(8);
+    map.setColumns(12);
+    map.setDataType(7);
+    map.setEndianness(WinMMM10::Endianness::Big);
+    map.setFactor(0.1);
+    map.setOffset(-1.0 / 3.0);
+    map.setWarningMax(1e300);
+    map.xAxis().setCount(12);
+    map.xAxis().setName("rpm");
+    map.yAxis().setCount(8);
+    map.yAxis().setEndianness(WinMMM10::Endianness::Big);
+    project.addMap(map);
+    project.annotations().emplace_back(0x1000, "Checksum block", "#FF0000", 16);
+    project.bookmarks().emplace_back("Start", 0x2000, "Code", "Reset vector");
+    
+    QTemporaryFile tempFile;
+    tempFile.setAutoRemove(false);
+    QVERIFY(tempFile.open());
+    std::string filepath = tempFile.fileName().toStdString();
+    tempFile.close();
+    
+    std::string error;
+    QVERIFY(WinMMM10::ProjectSerializer::save(project, filepath, error));
+    WinMMM10::Project loaded;
+    QVERIFY(WinMMM10::ProjectSerializer::load(filepath, loaded, error));
+    QCOMPARE(loaded.filepath(), filepath);
+    QCOMPARE(loaded.name(), project.name());
+    QCOMPARE(loaded.binaryFilepath(), project.binaryFilepath());
+    QCOMPARE(loaded.description(), project.description());
+    QCOMPARE(loaded.mapCount(), static_cast<size_t>(1));
+    
+    const WinMMM10::MapDefinition& result = loaded.getMap(0);
+    QCOMPARE(result.name(), map.name());
+    QCOMPARE(result.address(), map.address());
+    QVERIFY(result.type() == WinMMM10::MapType::Map3D);
+    QCOMPARE(result.columns(), static_cast<size_t>(12));
+    QCOMPARE(result.dataType(), static_cast<uint16_t>(7));
+    QVERIFY(result.endianness() == WinMMM10::Endianness::Big);
+    QCOMPARE(result.offset(), -1.0 / 3.0); // Doubles are written exactly
+    QCOMPARE(result.warningMax(), 1e300);
+    QCOMPARE(result.xAxis().name(), std::string("rpm"));
+    QCOMPARE(result.yAxis().count(), static_cast<size_t>(8));
+    QVERIFY(result.yAxis().endianness() == WinMMM10::Endianness::Big);
+    
+    QCOMPARE(loaded.annotations().size(), static_cast<size_t>(1));
+    QCOMPARE(loaded.annotations()[0].length, static_cast<size_t>(16));
+    QCOMPARE(loaded.annotations()[0].color, std::string("#FF0000"));
+    QCOMPARE(loaded.bookmarks().size(), static_cast<size_t>(1));
+    QCOMPARE(loaded.bookmarks()[0].description, std::string("Reset vector"));
+    
+    QFile::remove(QString::fromStdString(filepath));
+}
+
+void TestProjectSerializer::testLoadLegacyProject() {
+    // As QJsonDocument wrote it, with a key this version does not know
+    const char* json = R"({
+    "binaryFilepath": "ecu.bin",
+    "ecuName": "ME7",
+    "maps": [
+        {
+            "address": 2147487744,
+            "columns": 16,
+            "dataType": 2,
+            "endianness": "little",
+            "factor": 0.75,
+            "name": "Ign\u00e9 \ud83d\ude00",
+            "offset": 0,
+            "rows": 1,
+            "type": "2D",
+            "unit": "deg",
+            "xAxis": {"address": 4096, "count": 16, "dataType": 2, "endianness": "big",
+                      "factor": 1, "name": "rpm", "offset": 0, "unit": "1/min"}
+        }
+    ],
+    "name": "Old Project",
+    "plugins": {"nested": [1, 2.5e3, true, null, {"a": "b"}]}
+}
+)";
+    WinMMM10::Project project;
+    std::string error;
+    QVERIFY(WinMMM10::ProjectSerializer::fromJson(json, project, error));
+    QCOMPARE(project.name(), std::string("Old Project"));
+    QCOMPARE(project.mapCount(), static_cast<size_t>(1));
+    const WinMMM10::MapDefinition& map = project.getMap(0);
+    QCOMPARE(map.name(), std::string("Ign\xC3\xA9 \xF0\x9F\x98\x80"));
+    QCOMPARE(map.address(), static_cast<size_t>(2147487744u));
+    QCOMPARE(map.factor(), 0.75);
+    QCOMPARE(map.hardMax(), 10000.0); // Default, not in the file
+    QCOMPARE(map.xAxis().address(), static_cast<size_t>(4096));
+    QVERIFY(map.xAxis().endianness() == WinMMM10::Endianness::Big);
+    QVERIFY(project.annotations().empty());
+}
+
+void TestProjectSerializer::testRejectMalformedProject() {
+    WinMMM10::Project project;
+    std::string error;
+    QVERIFY(!WinMMM10::ProjectSerializer::fromJson("{\"name\": \"x\",\n\"maps\": [{\"rows\": -1}]}", project, error));
+    QVERIFY(error.rfind("Line 2:", 0) == 0);
+    QVERIFY(!WinMMM10::ProjectSerializer::fromJson("{\"maps\": [", project, error));
+    QVERIFY(!WinMMM10::ProjectSerializer::fromJson("{\"name\": \"unterminated}", project, error));
+    QVERIFY(!WinMMM10::ProjectSerializer::fromJson("{} trailing", project, error));
+    QVERIFY(!WinMMM10::ProjectSerializer::fromJson("{\"plugins\": " + std::string(1000, '['), project, error));
+}
+
+void TestProjectSerializer::benchmarkSaveProject() {
+    WinMMM10::Project project = makeLargeProject();
+    QTemporaryFile tempFile;
+    QVERIFY(tempFile.open());
+    std::string filepath = tempFile.fileName().toStdString();
+    tempFile.close();
+    
+    std::string error;
+    QBENCHMARK {
+        QVERIFY(WinMMM10::ProjectSerializer::save(project, filepath, error));
+    }
+}
+
+void TestProjectSerializer::benchmarkLoadProject() {
+    WinMMM10::Project project = makeLargeProject();
+    QTemporaryFile tempFile;
+    QVERIFY(tempFile.open());
+    std::string filepath = tempFile.fileName().toStdString();
+    tempFile.close();
+    std::string error;
+    QVERIFY(WinMMM10::ProjectSerializer::save(project, filepath, error));
+    
+    QBENCHMARK {
+        WinMMM10::Project loaded;
+        QVERIFY(WinMMM10::ProjectSerializer::load(filepath, loaded, error));
+        QCOMPARE(loaded.mapCount(), project.mapCount());
+    }
+}
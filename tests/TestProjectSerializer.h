@@ -0,0 +1,15 @@
+#pragma once
+
+#include <QtTest/QtTest>
+#include "../src/core/ProjectSerializer.h"
+
+class TestProjectSerializer : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testRoundTrip();
+    void testLoadLegacyProject();
+    void testRejectMalformedProject();
+    void benchmarkSaveProject();
+    void benchmarkLoadProject();
+};
@@ -0,0 +1,114 @@
+#include "TestScalingEngine.h"
+#include <QTest>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using WinMMM10::Endianness;
+using WinMMM10::ScalingEngine;
+
+void TestScalingEngine::testDecodeAllTypes() {
+    // Seven elements so both the vector body and the scalar tail are exercised
+    int16_t raw[] = {-32768, -1, 0, 1, 100, 32767, -200};
+    std::vector<double> out(7);
+    ScalingEngine::decode<int16_t>(reinterpret_cast<const uint8_t*>(raw), 7, Endianness::Little,
+                                   0.5, 10.0, out.data());
+    QCOMPARE(out[0], -16374.0);
+    QCOMPARE(out[1], 9.5);
+    QCOMPARE(out[5], 16393.5);
+    QCOMPARE(out[6], -90.0);
+    
+    uint32_t big[] = {0u, 1u, 0x80000000u, 0xFFFFFFFFu, 12345u};
+    std::vector<double> out32(5);
+    ScalingEngine::decode<uint32_t>(reinterpret_cast<const uint8_t*>(big), 5, Endianness::Little,
+                                    1.0, 0.0, out32.data());
+    QCOMPARE(out32[2], 2147483648.0);
+    QCOMPARE(out32[3], 4294967295.0);
+    QCOMPARE(out32[4], 12345.0);
+    
+    int8_t small[] = {-128, -1, 0, 127, 5};
+    std::vector<double> out8(5);
+    ScalingEngine::decode(static_cast<uint16_t>(WinMMM10::MapDataType::Int8),
+                          reinterpret_cast<const uint8_t*>(small), 5, Endianness::Little,
+                          1.0, 0.0, out8.data());
+    QCOMPARE(out8[0], -128.0);
+    QCOMPARE(out8[3], 127.0);
+}
+
+void TestScalingEngine::testEncodeSaturationAndRounding() {
+    double physical[] = {-5.0, 0.4, 0.5, 254.5, 300.0, std::nan(""), 1.49, 2.5};
+    uint8_t raw[8];
+    ScalingEngine::encode<uint8_t>(physical, 8, Endianness::Little, 1.0, 0.0, raw);
+    QCOMPARE(raw[0], uint8_t(0));
+    QCOMPARE(raw[1], uint8_t(0));
+    QCOMPARE(raw[2], uint8_t(1));
+    QCOMPARE(raw[3], uint8_t(255));
+    QCOMPARE(raw[4], uint8_t(255));
+    QCOMPARE(raw[5], uint8_t(0));
+    QCOMPARE(raw[6], uint8_t(1));
+    QCOMPARE(raw[7], uint8_t(3));
+    
+    double signedValues[] = {-2.5, -40000.0, 40000.0, -0.4};
+    int16_t raw16[4];
+    ScalingEngine::encode<int16_t>(signedValues, 4, Endianness::Little, 1.0, 0.0,
+                                   reinterpret_cast<uint8_t*>(raw16));
+    QCOMPARE(raw16[0], int16_t(-3));
+    QCOMPARE(raw16[1], int16_t(-32768));
+    QCOMPARE(raw16[2], int16_t(32767));
+    QCOMPARE(raw16[3], int16_t(0));
+    
+    double unsignedValues[] = {4294967295.4, 5e12, 2147483647.5, -1.0};
+    uint32_t raw32[4];
+    ScalingEngine::encode<uint32_t>(unsignedValues, 4, Endianness::Little, 1.0, 0.0,
+                                    reinterpret_cast<uint8_t*>(raw32));
+    QCOMPARE(raw32[0], 4294967295u);
+    QCOMPARE(raw32[1], 4294967295u);
+    QCOMPARE(raw32[2], 2147483648u);
+    QCOMPARE(raw32[3], 0u);
+}
+
+void TestScalingEngine::testBigEndianRoundTrip() {
+    uint8_t bytes[] = {0x12, 0x34, 0xAB, 0xCD, 0x00, 0x01, 0xFF, 0xFE, 0x80, 0x00};
+    std::vector<double> values(5);
+    ScalingEngine::decode<uint16_t>(bytes, 5, Endianness::Big, 1.0, 0.0, values.data());
+    QCOMPARE(values[0], double(0x1234));
+    QCOMPARE(values[1], double(0xABCD));
+    QCOMPARE(values[4], double(0x8000));
+    
+    uint8_t encoded[10];
+    ScalingEngine::encode<uint16_t>(values.data(), 5, Endianness::Big, 1.0, 0.0, encoded);
+    QCOMPARE(std::memcmp(bytes, encoded, sizeof(bytes)), 0);
+    
+    float floats[] = {1.5f, -2.25f, 1e6f, 0.0f, 3.0f};
+    uint8_t floatBytes[20];
+    std::vector<double> physical(floats, floats + 5);
+    ScalingEngine::encode<float>(physical.data(), 5, Endianness::Big, 1.0, 0.0, floatBytes);
+    QCOMPARE(floatBytes[0], uint8_t(0x3F)); // 1.5f = 0x3FC00000
+    QCOMPARE(floatBytes[1], uint8_t(0xC0));
+    
+    std::vector<double> decoded(5);
+    ScalingEngine::decode<float>(floatBytes, 5, Endianness::Big, 1.0, 0.0, decoded.data());
+    QCOMPARE(decoded[1], -2.25);
+    QCOMPARE(decoded[2], 1e6);
+}
+
+void TestScalingEngine::testBatchMatchesScalar() {
+    const double factor = 0.37;
+    const double offset = -12.5;
+    std::vector<double> physical;
+    for (int i = -500; i < 500; ++i) {
+        physical.push_back(i * 31.7 + 0.185);
+    }
+    
+    std::vector<int16_t> raw(physical.size());
+    ScalingEngine::physicalToRaw<int16_t>(physical, factor, offset, raw);
+    for (size_t i = 0; i < physical.size(); ++i) {
+        QCOMPARE(raw[i], ScalingEngine::physicalToRawI16(physical[i], factor, offset));
+    }
+    
+    std::vector<double> back(raw.size());
+    ScalingEngine::rawToPhysical<int16_t>(raw, factor, offset, back);
+    for (size_t i = 0; i < raw.size(); ++i) {
+        QCOMPARE(back[i], ScalingEngine::rawToPhysical(raw[i], factor, offset));
+    }
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <QtTest/QtTest>
+#include "../src/maps/ScalingEngine.h"
+
+class TestScalingEngine : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testDecodeAllTypes();
+    void testEncodeSaturationAndRounding();
+    void testBigEndianRoundTrip();
+    void testBatchMatchesScalar();
+};
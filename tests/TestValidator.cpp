@@ -0,0 +1,124 @@
+#include "TestValidator.h"
+#include <QTest>
+#include <random>
+#include <string>
+#include <vector>
+
+using WinMMM10::ValidationFlags;
+using WinMMM10::ValidationWarning;
+using WinMMM10::Validator;
+
+namespace {
+
+bool hasWarning(const std::vector<ValidationWarning>& warnings, const std::string& prefix) {
+    for (const auto& warning : warnings) {
+        if (warning.message.compare(0, prefix.size(), prefix) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+void TestValidator::testBatchMatchesValidateChange() {
+    Validator validator;
+    validator.setMinValue(-50.0);
+    validator.setMaxValue(200.0);
+    validator.setMaxChangePercent(25.0);
+    
+    // Edge cases first: limits, exactly 25%, old values near zero, NaN
+    std::vector<double> oldValues = {100, 100, 100, 100, 0, 0.00005, -40, 10, 150, 0, std::nan("")};
+    std::vector<double> newValues = {125, 125.001, 74.999, -60, 1000, 1, -50, 10, 250, -50.001, 5};
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> value(-100.0, 300.0);
+    std::uniform_real_distribution<double> change(0.5, 1.5);
+    while (oldValues.size() < 203) { // Ends partway through a word
+        double oldValue = value(rng);
+        oldValues.push_back(oldValue);
+        newValues.push_back(oldValue * change(rng));
+    }
+    
+    ValidationFlags flags = validator.validateBatch(oldValues, newValues);
+    QCOMPARE(flags.size(), oldValues.size());
+    const std::pair<ValidationFlags::Flag, std::string> checks[] = {
+        {ValidationFlags::BelowMinimum, "Value below minimum"},
+        {ValidationFlags::AboveMaximum, "Value above maximum"},
+        {ValidationFlags::ChangeTooLarge, "Change exceeds"}
+    };
+    size_t expectedCounts[3] = {0, 0, 0};
+    
+    for (size_t i = 0; i < oldValues.size(); ++i) {
+        size_t address = 0x1000 + i * 2;
+        std::vector<ValidationWarning> expected = validator.validateChange(address, oldValues[i], newValues[i]);
+        
+        for (size_t k = 0; k < 3; ++k) {
+            bool flagged = hasWarning(expected, checks[k].second);
+            const auto& bitmap = flags.bitmap(checks[k].first);
+            QCOMPARE(flags.test(i, checks[k].first), flagged);
+            QCOMPARE(static_cast<bool>((bitmap[i / 64] >> (i % 64)) & 1), flagged);
+            expectedCounts[k] += flagged ? 1 : 0;
+        }
+        
+        // Messages built afterwards are those of the per-value check
+        std::vector<ValidationWarning> described = validator.describe(address, oldValues[i], newValues[i],
+                                                                      flags.at(i));
+        QCOMPARE(described.size(), expected.size());
+        for (size_t w = 0; w < expected.size(); ++w) {
+            QCOMPARE(described[w].message, expected[w].message);
+            QCOMPARE(described[w].address, expected[w].address);
+            QCOMPARE(described[w].changePercent, expected[w].changePercent);
+        }
+    }
+    
+    for (size_t k = 0; k < 3; ++k) {
+        QCOMPARE(flags.count(checks[k].first), expectedCounts[k]);
+        QVERIFY(expectedCounts[k] > 0);
+        // No bits past the last cell
+        QCOMPARE(flags.bitmap(checks[k].first).back() >> (oldValues.size() % 64), uint64_t(0));
+    }
+    
+    // The edge cases, spelled out
+    QCOMPARE(flags.at(0), static_cast<uint8_t>(ValidationFlags::None));
+    QCOMPARE(flags.at(1), static_cast<uint8_t>(ValidationFlags::ChangeTooLarge));
+    QCOMPARE(flags.at(2), static_cast<uint8_t>(ValidationFlags::ChangeTooLarge));
+    QCOMPARE(flags.at(3), static_cast<uint8_t>(ValidationFlags::BelowMinimum | ValidationFlags::ChangeTooLarge));
+    QCOMPARE(flags.at(4), static_cast<uint8_t>(ValidationFlags::AboveMaximum));
+    QCOMPARE(flags.at(5), static_cast<uint8_t>(ValidationFlags::None));
+    QCOMPARE(flags.at(6), static_cast<uint8_t>(ValidationFlags::None));
+    QCOMPARE(flags.at(8), static_cast<uint8_t>(ValidationFlags::AboveMaximum | ValidationFlags::ChangeTooLarge));
+    QCOMPARE(flags.at(9), static_cast<uint8_t>(ValidationFlags::BelowMinimum));
+    QCOMPARE(flags.at(10), static_cast<uint8_t>(ValidationFlags::None));
+    
+    // Mismatched spans are checked up to the shorter one
+    QCOMPARE(validator.validateBatch(oldValues, std::span<const double>(newValues).first(70)).size(),
+             static_cast<size_t>(70));
+}
+
+void TestValidator::testFlagQueries() {
+    Validator validator;
+    std::vector<double> oldValues(130, 10.0);
+    std::vector<double> newValues(130, 10.0);
+    
+    ValidationFlags flags = validator.validateBatch(oldValues, newValues);
+    QVERIFY(!flags.any());
+    QVERIFY(flags.flaggedCells().empty());
+    QCOMPARE(flags.count(), static_cast<size_t>(0));
+    
+    newValues[3] = 20.0;      // Change too large
+    newValues[64] = 2e6;      // Also above maximum
+    newValues[129] = -2e6;    // Also below minimum
+    flags = validator.validateBatch(oldValues, newValues);
+    QVERIFY(flags.any());
+    QVERIFY(flags.flaggedCells() == std::vector<size_t>({3, 64, 129}));
+    QVERIFY(flags.flaggedCells(2) == std::vector<size_t>({3, 64}));
+    QCOMPARE(flags.count(), static_cast<size_t>(3));
+    QCOMPARE(flags.count(ValidationFlags::ChangeTooLarge), static_cast<size_t>(3));
+    QCOMPARE(flags.count(ValidationFlags::AboveMaximum), static_cast<size_t>(1));
+    QCOMPARE(flags.count(ValidationFlags::BelowMinimum), static_cast<size_t>(1));
+    
+    // Out-of-range cells are never flagged
+    QVERIFY(!flags.test(130, ValidationFlags::ChangeTooLarge));
+    QCOMPARE(flags.at(1000), static_cast<uint8_t>(ValidationFlags::None));
+    QVERIFY(validator.describe(0, 10.0, 10.0, flags.at(0)).empty());
+}
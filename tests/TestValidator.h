@@ -0,0 +1,12 @@
+#pragma once
+
+#include <QtTest/QtTest>
+#include "../src/validation/Validator.h"
+
+class TestValidator : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testBatchMatchesValidateChange();
+    void testFlagQueries();
+};